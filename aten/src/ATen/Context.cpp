@@ -69,6 +69,24 @@ void Context::setBenchmarkCuDNN(bool b) {
   benchmark_cudnn = b;
 }
 
+bool Context::benchmarkCPUConvolution() const {
+  return benchmark_cpu_convolution;
+}
+
+void Context::setBenchmarkCPUConvolution(bool b) {
+  benchmark_cpu_convolution = b;
+}
+
+std::string Context::cpuConvolutionCacheFile() const {
+  std::lock_guard<std::mutex> lock(cpu_convolution_cache_file_mutex);
+  return cpu_convolution_cache_file;
+}
+
+void Context::setCPUConvolutionCacheFile(std::string path) {
+  std::lock_guard<std::mutex> lock(cpu_convolution_cache_file_mutex);
+  cpu_convolution_cache_file = std::move(path);
+}
+
 bool Context::hasMKL() const {
 #if AT_MKL_ENABLED()
   return true;
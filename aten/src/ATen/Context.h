@@ -12,6 +12,7 @@
 #include <memory>
 #include <mutex>
 #include <cstdint>
+#include <string>
 
 namespace at {
 
@@ -143,6 +144,15 @@ public:
   void setBenchmarkCuDNN(bool);
   bool deterministicCuDNN() const;
   void setDeterministicCuDNN(bool);
+  // Whether CPU convolutions time the algorithms available for every new
+  // shape and then stick to the fastest one, like benchmarkCuDNN
+  bool benchmarkCPUConvolution() const;
+  void setBenchmarkCPUConvolution(bool);
+  // File the algorithms chosen by benchmarkCPUConvolution are saved to and
+  // loaded from, so that they are reused across processes. Empty to only
+  // keep them in memory.
+  std::string cpuConvolutionCacheFile() const;
+  void setCPUConvolutionCacheFile(std::string);
   std::unique_ptr<Generator>
     generator_registry[static_cast<int>(Backend::NumOptions)];
 private:
@@ -159,6 +169,9 @@ private:
   bool enabled_cudnn = true;
   bool deterministic_cudnn = false;
   bool benchmark_cudnn = false;
+  bool benchmark_cpu_convolution = false;
+  std::string cpu_convolution_cache_file;
+  mutable std::mutex cpu_convolution_cache_file_mutex;
   std::atomic<size_t> next_id;
   std::unique_ptr<THCState, void(*)(THCState*)> thc_state;
   friend struct Type;
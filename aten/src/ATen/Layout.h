@@ -3,10 +3,13 @@
 #include <ATen/ScalarType.h>
 
 namespace at {
-enum class Layout { Strided, Sparse };
+// SparseCsr matrices don't have a Backend yet: no Type has this layout, and
+// they are handled as their components by the _sparse_csr_* functions.
+enum class Layout { Strided, Sparse, SparseCsr };
 
 constexpr auto kStrided = Layout::Strided;
 constexpr auto kSparse = Layout::Sparse;
+constexpr auto kSparseCsr = Layout::SparseCsr;
 
 inline Layout layout_from_backend(Backend backend) {
   switch (backend) {
@@ -81,6 +81,7 @@ void SparseTensorImpl::set_indices_and_values(const Tensor& indices, const Tenso
   // more explicit this way.)
   nnz_ = empty ? 0 : values.size(0);
   coalesced_ = false;
+  csr_ = Tensor();
 }
 
 
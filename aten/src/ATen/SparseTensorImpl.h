@@ -4,6 +4,8 @@
 #include "ATen/TensorImpl.h"
 #include "ATen/Error.h"
 
+#include <mutex>
+
 namespace at {
 struct SparseTensorImpl : public TensorImpl {
   // Stored in COO format, indices + values.
@@ -46,6 +48,12 @@ struct SparseTensorImpl : public TensorImpl {
   // because many algorithms proceed by merging two sorted lists (of indices).
   bool coalesced_ = false;
 
+  // Row pointers of the first sparse dimension, i.e. the CSR form of the
+  // indices of a coalesced tensor, computed by the first operation that asks
+  // for them.  Every setter drops it.
+  Tensor csr_;
+  std::mutex csr_mutex_;
+
 public:
   // Public for now...
   explicit SparseTensorImpl(Type * type);
@@ -57,6 +65,18 @@ public:
   Tensor indices() const { return indices_; }
   Tensor values() const { return values_; }
 
+  // Returns the cached CSR row pointers, calling compute() to build them if
+  // there are none.  Only valid on coalesced tensors.
+  template <typename F>
+  Tensor csr(const F& compute) {
+    AT_ASSERT(coalesced_);
+    std::lock_guard<std::mutex> guard(csr_mutex_);
+    if (!csr_.defined()) {
+      csr_ = compute();
+    }
+    return csr_;
+  }
+
   const char * toString() const override;
   IntList sizes() const override;
   IntList strides() const override;
@@ -80,6 +100,7 @@ public:
     }
     sparseDims_ = sparseDims;
     denseDims_ = denseDims;
+    csr_ = Tensor();
   }
 
   // TODO: I hate these two setters, please get rid of them!!!
@@ -87,14 +108,22 @@ public:
     AT_ASSERT(indices.type().backend() == at::toDense(type().backend()));
     AT_ASSERT(indices.type().scalarType() == kLong);
     indices_ = indices;
+    csr_ = Tensor();
   }
   void set_values(const Tensor& values) {
     AT_ASSERT(values.type().toSparse() == type());
     values_ = values;
+    csr_ = Tensor();
   }
 
-  void set_coalesced(bool coalesced) { coalesced_ = coalesced; }
-  void set_nnz(int64_t nnz) { nnz_ = nnz; }
+  void set_coalesced(bool coalesced) {
+    coalesced_ = coalesced;
+    csr_ = Tensor();
+  }
+  void set_nnz(int64_t nnz) {
+    nnz_ = nnz;
+    csr_ = Tensor();
+  }
 
   // This used to be called THSTensor_(_move)
   // NB: This used to be able to avoid a refcount bump, but I was too lazy to
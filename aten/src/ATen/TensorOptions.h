@@ -186,7 +186,8 @@ struct TensorOptions {
   }
 
   // Resolves the ATen backend specified by the current construction axes.
-  Backend backend() const noexcept {
+  Backend backend() const {
+    AT_CHECK(layout_ != kSparseCsr, "there is no Type for sparse CSR tensors");
     Backend backend;
     if (device_.type() == Device::Type::CPU) {
       backend = (layout_ == kStrided) ? kCPU : kSparseCPU;
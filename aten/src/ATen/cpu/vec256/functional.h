@@ -136,4 +136,25 @@ inline void map2(
   }
 }
 
+// y[0:size] += a * x[0:size]
+template <typename scalar_t>
+inline void axpy(
+    int64_t size,
+    scalar_t a,
+    const scalar_t* x,
+    scalar_t* y) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const Vec a_vec(a);
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size); d += Vec::size) {
+    Vec output_vec = Vec::loadu(y + d) + a_vec * Vec::loadu(x + d);
+    output_vec.store(y + d);
+  }
+  if (size - d > 0) {
+    Vec output_vec =
+        Vec::loadu(y + d, size - d) + a_vec * Vec::loadu(x + d, size - d);
+    output_vec.store(y + d, size - d);
+  }
+}
+
 }} // namespace at::vec256
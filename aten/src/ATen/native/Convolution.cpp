@@ -1,8 +1,13 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/ConvolutionAutotuner.h"
 
 #include "ATen/Config.h"
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
 namespace at { namespace native {
 
 struct ConvParams {
@@ -25,6 +30,9 @@ struct ConvParams {
   void view1d_as_2d();
   bool use_cudnn(const at::Tensor& input) const;
   bool use_mkldnn(const at::Tensor& input) const;
+  bool use_pointwise(const at::Tensor& input, const at::Tensor& weight) const;
+  bool use_cpu_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
+  bool use_winograd(const at::Tensor& input, const at::Tensor& weight) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
@@ -130,6 +138,38 @@ auto ConvParams::use_mkldnn(const at::Tensor& input) const -> bool {
   return false;
 }
 
+// 1x1 convolutions without padding don't need to unfold their input, see
+// pointwise_convolution. Dilation has no effect on 1x1 kernels.
+auto ConvParams::use_pointwise(
+        const at::Tensor& input, const at::Tensor& weight) const -> bool {
+  if (input.type().backend() != kCPU || transposed || is_padded()) {
+    return false;
+  }
+  for (int64_t d = 2; d < weight.dim(); d++) {
+    if (weight.size(d) != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The CPU depthwise kernels support any depth multiplier, i.e. any number of
+// output channels per input channel. A single input channel with groups == 1
+// is an ordinary convolution, which the other algorithms handle better.
+auto ConvParams::use_cpu_depthwise(
+        const at::Tensor& input, const at::Tensor& weight) const -> bool {
+  return input.type().backend() == kCPU && input.ndimension() == 4 &&
+         !transposed && groups == input.size(1) && groups > 1 &&
+         weight.size(0) % input.size(1) == 0;
+}
+
+auto ConvParams::use_winograd(
+        const at::Tensor& input, const at::Tensor& weight) const -> bool {
+  return input.type().backend() == kCPU && input.ndimension() == 4 &&
+         !transposed && groups == 1 && !is_strided() && !is_dilated() &&
+         weight.size(2) == 3 && weight.size(3) == 3;
+}
+
 // We currently only have depthwise support for the case where groups ==
 // nInputPlane and nInputPlane == nOutputPlane (the latter due to the lack of
 // a depthwise multiplier)
@@ -219,6 +259,168 @@ static at::Tensor subtensor(at::Tensor& tensor, int dim, int groups, int g) {
 }
 
 
+// Calls _convolution_nogroup once per group and concatenates the results
+static at::Tensor convolution_per_group(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  if (params.groups == 1) {
+    return at::_convolution_nogroup(
+        input, weight, bias, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
+  }
+  // subtensor takes non-const references
+  auto input_ = input;
+  auto weight_ = weight;
+  auto bias_ = bias;
+  std::vector<Tensor> outputs(params.groups);
+  for (int g = 0; g < params.groups; ++g) {
+    auto input_g = subtensor(input_, 1, params.groups, g);
+    auto weight_g = subtensor(weight_, 0, params.groups, g);
+    auto bias_g = subtensor(bias_, 0, params.groups, g);
+    outputs[g] = at::_convolution_nogroup(
+        input_g, weight_g, bias_g, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
+  }
+  return at::cat(outputs, 1);
+}
+
+// With 1x1 kernels and no padding, every output pixel is the product of the
+// weight matrix of its group and the input pixel, so the whole convolution is
+// one batched matrix product and the input needs no unfolding.
+static at::Tensor pointwise_convolution(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  auto strided_input = input;
+  for (size_t d = 0; d < params.stride.size(); d++) {
+    if (params.stride[d] != 1) {
+      strided_input = strided_input.slice(
+          d + 2, 0, strided_input.size(d + 2), params.stride[d]);
+    }
+  }
+  const int64_t batch_size = input.size(0);
+  const int64_t groups = params.groups;
+  std::vector<int64_t> output_size{batch_size, weight.size(0)};
+  int64_t pixels = 1;
+  for (int64_t d = 2; d < strided_input.dim(); d++) {
+    output_size.push_back(strided_input.size(d));
+    pixels *= strided_input.size(d);
+  }
+  // (groups, C_out / groups, C_in / groups) x (N, groups, C_in / groups, pixels)
+  auto output = at::matmul(
+      weight.reshape({groups, weight.size(0) / groups, weight.size(1)}),
+      strided_input.reshape({batch_size, groups, input.size(1) / groups, pixels}));
+  output = output.reshape(output_size);
+  if (bias.defined()) {
+    std::vector<int64_t> bias_size(output.dim(), 1);
+    bias_size[1] = -1;
+    output.add_(bias.reshape(bias_size));
+  }
+  return output;
+}
+
+static bool cpu_conv_algorithm_applies(
+    CPUConvAlgorithm algorithm,
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  switch (algorithm) {
+    case CPUConvAlgorithm::Thnn:
+      return true;
+    case CPUConvAlgorithm::Mkldnn:
+      return params.use_mkldnn(input) && input.type() == weight.type() &&
+             (!bias.defined() || input.type() == bias.type());
+    case CPUConvAlgorithm::Pointwise:
+      return params.use_pointwise(input, weight);
+    case CPUConvAlgorithm::Depthwise:
+      return params.use_cpu_depthwise(input, weight);
+    case CPUConvAlgorithm::Winograd:
+      return params.use_winograd(input, weight);
+  }
+  return false;
+}
+
+static at::Tensor cpu_convolution_with(
+    CPUConvAlgorithm algorithm,
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  switch (algorithm) {
+    case CPUConvAlgorithm::Thnn:
+      return convolution_per_group(input, weight, bias, params);
+    case CPUConvAlgorithm::Mkldnn:
+#if AT_MKLDNN_ENABLED()
+      return at::mkldnn_convolution(
+          input, weight, bias, params.padding, params.stride, params.dilation);
+#else
+      break;
+#endif
+    case CPUConvAlgorithm::Pointwise:
+      return pointwise_convolution(input, weight, bias, params);
+    case CPUConvAlgorithm::Depthwise:
+      return at::cpu_depthwise_convolution(
+          input, weight, bias, params.padding, params.stride, params.dilation);
+    case CPUConvAlgorithm::Winograd:
+      return at::cpu_winograd_convolution(input, weight, bias, params.padding);
+  }
+  AT_ERROR("CPU convolution algorithm ", cpu_conv_algorithm_name(algorithm),
+           " is not available in this build");
+}
+
+// Everything that can change which algorithm is the fastest
+static std::vector<int64_t> cpu_conv_algorithm_key(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  std::vector<int64_t> key{
+      static_cast<int64_t>(input.type().scalarType()),
+      at::get_num_threads(),
+      params.transposed,
+      params.groups,
+      bias.defined(),
+      input.dim()};
+  for (auto list : {input.sizes(), weight.sizes(), IntList(params.stride),
+                    IntList(params.padding), IntList(params.dilation),
+                    IntList(params.output_padding)}) {
+    key.insert(key.end(), list.begin(), list.end());
+  }
+  return key;
+}
+
+// Number of timed runs of every algorithm, after an untimed warm-up run
+static constexpr int kCPUConvBenchmarkRuns = 3;
+
+// Runs the fastest applicable algorithm. On the first call for a given key,
+// every algorithm is timed and the output of the fastest one is returned.
+static at::Tensor cpu_convolution_autotuned(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const ConvParams& params) {
+  const auto key = cpu_conv_algorithm_key(input, weight, bias, params);
+  CPUConvAlgorithm algorithm;
+  if (lookup_cpu_conv_algorithm(key, &algorithm) &&
+      cpu_conv_algorithm_applies(algorithm, input, weight, bias, params)) {
+    return cpu_convolution_with(algorithm, input, weight, bias, params);
+  }
+
+  Tensor best_output;
+  double best_time = std::numeric_limits<double>::infinity();
+  for (auto candidate : kCPUConvAlgorithms) {
+    if (!cpu_conv_algorithm_applies(candidate, input, weight, bias, params)) {
+      continue;
+    }
+    auto output = cpu_convolution_with(candidate, input, weight, bias, params);
+    double time = std::numeric_limits<double>::infinity();
+    for (int run = 0; run < kCPUConvBenchmarkRuns; run++) {
+      const auto start = std::chrono::steady_clock::now();
+      output = cpu_convolution_with(candidate, input, weight, bias, params);
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      time = std::min(time, elapsed.count());
+    }
+    if (time < best_time) {
+      best_time = time;
+      best_output = output;
+      algorithm = candidate;
+    }
+  }
+  insert_cpu_conv_algorithm(key, algorithm);
+  return best_output;
+}
+
 at::Tensor conv1d(
     const Tensor& input, const Tensor& weight, const Tensor& bias,
     IntList stride, IntList padding, IntList dilation, int64_t groups) {
@@ -356,6 +558,12 @@ at::Tensor _convolution(
           input, weight, bias,
           params.padding, params.stride, params.dilation, params.groups, params.benchmark, params.deterministic);
     }
+  } else if (input.type().backend() == kCPU &&
+             at::globalContext().benchmarkCPUConvolution()) {
+    output = cpu_convolution_autotuned(input, weight, bias, params);
+  } else if (params.use_cpu_depthwise(input, weight)) {
+    output = at::cpu_depthwise_convolution(
+        input, weight, bias, params.padding, params.stride, params.dilation);
   } else if (params.use_mkldnn(input)) {
 #if AT_MKLDNN_ENABLED()
     if (input.type() != weight.type()){
@@ -372,20 +580,7 @@ at::Tensor _convolution(
     output = at::mkldnn_convolution(input, weight, bias, params.padding, params.stride, params.dilation);
 #endif
   } else {
-    if (params.groups == 1) {
-      output = at::_convolution_nogroup(
-          input, weight, bias, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
-    } else {
-      std::vector<Tensor> outputs(params.groups);
-      for (int g = 0; g < params.groups; ++g) {
-        auto input_g = subtensor(input, 1, params.groups, g);
-        auto weight_g = subtensor(weight, 0, params.groups, g);
-        auto bias_g = subtensor(bias, 0, params.groups, g);
-        outputs[g] = at::_convolution_nogroup(
-            input_g, weight_g, bias_g, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
-      }
-      output = at::cat(outputs, 1);
-    }
+    output = convolution_per_group(input, weight, bias, params);
   }
 
   if (k == 3) {
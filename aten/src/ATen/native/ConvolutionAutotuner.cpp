@@ -0,0 +1,122 @@
+#include "ATen/native/ConvolutionAutotuner.h"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "ATen/Context.h"
+#include "ATen/Error.h"
+
+namespace at { namespace native {
+
+namespace {
+
+struct AlgorithmCache {
+  std::mutex mutex;
+  std::map<std::vector<int64_t>, CPUConvAlgorithm> algorithms;
+  // Cache file whose entries have been read into algorithms
+  std::string loaded_file;
+};
+
+AlgorithmCache& algorithm_cache() {
+  static AlgorithmCache cache;
+  return cache;
+}
+
+bool parse_algorithm(const std::string& name, CPUConvAlgorithm* algorithm) {
+  for (auto candidate : kCPUConvAlgorithms) {
+    if (name == cpu_conv_algorithm_name(candidate)) {
+      *algorithm = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Every line of a cache file holds the integers of a key followed by the name
+// of its algorithm. Lines that can't be parsed, e.g. naming an algorithm this
+// build doesn't know about, are skipped. Entries already in memory win.
+void read_cache_file(
+    const std::string& path,
+    std::map<std::vector<int64_t>, CPUConvAlgorithm>& algorithms) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (fields >> token) {
+      tokens.push_back(token);
+    }
+    CPUConvAlgorithm algorithm;
+    if (tokens.size() < 2 || !parse_algorithm(tokens.back(), &algorithm)) {
+      continue;
+    }
+    std::vector<int64_t> key;
+    bool valid = true;
+    for (size_t i = 0; i + 1 < tokens.size() && valid; i++) {
+      std::istringstream number(tokens[i]);
+      int64_t value;
+      valid = (number >> value) && number.eof();
+      key.push_back(value);
+    }
+    if (valid) {
+      algorithms.emplace(std::move(key), algorithm);
+    }
+  }
+}
+
+} // anonymous namespace
+
+const char* cpu_conv_algorithm_name(CPUConvAlgorithm algorithm) {
+  switch (algorithm) {
+    case CPUConvAlgorithm::Thnn: return "thnn";
+    case CPUConvAlgorithm::Mkldnn: return "mkldnn";
+    case CPUConvAlgorithm::Pointwise: return "pointwise";
+    case CPUConvAlgorithm::Depthwise: return "depthwise";
+    case CPUConvAlgorithm::Winograd: return "winograd";
+  }
+  AT_ERROR("unknown CPU convolution algorithm");
+}
+
+bool lookup_cpu_conv_algorithm(
+    const std::vector<int64_t>& key, CPUConvAlgorithm* algorithm) {
+  const auto path = globalContext().cpuConvolutionCacheFile();
+  auto& cache = algorithm_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (path != cache.loaded_file) {
+    if (!path.empty()) {
+      read_cache_file(path, cache.algorithms);
+    }
+    cache.loaded_file = path;
+  }
+  auto it = cache.algorithms.find(key);
+  if (it == cache.algorithms.end()) {
+    return false;
+  }
+  *algorithm = it->second;
+  return true;
+}
+
+void insert_cpu_conv_algorithm(
+    const std::vector<int64_t>& key, CPUConvAlgorithm algorithm) {
+  const auto path = globalContext().cpuConvolutionCacheFile();
+  auto& cache = algorithm_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.algorithms[key] = algorithm;
+  if (path.empty()) {
+    return;
+  }
+  std::ofstream file(path, std::ios::app);
+  for (auto value : key) {
+    file << value << " ";
+  }
+  file << cpu_conv_algorithm_name(algorithm) << "\n";
+  if (!file) {
+    AT_WARN("could not write the CPU convolution algorithm cache file ", path);
+  }
+}
+
+}} // namespace at::native
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace at { namespace native {
+
+// Algorithms that benchmarkCPUConvolution chooses between. Their names are
+// what cache files store, so they must not change.
+enum class CPUConvAlgorithm {
+  Thnn,      // THNN kernels (unfold + GEMM), one call per group
+  Mkldnn,    // MKL-DNN, for ungrouped, undilated 2d float convolutions
+  Pointwise, // 1x1 kernels as a batched matrix product, without unfold
+  Depthwise, // direct kernels for groups == input channels
+  Winograd,  // F(m x m, 3 x 3) for ungrouped, stride 1, undilated 3x3 kernels
+};
+
+static constexpr CPUConvAlgorithm kCPUConvAlgorithms[] = {
+  CPUConvAlgorithm::Thnn,
+  CPUConvAlgorithm::Mkldnn,
+  CPUConvAlgorithm::Pointwise,
+  CPUConvAlgorithm::Depthwise,
+  CPUConvAlgorithm::Winograd,
+};
+
+const char* cpu_conv_algorithm_name(CPUConvAlgorithm algorithm);
+
+// Cache of the fastest algorithm for every convolution, keyed by everything
+// that can change which algorithm wins (see Convolution.cpp). If the global
+// context names a cache file, the file is read on the first lookup after the
+// name changes and every new entry is appended to it.
+bool lookup_cpu_conv_algorithm(
+    const std::vector<int64_t>& key, CPUConvAlgorithm* algorithm);
+void insert_cpu_conv_algorithm(
+    const std::vector<int64_t>& key, CPUConvAlgorithm algorithm);
+
+}} // namespace at::native
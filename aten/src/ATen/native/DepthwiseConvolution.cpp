@@ -0,0 +1,83 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/cpu/DepthwiseConvKernel.h"
+
+namespace at { namespace native {
+
+static std::vector<int64_t> depthwise_output_size(
+    const Tensor& input, const Tensor& weight,
+    IntList padding, IntList stride, IntList dilation) {
+  std::vector<int64_t> output_size{input.size(0), weight.size(0)};
+  for (int64_t d = 0; d < 2; d++) {
+    const int64_t kernel = dilation[d] * (weight.size(d + 2) - 1) + 1;
+    output_size.push_back(
+        (input.size(d + 2) + 2 * padding[d] - kernel) / stride[d] + 1);
+  }
+  return output_size;
+}
+
+static void check_depthwise_args(
+    const char* name, const Tensor& input, const Tensor& weight,
+    IntList padding, IntList stride, IntList dilation) {
+  AT_CHECK(input.dim() == 4 && weight.dim() == 4,
+           name, ": expected 4-d input and weight, but got ",
+           input.dim(), "-d and ", weight.dim(), "-d");
+  AT_CHECK(weight.size(1) == 1 && weight.size(0) % input.size(1) == 0,
+           name, ": expected a [k * C, 1, kH, kW] weight for an input with C = ",
+           input.size(1), " channels, but got ", weight.sizes());
+  AT_CHECK(padding.size() == 2 && stride.size() == 2 && dilation.size() == 2,
+           name, ": expected 2 paddings, strides and dilations");
+  for (int64_t d = 0; d < 2; d++) {
+    AT_CHECK(padding[d] >= 0 && stride[d] > 0 && dilation[d] > 0,
+             name, ": invalid padding ", padding, ", stride ", stride,
+             " or dilation ", dilation);
+  }
+  const auto output_size =
+      depthwise_output_size(input, weight, padding, stride, dilation);
+  AT_CHECK(output_size[2] > 0 && output_size[3] > 0,
+           name, ": the kernel is larger than the padded input of size ",
+           input.sizes());
+}
+
+Tensor cpu_depthwise_convolution(
+    const Tensor& self, const Tensor& weight, const Tensor& bias,
+    IntList padding, IntList stride, IntList dilation) {
+  check_depthwise_args(
+      "cpu_depthwise_convolution", self, weight, padding, stride, dilation);
+  auto output = at::empty(
+      depthwise_output_size(self, weight, padding, stride, dilation),
+      self.options());
+  depthwise_conv_kernel(
+      output, self.contiguous(), weight.contiguous(),
+      bias.defined() ? bias.contiguous() : bias, padding, stride, dilation);
+  return output;
+}
+
+std::tuple<Tensor, Tensor, Tensor> cpu_depthwise_convolution_backward(
+    const Tensor& self, const Tensor& grad_output_t, const Tensor& weight,
+    IntList padding, IntList stride, IntList dilation,
+    std::array<bool,3> output_mask) {
+  check_depthwise_args(
+      "cpu_depthwise_convolution_backward", self, weight, padding, stride,
+      dilation);
+  auto grad_output = grad_output_t.contiguous();
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = at::empty(self.sizes(), self.options());
+    depthwise_conv_backward_input_kernel(
+        grad_input, grad_output, weight.contiguous(), padding, stride,
+        dilation);
+  }
+  if (output_mask[1]) {
+    grad_weight = at::empty(weight.sizes(), weight.options());
+    depthwise_conv_backward_weight_kernel(
+        grad_weight, grad_output, self.contiguous(), padding, stride,
+        dilation);
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output.sum({0, 2, 3});
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
+}
+
+}} // namespace at::native
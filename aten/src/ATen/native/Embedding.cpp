@@ -78,7 +78,13 @@ Tensor embedding_sparse_backward(
 
   auto index = indices.reshape({1, -1});
   auto values = grad.reshape({-1, num_features});
-  return sparse_type._sparse_coo_tensor_unsafe(index, values, weight_size);
+  auto result = sparse_type._sparse_coo_tensor_unsafe(index, values, weight_size);
+  // Sum the rows of repeated indices once here, on CPU with the radix sort
+  // based unique_sum_kernel, instead of in every consumer of the gradient.
+  if (!grad.is_cuda()) {
+    return result.coalesce();
+  }
+  return result;
 }
 
 Tensor embedding_dense_backward_cpu(
@@ -1,8 +1,7 @@
 #include "ATen/ATen.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
-
-#include "TH/THBlasUtils.h"
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
 
 #include <cstring>
 #include <iostream>
@@ -31,31 +30,6 @@ static void make_offset2bag(const Tensor &offsets, const Tensor &indices,
   offset2bag = offset2bag.cumsum(0);     // offset2bag = [0 0 1 1 2]
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-static void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output) {
-  auto add_indices_data = add_indices.data<int64_t>();
-  auto select_indices_data = select_indices.data<int64_t>();
-  auto src_data = src.data<T>();
-  auto output_data = output.data<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
-  }
-}
-
 static void make_bag_size(const Tensor &offsets, const Tensor &indices,
                           const int64_t mode, Tensor &bag_size) {
   if (mode == MODE_MEAN || mode == MODE_MAX) {
@@ -69,26 +43,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = indices.size(0);
-      output /= bag_size_;
-    } else {
-      // Avoid dividing by 0 for empty bags.
-      // Instead we want empty bags to return all 0s
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .toType(output.type())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -107,6 +61,16 @@ static Tensor apply_bag_size_backward(const Tensor &offsets,
   return output;
 }
 
+// Per-bag factor the gradient of a bag is multiplied by: 1 / bag_size for
+// MODE_MEAN (with empty bags treated as size 1), undefined (i.e. 1) otherwise.
+static Tensor make_bag_scale(const Tensor &bag_size, const int64_t mode,
+                             const Type &type) {
+  if (mode != MODE_MEAN) {
+    return Tensor();
+  }
+  return (1 / at::max(bag_size, at::ones_like(bag_size)).toType(type))
+      .contiguous();
+}
 
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
@@ -187,17 +151,14 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
 
   offset2bag.resize_({indices.sizes()[0]});
 
-  auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
-
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    if (weight.type().scalarType() == kFloat) {
-      index_select_add<float>(indices, offset2bag, weight, output);
-    } else if (weight.type().scalarType() == kDouble) {
-      index_select_add<double>(indices, offset2bag, weight, output);
-    }
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    // Every bag is written by the kernel, empty ones included
+    auto output = at::empty({offsets.size(0), weight.size(1)}, weight.type());
+    embedding_bag_sum_kernel(output, weight, indices, offsets, Tensor(),
+                             mode == MODE_MEAN);
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
+    auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
     return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.type(), "embedding_bag_cpu_max", [&]() {
         return embedding_bag_cpu_max<scalar_t>(weight, indices, offset2bag, output, bag_size, offsets);
@@ -259,70 +220,13 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   auto ind_sort = std::get<1>(ind_sort_);
   auto offset2bag = offset2bag_.index_select(0, ind_sort);
 
-  auto indices_data = indices.data<int64_t>();
-  auto offsets_data = offsets_.data<int64_t>();
-  auto offset2bag_data = offset2bag.data<int64_t>();
-  int64_t numel = indices.numel();
-
-  std::vector<int64_t> counts(num_weights);
-  for (int i = 0; i < numel; i++) {
-    counts[indices_data[i]] = 0;
-  }
-  for (int i = 0; i < numel; i++) {
-    counts[indices_data[i]]++;
-  }
-
   auto index_grad_weight =
       at::zeros({num_weights, grad.size(1)}, grad.type()).contiguous();
 
-  std::vector<int64_t> counts_uniq;
-  counts_uniq.reserve(num_weights);
-  int64_t o = 0;
-  for (int64_t i = 0; i < numel; i += counts[indices_data[i]]) {
-    counts_uniq.push_back(counts[indices_data[i]]);
-    if (o > 0) {
-      counts_uniq[o] += counts_uniq[o - 1];
-    }
-    o++;
-  }
-
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    #pragma omp parallel for if (numel > 1000)
-      for (int64_t i = 0; i < (int64_t)counts_uniq.size(); i++) {
-        int64_t start = i == 0 ? 0 : counts_uniq[i - 1];
-        int64_t index = indices_data[start];
-        for (int64_t j = start; j < counts_uniq[i]; j++) {
-          int64_t source = offset2bag_data[j];
-          double scale = 1.0;
-          if (scale_grad_by_freq) {
-            scale /= counts[indices_data[i]];
-          }
-          if (mode == 1) { // MODE_MEAN
-            if (offsets_.size(0) == 1) {
-              auto bag_size = indices.size(0);
-              scale /= bag_size;
-            } else {
-              if (source == offsets_.size(0) - 1) {
-                scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-              } else {
-                scale /= offsets_data[source + 1] - offsets_data[source];
-              }
-            }
-          }
-          int64_t ddim = grad.size(1);
-          if (grad.type().scalarType() == kFloat) {
-            auto igwd = index_grad_weight.data<float>();
-            auto gd = grad.data<float>();
-            THBlas_axpy<float>(ddim, (float)scale, gd + ddim * source, 1,
-                        igwd + ddim * index, 1);
-          } else if (grad.type().scalarType() == kDouble) {
-            auto igwd = index_grad_weight.data<double>();
-            auto gd = grad.data<double>();
-            THBlas_axpy<double>(ddim, (double)scale, gd + ddim * source, 1,
-                         igwd + ddim * index, 1);
-          }
-        }
-      }
+    auto bag_scale = make_bag_scale(bag_size_, mode, grad.type());
+    embedding_bag_backward_kernel(index_grad_weight, grad, indices, offset2bag,
+                                  bag_scale, scale_grad_by_freq);
   } else if (mode == MODE_MAX) {
     auto nonempty_max_indices = max_indices_.index_select(0, bag_size_.nonzero().view(-1));
     auto nonempty_grad = grad_.index_select(0, bag_size_.nonzero().view(-1));
@@ -345,10 +249,21 @@ Tensor _embedding_bag_sparse_backward(
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
   // for more details.
 
-  Tensor grad = grad_;
-  Tensor index_grad = grad_.index_select(0, offset2bag);
-  index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
-                                       offset2bag, bag_size_);
+  Tensor index_grad;
+  if (grad_.type().is_cuda()) {
+    index_grad = grad_.index_select(0, offset2bag);
+    index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
+                                         offset2bag, bag_size_);
+  } else {
+    auto grad = grad_.contiguous();
+    auto grad_arg = TensorArg(grad, "grad_", 1);
+    checkScalarTypes("embedding_bag", grad_arg, {kFloat, kDouble});
+
+    index_grad = at::empty({indices.size(0), grad.size(1)}, grad.type());
+    auto bag_scale = make_bag_scale(bag_size_, mode, grad.type());
+    embedding_bag_backward_gather_kernel(index_grad, grad, offset2bag,
+                                         bag_scale);
+  }
   return native::embedding_backward(index_grad, indices, num_weights, -1,
                                     scale_grad_by_freq, true);
 }
@@ -0,0 +1,108 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/cpu/WinogradConvKernel.h"
+
+namespace at { namespace native {
+
+// Output tile size m of the F(m x m, 3 x 3) algorithm. Larger tiles take
+// fewer multiplies, but are less accurate and waste more work on the partial
+// tiles at the borders of small outputs.
+static int64_t winograd_tile_size(int64_t output_height, int64_t output_width) {
+  return (output_height >= 8 && output_width >= 8) ? 4 : 2;
+}
+
+// Stride 1, undilated 3x3 convolution of contiguous tensors
+static Tensor winograd_convolution(
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntList padding) {
+  const int64_t batch_size = input.size(0);
+  const int64_t in_channels = input.size(1);
+  const int64_t out_channels = weight.size(0);
+  const int64_t output_height = input.size(2) + 2 * padding[0] - 2;
+  const int64_t output_width = input.size(3) + 2 * padding[1] - 2;
+  const int64_t m = winograd_tile_size(output_height, output_width);
+  const int64_t alpha = m + 2;
+  const int64_t tiles =
+      ((output_height + m - 1) / m) * ((output_width + m - 1) / m);
+
+  auto transformed_weight =
+      at::empty({alpha * alpha, out_channels, in_channels}, weight.options());
+  winograd_weight_transform_kernel(transformed_weight, weight, m);
+  auto transformed_input = at::empty(
+      {alpha * alpha, in_channels, batch_size * tiles}, input.options());
+  winograd_input_transform_kernel(transformed_input, input, padding, m);
+  auto transformed_output = at::bmm(transformed_weight, transformed_input);
+  auto output = at::empty(
+      {batch_size, out_channels, output_height, output_width},
+      input.options());
+  winograd_output_transform_kernel(output, transformed_output, bias, m);
+  return output;
+}
+
+static void check_winograd_args(
+    const char* name, const Tensor& input, const Tensor& weight,
+    IntList padding) {
+  AT_CHECK(input.dim() == 4 && weight.dim() == 4,
+           name, ": expected 4-d input and weight, but got ",
+           input.dim(), "-d and ", weight.dim(), "-d");
+  AT_CHECK(weight.size(1) == input.size(1) && weight.size(2) == 3 &&
+           weight.size(3) == 3,
+           name, ": expected a [C_out, ", input.size(1), ", 3, 3] weight, but got ",
+           weight.sizes());
+  AT_CHECK(padding.size() == 2 && padding[0] >= 0 && padding[1] >= 0,
+           name, ": invalid padding ", padding);
+  AT_CHECK(input.size(2) + 2 * padding[0] >= 3 &&
+           input.size(3) + 2 * padding[1] >= 3,
+           name, ": the kernel is larger than the padded input of size ",
+           input.sizes());
+}
+
+Tensor cpu_winograd_convolution(
+    const Tensor& self, const Tensor& weight, const Tensor& bias,
+    IntList padding) {
+  check_winograd_args("cpu_winograd_convolution", self, weight, padding);
+  return winograd_convolution(
+      self.contiguous(), weight.contiguous(),
+      bias.defined() ? bias.contiguous() : bias, padding);
+}
+
+std::tuple<Tensor, Tensor, Tensor> cpu_winograd_convolution_backward(
+    const Tensor& self, const Tensor& grad_output, const Tensor& weight,
+    IntList padding, std::array<bool,3> output_mask) {
+  check_winograd_args(
+      "cpu_winograd_convolution_backward", self, weight, padding);
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    // The input gradient is a convolution of grad_output, padded by 2 -
+    // padding, with the flipped and transposed weight. Padding beyond 2 is
+    // cropped off grad_output instead.
+    auto grad = grad_output;
+    std::vector<int64_t> grad_padding(2);
+    for (int64_t d = 0; d < 2; d++) {
+      grad_padding[d] = 2 - padding[d];
+      if (grad_padding[d] < 0) {
+        grad = grad.narrow(
+            d + 2, -grad_padding[d], grad.size(d + 2) + 2 * grad_padding[d]);
+        grad_padding[d] = 0;
+      }
+    }
+    grad_input = winograd_convolution(
+        grad.contiguous(), weight.flip({2, 3}).transpose(0, 1).contiguous(),
+        Tensor(), grad_padding);
+  }
+  if (output_mask[1]) {
+    // grad_weight[o][i] is the correlation of input channel i with channel o
+    // of grad_output, summed over the batch, i.e. a convolution with the
+    // batch and channel dimensions swapped
+    grad_weight = at::thnn_conv2d(
+        self.transpose(0, 1), grad_output.transpose(0, 1),
+        {grad_output.size(2), grad_output.size(3)}, Tensor(), 1, padding)
+        .transpose(0, 1).contiguous();
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output.sum({0, 2, 3});
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
+}
+
+}} // namespace at::native
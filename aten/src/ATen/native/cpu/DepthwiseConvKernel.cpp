@@ -0,0 +1,324 @@
+#include "ATen/native/cpu/DepthwiseConvKernel.h"
+
+#include <algorithm>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/functional.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// Every output plane of a depthwise convolution only depends on one input
+// plane, so instead of unfolding the input into a matrix, the kernels loop
+// over the rows of a plane and the taps of the filter, and accumulate whole
+// rows at a time. With stride 1 the rows are contiguous and the accumulation
+// is a vectorized axpy (or dot product for the weight gradient). Work is
+// split across planes, so every output element is written by one thread.
+
+namespace at { namespace native {
+namespace {
+
+struct DepthwiseGeometry {
+  DepthwiseGeometry(
+      const Tensor& input, const Tensor& weight, const Tensor& output,
+      IntList padding, IntList stride, IntList dilation)
+    : batch_size(input.size(0)),
+      in_channels(input.size(1)),
+      out_channels(weight.size(0)),
+      multiplier(weight.size(0) / input.size(1)),
+      height(input.size(2)),
+      width(input.size(3)),
+      output_height(output.size(2)),
+      output_width(output.size(3)),
+      kernel_height(weight.size(2)),
+      kernel_width(weight.size(3)),
+      pad_h(padding[0]), pad_w(padding[1]),
+      stride_h(stride[0]), stride_w(stride[1]),
+      dilation_h(dilation[0]), dilation_w(dilation[1]) {}
+
+  int64_t batch_size, in_channels, out_channels, multiplier;
+  int64_t height, width, output_height, output_width;
+  int64_t kernel_height, kernel_width;
+  int64_t pad_h, pad_w, stride_h, stride_w, dilation_h, dilation_w;
+
+  // Input row read by output row oy for kernel row ky; may be out of range.
+  int64_t input_row(int64_t oy, int64_t ky) const {
+    return oy * stride_h - pad_h + ky * dilation_h;
+  }
+
+  // Output columns [*begin, *end) whose input column for kernel column kx is
+  // inside the input. The input column of output column x is
+  // x * stride_w + input_column_offset(kx).
+  void output_columns(int64_t kx, int64_t* begin, int64_t* end) const {
+    const int64_t offset = input_column_offset(kx);
+    *begin = offset >= 0 ? 0 : (-offset + stride_w - 1) / stride_w;
+    const int64_t last = width - 1 - offset;
+    *end = last < 0 ? 0 : std::min(last / stride_w + 1, output_width);
+    *end = std::max(*begin, *end);
+  }
+
+  int64_t input_column_offset(int64_t kx) const {
+    return kx * dilation_w - pad_w;
+  }
+};
+
+// Planes processed per task so that each task does roughly GRAIN_SIZE
+// multiply-adds
+inline int64_t grain_size_for(int64_t work_per_plane) {
+  return std::max<int64_t>(
+      internal::GRAIN_SIZE / std::max<int64_t>(work_per_plane, 1), 1);
+}
+
+// y[0:n] += a * x[0:n * x_stride:x_stride]
+template <typename scalar_t>
+inline void axpy_gather(
+    int64_t n, scalar_t a, const scalar_t* x, int64_t x_stride, scalar_t* y) {
+  if (x_stride == 1) {
+    vec256::axpy<scalar_t>(n, a, x, y);
+    return;
+  }
+  for (int64_t i = 0; i < n; i++) {
+    y[i] += a * x[i * x_stride];
+  }
+}
+
+// y[0:n * y_stride:y_stride] += a * x[0:n]
+template <typename scalar_t>
+inline void axpy_scatter(
+    int64_t n, scalar_t a, const scalar_t* x, scalar_t* y, int64_t y_stride) {
+  if (y_stride == 1) {
+    vec256::axpy<scalar_t>(n, a, x, y);
+    return;
+  }
+  for (int64_t i = 0; i < n; i++) {
+    y[i * y_stride] += a * x[i];
+  }
+}
+
+// sum of x[i] * y[i * y_stride] for i in [0, n)
+template <typename scalar_t>
+inline scalar_t dot_gather(
+    int64_t n, const scalar_t* x, const scalar_t* y, int64_t y_stride) {
+  scalar_t sum = 0;
+  int64_t i = 0;
+  if (y_stride == 1) {
+    using Vec = vec256::Vec256<scalar_t>;
+    Vec sum_vec(0);
+    for (; i < n - (n % Vec::size); i += Vec::size) {
+      sum_vec = sum_vec + Vec::loadu(x + i) * Vec::loadu(y + i);
+    }
+    scalar_t sums[Vec::size];
+    sum_vec.store(sums);
+    for (int64_t j = 0; j < Vec::size; j++) {
+      sum += sums[j];
+    }
+  }
+  for (; i < n; i++) {
+    sum += x[i] * y[i * y_stride];
+  }
+  return sum;
+}
+
+template <typename scalar_t>
+void depthwise_conv(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const DepthwiseGeometry& g) {
+  const auto* input_data = input.data<scalar_t>();
+  const auto* weight_data = weight.data<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data<scalar_t>() : nullptr;
+  auto* output_data = output.data<scalar_t>();
+  const int64_t input_plane = g.height * g.width;
+  const int64_t output_plane = g.output_height * g.output_width;
+  const int64_t kernel_plane = g.kernel_height * g.kernel_width;
+
+  parallel_for(
+      0, g.batch_size * g.out_channels, grain_size_for(output_plane * kernel_plane),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t plane = begin; plane < end; plane++) {
+          const int64_t c = plane % g.out_channels;
+          const int64_t n = plane / g.out_channels;
+          const scalar_t* in =
+              input_data + (n * g.in_channels + c / g.multiplier) * input_plane;
+          const scalar_t* w = weight_data + c * kernel_plane;
+          scalar_t* out = output_data + plane * output_plane;
+          std::fill(out, out + output_plane, bias_data ? bias_data[c] : scalar_t(0));
+          for (int64_t oy = 0; oy < g.output_height; oy++) {
+            scalar_t* out_row = out + oy * g.output_width;
+            for (int64_t ky = 0; ky < g.kernel_height; ky++) {
+              const int64_t iy = g.input_row(oy, ky);
+              if (iy < 0 || iy >= g.height) {
+                continue;
+              }
+              const scalar_t* in_row = in + iy * g.width;
+              for (int64_t kx = 0; kx < g.kernel_width; kx++) {
+                int64_t x_begin, x_end;
+                g.output_columns(kx, &x_begin, &x_end);
+                axpy_gather<scalar_t>(
+                    x_end - x_begin, w[ky * g.kernel_width + kx],
+                    in_row + x_begin * g.stride_w + g.input_column_offset(kx),
+                    g.stride_w, out_row + x_begin);
+              }
+            }
+          }
+        }
+      });
+}
+
+template <typename scalar_t>
+void depthwise_conv_backward_input(
+    Tensor& grad_input,
+    const Tensor& grad_output,
+    const Tensor& weight,
+    const DepthwiseGeometry& g) {
+  const auto* grad_output_data = grad_output.data<scalar_t>();
+  const auto* weight_data = weight.data<scalar_t>();
+  auto* grad_input_data = grad_input.data<scalar_t>();
+  const int64_t input_plane = g.height * g.width;
+  const int64_t output_plane = g.output_height * g.output_width;
+  const int64_t kernel_plane = g.kernel_height * g.kernel_width;
+
+  parallel_for(
+      0, g.batch_size * g.in_channels,
+      grain_size_for(g.multiplier * output_plane * kernel_plane),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t plane = begin; plane < end; plane++) {
+          const int64_t c = plane % g.in_channels;
+          const int64_t n = plane / g.in_channels;
+          scalar_t* grad_in = grad_input_data + plane * input_plane;
+          std::fill(grad_in, grad_in + input_plane, scalar_t(0));
+          for (int64_t k = 0; k < g.multiplier; k++) {
+            const int64_t oc = c * g.multiplier + k;
+            const scalar_t* grad_out =
+                grad_output_data + (n * g.out_channels + oc) * output_plane;
+            const scalar_t* w = weight_data + oc * kernel_plane;
+            for (int64_t oy = 0; oy < g.output_height; oy++) {
+              const scalar_t* grad_out_row = grad_out + oy * g.output_width;
+              for (int64_t ky = 0; ky < g.kernel_height; ky++) {
+                const int64_t iy = g.input_row(oy, ky);
+                if (iy < 0 || iy >= g.height) {
+                  continue;
+                }
+                scalar_t* grad_in_row = grad_in + iy * g.width;
+                for (int64_t kx = 0; kx < g.kernel_width; kx++) {
+                  int64_t x_begin, x_end;
+                  g.output_columns(kx, &x_begin, &x_end);
+                  axpy_scatter<scalar_t>(
+                      x_end - x_begin, w[ky * g.kernel_width + kx],
+                      grad_out_row + x_begin,
+                      grad_in_row + x_begin * g.stride_w + g.input_column_offset(kx),
+                      g.stride_w);
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+template <typename scalar_t>
+void depthwise_conv_backward_weight(
+    Tensor& grad_weight,
+    const Tensor& grad_output,
+    const Tensor& input,
+    const DepthwiseGeometry& g) {
+  const auto* grad_output_data = grad_output.data<scalar_t>();
+  const auto* input_data = input.data<scalar_t>();
+  auto* grad_weight_data = grad_weight.data<scalar_t>();
+  const int64_t input_plane = g.height * g.width;
+  const int64_t output_plane = g.output_height * g.output_width;
+  const int64_t kernel_plane = g.kernel_height * g.kernel_width;
+
+  parallel_for(
+      0, g.out_channels,
+      grain_size_for(g.batch_size * output_plane * kernel_plane),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t oc = begin; oc < end; oc++) {
+          scalar_t* grad_w = grad_weight_data + oc * kernel_plane;
+          std::fill(grad_w, grad_w + kernel_plane, scalar_t(0));
+          for (int64_t n = 0; n < g.batch_size; n++) {
+            const scalar_t* in = input_data +
+                (n * g.in_channels + oc / g.multiplier) * input_plane;
+            const scalar_t* grad_out =
+                grad_output_data + (n * g.out_channels + oc) * output_plane;
+            for (int64_t oy = 0; oy < g.output_height; oy++) {
+              const scalar_t* grad_out_row = grad_out + oy * g.output_width;
+              for (int64_t ky = 0; ky < g.kernel_height; ky++) {
+                const int64_t iy = g.input_row(oy, ky);
+                if (iy < 0 || iy >= g.height) {
+                  continue;
+                }
+                const scalar_t* in_row = in + iy * g.width;
+                for (int64_t kx = 0; kx < g.kernel_width; kx++) {
+                  int64_t x_begin, x_end;
+                  g.output_columns(kx, &x_begin, &x_end);
+                  grad_w[ky * g.kernel_width + kx] += dot_gather<scalar_t>(
+                      x_end - x_begin, grad_out_row + x_begin,
+                      in_row + x_begin * g.stride_w + g.input_column_offset(kx),
+                      g.stride_w);
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+static void depthwise_conv_kernel_impl(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntList padding,
+    IntList stride,
+    IntList dilation) {
+  const DepthwiseGeometry g(input, weight, output, padding, stride, dilation);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "depthwise_conv_kernel", [&] {
+    depthwise_conv<scalar_t>(output, input, weight, bias, g);
+  });
+}
+
+static void depthwise_conv_backward_input_kernel_impl(
+    Tensor& grad_input,
+    const Tensor& grad_output,
+    const Tensor& weight,
+    IntList padding,
+    IntList stride,
+    IntList dilation) {
+  const DepthwiseGeometry g(
+      grad_input, weight, grad_output, padding, stride, dilation);
+  AT_DISPATCH_FLOATING_TYPES(
+      grad_output.type(), "depthwise_conv_backward_input_kernel", [&] {
+        depthwise_conv_backward_input<scalar_t>(
+            grad_input, grad_output, weight, g);
+      });
+}
+
+static void depthwise_conv_backward_weight_kernel_impl(
+    Tensor& grad_weight,
+    const Tensor& grad_output,
+    const Tensor& input,
+    IntList padding,
+    IntList stride,
+    IntList dilation) {
+  const DepthwiseGeometry g(
+      input, grad_weight, grad_output, padding, stride, dilation);
+  AT_DISPATCH_FLOATING_TYPES(
+      grad_output.type(), "depthwise_conv_backward_weight_kernel", [&] {
+        depthwise_conv_backward_weight<scalar_t>(
+            grad_weight, grad_output, input, g);
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(depthwise_conv_kernel, &depthwise_conv_kernel_impl);
+REGISTER_DISPATCH(
+    depthwise_conv_backward_input_kernel,
+    &depthwise_conv_backward_input_kernel_impl);
+REGISTER_DISPATCH(
+    depthwise_conv_backward_weight_kernel,
+    &depthwise_conv_backward_weight_kernel_impl);
+
+}} // namespace at::native
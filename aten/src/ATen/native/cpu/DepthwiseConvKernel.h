@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at {
+namespace native {
+
+// Depthwise 2d convolution of a contiguous [N, C, H, W] input with a
+// contiguous [C * k, 1, kH, kW] weight: output channel c only reads input
+// channel c / k. output must be a contiguous [N, C * k, oH, oW] tensor;
+// bias may be undefined. The IntLists are padding, stride and dilation.
+using depthwise_conv_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, const Tensor &,
+    IntList, IntList, IntList);
+
+// grad_input = gradient of depthwise_conv_kernel w.r.t. its input, given the
+// contiguous grad_output and weight
+using depthwise_conv_backward_input_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, IntList, IntList, IntList);
+
+// grad_weight = gradient of depthwise_conv_kernel w.r.t. its weight, given
+// the contiguous grad_output and input
+using depthwise_conv_backward_weight_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, IntList, IntList, IntList);
+
+extern DispatchStub<depthwise_conv_fn> depthwise_conv_kernel;
+extern DispatchStub<depthwise_conv_backward_input_fn>
+    depthwise_conv_backward_input_kernel;
+extern DispatchStub<depthwise_conv_backward_weight_fn>
+    depthwise_conv_backward_weight_kernel;
+
+}
+}
@@ -0,0 +1,259 @@
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/functional.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// The sum and mean reductions follow the structure of caffe2's
+// EmbeddingLookup perfkernels: every looked up row is accumulated into the
+// output row with full-width vector FMAs and the row a few indices ahead is
+// prefetched, since the lookups are random accesses into a table that
+// usually does not fit in cache. Work is split across bags in the forward
+// pass and across unique indices in the backward pass, so every output row
+// is written by exactly one thread.
+
+namespace at { namespace native {
+namespace {
+
+// Number of indices to look ahead when prefetching rows of the table
+static constexpr int64_t kPrefetchDistance = 16;
+
+inline void prefetch_row(const void* row) {
+#ifdef __GNUC__
+  __builtin_prefetch(row, 0 /* read */, 1 /* low temporal locality */);
+#endif
+}
+
+// y[0:n] = a * x[0:n]
+template <typename scalar_t>
+inline void vec_scale(int64_t n, scalar_t a, const scalar_t* x, scalar_t* y) {
+  using Vec = vec256::Vec256<scalar_t>;
+  const Vec a_vec(a);
+  int64_t d = 0;
+  for (; d < n - (n % Vec::size); d += Vec::size) {
+    Vec y_vec = a_vec * Vec::loadu(x + d);
+    y_vec.store(y + d);
+  }
+  if (n - d > 0) {
+    Vec y_vec = a_vec * Vec::loadu(x + d, n - d);
+    y_vec.store(y + d, n - d);
+  }
+}
+
+// Rows processed per task so that each task does roughly GRAIN_SIZE
+// multiply-adds.
+inline int64_t grain_size_for(int64_t num_tasks, int64_t work) {
+  if (num_tasks == 0) {
+    return 1;
+  }
+  const int64_t work_per_task = std::max<int64_t>(work / num_tasks, 1);
+  return std::max<int64_t>(internal::GRAIN_SIZE / work_per_task, 1);
+}
+
+template <typename scalar_t>
+void embedding_bag_sum(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    bool mean) {
+  const int64_t num_weights = weight.size(0);
+  const int64_t ddim = weight.size(1);
+  const int64_t numel = indices.numel();
+  const int64_t num_bags = offsets.numel();
+  const auto* indices_data = indices.data<int64_t>();
+  const auto* offsets_data = offsets.data<int64_t>();
+  const auto* weight_data = weight.data<scalar_t>();
+  const auto weight_stride0 = weight.stride(0);
+  const auto weight_stride1 = weight.stride(1);
+  const scalar_t* psw_data = per_sample_weights.defined()
+      ? per_sample_weights.data<scalar_t>()
+      : nullptr;
+  auto* output_data = output.data<scalar_t>();
+
+  // Validate up front; errors cannot be raised from the parallel region.
+  for (int64_t b = 0; b < num_bags; b++) {
+    AT_CHECK(
+        offsets_data[b] >= 0 && offsets_data[b] <= numel,
+        "embedding_bag: offsets[", b, "] = ", offsets_data[b],
+        " is out of range [0, ", numel, "]");
+  }
+  for (int64_t i = 0; i < numel; i++) {
+    AT_CHECK(
+        indices_data[i] >= 0 && indices_data[i] < num_weights,
+        "embedding_bag: index ", indices_data[i], " at position ", i,
+        " is out of range [0, ", num_weights, ")");
+  }
+
+  parallel_for(
+      0, num_bags, grain_size_for(num_bags, numel * ddim),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t b = begin; b < end; b++) {
+          const int64_t start = offsets_data[b];
+          const int64_t stop = b + 1 < num_bags ? offsets_data[b + 1] : numel;
+          scalar_t* out = output_data + b * ddim;
+          std::memset(out, 0, ddim * sizeof(scalar_t));
+          for (int64_t i = start; i < stop; i++) {
+            if (i + kPrefetchDistance < numel) {
+              prefetch_row(
+                  weight_data +
+                  weight_stride0 * indices_data[i + kPrefetchDistance]);
+            }
+            const scalar_t* row =
+                weight_data + weight_stride0 * indices_data[i];
+            const scalar_t scale = psw_data ? psw_data[i] : scalar_t(1);
+            if (weight_stride1 == 1) {
+              vec256::axpy<scalar_t>(ddim, scale, row, out);
+            } else {
+              for (int64_t d = 0; d < ddim; d++) {
+                out[d] += scale * row[d * weight_stride1];
+              }
+            }
+          }
+          // Empty bags stay all 0s in mean mode as well
+          if (mean && stop > start) {
+            vec_scale<scalar_t>(ddim, scalar_t(1) / (stop - start), out, out);
+          }
+        }
+      });
+}
+
+template <typename scalar_t>
+void embedding_bag_backward(
+    Tensor& grad_weight,
+    const Tensor& grad,
+    const Tensor& sorted_indices,
+    const Tensor& sorted_offset2bag,
+    const Tensor& bag_scale,
+    bool scale_grad_by_freq) {
+  const int64_t ddim = grad.size(1);
+  const int64_t numel = sorted_indices.numel();
+  const auto* indices_data = sorted_indices.data<int64_t>();
+  const auto* offset2bag_data = sorted_offset2bag.data<int64_t>();
+  const auto* grad_data = grad.data<scalar_t>();
+  const scalar_t* bag_scale_data =
+      bag_scale.defined() ? bag_scale.data<scalar_t>() : nullptr;
+  auto* grad_weight_data = grad_weight.data<scalar_t>();
+
+  // segment_starts[s] is the first position of the s-th unique index in
+  // sorted_indices. The last entry is numel.
+  std::vector<int64_t> segment_starts;
+  for (int64_t i = 0; i < numel; i++) {
+    if (i == 0 || indices_data[i] != indices_data[i - 1]) {
+      segment_starts.push_back(i);
+    }
+  }
+  const int64_t num_segments = segment_starts.size();
+  segment_starts.push_back(numel);
+
+  parallel_for(
+      0, num_segments, grain_size_for(num_segments, numel * ddim),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t s = begin; s < end; s++) {
+          const int64_t start = segment_starts[s];
+          const int64_t stop = segment_starts[s + 1];
+          scalar_t* dst = grad_weight_data + ddim * indices_data[start];
+          const scalar_t freq_scale =
+              scale_grad_by_freq ? scalar_t(1) / (stop - start) : scalar_t(1);
+          for (int64_t i = start; i < stop; i++) {
+            const int64_t source = offset2bag_data[i];
+            if (i + kPrefetchDistance < stop) {
+              prefetch_row(
+                  grad_data + ddim * offset2bag_data[i + kPrefetchDistance]);
+            }
+            const scalar_t scale = bag_scale_data
+                ? freq_scale * bag_scale_data[source]
+                : freq_scale;
+            vec256::axpy<scalar_t>(ddim, scale, grad_data + ddim * source, dst);
+          }
+        }
+      });
+}
+
+template <typename scalar_t>
+void embedding_bag_backward_gather(
+    Tensor& index_grad,
+    const Tensor& grad,
+    const Tensor& offset2bag,
+    const Tensor& bag_scale) {
+  const int64_t ddim = grad.size(1);
+  const int64_t numel = offset2bag.numel();
+  const auto* offset2bag_data = offset2bag.data<int64_t>();
+  const auto* grad_data = grad.data<scalar_t>();
+  const scalar_t* bag_scale_data =
+      bag_scale.defined() ? bag_scale.data<scalar_t>() : nullptr;
+  auto* index_grad_data = index_grad.data<scalar_t>();
+
+  parallel_for(
+      0, numel, grain_size_for(numel, numel * ddim),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          const int64_t source = offset2bag_data[i];
+          const scalar_t* src = grad_data + ddim * source;
+          scalar_t* dst = index_grad_data + ddim * i;
+          if (bag_scale_data) {
+            vec_scale<scalar_t>(ddim, bag_scale_data[source], src, dst);
+          } else {
+            std::memcpy(dst, src, ddim * sizeof(scalar_t));
+          }
+        }
+      });
+}
+
+static void embedding_bag_sum_kernel_impl(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    bool mean) {
+  AT_DISPATCH_FLOATING_TYPES(weight.type(), "embedding_bag_sum_kernel", [&] {
+    embedding_bag_sum<scalar_t>(
+        output, weight, indices, offsets, per_sample_weights, mean);
+  });
+}
+
+static void embedding_bag_backward_kernel_impl(
+    Tensor& grad_weight,
+    const Tensor& grad,
+    const Tensor& sorted_indices,
+    const Tensor& sorted_offset2bag,
+    const Tensor& bag_scale,
+    bool scale_grad_by_freq) {
+  AT_DISPATCH_FLOATING_TYPES(
+      grad.type(), "embedding_bag_backward_kernel", [&] {
+        embedding_bag_backward<scalar_t>(
+            grad_weight, grad, sorted_indices, sorted_offset2bag, bag_scale,
+            scale_grad_by_freq);
+      });
+}
+
+static void embedding_bag_backward_gather_kernel_impl(
+    Tensor& index_grad,
+    const Tensor& grad,
+    const Tensor& offset2bag,
+    const Tensor& bag_scale) {
+  AT_DISPATCH_FLOATING_TYPES(
+      grad.type(), "embedding_bag_backward_gather_kernel", [&] {
+        embedding_bag_backward_gather<scalar_t>(
+            index_grad, grad, offset2bag, bag_scale);
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(embedding_bag_sum_kernel, &embedding_bag_sum_kernel_impl);
+REGISTER_DISPATCH(
+    embedding_bag_backward_kernel,
+    &embedding_bag_backward_kernel_impl);
+REGISTER_DISPATCH(
+    embedding_bag_backward_gather_kernel,
+    &embedding_bag_backward_gather_kernel_impl);
+
+}} // namespace at::native
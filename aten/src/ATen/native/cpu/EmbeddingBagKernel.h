@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at {
+namespace native {
+
+// output[b] = sum of per_sample_weights[i] * weight[indices[i]] over the
+// indices of bag b, divided by the bag length if mean is set. output must be
+// a contiguous [num_bags, dim] tensor; per_sample_weights may be undefined.
+using embedding_bag_sum_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, const Tensor &, const Tensor &,
+    bool);
+
+// grad_weight[sorted_indices[i]] +=
+//     bag_scale[sorted_offset2bag[i]] * grad[sorted_offset2bag[i]]
+// divided by the number of occurrences of the index if scale_grad_by_freq.
+// bag_scale may be undefined, in which case it is 1 for every bag.
+using embedding_bag_backward_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, const Tensor &, const Tensor &,
+    bool);
+
+// index_grad[i] = bag_scale[offset2bag[i]] * grad[offset2bag[i]]
+using embedding_bag_backward_gather_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, const Tensor &);
+
+extern DispatchStub<embedding_bag_sum_fn> embedding_bag_sum_kernel;
+extern DispatchStub<embedding_bag_backward_fn> embedding_bag_backward_kernel;
+extern DispatchStub<embedding_bag_backward_gather_fn>
+    embedding_bag_backward_gather_kernel;
+
+}
+}
@@ -0,0 +1,128 @@
+#include "ATen/native/cpu/SpmmKernel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/functional.h"
+
+// Rows of the sparse matrix are split into blocks holding roughly the same
+// number of nonzeros rather than the same number of rows, so that a few very
+// dense rows (common for power law graphs and embedding style inputs) do not
+// serialize the product behind one thread. Each row of the result is written
+// by exactly one thread, and each nonzero becomes one vectorized axpy of a
+// row of the dense matrix into it.
+
+namespace at { namespace native {
+namespace {
+
+// Number of nonzeros to look ahead when prefetching rows of the dense matrix
+static constexpr int64_t kPrefetchDistance = 8;
+
+inline void prefetch_row(const void* row) {
+#ifdef __GNUC__
+  __builtin_prefetch(row, 0 /* read */, 1 /* low temporal locality */);
+#endif
+}
+
+// Returns the first row of every block, followed by dim_i. Blocks are cut
+// whenever they reach nnz_per_block nonzeros, so a single row may make up a
+// block of its own.
+std::vector<int64_t> balance_rows(
+    const int64_t* csr,
+    int64_t dim_i,
+    int64_t nnz_per_block) {
+  std::vector<int64_t> block_starts = {0};
+  for (int64_t h = 0; h < dim_i; h++) {
+    if (csr[h + 1] - csr[block_starts.back()] >= nnz_per_block) {
+      block_starts.push_back(h + 1);
+    }
+  }
+  if (block_starts.back() != dim_i) {
+    block_starts.push_back(dim_i);
+  }
+  return block_starts;
+}
+
+template <typename scalar_t>
+void spmm(
+    Tensor& r,
+    const Tensor& csr,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    Scalar alpha) {
+  const int64_t dim_i = r.size(0);
+  const int64_t dim_k = r.size(1);
+  const int64_t* csr_data = csr.data<int64_t>();
+  const int64_t* col_data = col_indices.data<int64_t>();
+  const int64_t col_stride = col_indices.stride(0);
+  const scalar_t* values_data = values.data<scalar_t>();
+  const int64_t values_stride = values.stride(0);
+  const scalar_t* dense_data = dense.data<scalar_t>();
+  const int64_t dense_stride0 = dense.stride(0);
+  const int64_t dense_stride1 = dense.stride(1);
+  scalar_t* r_data = r.data<scalar_t>();
+  const int64_t r_stride0 = r.stride(0);
+  const int64_t r_stride1 = r.stride(1);
+  const bool contiguous_rows = dense_stride1 == 1 && r_stride1 == 1;
+  const scalar_t cast_alpha = alpha.to<scalar_t>();
+
+  auto run = [&](int64_t row_begin, int64_t row_end) {
+    const int64_t stop = csr_data[row_end];
+    for (int64_t h = row_begin; h < row_end; h++) {
+      scalar_t* out = r_data + h * r_stride0;
+      for (int64_t p = csr_data[h]; p < csr_data[h + 1]; p++) {
+        if (p + kPrefetchDistance < stop) {
+          prefetch_row(
+              dense_data +
+              dense_stride0 * col_data[(p + kPrefetchDistance) * col_stride]);
+        }
+        const scalar_t* row =
+            dense_data + dense_stride0 * col_data[p * col_stride];
+        const scalar_t scale = cast_alpha * values_data[p * values_stride];
+        if (contiguous_rows) {
+          vec256::axpy<scalar_t>(dim_k, scale, row, out);
+        } else {
+          for (int64_t k = 0; k < dim_k; k++) {
+            out[k * r_stride1] += scale * row[k * dense_stride1];
+          }
+        }
+      }
+    }
+  };
+
+  const int64_t nnz_per_block =
+      std::max<int64_t>(internal::GRAIN_SIZE / std::max<int64_t>(dim_k, 1), 1);
+  if (csr_data[dim_i] <= nnz_per_block) {
+    run(0, dim_i);
+    return;
+  }
+  const std::vector<int64_t> block_starts =
+      balance_rows(csr_data, dim_i, nnz_per_block);
+  const int64_t num_blocks = block_starts.size() - 1;
+  parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      run(block_starts[b], block_starts[b + 1]);
+    }
+  });
+}
+
+static void spmm_kernel_impl(
+    Tensor& r,
+    const Tensor& csr,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    Scalar alpha) {
+  AT_DISPATCH_ALL_TYPES(values.type(), "spmm_kernel", [&] {
+    spmm<scalar_t>(r, csr, col_indices, values, dense, alpha);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(spmm_kernel, &spmm_kernel_impl);
+
+}} // namespace at::native
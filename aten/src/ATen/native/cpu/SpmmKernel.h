@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at {
+namespace native {
+
+// r[i] += alpha * sum of values[p] * dense[col_indices[p]] over the entries p
+// of row i of a sparse matrix in CSR form, where csr ([dim_i + 1] int64,
+// contiguous) holds the row pointers and col_indices ([nnz] int64) and values
+// ([nnz]) the columns and values of the entries. Column indices must already
+// have been checked against dense.size(0).
+using spmm_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, const Tensor &, const Tensor &,
+    Scalar);
+
+extern DispatchStub<spmm_fn> spmm_kernel;
+
+}
+}
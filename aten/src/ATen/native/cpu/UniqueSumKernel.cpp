@@ -0,0 +1,185 @@
+#include "ATen/native/cpu/UniqueSumKernel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+// Keys are grouped with a stable LSD radix sort, 8 bits per pass, over the
+// range of the keys only: embedding and sparse indices rarely need more than
+// three passes. Each pass splits the keys into chunks that are counted and
+// scattered in parallel. The rows of every group are then summed in parallel
+// across groups, so heavily repeated keys cost one pass over their rows
+// rather than a comparison sort of every duplicate.
+
+namespace at { namespace native {
+namespace {
+
+static constexpr int kRadixBits = 8;
+static constexpr int kRadixSize = 1 << kRadixBits;
+// Bounds on the number of keys a chunk of a radix pass works on
+static constexpr int64_t kMinChunkSize = 16384;
+static constexpr int64_t kMaxChunks = 64;
+
+// Calls f(c, begin, end) for every chunk c of [0, n), in parallel if there
+// is more than one.
+template <typename F>
+void for_each_chunk(int64_t n, int64_t num_chunks, const F& f) {
+  auto run = [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      f(c, n * c / num_chunks, n * (c + 1) / num_chunks);
+    }
+  };
+  if (num_chunks == 1) {
+    run(0, 1);
+  } else {
+    parallel_for(0, num_chunks, 1, run);
+  }
+}
+
+// Sorts keys stably. On return sorted_keys holds the keys relative to the
+// smallest one and permutation the position each of them came from.
+void radix_sort(
+    const int64_t* keys,
+    int64_t n,
+    std::vector<uint64_t>& sorted_keys,
+    std::vector<int64_t>& permutation) {
+  const auto minmax = std::minmax_element(keys, keys + n);
+  const uint64_t min_key = static_cast<uint64_t>(*minmax.first);
+  const uint64_t range = static_cast<uint64_t>(*minmax.second) - min_key;
+
+  sorted_keys.resize(n);
+  permutation.resize(n);
+  for (int64_t i = 0; i < n; i++) {
+    sorted_keys[i] = static_cast<uint64_t>(keys[i]) - min_key;
+  }
+  std::iota(permutation.begin(), permutation.end(), 0);
+
+  int num_passes = 0;
+  while (num_passes * kRadixBits < 64 && (range >> (num_passes * kRadixBits))) {
+    num_passes++;
+  }
+  if (num_passes == 0) {
+    return;
+  }
+
+  const int64_t num_chunks =
+      std::max<int64_t>(1, std::min<int64_t>(kMaxChunks, n / kMinChunkSize));
+  std::vector<uint64_t> keys_buffer(n);
+  std::vector<int64_t> permutation_buffer(n);
+  // offsets[c * kRadixSize + d] is first the number of keys with digit d in
+  // chunk c, then the position the next of them goes to.
+  std::vector<int64_t> offsets(num_chunks * kRadixSize);
+
+  for (int pass = 0; pass < num_passes; pass++) {
+    const int shift = pass * kRadixBits;
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for_each_chunk(n, num_chunks, [&](int64_t c, int64_t begin, int64_t end) {
+      int64_t* counts = offsets.data() + c * kRadixSize;
+      for (int64_t i = begin; i < end; i++) {
+        counts[(sorted_keys[i] >> shift) & (kRadixSize - 1)]++;
+      }
+    });
+    int64_t position = 0;
+    for (int d = 0; d < kRadixSize; d++) {
+      for (int64_t c = 0; c < num_chunks; c++) {
+        const int64_t count = offsets[c * kRadixSize + d];
+        offsets[c * kRadixSize + d] = position;
+        position += count;
+      }
+    }
+    for_each_chunk(n, num_chunks, [&](int64_t c, int64_t begin, int64_t end) {
+      int64_t* next = offsets.data() + c * kRadixSize;
+      for (int64_t i = begin; i < end; i++) {
+        const int64_t dst =
+            next[(sorted_keys[i] >> shift) & (kRadixSize - 1)]++;
+        keys_buffer[dst] = sorted_keys[i];
+        permutation_buffer[dst] = permutation[i];
+      }
+    });
+    sorted_keys.swap(keys_buffer);
+    permutation.swap(permutation_buffer);
+  }
+}
+
+// y[0:n] += x[0:n]
+template <typename scalar_t>
+inline void vec_add(int64_t n, const scalar_t* x, scalar_t* y) {
+  using Vec = vec256::Vec256<scalar_t>;
+  int64_t d = 0;
+  for (; d < n - (n % Vec::size); d += Vec::size) {
+    Vec y_vec = Vec::loadu(y + d) + Vec::loadu(x + d);
+    y_vec.store(y + d);
+  }
+  if (n - d > 0) {
+    Vec y_vec = Vec::loadu(y + d, n - d) + Vec::loadu(x + d, n - d);
+    y_vec.store(y + d, n - d);
+  }
+}
+
+static void unique_sum_kernel_impl(
+    Tensor& reduced,
+    Tensor& first_positions,
+    const Tensor& keys,
+    const Tensor& values) {
+  const int64_t n = keys.numel();
+  const int64_t ddim = n == 0 ? 0 : values.numel() / n;
+  if (n == 0) {
+    reduced.resize_({0, ddim});
+    first_positions.resize_({0});
+    return;
+  }
+
+  std::vector<uint64_t> sorted_keys;
+  std::vector<int64_t> permutation;
+  radix_sort(keys.data<int64_t>(), n, sorted_keys, permutation);
+
+  // segment_starts[s] is the position in sorted_keys of the first key of the
+  // s-th group. The last entry is n.
+  std::vector<int64_t> segment_starts;
+  for (int64_t i = 0; i < n; i++) {
+    if (i == 0 || sorted_keys[i] != sorted_keys[i - 1]) {
+      segment_starts.push_back(i);
+    }
+  }
+  const int64_t num_unique = segment_starts.size();
+  segment_starts.push_back(n);
+
+  reduced.resize_({num_unique, ddim});
+  first_positions.resize_({num_unique});
+  auto* first_positions_data = first_positions.data<int64_t>();
+  for (int64_t s = 0; s < num_unique; s++) {
+    first_positions_data[s] = permutation[segment_starts[s]];
+  }
+
+  const int64_t work_per_group = std::max<int64_t>(n * ddim / num_unique, 1);
+  const int64_t grain_size =
+      std::max<int64_t>(internal::GRAIN_SIZE / work_per_group, 1);
+  AT_DISPATCH_ALL_TYPES(values.type(), "unique_sum_kernel", [&] {
+    const scalar_t* values_data = values.data<scalar_t>();
+    scalar_t* reduced_data = reduced.data<scalar_t>();
+    parallel_for(0, num_unique, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t s = begin; s < end; s++) {
+        scalar_t* dst = reduced_data + s * ddim;
+        const int64_t start = segment_starts[s];
+        std::memcpy(
+            dst,
+            values_data + permutation[start] * ddim,
+            ddim * sizeof(scalar_t));
+        for (int64_t i = start + 1; i < segment_starts[s + 1]; i++) {
+          vec_add<scalar_t>(ddim, values_data + permutation[i] * ddim, dst);
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(unique_sum_kernel, &unique_sum_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at {
+namespace native {
+
+// Groups the rows of values ([n, d], contiguous) by keys ([n] int64,
+// contiguous) and sums every group. reduced is resized to [num_unique, d] and
+// holds the sums in ascending key order; first_positions is resized to
+// [num_unique] and holds the position in keys of the first occurrence of each
+// unique key. Rows of a group are summed in their order in the input.
+using unique_sum_fn = void(*)(Tensor &, Tensor &, const Tensor &, const Tensor &);
+
+extern DispatchStub<unique_sum_fn> unique_sum_kernel;
+
+}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at {
+namespace native {
+
+// Kernels of the Winograd F(m x m, 3 x 3) convolution, for m = 2 or 4. The
+// transformed tensors have alpha * alpha = (m + 2) * (m + 2) matrices, so
+// that the convolution reduces to one batched matrix product
+//   transformed_output = bmm(transformed_weight, transformed_input).
+
+// transformed_weight [alpha^2, C_out, C_in] = transform of the contiguous
+// weight [C_out, C_in, 3, 3]
+using winograd_weight_transform_fn = void(*)(Tensor &, const Tensor &, int64_t);
+
+// transformed_input [alpha^2, C_in, N * tiles] = transform of the contiguous
+// input [N, C_in, H, W], zero padded by padding, where tiles is the number of
+// m x m tiles needed to cover the output
+using winograd_input_transform_fn = void(*)(
+    Tensor &, const Tensor &, IntList, int64_t);
+
+// output [N, C_out, oH, oW] = inverse transform of the contiguous
+// transformed_output [alpha^2, C_out, N * tiles], plus bias if it is defined
+using winograd_output_transform_fn = void(*)(
+    Tensor &, const Tensor &, const Tensor &, int64_t);
+
+extern DispatchStub<winograd_weight_transform_fn>
+    winograd_weight_transform_kernel;
+extern DispatchStub<winograd_input_transform_fn>
+    winograd_input_transform_kernel;
+extern DispatchStub<winograd_output_transform_fn>
+    winograd_output_transform_kernel;
+
+}
+}
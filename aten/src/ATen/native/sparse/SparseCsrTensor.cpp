@@ -0,0 +1,343 @@
+// Sparse matrices in compressed sparse row (CSR) format.
+//
+// A CSR matrix of size (m, n) with nnz nonzeros is stored as three dense
+// tensors:
+//
+//   crow_indices: int64 [m + 1], the entries of row i are at positions
+//                 crow_indices[i] to crow_indices[i + 1] - 1
+//   col_indices:  int64 [nnz], the column of every entry
+//   values:       [nnz], the value of every entry
+//
+// Compared to COO, the row indices (nnz int64s) shrink to m + 1 row pointers,
+// and the entries of a row are found without searching, so kernels can work
+// on rows in parallel.  Within a row, the columns produced by the conversions
+// below are sorted and unique; the kernels don't rely on it.
+//
+// CSR matrices don't have a Type of their own (yet), so these functions take
+// and return the component tensors; torch.sparse.CsrTensor wraps them for
+// Python.
+
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/sparse/SparseUtils.h>
+#include <ATen/native/cpu/SpmmKernel.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace at { namespace native {
+
+namespace {
+
+// Rows processed per task so that each task touches about GRAIN_SIZE entries
+int64_t _row_grain_size(int64_t num_rows, int64_t work) {
+  int64_t work_per_row = std::max<int64_t>(work / std::max<int64_t>(num_rows, 1), 1);
+  return std::max<int64_t>(internal::GRAIN_SIZE / work_per_row, 1);
+}
+
+// Checks that crow_indices are valid row pointers for nnz entries
+void _check_crow_indices(const LongTensor& crow_indices, int64_t nnz) {
+  AT_CHECK(crow_indices.type().scalarType() == kLong, "CSR: crow_indices must be an int64 tensor");
+  AT_CHECK(crow_indices.dim() == 1, "CSR: crow_indices must be 1-D, got ", crow_indices.dim(), "D tensor");
+  AT_CHECK(crow_indices.is_contiguous(), "CSR: crow_indices must be contiguous");
+  AT_CHECK(crow_indices.numel() >= 1, "CSR: crow_indices must have at least one element");
+
+  int64_t num_rows = crow_indices.numel() - 1;
+  auto crow_accessor = crow_indices.accessor<int64_t, 1>();
+  AT_CHECK(crow_accessor[0] == 0, "CSR: crow_indices must start at 0, got ", crow_accessor[0]);
+  AT_CHECK(crow_accessor[num_rows] == nnz,
+      "CSR: crow_indices must end at nnz = ", nnz, ", got ", crow_accessor[num_rows]);
+  for (int64_t i = 0; i < num_rows; i++) {
+    AT_CHECK(crow_accessor[i] <= crow_accessor[i + 1],
+        "CSR: crow_indices must be non-decreasing, but row ", i, " starts at ",
+        crow_accessor[i], " and ends at ", crow_accessor[i + 1]);
+  }
+}
+
+// Checks the structure of a CSR matrix, and if num_cols >= 0 that its column
+// indices are in range.  Errors can't be raised from the parallel kernels, so
+// every entry point calls this first.
+void _check_csr(const LongTensor& crow_indices, const LongTensor& col_indices, const Tensor& values, int64_t num_cols) {
+  AT_CHECK(col_indices.type().scalarType() == kLong, "CSR: col_indices must be an int64 tensor");
+  AT_CHECK(col_indices.dim() == 1 && values.dim() == 1,
+      "CSR: col_indices and values must be 1-D, got ", col_indices.dim(), "D and ", values.dim(), "D tensors");
+  AT_CHECK(col_indices.numel() == values.numel(),
+      "CSR: col_indices and values must have the same number of elements, got ",
+      col_indices.numel(), " and ", values.numel());
+  _check_crow_indices(crow_indices, values.numel());
+
+  if (num_cols >= 0) {
+    auto col_accessor = col_indices.accessor<int64_t, 1>();
+    for (int64_t p = 0; p < values.numel(); p++) {
+      AT_CHECK(col_accessor[p] >= 0 && col_accessor[p] < num_cols,
+          "CSR: column index ", col_accessor[p], " of entry ", p, " is out of range [0, ", num_cols, ")");
+    }
+  }
+}
+
+// crow_indices of the matrix whose entry p is in row row_indices[p].  The
+// row indices must be sorted.
+LongTensor _crow_indices_from_rows(const LongTensor& row_indices, int64_t num_rows) {
+  LongTensor crow_indices = native::zeros({num_rows + 1}, kLong);
+  int64_t nnz = row_indices.numel();
+  auto row_accessor = row_indices.accessor<int64_t, 1>();
+  auto crow_accessor = crow_indices.accessor<int64_t, 1>();
+  for (int64_t p = 0; p < nnz; p++) {
+    crow_accessor[row_accessor[p] + 1]++;
+  }
+  for (int64_t i = 0; i < num_rows; i++) {
+    crow_accessor[i + 1] += crow_accessor[i];
+  }
+  return crow_indices;
+}
+
+// Row index of every entry, i.e. the COO row indices of the matrix
+LongTensor _rows_from_crow_indices(const LongTensor& crow_indices, int64_t nnz) {
+  int64_t num_rows = crow_indices.numel() - 1;
+  LongTensor row_indices = native::empty({nnz}, kLong);
+  const int64_t* crow_ptr = crow_indices.data<int64_t>();
+  int64_t* row_ptr = row_indices.data<int64_t>();
+  parallel_for(0, num_rows, _row_grain_size(num_rows, nnz), [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      std::fill(row_ptr + crow_ptr[i], row_ptr + crow_ptr[i + 1], i);
+    }
+  });
+  return row_indices;
+}
+
+} // namespace
+
+// --------------------------------------------------------------------
+// Conversions
+// --------------------------------------------------------------------
+
+std::tuple<Tensor, Tensor, Tensor> sparse_csr_from_coo_cpu(const SparseTensor& self) {
+  AT_CHECK(self._sparseDims() == 2 && self._denseDims() == 0,
+      "_sparse_csr_from_coo: expected a sparse matrix with scalar values, got ",
+      self._sparseDims(), " sparse and ", self._denseDims(), " dense dimensions");
+
+  // Coalescing sorts the entries by row, then column
+  SparseTensor coalesced = self.coalesce();
+  int64_t nnz = coalesced._nnz();
+  if (nnz == 0) {
+    return std::make_tuple(native::zeros({self.size(0) + 1}, kLong),
+                           native::empty({0}, kLong),
+                           self._values().type().tensor({0}));
+  }
+  LongTensor indices = coalesced._indices();
+  LongTensor crow_indices = _crow_indices_from_rows(indices.select(0, 0), self.size(0));
+  return std::make_tuple(crow_indices, indices.select(0, 1).clone(), coalesced._values().clone());
+}
+
+std::tuple<Tensor, Tensor, Tensor> sparse_csr_from_dense_cpu(const Tensor& self) {
+  AT_CHECK(self.dim() == 2, "_sparse_csr_from_dense: expected a matrix, got ", self.dim(), "D tensor");
+  int64_t num_rows = self.size(0);
+  int64_t num_cols = self.size(1);
+  LongTensor crow_indices = native::zeros({num_rows + 1}, kLong);
+  if (self.numel() == 0) {
+    return std::make_tuple(crow_indices, native::empty({0}, kLong), self.type().tensor({0}));
+  }
+
+  Tensor dense = self.contiguous();
+  int64_t* crow_ptr = crow_indices.data<int64_t>();
+  LongTensor col_indices;
+  Tensor values;
+  AT_DISPATCH_ALL_TYPES(self.type(), "_sparse_csr_from_dense", [&] {
+    const scalar_t* dense_ptr = dense.data<scalar_t>();
+    int64_t grain_size = _row_grain_size(num_rows, num_rows * num_cols);
+    // Count the nonzeros of every row, then write them at the row offsets
+    parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* row = dense_ptr + i * num_cols;
+        crow_ptr[i + 1] = std::count_if(row, row + num_cols, [](scalar_t x) { return x != scalar_t(0); });
+      }
+    });
+    for (int64_t i = 0; i < num_rows; i++) {
+      crow_ptr[i + 1] += crow_ptr[i];
+    }
+    col_indices = native::empty({crow_ptr[num_rows]}, kLong);
+    values = self.type().tensor({crow_ptr[num_rows]});
+    int64_t* col_ptr = col_indices.data<int64_t>();
+    scalar_t* values_ptr = values.data<scalar_t>();
+    parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* row = dense_ptr + i * num_cols;
+        int64_t p = crow_ptr[i];
+        for (int64_t j = 0; j < num_cols; j++) {
+          if (row[j] != scalar_t(0)) {
+            col_ptr[p] = j;
+            values_ptr[p] = row[j];
+            p++;
+          }
+        }
+      }
+    });
+  });
+  return std::make_tuple(crow_indices, col_indices, values);
+}
+
+Tensor sparse_csr_to_coo_cpu(const LongTensor& crow_indices, const LongTensor& col_indices, const Tensor& values, IntList size) {
+  AT_CHECK(size.size() == 2, "_sparse_csr_to_coo: expected a matrix size, got ", size.size(), " dimensions");
+  AT_CHECK(crow_indices.numel() == size[0] + 1,
+      "_sparse_csr_to_coo: expected ", size[0] + 1, " crow_indices for ", size[0], " rows, got ", crow_indices.numel());
+  _check_csr(crow_indices, col_indices, values, size[1]);
+  int64_t nnz = values.numel();
+  if (nnz == 0) {
+    return values.type().toSparse().tensor(size);
+  }
+  LongTensor indices = at::stack({_rows_from_crow_indices(crow_indices, nnz), col_indices}, 0);
+  // Columns may repeat within a row, so the result isn't marked coalesced
+  return at::_sparse_coo_tensor_unsafe(indices, values.clone(), size);
+}
+
+Tensor sparse_csr_to_dense_cpu(const LongTensor& crow_indices, const LongTensor& col_indices, const Tensor& values, IntList size) {
+  AT_CHECK(size.size() == 2, "_sparse_csr_to_dense: expected a matrix size, got ", size.size(), " dimensions");
+  AT_CHECK(crow_indices.numel() == size[0] + 1,
+      "_sparse_csr_to_dense: expected ", size[0] + 1, " crow_indices for ", size[0], " rows, got ", crow_indices.numel());
+  _check_csr(crow_indices, col_indices, values, size[1]);
+  Tensor dense = native::zeros(size, values.options());
+  int64_t num_rows = size[0];
+  int64_t num_cols = size[1];
+  int64_t nnz = values.numel();
+  if (nnz == 0) {
+    return dense;
+  }
+
+  LongTensor cols = col_indices.contiguous();
+  Tensor vals = values.contiguous();
+  const int64_t* crow_ptr = crow_indices.data<int64_t>();
+  const int64_t* col_ptr = cols.data<int64_t>();
+  AT_DISPATCH_ALL_TYPES(values.type(), "_sparse_csr_to_dense", [&] {
+    const scalar_t* values_ptr = vals.data<scalar_t>();
+    scalar_t* dense_ptr = dense.data<scalar_t>();
+    parallel_for(0, num_rows, _row_grain_size(num_rows, nnz), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        scalar_t* row = dense_ptr + i * num_cols;
+        for (int64_t p = crow_ptr[i]; p < crow_ptr[i + 1]; p++) {
+          row[col_ptr[p]] += values_ptr[p];
+        }
+      }
+    });
+  });
+  return dense;
+}
+
+// --------------------------------------------------------------------
+// addmm(Tensor, CSR matrix, Tensor, Scalar, Scalar)
+// --------------------------------------------------------------------
+
+Tensor sparse_csr_addmm_cpu(
+    const Tensor& self,
+    const LongTensor& crow_indices,
+    const LongTensor& col_indices,
+    const Tensor& values,
+    IntList size,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha
+) {
+  AT_CHECK(size.size() == 2, "_sparse_csr_addmm: expected a matrix size, got ", size.size(), " dimensions");
+  AT_CHECK(mat2.dim() == 2, "_sparse_csr_addmm: matrices expected, got ", mat2.dim(), "D tensor");
+  AT_CHECK(size[1] == mat2.size(0),
+      "_sparse_csr_addmm: size mismatch, a ", size[0], "x", size[1], " matrix can't multiply mat2 of size ", mat2.sizes());
+  AT_CHECK(crow_indices.numel() == size[0] + 1,
+      "_sparse_csr_addmm: expected ", size[0] + 1, " crow_indices for ", size[0], " rows, got ", crow_indices.numel());
+  AT_CHECK(values.type() == mat2.type() && self.type() == mat2.type(),
+      "_sparse_csr_addmm: expected self, values and mat2 to have the same type, got ",
+      self.type().toString(), ", ", values.type().toString(), " and ", mat2.type().toString());
+  _check_csr(crow_indices, col_indices, values, size[1]);
+
+  // ixj * jxk = ixk
+  int64_t dim_i = size[0];
+  int64_t dim_k = mat2.size(1);
+  Tensor t = self.expand({dim_i, dim_k});
+
+  Tensor r;
+  if (beta.toDouble() == 0) {
+    r = native::zeros({dim_i, dim_k}, mat2.options());
+  } else {
+    r = at::mul(t, beta).contiguous();
+  }
+  if (values.numel() != 0) {
+    spmm_kernel(r, crow_indices, col_indices, values, mat2, alpha);
+  }
+  return r;
+}
+
+// --------------------------------------------------------------------
+// Row indexing and reduction
+// --------------------------------------------------------------------
+
+std::tuple<Tensor, Tensor, Tensor> sparse_csr_index_select_cpu(
+    const LongTensor& crow_indices,
+    const LongTensor& col_indices,
+    const Tensor& values,
+    const LongTensor& index
+) {
+  _check_csr(crow_indices, col_indices, values, -1);
+  AT_CHECK(index.dim() <= 1, "_sparse_csr_index_select: index must be a vector, got ", index.dim(), "D tensor");
+  int64_t num_rows = crow_indices.numel() - 1;
+  LongTensor rows = index.contiguous().view(-1);
+  int64_t num_selected = rows.numel();
+  const int64_t* rows_ptr = rows.data<int64_t>();
+  for (int64_t i = 0; i < num_selected; i++) {
+    AT_CHECK(rows_ptr[i] >= 0 && rows_ptr[i] < num_rows,
+        "_sparse_csr_index_select: row ", rows_ptr[i], " is out of range [0, ", num_rows, ")");
+  }
+
+  const int64_t* crow_ptr = crow_indices.data<int64_t>();
+  LongTensor new_crow_indices = native::zeros({num_selected + 1}, kLong);
+  int64_t* new_crow_ptr = new_crow_indices.data<int64_t>();
+  for (int64_t i = 0; i < num_selected; i++) {
+    new_crow_ptr[i + 1] = new_crow_ptr[i] + crow_ptr[rows_ptr[i] + 1] - crow_ptr[rows_ptr[i]];
+  }
+  int64_t new_nnz = new_crow_ptr[num_selected];
+
+  LongTensor cols = col_indices.contiguous();
+  Tensor vals = values.contiguous();
+  LongTensor new_col_indices = native::empty({new_nnz}, kLong);
+  Tensor new_values = values.type().tensor({new_nnz});
+  const int64_t* col_ptr = cols.data<int64_t>();
+  int64_t* new_col_ptr = new_col_indices.data<int64_t>();
+  AT_DISPATCH_ALL_TYPES(values.type(), "_sparse_csr_index_select", [&] {
+    const scalar_t* values_ptr = vals.data<scalar_t>();
+    scalar_t* new_values_ptr = new_values.data<scalar_t>();
+    parallel_for(0, num_selected, _row_grain_size(num_selected, new_nnz), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        int64_t src = crow_ptr[rows_ptr[i]];
+        int64_t len = new_crow_ptr[i + 1] - new_crow_ptr[i];
+        std::memcpy(new_col_ptr + new_crow_ptr[i], col_ptr + src, len * sizeof(int64_t));
+        std::memcpy(new_values_ptr + new_crow_ptr[i], values_ptr + src, len * sizeof(scalar_t));
+      }
+    });
+  });
+  return std::make_tuple(new_crow_indices, new_col_indices, new_values);
+}
+
+Tensor sparse_csr_sum_rows_cpu(const LongTensor& crow_indices, const Tensor& values) {
+  AT_CHECK(values.dim() == 1, "_sparse_csr_sum_rows: values must be 1-D, got ", values.dim(), "D tensor");
+  _check_crow_indices(crow_indices, values.numel());
+  int64_t num_rows = crow_indices.numel() - 1;
+  int64_t nnz = values.numel();
+  Tensor result = native::zeros({num_rows}, values.options());
+  if (nnz == 0) {
+    return result;
+  }
+
+  Tensor vals = values.contiguous();
+  const int64_t* crow_ptr = crow_indices.data<int64_t>();
+  AT_DISPATCH_ALL_TYPES(values.type(), "_sparse_csr_sum_rows", [&] {
+    const scalar_t* values_ptr = vals.data<scalar_t>();
+    scalar_t* result_ptr = result.data<scalar_t>();
+    parallel_for(0, num_rows, _row_grain_size(num_rows, nnz), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        result_ptr[i] = std::accumulate(values_ptr + crow_ptr[i], values_ptr + crow_ptr[i + 1], scalar_t(0));
+      }
+    });
+  });
+  return result;
+}
+
+}} // namespace at::native
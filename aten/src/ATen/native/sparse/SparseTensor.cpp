@@ -4,8 +4,7 @@
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/sparse/SparseUtils.h>
-
-#include <TH/THBlasUtils.h>
+#include <ATen/native/cpu/UniqueSumKernel.h>
 
 namespace at { namespace native {
 
@@ -281,47 +280,23 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
     factor *= self.size(d);
   }
 
+  // Sum the values of equal indices, keeping the first occurrence of each
+  LongTensor firstPositions = indices.type().tensor();
+  Tensor newValues = values.type().tensor();
+  int64_t blockSize = values.numel() / nnz;
+  unique_sum_kernel(
+      newValues, firstPositions, indices_scalar, values.view({nnz, blockSize}));
+  int64_t newNnz = firstPositions.size(0);
+
+  std::vector<int64_t> newValuesSize(values.sizes());
+  newValuesSize[0] = newNnz;
+  LongTensor newIndices = indices.index_select(1, firstPositions);
+
   SparseTensor dst = new_sparse(self.type());
   _raw_resize_sparse(dst, sparseDims, denseDims, self.sizes());
-  // TODO: is there a more idiomatic way to do this?
-  LongTensor newIndices = indices.type().tensor(indices.sizes());
-  Tensor newValues = values.type().tensor(values.sizes());
-  _alias_into_sparse(dst, newIndices, newValues);
-
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
-  // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
-  auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
-  auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
-
-  int64_t i = -1;
-  AT_DISPATCH_ALL_TYPES(
-      values.type(), "coalesce", [&] {
-        int64_t prev = -1;
-        int64_t blockSize = values.stride(0);
-        scalar_t* values_ptr = values.data<scalar_t>();
-        scalar_t* newValues_ptr = newValues.data<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-          } else {
-            ++i;
-            for (int64_t d = 0; d < sparseDims; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
-            }
-            THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-          }
-          prev = curr;
-        }
-    });
-
+  _alias_into_sparse(dst, newIndices, newValues.view(newValuesSize));
   _get_sparse_impl(dst)->set_coalesced(true);
-  _get_sparse_impl(dst)->set_nnz(i + 1);
+  _get_sparse_impl(dst)->set_nnz(newNnz);
 
   return dst;
 }
@@ -2,7 +2,9 @@
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/sparse/SparseUtils.h>
+#include <ATen/native/cpu/SpmmKernel.h>
 
 #include <TH/THBlasUtils.h>
 
@@ -323,7 +325,8 @@ void add_dense_sparse_worker_cpu(Tensor& r, Scalar value, const SparseTensor& sp
 
   #pragma omp parallel for private(k)
   for (k = 0; k < sparse._nnz(); k++) {
-    int64_t index = r.storage_offset();
+    // r_ptr already points at the storage offset of r
+    int64_t index = 0;
     for (int64_t d = 0; d < sparse._sparseDims(); d++) {
       index += r.stride(d) * indices_accessor[d][k];
     }
@@ -331,6 +334,32 @@ void add_dense_sparse_worker_cpu(Tensor& r, Scalar value, const SparseTensor& sp
   }
 }
 
+// Adds every contiguous block of values into the matching block of a
+// contiguous r. The indices are coalesced, so blocks never overlap and can be
+// added in parallel.
+template <typename scalar_t>
+void add_dense_sparse_blocks_worker_cpu(Tensor& r, Scalar value, const SparseTensor& sparse, const Tensor& indices, const Tensor& values) {
+  int64_t nnz = sparse._nnz();
+  int64_t sparseDims = sparse._sparseDims();
+  int64_t blockSize = values.stride(0);
+
+  auto indices_accessor = indices.accessor<int64_t, 2>();
+  scalar_t* r_ptr = r.data<scalar_t>();
+  scalar_t* values_ptr = values.data<scalar_t>();
+  scalar_t cast_value = value.to<scalar_t>();
+
+  int64_t grain_size = std::max<int64_t>(internal::GRAIN_SIZE / std::max<int64_t>(blockSize, 1), 1);
+  at::parallel_for(0, nnz, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t k = begin; k < end; k++) {
+      int64_t index = 0;
+      for (int64_t d = 0; d < sparseDims; d++) {
+        index += r.stride(d) * indices_accessor[d][k];
+      }
+      THBlas_axpy<scalar_t>(blockSize, cast_value, values_ptr + k * blockSize, 1, r_ptr + index, 1);
+    }
+  });
+}
+
 Tensor& add_out_dense_sparse_cpu(Tensor& r, const Tensor& dense, SparseTensorRef sparse__, Scalar value) {
   const SparseTensor& sparse_ = sparse__.tref;
 
@@ -357,7 +386,13 @@ Tensor& add_out_dense_sparse_cpu(Tensor& r, const Tensor& dense, SparseTensorRef
   if (sparse._nnz() == 0) return r;
 
   // accessors rely on nnz test
-  if (nDim > nDimI) {
+  if (nDim > nDimI && r.is_contiguous() && values.sizes().slice(1).equals(r.sizes().slice(nDimI))) {
+    Tensor contiguous_values = values.contiguous();
+    AT_DISPATCH_ALL_TYPES(
+        values.type(), "add_dense_sparse_blocks", [&] {
+          add_dense_sparse_blocks_worker_cpu<scalar_t>(r, value, sparse, indices, contiguous_values);
+        });
+  } else if (nDim > nDimI) {
     auto indices_accessor = indices.accessor<int64_t, 2>();
     for (int64_t k = 0; k < sparse._nnz(); k++) {
       Tensor dstBuffer = r;
@@ -528,54 +563,6 @@ SparseTensor& s_mul_sparse_cpu_(SparseTensor& t, const SparseTensor& src) {
 // addmm(Tensor, SparseTensorRef, Tensor, Scalar, Scalar)  [broadcasts]
 // --------------------------------------------------------------------
 
-// NB: OMP pragmas have to get their own functions; can't put them in lambdas
-template <typename scalar_t>
-void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& csr, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t h, i;
-
-  // r_ = alpha * sparse * dense
-  scalar_t cast_alpha = alpha.to<scalar_t>();
-  scalar_t cast_beta = beta.to<scalar_t>();
-  if (cast_beta == 0) {
-    r.zero_();
-  } else if (cast_beta == 1) {
-    if (!isSameTensor(r, t)) {
-      r.copy_(t);
-    }
-  } else {
-    at::mul_out(r, t, beta);
-  }
-
-  auto csr_accessor = csr.accessor<int64_t, 1>();
-  auto indices_accessor = indices.accessor<int64_t, 2>();
-
-  auto values_accessor = values.accessor<scalar_t, 1>();
-  scalar_t* dense_ptr = dense.data<scalar_t>();
-  scalar_t* r_ptr = r.data<scalar_t>();
-
-  int64_t dense_stride0 = dense.stride(0);
-  int64_t dense_stride1 = dense.stride(1);
-  int64_t r_stride0 = r.stride(0);
-  int64_t r_stride1 = r.stride(1);
-#pragma omp parallel for private(h, i) schedule(static) if (nnz > 10000)
-  for (h = 0; h < dim_i; h++) {
-    int64_t i_start = csr_accessor[h];
-    int64_t i_end = csr_accessor[h+1];
-    for (i = i_start; i < i_end; i++) {
-      scalar_t val = values_accessor[i];
-      int64_t col = indices_accessor[1][i];
-      if (col >= 0 && col < dim_j) {
-        THBlas_axpy<scalar_t>(dim_k,
-            cast_alpha * val,
-            dense_ptr + col * dense_stride0, dense_stride1,
-            r_ptr + h * r_stride0, r_stride1);
-      } else {
-        AT_ERROR("addmm: index out of bound: ", col, " not between 1 and ", dim_j);
-      }
-    }
-  }
-};
-
 Tensor& s_addmm_out_sparse_dense_cpu(
     Tensor& r,
     const Tensor& t,
@@ -620,13 +607,36 @@ Tensor& s_addmm_out_sparse_dense_cpu(
 
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
-  LongTensor csr = _to_csr(indices.data<int64_t>(), dim_i, nnz);
+
+  // Checked here because errors can't be raised from the parallel kernel
+  LongTensor col_indices = indices.select(0, 1);
+  auto col_accessor = col_indices.accessor<int64_t, 1>();
+  for (int64_t i = 0; i < nnz; i++) {
+    int64_t col = col_accessor[i];
+    AT_CHECK(col >= 0 && col < dim_j, "addmm: index out of bound: ", col, " not between 1 and ", dim_j);
+  }
+
+  // The row pointers are kept on the sparse tensor, so multiplying the same
+  // matrix again (e.g. every iteration of a GCN layer) skips the conversion.
+  LongTensor csr = _get_sparse_impl(sparse)->csr([&] {
+    return _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  });
 
   AT_DISPATCH_ALL_TYPES(
       values.type(), "addmm_sparse_dense", [&] {
-        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, csr, indices, values, dense);
+        scalar_t cast_beta = beta.to<scalar_t>();
+        if (cast_beta == 0) {
+          r.zero_();
+        } else if (cast_beta == 1) {
+          if (!isSameTensor(r, t)) {
+            r.copy_(t);
+          }
+        } else {
+          at::mul_out(r, t, beta);
+        }
       }
   );
+  spmm_kernel(r, csr, col_indices, values, dense, alpha);
 
   return r;
 
@@ -777,7 +787,9 @@ SparseTensor& _sspaddmm_out_cpu(
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
 
-  LongTensor csr = _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  LongTensor csr = _get_sparse_impl(sparse)->csr([&] {
+    return _to_csr(indices.data<int64_t>(), dim_i, nnz);
+  });
 
   int64_t t_nnz = t._nnz();
   int64_t r_nnz = nnz * dim_k + t_nnz;
@@ -2,6 +2,7 @@
 #include <float.h>
 
 #include <atomic>
+#include <type_traits>
 #include "THTensor.hpp"
 #include "THVector.h"
 #include "generic/simd/simd.h"
@@ -12,6 +13,8 @@
 #include "THTensorDimApply.h"
 #include "THMath.h"
 
+#include "c10/util/Transpose.h"
+
 #include "generic/THTensor.cpp"
 #include "THGenerateAllTypes.h"
 
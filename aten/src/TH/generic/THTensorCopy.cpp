@@ -13,70 +13,343 @@
 #include <omp.h>
 #endif
 
-int THTensor_(copyTransposeValid)(THTensor *tensor, THTensor *src) {
-  const int MIN_SZ = 60 * 60;
-  return THTensor_(isContiguous)(tensor) &&
-         !src->is_empty() &&
-         THTensor_(nDimension)(src) == 2 &&
-         THTensor_(stride)(src, 0) == 1 &&
-         THTensor_(stride)(src, 1) == THTensor_(size)(src, 0) &&
-         THTensor_(nElement)(tensor) >= MIN_SZ;
-}
+#define TH_TENSOR_COPY_MAX_DIM 16
 
-// special case copy where tensor is contiguous and src is a transposed matrix
-// This can be generalized to most copies, but it's tricker
-void THTensor_(copyTranspose)(THTensor *tensor, THTensor *src) {
-  #define MIN(x, y) (((x) < (y)) ? (x) : (y))
-  #define MAX(x, y) (((x) > (y)) ? (x) : (y))
+#ifndef INTER_COPY_TYPE_DEFINED
+#define INTER_COPY_TYPE_DEFINED
 
-#ifdef TH_REAL_IS_BYTE
-  const int BLOCK_SZ = 120;
-#else
-  const int BLOCK_SZ = 60;
-#endif
+// C and C++ have a lovely set of implicit conversion rules, where casting
+// signed integral values to unsigned integral values is always valid
+// (it basically treats the value as if using modulo arithmetic), however
+// converting negative floating point values to unsigned integral types
+// is UB! This means that: (double)-1 -> (int64_t)-1 -> (uint8_t)255 is
+// guaranteed to look like this, but we have (double)-1 -> (uint8_t)<ANYTHING>
+// because it's UB. This also makes UBSan really angry.
+//
+// I think those rules are stupid and we really shouldn't conform to them.
+// The structs below ensure that for all unsigned types we use (currently
+// only uint8_t), we will do an intermediate convertion via int64_t,
+// to ensure that any negative values are wrapped around correctly.
+//
+// Note that conversions from doubles to signed integral types that can't
+// represent a particular value after truncating the fracitonal part are UB as well,
+// but fixing them is not as simple as adding an int64_t intermediate, beacuse the
+// int64_t -> <smaller signed type> conversion is UB for those large values anyway.
+// I guess in that case we just have to live with that, but it's definitely less
+// surprising than the thing above.
+//
+// For the curious:
+//   https://en.cppreference.com/w/cpp/language/implicit_conversion
+//   The relevant paragraph is "Floating–integral conversions".
+template<typename T>
+struct inter_copy_type {
+  using type = T;
+};
 
-  THTensor *buf = THTensor_(newWithSize2d)(BLOCK_SZ, BLOCK_SZ);
-  real *sp = THTensor_(data)(src);
-  real *rp = THTensor_(data)(tensor);
-  real *bp = THTensor_(data)(buf);
+template<>
+struct inter_copy_type<uint8_t> {
+  using type = int64_t;
+};
 
+template<typename T>
+using inter_copy_type_t = typename inter_copy_type<T>::type;
 
-  int64_t NR = THTensor_(size)(src, 0);
-  int64_t NC = THTensor_(size)(src, 1);
-  for (int64_t R = 0; R < NR; R += BLOCK_SZ) {
-    for (int64_t C = 0; C < NC; C += BLOCK_SZ) {
-      real *spo = sp + R + C * NR;
-      real *rpo = rp + C + R * NC;
+#endif
 
-      int nr = MIN(NR - R, BLOCK_SZ);
-      int nc = MIN(NC - C, BLOCK_SZ);
+#ifndef TH_COPY_KERNELS_DEFINED
+#define TH_COPY_KERNELS_DEFINED
 
-      // 1. copy columns from src to buf
-      for (int c = 0; c < nc; c++) {
-        memcpy(bp + c * BLOCK_SZ, spo + c * NR, nr * sizeof(real));
+// Splits the work of the copy kernels over the OpenMP threads, with the
+// parallel_for(n, cost, f) signature of c10::PermuteCopy.
+struct THCopyParallelFor {
+  template <typename F>
+  void operator()(int64_t n, int64_t cost, const F& f) const {
+#ifdef _OPENMP
+    if (n > 1 && n * cost > TH_OMP_OVERHEAD_THRESHOLD_COPY && !omp_in_parallel()) {
+      #pragma omp parallel
+      {
+        int64_t num_threads = omp_get_num_threads();
+        int64_t tid = omp_get_thread_num();
+        int64_t begin = n * tid / num_threads;
+        int64_t end = n * (tid + 1) / num_threads;
+        if (begin < end) {
+          f(begin, end);
+        }
       }
+      return;
+    }
+#endif
+    f(0, n);
+  }
+};
+
+// Element conversions of the copy kernels: one() converts an element, run()
+// n contiguous ones. Copies from or to half go through float, using the F16C
+// vector conversions where available.
+template <typename dst_t, typename src_t>
+struct THCopyConvert {
+  static inline dst_t one(src_t x) {
+    return static_cast<dst_t>(static_cast<inter_copy_type_t<dst_t>>(x));
+  }
+  static void run(dst_t *y, const src_t *x, ptrdiff_t n) {
+    for (ptrdiff_t i = 0; i < n; i++) {
+      y[i] = one(x[i]);
+    }
+  }
+};
+
+template <typename T>
+struct THCopyConvert<T, T> {
+  static inline T one(T x) {
+    return x;
+  }
+  static void run(T *y, const T *x, ptrdiff_t n) {
+    memcpy(y, x, n * sizeof(T));
+  }
+};
+
+template <>
+struct THCopyConvert<THHalf, THHalf> {
+  static inline THHalf one(THHalf x) {
+    return x;
+  }
+  static void run(THHalf *y, const THHalf *x, ptrdiff_t n) {
+    memcpy(y, x, n * sizeof(THHalf));
+  }
+};
+
+template <>
+struct THCopyConvert<float, THHalf> {
+  static inline float one(THHalf x) {
+    return TH_half2float(x);
+  }
+  static void run(float *y, const THHalf *x, ptrdiff_t n) {
+    THFloatVector_cvtFromHalf(y, x, n);
+  }
+};
+
+template <>
+struct THCopyConvert<THHalf, float> {
+  static inline THHalf one(float x) {
+    return TH_float2half(x);
+  }
+  static void run(THHalf *y, const float *x, ptrdiff_t n) {
+    THFloatVector_cvtToHalf(y, x, n);
+  }
+};
+
+#define TH_COPY_CONVERT_BLOCK 256
+
+template <typename dst_t>
+struct THCopyConvert<dst_t, THHalf> {
+  static inline dst_t one(THHalf x) {
+    return THCopyConvert<dst_t, float>::one(TH_half2float(x));
+  }
+  static void run(dst_t *y, const THHalf *x, ptrdiff_t n) {
+    float buffer[TH_COPY_CONVERT_BLOCK];
+    for (ptrdiff_t i = 0; i < n; i += TH_COPY_CONVERT_BLOCK) {
+      ptrdiff_t m = n - i < TH_COPY_CONVERT_BLOCK ? n - i : TH_COPY_CONVERT_BLOCK;
+      THFloatVector_cvtFromHalf(buffer, x + i, m);
+      THCopyConvert<dst_t, float>::run(y + i, buffer, m);
+    }
+  }
+};
+
+template <typename src_t>
+struct THCopyConvert<THHalf, src_t> {
+  static inline THHalf one(src_t x) {
+    return TH_float2half(static_cast<float>(x));
+  }
+  static void run(THHalf *y, const src_t *x, ptrdiff_t n) {
+    float buffer[TH_COPY_CONVERT_BLOCK];
+    for (ptrdiff_t i = 0; i < n; i += TH_COPY_CONVERT_BLOCK) {
+      ptrdiff_t m = n - i < TH_COPY_CONVERT_BLOCK ? n - i : TH_COPY_CONVERT_BLOCK;
+      THCopyConvert<float, src_t>::run(buffer, x + i, m);
+      THFloatVector_cvtToHalf(y + i, buffer, m);
+    }
+  }
+};
+
+#define TH_COPY_TILE 32
+#define TH_COPY_CHUNK 16384
+
+// Copies src into dst, converting every element, if both have the same
+// sizes, and returns whether it did. Unlike TH_TENSOR_APPLY2 it collapses
+// the dimensions that are contiguous in both tensors together and walks
+// them in whole rows, and it splits the copy over the OpenMP threads:
+// - rows that are contiguous in both tensors are memcpy'd or converted by
+//   THCopyConvert::run,
+// - when the innermost dimension is contiguous in one tensor and the next
+//   one in the other, e.g. a transposed 2D copy, both are walked in tiles
+//   so that the strided side reads or writes whole cache lines,
+// - all other rows are copied element by element.
+template <typename dst_t, typename src_t>
+static int THTensor_copyKernel(THTensor *dst, THTensor *src) {
+  typedef THCopyConvert<dst_t, src_t> Convert;
+  if (dst->dim() != src->dim()) {
+    return 0;
+  }
+  int64_t sizes[TH_TENSOR_COPY_MAX_DIM];
+  int64_t dst_strides[TH_TENSOR_COPY_MAX_DIM];
+  int64_t src_strides[TH_TENSOR_COPY_MAX_DIM];
+  int n = 0;
+  for (int64_t d = 0; d < dst->dim(); d++) {
+    if (dst->size[d] != src->size[d]) {
+      return 0;
+    }
+    if (dst->size[d] == 1) {
+      continue;
+    }
+    if (n > 0 &&
+        dst_strides[n - 1] == dst->stride[d] * dst->size[d] &&
+        src_strides[n - 1] == src->stride[d] * src->size[d]) {
+      sizes[n - 1] *= dst->size[d];
+      dst_strides[n - 1] = dst->stride[d];
+      src_strides[n - 1] = src->stride[d];
+      continue;
+    }
+    if (n == TH_TENSOR_COPY_MAX_DIM) {
+      return 0;
+    }
+    sizes[n] = dst->size[d];
+    dst_strides[n] = dst->stride[d];
+    src_strides[n] = src->stride[d];
+    n++;
+  }
+  if (dst->is_empty()) {
+    return 1;
+  }
+  dst_t *dst_data = dst->data<dst_t>();
+  const src_t *src_data = src->data<src_t>();
+  if (n == 0) {
+    *dst_data = Convert::one(*src_data);
+    return 1;
+  }
+
+  const int64_t inner = sizes[n - 1];
+  const int64_t dst_inner = dst_strides[n - 1];
+  const int64_t src_inner = src_strides[n - 1];
+  if (n == 1 && dst_inner == 1 && src_inner == 1) {
+    THCopyParallelFor()(
+        (inner + TH_COPY_CHUNK - 1) / TH_COPY_CHUNK, TH_COPY_CHUNK,
+        [&](int64_t begin, int64_t end) {
+          int64_t offset = begin * TH_COPY_CHUNK;
+          int64_t last = end * TH_COPY_CHUNK < inner ? end * TH_COPY_CHUNK : inner;
+          Convert::run(dst_data + offset, src_data + offset, last - offset);
+        });
+    return 1;
+  }
+
+  // Tiles of the two innermost dimensions when they are transposed between
+  // the tensors. Each work item is a strip of TH_COPY_TILE of their rows.
+  const int tiled = n >= 2 &&
+      ((dst_inner == 1 && src_strides[n - 2] == 1) ||
+       (src_inner == 1 && dst_strides[n - 2] == 1));
+  const int outer_dims = tiled ? n - 2 : n - 1;
+  const int64_t rows = tiled ? sizes[n - 2] : 1;
+  const int64_t strips = (rows + TH_COPY_TILE - 1) / TH_COPY_TILE;
+  int64_t outer = 1;
+  for (int d = 0; d < outer_dims; d++) {
+    outer *= sizes[d];
+  }
 
-      // 2. transpose buf in place
-      int rc_max = MAX(nr, nc);
-      int rc_min = MIN(nr, nc);
-      for (int r = 0; r < rc_max; r++) {
-        int end = MIN(r, rc_min);
-        for (int c = 0; c < end; c++) {
-          real tmp = bp[r + BLOCK_SZ * c];
-          bp[r + BLOCK_SZ * c] = bp[r * BLOCK_SZ + c];
-          bp[r * BLOCK_SZ + c] = tmp;
+  THCopyParallelFor()(
+      outer * strips, (tiled ? TH_COPY_TILE : 1) * inner,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t item = begin; item < end; item++) {
+          int64_t index = item / strips;
+          dst_t *y = dst_data;
+          const src_t *x = src_data;
+          for (int d = outer_dims - 1; d >= 0; d--) {
+            int64_t i = index % sizes[d];
+            index /= sizes[d];
+            y += i * dst_strides[d];
+            x += i * src_strides[d];
+          }
+          if (!tiled) {
+            if (dst_inner == 1 && src_inner == 1) {
+              Convert::run(y, x, inner);
+            } else {
+              for (int64_t j = 0; j < inner; j++) {
+                y[j * dst_inner] = Convert::one(x[j * src_inner]);
+              }
+            }
+            continue;
+          }
+          const int64_t dst_outer = dst_strides[n - 2];
+          const int64_t src_outer = src_strides[n - 2];
+          const int64_t row_begin = item % strips * TH_COPY_TILE;
+          const int64_t row_end =
+              row_begin + TH_COPY_TILE < rows ? row_begin + TH_COPY_TILE : rows;
+          for (int64_t j0 = 0; j0 < inner; j0 += TH_COPY_TILE) {
+            const int64_t j1 = j0 + TH_COPY_TILE < inner ? j0 + TH_COPY_TILE : inner;
+            for (int64_t i = row_begin; i < row_end; i++) {
+              for (int64_t j = j0; j < j1; j++) {
+                y[i * dst_outer + j * dst_inner] =
+                    Convert::one(x[i * src_outer + j * src_inner]);
+              }
+            }
+          }
         }
-      }
+      });
+  return 1;
+}
 
-      // 3. copy rows from buf to dst
-      for (int r = 0; r < nr; r++) {
-        memcpy(rpo + r * NC, bp + r * BLOCK_SZ, nc * sizeof(real));
+#endif
+
+// Whether tensor is contiguous and src is a permutation of a contiguous
+// tensor, e.g. a transposed matrix or an NHWC view of NCHW data, so that the
+// copy is a c10::PermuteCopy. If so, fills dims with the sizes of src's
+// underlying contiguous layout and axes with the permutation that gives src,
+// leaving out dimensions of size 1, and returns their number.
+int THTensor_(copyTransposeValid)(THTensor *tensor, THTensor *src, int64_t *dims, int *axes) {
+  const int MIN_SZ = 60 * 60;
+  if (!THTensor_(isContiguous)(tensor) ||
+      src->is_empty() ||
+      THTensor_(nElement)(tensor) < MIN_SZ) {
+    return 0;
+  }
+  int ndim = 0;
+  int order[TH_TENSOR_COPY_MAX_DIM];
+  for (int d = 0; d < THTensor_(nDimension)(src); d++) {
+    if (THTensor_(size)(src, d) == 1) {
+      continue;
+    }
+    if (ndim == TH_TENSOR_COPY_MAX_DIM) {
+      return 0;
+    }
+    // Insertion sort of the dimensions by decreasing stride
+    int i = ndim++;
+    for (; i > 0 && THTensor_(stride)(src, order[i - 1]) < THTensor_(stride)(src, d); i--) {
+      order[i] = order[i - 1];
+    }
+    order[i] = d;
+  }
+  int64_t expected_stride = 1;
+  for (int i = ndim - 1; i >= 0; i--) {
+    if (THTensor_(stride)(src, order[i]) != expected_stride) {
+      return 0;
+    }
+    dims[i] = THTensor_(size)(src, order[i]);
+    expected_stride *= dims[i];
+  }
+  int y = 0;
+  for (int d = 0; d < THTensor_(nDimension)(src); d++) {
+    for (int i = 0; i < ndim; i++) {
+      if (order[i] == d) {
+        axes[y++] = i;
       }
     }
   }
-  THTensor_(free)(buf);
-  #undef MIN
-  #undef MAX
+  return ndim;
+}
+
+// special case copy where tensor is contiguous and src is a permuted
+// contiguous tensor, done by tiled transposes on all OpenMP threads
+void THTensor_(copyTranspose)(THTensor *tensor, THTensor *src, int ndim, int64_t *dims, int *axes) {
+  c10::PermuteCopy(
+      ndim, dims, axes, THTensor_(data)(src), THTensor_(data)(tensor),
+      THCopyParallelFor());
 }
 
 void THTensor_(copy)(THTensor *tensor, THTensor *src)
@@ -88,6 +361,9 @@ void THTensor_(copy)(THTensor *tensor, THTensor *src)
   int srcContig = THTensor_(isContiguous)(src);
 
   int serial_path = 0;
+  int transposeDim;
+  int64_t transposeSizes[TH_TENSOR_COPY_MAX_DIM];
+  int transposeAxes[TH_TENSOR_COPY_MAX_DIM];
 #ifdef _OPENMP
   int inOMP = omp_in_parallel();
 #endif
@@ -130,11 +406,9 @@ void THTensor_(copy)(THTensor *tensor, THTensor *src)
 
 #endif
 
-#ifndef TH_REAL_IS_HALF
-    } else if (THTensor_(copyTransposeValid)(tensor, src)) {
-      THTensor_(copyTranspose)(tensor, src);
-#endif
-    } else {
+    } else if ((transposeDim = THTensor_(copyTransposeValid)(tensor, src, transposeSizes, transposeAxes))) {
+      THTensor_(copyTranspose)(tensor, src, transposeDim, transposeSizes, transposeAxes);
+    } else if (!THTensor_copyKernel<real, real>(tensor, src)) {
 #ifdef _OPENMP
       if (inOMP) {
         serial_path = 1;
@@ -154,77 +428,19 @@ void THTensor_(copy)(THTensor *tensor, THTensor *src)
   }
 }
 
-#ifndef INTER_COPY_TYPE_DEFINED
-#define INTER_COPY_TYPE_DEFINED
-
-// C and C++ have a lovely set of implicit conversion rules, where casting
-// signed integral values to unsigned integral values is always valid
-// (it basically treats the value as if using modulo arithmetic), however
-// converting negative floating point values to unsigned integral types
-// is UB! This means that: (double)-1 -> (int64_t)-1 -> (uint8_t)255 is
-// guaranteed to look like this, but we have (double)-1 -> (uint8_t)<ANYTHING>
-// because it's UB. This also makes UBSan really angry.
-//
-// I think those rules are stupid and we really shouldn't conform to them.
-// The structs below ensure that for all unsigned types we use (currently
-// only uint8_t), we will do an intermediate convertion via int64_t,
-// to ensure that any negative values are wrapped around correctly.
-//
-// Note that conversions from doubles to signed integral types that can't
-// represent a particular value after truncating the fracitonal part are UB as well,
-// but fixing them is not as simple as adding an int64_t intermediate, beacuse the
-// int64_t -> <smaller signed type> conversion is UB for those large values anyway.
-// I guess in that case we just have to live with that, but it's definitely less
-// surprising than the thing above.
-//
-// For the curious:
-//   https://en.cppreference.com/w/cpp/language/implicit_conversion
-//   The relevant paragraph is "Floating–integral conversions".
-template<typename T>
-struct inter_copy_type {
-  using type = T;
-};
-
-template<>
-struct inter_copy_type<uint8_t> {
-  using type = int64_t;
-};
-
-template<typename T>
-using inter_copy_type_t = typename inter_copy_type<T>::type;
-
-#endif
-
 #define IMPLEMENT_THTensor_COPY(TYPENAMESRC, TYPE_SRC) \
 void THTensor_(copy##TYPENAMESRC)(THTensor *tensor, TH##TYPENAMESRC##Tensor *src) \
 { \
-  TH_TENSOR_APPLY2(real, tensor, TYPE_SRC, src, \
-                   *tensor_data = static_cast<real>( \
-                       static_cast<inter_copy_type_t<real>>(*src_data));) \
-}
-
-#define IMPLEMENT_THTensor_COPY_TO_HALF(TYPENAMESRC, TYPE_SRC) \
-void THTensor_(copy##TYPENAMESRC)(THTensor *tensor, TH##TYPENAMESRC##Tensor *src) \
-{ \
- TH_TENSOR_APPLY2(real, tensor, TYPE_SRC, src, *tensor_data = TH_float2half((float)*src_data);) \
+  typedef THCopyConvert<real, TYPE_SRC> Convert; \
+  /* ATen's copy_ between tensors of the same type lands here */ \
+  if (std::is_same<real, TYPE_SRC>::value) { \
+    THTensor_(copy)(tensor, src); \
+  } else if (!THTensor_copyKernel<real, TYPE_SRC>(tensor, src)) { \
+    TH_TENSOR_APPLY2(real, tensor, TYPE_SRC, src, \
+                     *tensor_data = Convert::one(*src_data);) \
+  } \
 }
 
-#define IMPLEMENT_THTensor_COPY_FROM_HALF(TYPENAMESRC, TYPE_SRC) \
-void THTensor_(copy##TYPENAMESRC)(THTensor *tensor, TH##TYPENAMESRC##Tensor *src) \
-{ \
- TH_TENSOR_APPLY2(real, tensor, TYPE_SRC, src, \
-                  *tensor_data = static_cast<real>( \
-                      static_cast<inter_copy_type_t<real>>( \
-                          TH_half2float(*src_data)));) \
-}
-
-#define IMPLEMENT_THTensor_COPY_TO_FROM_HALF(TYPENAMESRC, TYPE_SRC) \
-void THTensor_(copy##TYPENAMESRC)(THTensor *tensor, TH##TYPENAMESRC##Tensor *src) \
-{ \
- TH_TENSOR_APPLY2(real, tensor, TYPE_SRC, src, *tensor_data = *src_data;) \
-}
-
-#ifndef TH_REAL_IS_HALF
 IMPLEMENT_THTensor_COPY(Byte, uint8_t)
 IMPLEMENT_THTensor_COPY(Char, int8_t)
 IMPLEMENT_THTensor_COPY(Short, int16_t)
@@ -232,18 +448,6 @@ IMPLEMENT_THTensor_COPY(Int, int32_t)
 IMPLEMENT_THTensor_COPY(Long, int64_t)
 IMPLEMENT_THTensor_COPY(Float, float)
 IMPLEMENT_THTensor_COPY(Double, double)
-IMPLEMENT_THTensor_COPY_FROM_HALF(Half, THHalf)
-#else
-/* only allow pass-through for Half */
-IMPLEMENT_THTensor_COPY_TO_FROM_HALF(Half, THHalf)
-IMPLEMENT_THTensor_COPY_TO_HALF(Byte, uint8_t)
-IMPLEMENT_THTensor_COPY_TO_HALF(Char, int8_t)
-IMPLEMENT_THTensor_COPY_TO_HALF(Short, int16_t)
-IMPLEMENT_THTensor_COPY_TO_HALF(Int, int32_t)
-IMPLEMENT_THTensor_COPY_TO_HALF(Long, int64_t)
-IMPLEMENT_THTensor_COPY_TO_HALF(Float, float)
-IMPLEMENT_THTensor_COPY_TO_HALF(Double, double)
-
-#endif /* REAL_IS_HALF */
+IMPLEMENT_THTensor_COPY(Half, THHalf)
 
 #endif
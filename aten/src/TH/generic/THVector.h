@@ -23,6 +23,11 @@ TH_API void THVector_(normal_fill)(real *data,
 TH_API void THVector_(cvtFromInt)(real *y, const int *x, const ptrdiff_t n);
 #endif
 
+#if defined(TH_REAL_IS_FLOAT)
+TH_API void THVector_(cvtFromHalf)(real *y, const THHalf *x, const ptrdiff_t n);
+TH_API void THVector_(cvtToHalf)(THHalf *y, const real *x, const ptrdiff_t n);
+#endif
+
 #if defined(TH_REAL_IS_SHORT) || defined(TH_REAL_IS_INT) || defined(TH_REAL_IS_LONG)
 TH_API void THVector_(abs)(real *y, const real *x, const ptrdiff_t n);
 #endif
@@ -148,6 +148,22 @@ void THVector_(cvtFromInt_DEFAULT)(real *y, const int *x, const ptrdiff_t n)
 }
 #endif
 
+#if defined(TH_REAL_IS_FLOAT)
+void THVector_(cvtFromHalf_DEFAULT)(real *y, const THHalf *x, const ptrdiff_t n)
+{
+  ptrdiff_t i;
+  for(i = 0; i < n; i++)
+    y[i] = TH_half2float(x[i]);
+}
+
+void THVector_(cvtToHalf_DEFAULT)(THHalf *y, const real *x, const ptrdiff_t n)
+{
+  ptrdiff_t i;
+  for(i = 0; i < n; i++)
+    y[i] = TH_float2half(x[i]);
+}
+#endif
+
 // Fills 16 normally distributed samples into data, interleaved with a
 // stride of 8, i.e. in order of ([0], [8]), ([1], [9]), ...
 static void THVector_(interleaved_normal_fill_16)(real *data,
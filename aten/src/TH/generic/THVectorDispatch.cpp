@@ -262,6 +262,34 @@ void THVector_(cvtFromInt)(real *y, const int *x, const ptrdiff_t n) {
 }
 #endif
 
+#if defined(TH_REAL_IS_FLOAT)
+/* The AVX2 versions use the F16C conversion instructions, which every CPU
+ * with AVX2 has */
+static void (*THVector_(cvtFromHalf_DISPATCHPTR))(real *, const THHalf *, const ptrdiff_t) = &THVector_(cvtFromHalf_DEFAULT);
+static FunctionDescription THVector_(cvtFromHalf_DISPATCHTABLE)[] = {
+  #if defined(USE_AVX2)
+      FUNCTION_IMPL(THVector_(cvtFromHalf_AVX2), SIMDExtension_AVX2),
+  #endif
+
+  FUNCTION_IMPL(THVector_(cvtFromHalf_DEFAULT), SIMDExtension_DEFAULT)
+};
+void THVector_(cvtFromHalf)(real *y, const THHalf *x, const ptrdiff_t n) {
+  THVector_(cvtFromHalf_DISPATCHPTR)(y, x, n);
+}
+
+static void (*THVector_(cvtToHalf_DISPATCHPTR))(THHalf *, const real *, const ptrdiff_t) = &THVector_(cvtToHalf_DEFAULT);
+static FunctionDescription THVector_(cvtToHalf_DISPATCHTABLE)[] = {
+  #if defined(USE_AVX2)
+      FUNCTION_IMPL(THVector_(cvtToHalf_AVX2), SIMDExtension_AVX2),
+  #endif
+
+  FUNCTION_IMPL(THVector_(cvtToHalf_DEFAULT), SIMDExtension_DEFAULT)
+};
+void THVector_(cvtToHalf)(THHalf *y, const real *x, const ptrdiff_t n) {
+  THVector_(cvtToHalf_DISPATCHPTR)(y, x, n);
+}
+#endif
+
 static void (*THVector_(normal_fill_DISPATCHPTR))(real *, const int64_t, THGenerator *, const real, const real) = &THVector_(normal_fill_DEFAULT);
 static FunctionDescription THVector_(normal_fill_DISPATCHTABLE)[] = {
   #if defined(TH_REAL_IS_FLOAT) && defined(USE_AVX2)
@@ -317,6 +345,11 @@ struct THVector_(startup) {
     INIT_DISPATCH_PTR(cvtFromInt);
 #endif
 
+#if defined(TH_REAL_IS_FLOAT)
+    INIT_DISPATCH_PTR(cvtFromHalf);
+    INIT_DISPATCH_PTR(cvtToHalf);
+#endif
+
 #if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
     INIT_DISPATCH_PTR(sigmoid);
 #endif
@@ -127,4 +127,32 @@ void THFloatVector_sigmoid_AVX2(float *y, const float *x, const ptrdiff_t n) {
   }
 }
 
+// F16C conversions. They round to nearest even like TH_float2half, but keep
+// the sign and payload of NaNs instead of making them all 0x7fff.
+void THFloatVector_cvtFromHalf_AVX2(float *y, const THHalf *x, const ptrdiff_t n) {
+  ptrdiff_t i;
+  for (i = 0; i <= ((n)-16); i += 16) {
+    __m128i XMM0 = _mm_loadu_si128((const __m128i*)(x + i));
+    __m128i XMM1 = _mm_loadu_si128((const __m128i*)(x + i + 8));
+    _mm256_storeu_ps(y + i, _mm256_cvtph_ps(XMM0));
+    _mm256_storeu_ps(y + i + 8, _mm256_cvtph_ps(XMM1));
+  }
+  for (; i < (n); i++) {
+    y[i] = TH_half2float(x[i]);
+  }
+}
+
+void THFloatVector_cvtToHalf_AVX2(THHalf *y, const float *x, const ptrdiff_t n) {
+  ptrdiff_t i;
+  for (i = 0; i <= ((n)-16); i += 16) {
+    __m256 YMM0 = _mm256_loadu_ps(x + i);
+    __m256 YMM1 = _mm256_loadu_ps(x + i + 8);
+    _mm_storeu_si128((__m128i*)(y + i), _mm256_cvtps_ph(YMM0, _MM_FROUND_TO_NEAREST_INT));
+    _mm_storeu_si128((__m128i*)(y + i + 8), _mm256_cvtps_ph(YMM1, _MM_FROUND_TO_NEAREST_INT));
+  }
+  for (; i < (n); i++) {
+    y[i] = TH_float2half(x[i]);
+  }
+}
+
 #endif // defined(__AVX2__)
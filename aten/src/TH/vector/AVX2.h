@@ -2,6 +2,7 @@
 #define TH_AVX2_H
 
 #include "THGeneral.h"
+#include "THHalf.h"
 
 #include <stdint.h>
 #include <stddef.h>
@@ -16,4 +17,6 @@ TH_API void THFloatVector_normal_fill_AVX2(float *data,
                                     const float mean,
                                     const float stddev);
 TH_API void THFloatVector_sigmoid_AVX2(float *y, const float *x, const ptrdiff_t n);
+TH_API void THFloatVector_cvtFromHalf_AVX2(float *y, const THHalf *x, const ptrdiff_t n);
+TH_API void THFloatVector_cvtToHalf_AVX2(THHalf *y, const float *x, const ptrdiff_t n);
 #endif
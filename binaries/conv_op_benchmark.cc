@@ -0,0 +1,91 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/utils/math.h"
+#include "caffe2/utils/proto_utils.h"
+
+// Single-threaded CPU Conv on the layer shapes of a ResNet-50 bottleneck:
+// 1x1 reductions and expansions (stride 1 and the stride 2 projection
+// shortcut) and the 3x3 convolution in between, in both storage orders.
+//
+// Arguments are {channels in, channels out, image size, kernel, stride}, with
+// a batch of one image as in inference. Run e.g. with
+// --benchmark_filter=NHWC to only time one order.
+
+using namespace caffe2;
+
+namespace {
+
+void FillRandom(Workspace* ws, const string& name, const vector<TIndex>& dims) {
+  auto* tensor = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+  tensor->Resize(dims);
+  CPUContext context;
+  math::RandUniform<float, CPUContext>(
+      tensor->size(), -1, 1, tensor->mutable_data<float>(), &context);
+}
+
+void BM_Conv(benchmark::State& state, const string& order) {
+  const int input_channels = state.range(0);
+  const int output_channels = state.range(1);
+  const int size = state.range(2);
+  const int kernel = state.range(3);
+  const int stride = state.range(4);
+  const bool nchw = order == "NCHW";
+
+  Workspace ws;
+  FillRandom(
+      &ws,
+      "X",
+      nchw ? vector<TIndex>{1, input_channels, size, size}
+           : vector<TIndex>{1, size, size, input_channels});
+  FillRandom(
+      &ws,
+      "W",
+      nchw ? vector<TIndex>{output_channels, input_channels, kernel, kernel}
+           : vector<TIndex>{output_channels, kernel, kernel, input_channels});
+  FillRandom(&ws, "B", {output_channels});
+
+  auto def = CreateOperatorDef(
+      "Conv",
+      "",
+      {"X", "W", "B"},
+      {"Y"},
+      {MakeArgument<int>("kernel", kernel),
+       MakeArgument<int>("stride", stride),
+       MakeArgument<int>("pad", kernel / 2),
+       MakeArgument<string>("order", order)});
+  auto op = CreateOperator(def, &ws);
+  CAFFE_ENFORCE(op->Run());
+
+  while (state.KeepRunning()) {
+    op->Run();
+  }
+  const int output_size = (size + 2 * (kernel / 2) - kernel) / stride + 1;
+  state.SetItemsProcessed(
+      state.iterations() * 2 * output_channels * output_size * output_size *
+      input_channels * kernel * kernel);
+}
+
+void ResNetShapes(benchmark::internal::Benchmark* b) {
+  b->Args({256, 64, 56, 1, 1});
+  b->Args({64, 256, 56, 1, 1});
+  b->Args({64, 64, 56, 3, 1});
+  b->Args({256, 512, 56, 1, 2});
+  b->Args({512, 128, 28, 1, 1});
+  b->Args({128, 128, 28, 3, 1});
+  b->Args({1024, 256, 14, 1, 1});
+  b->Args({256, 256, 14, 3, 1});
+  b->Args({1024, 2048, 14, 1, 2});
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Conv, NCHW, string("NCHW"))->Apply(ResNetShapes);
+BENCHMARK_CAPTURE(BM_Conv, NHWC, string("NHWC"))->Apply(ResNetShapes);
+
+BENCHMARK_MAIN();
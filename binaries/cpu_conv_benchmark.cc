@@ -0,0 +1,114 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "ATen/ATen.h"
+
+// CPU convolution algorithms against the THNN kernels (unfold + GEMM, one call
+// per group) that they replace, on batch 1 inference shapes:
+//
+// - Depthwise: 3x3 depthwise convolutions of MobileNet, computed by
+//   cpu_depthwise_convolution, args {channels, image size, stride}
+// - Winograd: ungrouped 3x3 convolutions of ResNet, computed by
+//   cpu_winograd_convolution, args {channels, image size}
+//
+// The thread count comes from OMP_NUM_THREADS / MKL_NUM_THREADS.
+
+namespace {
+
+// Calls _convolution_nogroup once per group, as the THNN algorithm of
+// at::convolution does.
+at::Tensor ThnnConvolution(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    at::IntList stride,
+    at::IntList padding,
+    int64_t groups) {
+  const int64_t in_channels = input.size(1) / groups;
+  const int64_t out_channels = weight.size(0) / groups;
+  std::vector<at::Tensor> outputs;
+  for (int64_t g = 0; g < groups; ++g) {
+    outputs.push_back(at::_convolution_nogroup(
+        input.narrow(1, g * in_channels, in_channels).contiguous(),
+        weight.narrow(0, g * out_channels, out_channels).contiguous(),
+        bias.narrow(0, g * out_channels, out_channels).contiguous(),
+        stride,
+        padding,
+        {1, 1},
+        false,
+        {0, 0}));
+  }
+  return groups == 1 ? outputs[0] : at::cat(outputs, 1);
+}
+
+void SetItemsProcessed(
+    benchmark::State& state,
+    const at::Tensor& output,
+    int64_t macs_per_output) {
+  state.SetItemsProcessed(
+      state.iterations() * output.numel() * macs_per_output);
+}
+
+void BM_Depthwise(benchmark::State& state, bool thnn) {
+  const int64_t channels = state.range(0);
+  const int64_t size = state.range(1);
+  const int64_t stride = state.range(2);
+  auto input = at::randn({1, channels, size, size});
+  auto weight = at::randn({channels, 1, 3, 3});
+  auto bias = at::randn({channels});
+
+  at::Tensor output;
+  while (state.KeepRunning()) {
+    output = thnn ? ThnnConvolution(
+                        input, weight, bias, {stride, stride}, {1, 1}, channels)
+                  : at::cpu_depthwise_convolution(
+                        input, weight, bias, {1, 1}, {stride, stride}, {1, 1});
+    benchmark::DoNotOptimize(output.data_ptr());
+  }
+  SetItemsProcessed(state, output, 9);
+}
+
+void BM_Winograd(benchmark::State& state, bool thnn) {
+  const int64_t channels = state.range(0);
+  const int64_t size = state.range(1);
+  auto input = at::randn({1, channels, size, size});
+  auto weight = at::randn({channels, channels, 3, 3});
+  auto bias = at::randn({channels});
+
+  at::Tensor output;
+  while (state.KeepRunning()) {
+    output = thnn
+        ? ThnnConvolution(input, weight, bias, {1, 1}, {1, 1}, 1)
+        : at::cpu_winograd_convolution(input, weight, bias, {1, 1});
+    benchmark::DoNotOptimize(output.data_ptr());
+  }
+  SetItemsProcessed(state, output, channels * 9);
+}
+
+void DepthwiseShapes(benchmark::internal::Benchmark* b) {
+  b->Args({32, 112, 1});
+  b->Args({64, 112, 2});
+  b->Args({128, 56, 1});
+  b->Args({256, 28, 2});
+  b->Args({512, 14, 1});
+  b->Args({1024, 7, 1});
+  b->UseRealTime();
+}
+
+void WinogradShapes(benchmark::internal::Benchmark* b) {
+  b->Args({64, 56});
+  b->Args({128, 28});
+  b->Args({256, 14});
+  b->Args({512, 7});
+  b->UseRealTime();
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Depthwise, Thnn, true)->Apply(DepthwiseShapes);
+BENCHMARK_CAPTURE(BM_Depthwise, Direct, false)->Apply(DepthwiseShapes);
+BENCHMARK_CAPTURE(BM_Winograd, Thnn, true)->Apply(WinogradShapes);
+BENCHMARK_CAPTURE(BM_Winograd, Winograd, false)->Apply(WinogradShapes);
+
+BENCHMARK_MAIN();
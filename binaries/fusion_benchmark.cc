@@ -0,0 +1,152 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/optimizer.h"
+#include "caffe2/utils/math.h"
+#include "caffe2/utils/proto_utils.h"
+
+// Inference blocks before and after the level 1 graph optimizations of
+// caffe2/opt/optimizer.h, which fold normalizations into Conv and FC, fuse
+// the activations that follow them and merge elementwise chains:
+//
+// - ConvBNRelu: Conv -> SpatialBN -> Relu, args {channels, image size}
+// - FCRelu: two FC -> Relu layers of an MLP, args {batch, width}
+// - Elementwise: Mul -> Add -> Sigmoid -> Mul -> Tanh of an LSTM-like gate,
+//   args {batch, width}
+//
+// The Unfused and Fused variants run the same net. To measure a whole model,
+// run speed_benchmark with and without --opt 1.
+
+using namespace caffe2;
+
+namespace {
+
+void FillRandom(Workspace* ws, const string& name, const vector<TIndex>& dims) {
+  auto* tensor = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+  tensor->Resize(dims);
+  CPUContext context;
+  math::RandUniform<float, CPUContext>(
+      tensor->size(), 0.5, 1, tensor->mutable_data<float>(), &context);
+}
+
+void AddOp(
+    NetDef* net,
+    const string& type,
+    const vector<string>& inputs,
+    const string& output,
+    const vector<Argument>& args = {}) {
+  *net->add_op() = CreateOperatorDef(type, "", inputs, {output}, args);
+}
+
+void RunNet(benchmark::State& state, Workspace* ws, NetDef net, bool fused) {
+  for (const auto& name : ws->Blobs()) {
+    net.add_external_input(name);
+  }
+  net.add_external_output("Y");
+  if (fused) {
+    net = opt::optimize(net, ws, 1);
+  }
+  net.set_name("block");
+  auto* net_ptr = ws->CreateNet(net);
+  CAFFE_ENFORCE(net_ptr->Run());
+
+  while (state.KeepRunning()) {
+    net_ptr->Run();
+  }
+}
+
+void BM_ConvBNRelu(benchmark::State& state, bool fused) {
+  const int channels = state.range(0);
+  const int size = state.range(1);
+
+  Workspace ws;
+  FillRandom(&ws, "X", {1, channels, size, size});
+  FillRandom(&ws, "W", {channels, channels, 3, 3});
+  for (const string name : {"scale", "bias", "mean", "var"}) {
+    FillRandom(&ws, name, {channels});
+  }
+
+  NetDef net;
+  AddOp(
+      &net,
+      "Conv",
+      {"X", "W"},
+      "Y_conv",
+      {MakeArgument<int>("kernel", 3), MakeArgument<int>("pad", 1)});
+  AddOp(
+      &net,
+      "SpatialBN",
+      {"Y_conv", "scale", "bias", "mean", "var"},
+      "Y_bn",
+      {MakeArgument<int>("is_test", 1)});
+  AddOp(&net, "Relu", {"Y_bn"}, "Y");
+  RunNet(state, &ws, net, fused);
+  state.SetItemsProcessed(
+      state.iterations() * 2 * channels * channels * size * size * 9);
+}
+
+void BM_FCRelu(benchmark::State& state, bool fused) {
+  const int batch = state.range(0);
+  const int width = state.range(1);
+
+  Workspace ws;
+  FillRandom(&ws, "X", {batch, width});
+  NetDef net;
+  string input = "X";
+  for (const string layer : {"1", "2"}) {
+    FillRandom(&ws, "W" + layer, {width, width});
+    FillRandom(&ws, "b" + layer, {width});
+    AddOp(&net, "FC", {input, "W" + layer, "b" + layer}, "fc" + layer);
+    input = layer == "2" ? "Y" : "relu" + layer;
+    AddOp(&net, "Relu", {"fc" + layer}, input);
+  }
+  RunNet(state, &ws, net, fused);
+  state.SetItemsProcessed(state.iterations() * 2 * 2 * batch * width * width);
+}
+
+void BM_Elementwise(benchmark::State& state, bool fused) {
+  const int batch = state.range(0);
+  const int width = state.range(1);
+
+  Workspace ws;
+  for (const string name : {"X", "A", "C"}) {
+    FillRandom(&ws, name, {batch, width});
+  }
+  FillRandom(&ws, "B", {width});
+
+  NetDef net;
+  AddOp(&net, "Mul", {"X", "A"}, "T1");
+  AddOp(&net, "Add", {"T1", "B"}, "T2");
+  AddOp(&net, "Sigmoid", {"T2"}, "T3");
+  AddOp(&net, "Mul", {"T3", "C"}, "T4");
+  AddOp(&net, "Tanh", {"T4"}, "Y");
+  RunNet(state, &ws, net, fused);
+  state.SetItemsProcessed(state.iterations() * batch * width);
+}
+
+void ConvShapes(benchmark::internal::Benchmark* b) {
+  b->Args({64, 56});
+  b->Args({128, 28});
+  b->Args({256, 14});
+}
+
+void MLPShapes(benchmark::internal::Benchmark* b) {
+  b->Args({1, 1024});
+  b->Args({64, 512});
+  b->Args({256, 256});
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ConvBNRelu, Unfused, false)->Apply(ConvShapes);
+BENCHMARK_CAPTURE(BM_ConvBNRelu, Fused, true)->Apply(ConvShapes);
+BENCHMARK_CAPTURE(BM_FCRelu, Unfused, false)->Apply(MLPShapes);
+BENCHMARK_CAPTURE(BM_FCRelu, Fused, true)->Apply(MLPShapes);
+BENCHMARK_CAPTURE(BM_Elementwise, Unfused, false)->Apply(MLPShapes);
+BENCHMARK_CAPTURE(BM_Elementwise, Fused, true)->Apply(MLPShapes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/operators/index_ops.h"
+
+// Multi-threaded IndexGet throughput. Every thread repeatedly looks up
+// batches of keys drawn from the same pool in a shared index, which is
+// either mutable (every lookup takes its shard's lock) or frozen (no locks).
+//
+// Run e.g. with --benchmark_filter=int64 to only time integer keys.
+
+using namespace caffe2;
+
+namespace {
+
+constexpr int kNumKeys = 1 << 20;
+constexpr int kBatchSize = 512;
+
+template <typename T>
+T MakeKey(int64_t i);
+
+template <>
+int64_t MakeKey<int64_t>(int64_t i) {
+  // Sparse feature ids are hashed and spread over the whole int64 range.
+  return static_cast<int64_t>(
+      static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull);
+}
+
+template <>
+std::string MakeKey<std::string>(int64_t i) {
+  return "feature_" + std::to_string(i);
+}
+
+template <typename T>
+Index<T>* BuildIndex(bool frozen) {
+  auto* index = new Index<T>(std::numeric_limits<int64_t>::max());
+  std::vector<T> keys;
+  keys.reserve(kNumKeys);
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.push_back(MakeKey<T>(i));
+  }
+  index->Load(keys.data(), keys.size());
+  if (frozen) {
+    index->Freeze();
+  }
+  return index;
+}
+
+// Shared by all threads and benchmark runs; built by whichever thread gets
+// here first, before timing starts.
+template <typename T, bool kFrozen>
+Index<T>* SharedIndex() {
+  static Index<T>* index = BuildIndex<T>(kFrozen);
+  return index;
+}
+
+template <typename T, bool kFrozen>
+void BM_IndexGet(benchmark::State& state) {
+  auto* index = SharedIndex<T, kFrozen>();
+  std::mt19937 gen(state.thread_index);
+  std::uniform_int_distribution<int64_t> dist(0, kNumKeys - 1);
+  std::vector<T> keys(kBatchSize);
+  std::vector<TIndexValue> values(kBatchSize);
+  for (auto& key : keys) {
+    key = MakeKey<T>(dist(gen));
+  }
+  while (state.KeepRunning()) {
+    index->Get(keys.data(), values.data(), keys.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_IndexGet, int64_t, false)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_IndexGet, int64_t, true)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_IndexGet, std::string, false)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_IndexGet, std::string, true)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,160 @@
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/core/context.h"
+#include "caffe2/utils/math.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+// CPU math functions that split their work over the context's thread pool,
+// timed on one thread (argument 0) and on the default pool (argument 1).
+// The shapes are those of mid-sized ResNet layers and their activations.
+
+using namespace caffe2;
+
+namespace {
+
+ThreadPool* SharedThreadPool() {
+  static std::unique_ptr<ThreadPool> pool = []() {
+    auto p = ThreadPool::defaultThreadPool();
+    p->setMinWorkSize(1);
+    return p;
+  }();
+  return pool.get();
+}
+
+std::vector<float> RandomData(int size) {
+  std::vector<float> data(size);
+  CPUContext context;
+  math::RandUniform<float, CPUContext>(size, -1, 1, data.data(), &context);
+  return data;
+}
+
+void SetUpContext(const benchmark::State& state, CPUContext* context) {
+  context->set_thread_pool(state.range(0) ? SharedThreadPool() : nullptr);
+}
+
+void BM_Im2ColNCHW(benchmark::State& state) {
+  CPUContext context;
+  SetUpContext(state, &context);
+  const int C = 128, H = 28, W = 28;
+  const auto img = RandomData(C * H * W);
+  std::vector<float> col(C * 3 * 3 * H * W);
+  while (state.KeepRunning()) {
+    math::Im2Col<float, CPUContext, StorageOrder::NCHW>(
+        C,
+        H,
+        W,
+        3,
+        3,
+        1,
+        1,
+        1,
+        1,
+        1,
+        1,
+        1,
+        1,
+        img.data(),
+        col.data(),
+        &context);
+  }
+  state.SetBytesProcessed(state.iterations() * col.size() * sizeof(float));
+}
+
+void BM_Im2ColNHWC(benchmark::State& state) {
+  CPUContext context;
+  SetUpContext(state, &context);
+  const int C = 128, H = 28, W = 28;
+  const auto img = RandomData(C * H * W);
+  std::vector<float> col(C * 3 * 3 * H * W);
+  while (state.KeepRunning()) {
+    math::Im2Col<float, CPUContext, StorageOrder::NHWC>(
+        C,
+        H,
+        W,
+        3,
+        3,
+        1,
+        1,
+        1,
+        1,
+        1,
+        1,
+        1,
+        1,
+        img.data(),
+        col.data(),
+        &context);
+  }
+  state.SetBytesProcessed(state.iterations() * col.size() * sizeof(float));
+}
+
+void BM_TransposeNCHWToNHWC(benchmark::State& state) {
+  CPUContext context;
+  SetUpContext(state, &context);
+  const std::vector<int> dims = {8, 256, 28, 28};
+  const std::vector<int> axes = {0, 2, 3, 1};
+  const auto X = RandomData(8 * 256 * 28 * 28);
+  std::vector<float> Y(X.size());
+  while (state.KeepRunning()) {
+    math::Transpose<float, CPUContext>(
+        dims.size(), dims.data(), axes.data(), X.data(), Y.data(), &context);
+  }
+  state.SetBytesProcessed(state.iterations() * Y.size() * sizeof(float));
+}
+
+void BM_ReduceMax(benchmark::State& state) {
+  CPUContext context;
+  SetUpContext(state, &context);
+  const std::vector<int> dims = {64, 1024, 64};
+  const std::vector<int> axes = {2};
+  const auto X = RandomData(64 * 1024 * 64);
+  std::vector<float> Y(64 * 1024);
+  while (state.KeepRunning()) {
+    math::ReduceMax<float, CPUContext>(
+        dims.size(),
+        dims.data(),
+        axes.size(),
+        axes.data(),
+        X.data(),
+        Y.data(),
+        &context);
+  }
+  state.SetBytesProcessed(state.iterations() * X.size() * sizeof(float));
+}
+
+void BM_BroadcastAdd(benchmark::State& state) {
+  CPUContext context;
+  SetUpContext(state, &context);
+  // Per-channel bias on NCHW activations, which neither broadcasts along rows
+  // nor along columns.
+  const std::vector<int> A_dims = {8, 256, 28, 28};
+  const std::vector<int> B_dims = {256, 1, 1};
+  const auto A = RandomData(8 * 256 * 28 * 28);
+  const auto B = RandomData(256);
+  std::vector<float> C(A.size());
+  while (state.KeepRunning()) {
+    math::Add<float, CPUContext>(
+        A_dims.size(),
+        A_dims.data(),
+        B_dims.size(),
+        B_dims.data(),
+        A.data(),
+        B.data(),
+        C.data(),
+        &context);
+  }
+  state.SetBytesProcessed(state.iterations() * C.size() * sizeof(float));
+}
+
+} // namespace
+
+BENCHMARK(BM_Im2ColNCHW)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_Im2ColNHWC)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_TransposeNCHWToNHWC)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_ReduceMax)->Arg(0)->Arg(1)->UseRealTime();
+BENCHMARK(BM_BroadcastAdd)->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,76 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "ATen/ATen.h"
+
+// Sparse-dense matrix product and coalesce on CPU, on square matrices whose
+// row degrees follow a power law, as in graph adjacency matrices and sparse
+// feature inputs. The matrices average kAverageDegree nonzeros per row.
+//
+// The thread count comes from OMP_NUM_THREADS / MKL_NUM_THREADS.
+
+namespace {
+
+constexpr int64_t kAverageDegree = 16;
+
+// Draws nnz (row, column) pairs; rows are heavily skewed towards 0.
+at::Tensor PowerLawIndices(int64_t n, int64_t nnz) {
+  auto rows = (at::rand({nnz}).pow(4) * n).toType(at::kLong);
+  auto cols = (at::rand({nnz}) * n).toType(at::kLong);
+  return at::stack({rows, cols}, 0);
+}
+
+at::Tensor PowerLawMatrix(int64_t n) {
+  const int64_t nnz = n * kAverageDegree;
+  return at::sparse_coo_tensor(PowerLawIndices(n, nnz), at::randn({nnz}), {n, n});
+}
+
+// range(0): number of rows and columns, range(1): columns of the dense matrix
+void BM_Spmm(benchmark::State& state) {
+  const int64_t n = state.range(0);
+  const int64_t dim_k = state.range(1);
+  auto sparse = PowerLawMatrix(n).coalesce();
+  auto dense = at::randn({n, dim_k});
+  while (state.KeepRunning()) {
+    auto result = at::mm(sparse, dense);
+    benchmark::DoNotOptimize(result.data_ptr());
+  }
+  state.SetItemsProcessed(state.iterations() * sparse._nnz() * dim_k);
+}
+
+// range(0): number of rows and columns, range(1): columns of the values
+void BM_Coalesce(benchmark::State& state) {
+  const int64_t n = state.range(0);
+  const int64_t nnz = n * kAverageDegree;
+  auto values = state.range(1) == 1 ? at::randn({nnz})
+                                    : at::randn({nnz, state.range(1)});
+  std::vector<int64_t> size = {n, n};
+  if (state.range(1) != 1) {
+    size.push_back(state.range(1));
+  }
+  auto sparse = at::sparse_coo_tensor(PowerLawIndices(n, nnz), values, size);
+  while (state.KeepRunning()) {
+    // clone() keeps the coalesced flag unset, so every iteration sorts.
+    auto result = sparse.clone().coalesce();
+    benchmark::DoNotOptimize(result._values().data_ptr());
+  }
+  state.SetItemsProcessed(state.iterations() * nnz);
+}
+
+} // namespace
+
+BENCHMARK(BM_Spmm)
+    ->Args({1 << 14, 64})
+    ->Args({1 << 17, 64})
+    ->Args({1 << 17, 256})
+    ->Args({1 << 20, 16})
+    ->UseRealTime();
+BENCHMARK(BM_Coalesce)
+    ->Args({1 << 14, 1})
+    ->Args({1 << 17, 1})
+    ->Args({1 << 17, 64})
+    ->Args({1 << 20, 1})
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
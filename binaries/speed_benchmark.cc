@@ -15,11 +15,13 @@
  */
 
 #include <string>
+#include <unordered_set>
 
 #include "caffe2/core/init.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
 #ifdef CAFFE2_OPTIMIZER
+#include "caffe2/opt/constant_folding.h"
 #include "caffe2/opt/optimizer.h"
 #endif
 #include "caffe2/proto/caffe2.pb.h"
@@ -86,13 +88,14 @@ int main(int argc, char** argv) {
   unique_ptr<caffe2::Workspace> workspace(new caffe2::Workspace());
 
   // Run initialization network.
-  caffe2::NetDef net_def;
-  CAFFE_ENFORCE(ReadProtoFromFile(caffe2::FLAGS_init_net, &net_def));
-  CAFFE_ENFORCE(workspace->RunNetOnce(net_def));
+  caffe2::NetDef init_net_def;
+  CAFFE_ENFORCE(ReadProtoFromFile(caffe2::FLAGS_init_net, &init_net_def));
+  CAFFE_ENFORCE(workspace->RunNetOnce(init_net_def));
 
   // Load input.
+  vector<string> input_names;
   if (caffe2::FLAGS_input.size()) {
-    vector<string> input_names = caffe2::split(',', caffe2::FLAGS_input);
+    input_names = caffe2::split(',', caffe2::FLAGS_input);
     if (caffe2::FLAGS_input_file.size()) {
       vector<string> input_files = caffe2::split(',', caffe2::FLAGS_input_file);
       CAFFE_ENFORCE_EQ(
@@ -155,6 +158,7 @@ int main(int argc, char** argv) {
   }
 
   // Run main network.
+  caffe2::NetDef net_def;
   CAFFE_ENFORCE(ReadProtoFromFile(caffe2::FLAGS_net, &net_def));
   if (!net_def.has_name()) {
     net_def.set_name("benchmark");
@@ -176,6 +180,11 @@ int main(int argc, char** argv) {
   }
   if (caffe2::FLAGS_opt) {
 #ifdef CAFFE2_OPTIMIZER
+    net_def = caffe2::opt::foldConstants(
+        net_def,
+        &init_net_def,
+        workspace.get(),
+        std::unordered_set<string>(input_names.begin(), input_names.end()));
     net_def = caffe2::opt::optimize(net_def, workspace.get(), caffe2::FLAGS_opt);
 #else
     LOG(WARNING) << "Caffe2 not compiled with optimization passes.";
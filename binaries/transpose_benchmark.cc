@@ -0,0 +1,111 @@
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "caffe2/core/context.h"
+#include "caffe2/utils/math.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+// Memory bandwidth of math::Transpose, which NCHW2NHWC, NHWC2NCHW and the
+// Transpose operator run on, for 2D, 3D and 4D permutations of float tensors.
+// Bytes processed count both the read of X and the write of Y, so the
+// reported rate compares directly to the STREAM copy bandwidth of the
+// machine. Argument 0 runs on one thread, argument 1 on the default pool.
+
+using namespace caffe2;
+
+namespace {
+
+ThreadPool* SharedThreadPool() {
+  static std::unique_ptr<ThreadPool> pool = []() {
+    auto p = ThreadPool::defaultThreadPool();
+    p->setMinWorkSize(1);
+    return p;
+  }();
+  return pool.get();
+}
+
+void BM_Transpose(
+    benchmark::State& state,
+    const std::vector<int>& dims,
+    const std::vector<int>& axes) {
+  CPUContext context;
+  context.set_thread_pool(state.range(0) ? SharedThreadPool() : nullptr);
+  const int size =
+      std::accumulate(dims.begin(), dims.end(), 1, std::multiplies<int>());
+  std::vector<float> X(size);
+  std::iota(X.begin(), X.end(), 0.0f);
+  std::vector<float> Y(size);
+  while (state.KeepRunning()) {
+    math::Transpose<float, CPUContext>(
+        dims.size(), dims.data(), axes.data(), X.data(), Y.data(), &context);
+  }
+  state.SetBytesProcessed(state.iterations() * 2 * size * sizeof(float));
+}
+
+} // namespace
+
+// Square and skinny matrices, and a large one that doesn't fit in L2.
+BENCHMARK_CAPTURE(BM_Transpose, 2D_512x512, {512, 512}, {1, 0})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Transpose, 2D_4096x4096, {4096, 4096}, {1, 0})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Transpose, 2D_65536x3, {65536, 3}, {1, 0})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+// Batched matrix transposes and swapping the outer axes of a sequence batch.
+BENCHMARK_CAPTURE(BM_Transpose, 3D_64x128x128_021, {64, 128, 128}, {0, 2, 1})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Transpose, 3D_128x64x512_102, {128, 64, 512}, {1, 0, 2})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_Transpose, 3D_32x64x256_210, {32, 64, 256}, {2, 1, 0})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+// Storage order switches of ResNet activations and of an RGB image batch.
+BENCHMARK_CAPTURE(
+    BM_Transpose,
+    4D_NCHWToNHWC_8x256x28x28,
+    {8, 256, 28, 28},
+    {0, 2, 3, 1})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(
+    BM_Transpose,
+    4D_NHWCToNCHW_8x28x28x256,
+    {8, 28, 28, 256},
+    {0, 3, 1, 2})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(
+    BM_Transpose,
+    4D_NHWCToNCHW_32x224x224x3,
+    {32, 224, 224, 3},
+    {0, 3, 1, 2})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(
+    BM_Transpose,
+    4D_3201_16x64x56x56,
+    {16, 64, 56, 56},
+    {3, 2, 0, 1})
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
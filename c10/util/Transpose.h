@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define C10_TRANSPOSE_USE_SSE2
+#endif
+
+// Copies of a tensor with its axes permuted, shared by caffe2's
+// math::Transpose and TH's copy (and hence ATen's copy_ and contiguous()).
+//
+// Adjacent axes that stay adjacent are merged first, so e.g. NCHW -> NHWC is
+// a batch of [C, H * W] -> [H * W, C] matrix transposes. Permutations that
+// keep the innermost axis are row copies; all others transpose the 2D slices
+// formed by the innermost axes of the input and of the output, in square
+// tiles that fit in L1 so that both reads and writes use whole cache lines.
+// Tiles of 4 and 8 byte elements are transposed in registers with SSE2
+// shuffles, 4x4 and 2x2 at a time.
+
+namespace c10 {
+
+namespace detail {
+
+// Tile edge in elements: two cache lines per tile row, or 32 elements for
+// types narrower than 4 bytes.
+template <typename T>
+constexpr int64_t TransposeTileSize() {
+  return sizeof(T) >= 4 ? 128 / sizeof(T) : 32;
+}
+
+template <typename T>
+inline void TransposeTileScalar(
+    const int64_t rows,
+    const int64_t cols,
+    const T* src,
+    const int64_t ld_src,
+    T* dst,
+    const int64_t ld_dst) {
+  for (int64_t j = 0; j < cols; ++j) {
+    for (int64_t i = 0; i < rows; ++i) {
+      dst[j * ld_dst + i] = src[i * ld_src + j];
+    }
+  }
+}
+
+#ifdef C10_TRANSPOSE_USE_SSE2
+
+// 4x4 blocks of 32 bit elements, moved as floats since only bits are copied.
+inline void Transpose4x4(
+    const void* src,
+    const int64_t ld_src,
+    void* dst,
+    const int64_t ld_dst) {
+  const float* s = static_cast<const float*>(src);
+  float* d = static_cast<float*>(dst);
+  __m128 r0 = _mm_loadu_ps(s);
+  __m128 r1 = _mm_loadu_ps(s + ld_src);
+  __m128 r2 = _mm_loadu_ps(s + 2 * ld_src);
+  __m128 r3 = _mm_loadu_ps(s + 3 * ld_src);
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  _mm_storeu_ps(d, r0);
+  _mm_storeu_ps(d + ld_dst, r1);
+  _mm_storeu_ps(d + 2 * ld_dst, r2);
+  _mm_storeu_ps(d + 3 * ld_dst, r3);
+}
+
+// 2x2 blocks of 64 bit elements, moved as doubles.
+inline void Transpose2x2(
+    const void* src,
+    const int64_t ld_src,
+    void* dst,
+    const int64_t ld_dst) {
+  const double* s = static_cast<const double*>(src);
+  double* d = static_cast<double*>(dst);
+  const __m128d r0 = _mm_loadu_pd(s);
+  const __m128d r1 = _mm_loadu_pd(s + ld_src);
+  _mm_storeu_pd(d, _mm_unpacklo_pd(r0, r1));
+  _mm_storeu_pd(d + ld_dst, _mm_unpackhi_pd(r0, r1));
+}
+
+// Transposes the leading multiple-of-K rows and columns of a tile with
+// kernel(), and the remaining border elements one at a time.
+template <int K, typename T, class Kernel>
+inline void TransposeTileBlocked(
+    const int64_t rows,
+    const int64_t cols,
+    const T* src,
+    const int64_t ld_src,
+    T* dst,
+    const int64_t ld_dst,
+    const Kernel& kernel) {
+  const int64_t rows_k = rows / K * K;
+  const int64_t cols_k = cols / K * K;
+  for (int64_t i = 0; i < rows_k; i += K) {
+    for (int64_t j = 0; j < cols_k; j += K) {
+      kernel(src + i * ld_src + j, ld_src, dst + j * ld_dst + i, ld_dst);
+    }
+  }
+  TransposeTileScalar(
+      rows_k,
+      cols - cols_k,
+      src + cols_k,
+      ld_src,
+      dst + cols_k * ld_dst,
+      ld_dst);
+  TransposeTileScalar(
+      rows - rows_k,
+      cols,
+      src + rows_k * ld_src,
+      ld_src,
+      dst + rows_k,
+      ld_dst);
+}
+
+#endif // C10_TRANSPOSE_USE_SSE2
+
+template <typename T>
+inline void TransposeTile(
+    const int64_t rows,
+    const int64_t cols,
+    const T* src,
+    const int64_t ld_src,
+    T* dst,
+    const int64_t ld_dst) {
+#ifdef C10_TRANSPOSE_USE_SSE2
+  if (sizeof(T) == 4) {
+    TransposeTileBlocked<4>(rows, cols, src, ld_src, dst, ld_dst, Transpose4x4);
+    return;
+  }
+  if (sizeof(T) == 8) {
+    TransposeTileBlocked<2>(rows, cols, src, ld_src, dst, ld_dst, Transpose2x2);
+    return;
+  }
+#endif
+  TransposeTileScalar(rows, cols, src, ld_src, dst, ld_dst);
+}
+
+} // namespace detail
+
+// dst[j * ld_dst + i] = src[i * ld_src + j] for i < rows and j < cols.
+template <typename T>
+void TransposeMatrix(
+    const int64_t rows,
+    const int64_t cols,
+    const T* src,
+    const int64_t ld_src,
+    T* dst,
+    const int64_t ld_dst) {
+  constexpr int64_t kTile = detail::TransposeTileSize<T>();
+  for (int64_t i = 0; i < rows; i += kTile) {
+    const int64_t tile_rows = std::min(kTile, rows - i);
+    for (int64_t j = 0; j < cols; j += kTile) {
+      detail::TransposeTile(
+          tile_rows,
+          std::min(kTile, cols - j),
+          src + i * ld_src + j,
+          ld_src,
+          dst + j * ld_dst + i,
+          ld_dst);
+    }
+  }
+}
+
+// Y = X with its axes permuted, i.e. Y's axis i is X's axis axes[i], for
+// contiguous X of shape dims and contiguous Y. T must be trivially copyable.
+//
+// parallel_for(n, cost, f) runs f(begin, end) over a partition of [0, n),
+// where every one of the n items copies about cost elements; it lets each
+// caller split the work over its own threads. Work is split into strips of
+// rows of the transposed matrices, so even a single large 2D transpose runs
+// in parallel.
+template <typename T, class ParallelFor>
+void PermuteCopy(
+    const int ndim,
+    const int64_t* dims,
+    const int* axes,
+    const T* X,
+    T* Y,
+    const ParallelFor& parallel_for) {
+  // Drop axes of size 1, and merge X's axes d and d + 1 where d + 1
+  // directly follows d in Y.
+  std::vector<int64_t> index(ndim, -1);
+  std::vector<int64_t> sizes;
+  for (int d = 0; d < ndim; ++d) {
+    if (dims[d] == 0) {
+      return;
+    }
+    if (dims[d] != 1) {
+      index[d] = sizes.size();
+      sizes.push_back(dims[d]);
+    }
+  }
+  std::vector<int64_t> perm;
+  for (int i = 0; i < ndim; ++i) {
+    if (index[axes[i]] >= 0) {
+      perm.push_back(index[axes[i]]);
+    }
+  }
+  std::vector<int64_t> position(perm.size());
+  for (size_t i = 0; i < perm.size(); ++i) {
+    position[perm[i]] = i;
+  }
+  std::vector<int64_t> merged(sizes.size());
+  std::vector<int64_t> x_dims;
+  for (size_t d = 0; d < sizes.size(); ++d) {
+    if (d > 0 && position[d] == position[d - 1] + 1) {
+      x_dims.back() *= sizes[d];
+    } else {
+      x_dims.push_back(sizes[d]);
+    }
+    merged[d] = x_dims.size() - 1;
+  }
+  std::vector<int64_t> y_axes;
+  for (size_t i = 0; i < perm.size(); ++i) {
+    if (i == 0 || perm[i] != perm[i - 1] + 1) {
+      y_axes.push_back(merged[perm[i]]);
+    }
+  }
+
+  const int64_t n = x_dims.size();
+  int64_t size = 1;
+  for (const auto d : x_dims) {
+    size *= d;
+  }
+  if (n <= 1) {
+    constexpr int64_t kChunk = 16384;
+    parallel_for(
+        (size + kChunk - 1) / kChunk, kChunk, [&](int64_t begin, int64_t end) {
+          const int64_t offset = begin * kChunk;
+          std::memcpy(
+              Y + offset,
+              X + offset,
+              (std::min(end * kChunk, size) - offset) * sizeof(T));
+        });
+    return;
+  }
+
+  std::vector<int64_t> x_strides(n);
+  x_strides[n - 1] = 1;
+  for (int64_t d = n - 1; d > 0; --d) {
+    x_strides[d - 1] = x_strides[d] * x_dims[d];
+  }
+  std::vector<int64_t> y_dims(n);
+  std::vector<int64_t> y_strides(n);
+  for (int64_t i = n - 1; i >= 0; --i) {
+    y_dims[i] = x_dims[y_axes[i]];
+    y_strides[i] = i == n - 1 ? 1 : y_strides[i + 1] * y_dims[i + 1];
+  }
+
+  // The slices of Y copied at a time are spanned by Y's axes inner_axes, the
+  // rest index them.
+  std::vector<int64_t> inner_axes;
+  if (y_axes[n - 1] == n - 1) {
+    inner_axes = {n - 1};
+  } else {
+    const int64_t p = std::find(y_axes.begin(), y_axes.end(), n - 1) -
+        y_axes.begin();
+    inner_axes = {p, n - 1};
+  }
+  std::vector<int64_t> outer_dims;
+  std::vector<int64_t> outer_x_strides;
+  std::vector<int64_t> outer_y_strides;
+  for (int64_t i = 0; i < n; ++i) {
+    if (std::find(inner_axes.begin(), inner_axes.end(), i) ==
+        inner_axes.end()) {
+      outer_dims.push_back(y_dims[i]);
+      outer_x_strides.push_back(x_strides[y_axes[i]]);
+      outer_y_strides.push_back(y_strides[i]);
+    }
+  }
+  const auto outer_offsets = [&](int64_t outer, int64_t* x, int64_t* y) {
+    *x = 0;
+    *y = 0;
+    for (int64_t i = outer_dims.size() - 1; i >= 0; --i) {
+      const int64_t k = outer % outer_dims[i];
+      outer /= outer_dims[i];
+      *x += k * outer_x_strides[i];
+      *y += k * outer_y_strides[i];
+    }
+  };
+
+  if (inner_axes.size() == 1) {
+    // The last axis is kept: copy rows of y_dims[n - 1] elements.
+    const int64_t row = y_dims[n - 1];
+    parallel_for(size / row, row, [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; ++r) {
+        int64_t x, y;
+        outer_offsets(r, &x, &y);
+        std::memcpy(Y + y, X + x, row * sizeof(T));
+      }
+    });
+    return;
+  }
+
+  // Transpose [rows, cols] matrices of X, whose columns are X's last axis and
+  // whose rows are the axis that becomes Y's last, in strips of strip_rows.
+  const int64_t rows = y_dims[n - 1];
+  const int64_t cols = x_dims[n - 1];
+  const int64_t ld_src = x_strides[y_axes[n - 1]];
+  const int64_t ld_dst = y_strides[inner_axes[0]];
+  constexpr int64_t kTile = detail::TransposeTileSize<T>();
+  const int64_t strip_rows = std::min(
+      rows,
+      std::max<int64_t>((4096 / cols + kTile - 1) / kTile, 1) * kTile);
+  const int64_t strips = (rows + strip_rows - 1) / strip_rows;
+  const int64_t matrices = size / (rows * cols);
+  parallel_for(
+      matrices * strips, strip_rows * cols, [&](int64_t begin, int64_t end) {
+        for (int64_t u = begin; u < end; ++u) {
+          int64_t x, y;
+          outer_offsets(u / strips, &x, &y);
+          const int64_t i = u % strips * strip_rows;
+          TransposeMatrix(
+              std::min(strip_rows, rows - i),
+              cols,
+              X + x + i * ld_src,
+              ld_src,
+              Y + y + i,
+              ld_dst);
+        }
+      });
+}
+
+} // namespace c10
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <c10/util/Transpose.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Runs f serially, item by item in reverse order.
+struct SerialFor {
+  template <class F>
+  void operator()(int64_t n, int64_t /* cost */, const F& f) const {
+    for (int64_t i = n - 1; i >= 0; --i) {
+      f(i, i + 1);
+    }
+  }
+};
+
+// Runs f on up to four threads.
+struct ThreadedFor {
+  template <class F>
+  void operator()(int64_t n, int64_t /* cost */, const F& f) const {
+    const int64_t chunk = (n + 3) / 4;
+    std::vector<std::thread> threads;
+    for (int64_t begin = 0; begin < n; begin += chunk) {
+      threads.emplace_back(f, begin, std::min(begin + chunk, n));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+template <typename T>
+std::vector<T> ReferencePermute(
+    const std::vector<int64_t>& dims,
+    const std::vector<int>& axes,
+    const std::vector<T>& X) {
+  const int ndim = dims.size();
+  std::vector<int64_t> x_strides(ndim, 1);
+  for (int d = ndim - 2; d >= 0; --d) {
+    x_strides[d] = x_strides[d + 1] * dims[d + 1];
+  }
+  std::vector<T> Y(X.size());
+  std::vector<int64_t> index(ndim, 0);
+  for (size_t y = 0; y < Y.size(); ++y) {
+    int64_t x = 0;
+    for (int i = 0; i < ndim; ++i) {
+      x += index[i] * x_strides[axes[i]];
+    }
+    Y[y] = X[x];
+    for (int i = ndim - 1; i >= 0 && ++index[i] == dims[axes[i]]; --i) {
+      index[i] = 0;
+    }
+  }
+  return Y;
+}
+
+template <typename T, class ParallelFor>
+void ExpectPermuteCopy(
+    const std::vector<int64_t>& dims,
+    const std::vector<int>& axes,
+    const ParallelFor& parallel_for) {
+  const int64_t size = std::accumulate(
+      dims.begin(), dims.end(), int64_t(1), std::multiplies<int64_t>());
+  std::vector<T> X(size);
+  for (int64_t i = 0; i < size; ++i) {
+    X[i] = static_cast<T>(i % 251);
+  }
+  std::vector<T> Y(size);
+  c10::PermuteCopy(
+      dims.size(), dims.data(), axes.data(), X.data(), Y.data(), parallel_for);
+  EXPECT_EQ(ReferencePermute(dims, axes, X), Y);
+}
+
+template <typename T, class ParallelFor>
+void ExpectRandomPermuteCopies(const ParallelFor& parallel_for) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> ndim_dis(1, 5);
+  std::uniform_int_distribution<int64_t> dim_dis(1, 13);
+  for (int trial = 0; trial < 200; ++trial) {
+    const int ndim = ndim_dis(gen);
+    std::vector<int64_t> dims(ndim);
+    for (auto& d : dims) {
+      d = dim_dis(gen);
+    }
+    std::vector<int> axes(ndim);
+    std::iota(axes.begin(), axes.end(), 0);
+    std::shuffle(axes.begin(), axes.end(), gen);
+    ExpectPermuteCopy<T>(dims, axes, parallel_for);
+  }
+}
+
+TEST(TransposeTest, TransposeMatrix) {
+  for (int64_t rows : {1, 3, 4, 33, 70}) {
+    for (int64_t cols : {1, 2, 5, 32, 67}) {
+      std::vector<float> src(rows * (cols + 3));
+      std::iota(src.begin(), src.end(), 0.0f);
+      std::vector<float> dst(cols * (rows + 1), -1.0f);
+      c10::TransposeMatrix(
+          rows, cols, src.data(), cols + 3, dst.data(), rows + 1);
+      for (int64_t i = 0; i < rows; ++i) {
+        for (int64_t j = 0; j < cols; ++j) {
+          EXPECT_EQ(src[i * (cols + 3) + j], dst[j * (rows + 1) + i]);
+        }
+      }
+      for (int64_t j = 0; j < cols; ++j) {
+        EXPECT_EQ(-1.0f, dst[j * (rows + 1) + rows]);
+      }
+    }
+  }
+}
+
+TEST(TransposeTest, PermuteCopyLayouts) {
+  // NCHW <-> NHWC, a large 2D transpose and a 3D permutation
+  ExpectPermuteCopy<float>({2, 37, 9, 11}, {0, 2, 3, 1}, SerialFor());
+  ExpectPermuteCopy<float>({2, 9, 11, 37}, {0, 3, 1, 2}, SerialFor());
+  ExpectPermuteCopy<double>({300, 129}, {1, 0}, ThreadedFor());
+  ExpectPermuteCopy<int32_t>({5, 1, 66, 40}, {3, 1, 0, 2}, ThreadedFor());
+  ExpectPermuteCopy<float>({17, 23, 3}, {2, 1, 0}, ThreadedFor());
+  ExpectPermuteCopy<float>({4, 0, 3}, {2, 1, 0}, SerialFor());
+}
+
+TEST(TransposeTest, PermuteCopyRandom) {
+  ExpectRandomPermuteCopies<uint8_t>(SerialFor());
+  ExpectRandomPermuteCopies<int16_t>(ThreadedFor());
+  ExpectRandomPermuteCopies<float>(SerialFor());
+  ExpectRandomPermuteCopies<float>(ThreadedFor());
+  ExpectRandomPermuteCopies<double>(ThreadedFor());
+  ExpectRandomPermuteCopies<int64_t>(SerialFor());
+}
+
+} // namespace
@@ -16,6 +16,8 @@ CAFFE2_DECLARE_bool(caffe2_report_cpu_memory_usage);
 
 namespace caffe2 {
 
+class ThreadPool;
+
 /**
  * A function to generate a random number seed that is unique in a best-effort
  * basis, using an ever-incrementing seed and the current time.
@@ -92,6 +94,15 @@ class CPUContext final {
 
   inline void FinishDeviceComputation() {}
 
+  // Pool that the CPU math functions split large inputs over, or nullptr
+  // (the default) to run them on the calling thread. Not owned.
+  inline ThreadPool* thread_pool() const {
+    return thread_pool_;
+  }
+  inline void set_thread_pool(ThreadPool* thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+
   inline rand_gen_type& RandGenerator() {
     if (!random_generator_.get()) {
       random_generator_.reset(new rand_gen_type(random_seed_));
@@ -155,6 +166,7 @@ class CPUContext final {
   // TODO(jiayq): instead of hard-coding a generator, make it more flexible.
   int random_seed_{1701};
   std::unique_ptr<rand_gen_type> random_generator_;
+  ThreadPool* thread_pool_{nullptr};
   CAFFE2_API static MemoryAllocationReporter reporter_;
 
  private:
@@ -1,5 +1,6 @@
 #include "caffe2/core/memonger.h"
 
+#include <algorithm>
 #include <set>
 #include <unordered_set>
 
@@ -589,5 +590,221 @@ NetDef compute_blob_recycling_for_dag(
       blob_shapes);
 }
 
+namespace {
+
+// Arena offsets are multiples of this, like the CPU allocator's alignment.
+constexpr size_t kArenaAlignment = 64;
+
+bool IsNetArgument(const Argument& arg) {
+  return arg.has_n() || arg.nets_size() > 0;
+}
+
+} // namespace
+
+ArenaPlan plan_inference_arena(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const CaffeMap<string, TensorShape>& input_shapes) {
+  ArenaPlan plan;
+  // Lifetimes below follow the order of the ops
+  if (net.type() != "" && net.type() != "simple") {
+    LOG(INFO) << "Cannot plan an arena for nets of type: " << net.type();
+    return plan;
+  }
+
+  CaffeMap<string, TensorShape> blob_desc = input_shapes;
+  NetDef shape_net = net;
+  const TensorShapes inferred =
+      InferBlobShapesAndTypes(blob_desc, {&shape_net});
+  CaffeMap<string, TensorShape> shapes;
+  for (const auto& shape : inferred.shapes()) {
+    shapes[shape.name()] = shape;
+  }
+
+  std::set<string> excluded = static_blobs;
+  excluded.insert(net.external_input().begin(), net.external_input().end());
+  excluded.insert(net.external_output().begin(), net.external_output().end());
+
+  // First and last op using every blob written by an op. Alias outputs share
+  // the storage of their input, which then lives as long as both.
+  std::unordered_map<string, std::pair<int, int>> ranges;
+  std::unordered_map<string, string> storage;
+  for (int i = 0; i < net.op_size(); i++) {
+    const auto& op = net.op(i);
+    for (const auto& inp : op.input()) {
+      auto it = storage.find(inp);
+      if (it != storage.end()) {
+        ranges[it->second].second = i;
+      } else {
+        excluded.insert(inp);
+      }
+    }
+    const bool on_cpu = !op.has_device_option()
+        ? net.device_option().device_type() == CPU
+        : op.device_option().device_type() == CPU;
+    const bool holds_nets =
+        std::any_of(op.arg().begin(), op.arg().end(), IsNetArgument);
+    for (const auto& outp : op.output()) {
+      if (op.type() == "Alias") {
+        if (storage.count(op.input(0))) {
+          storage[outp] = storage[op.input(0)];
+        }
+        excluded.insert(outp);
+        continue;
+      }
+      if (!on_cpu || holds_nets) {
+        excluded.insert(outp);
+      }
+      if (!storage.count(outp)) {
+        storage[outp] = outp;
+        ranges[outp] = std::make_pair(i, i);
+      }
+      ranges[storage[outp]].second = i;
+    }
+  }
+
+  struct Interval {
+    string blob;
+    int first;
+    int last;
+    size_t nbytes;
+  };
+  std::vector<Interval> intervals;
+  for (const auto& range : ranges) {
+    const string& blob = range.first;
+    auto shape = shapes.find(blob);
+    if (excluded.count(blob) || shape == shapes.end() ||
+        shape->second.unknown_shape() ||
+        shape->second.data_type() == TensorProto::UNDEFINED ||
+        shape->second.data_type() == TensorProto::BYTE) {
+      continue;
+    }
+    const TypeMeta& meta = DataTypeToTypeMeta(shape->second.data_type());
+    if (meta.ctor()) {
+      continue;
+    }
+    size_t size = 1;
+    for (const auto d : shape->second.dims()) {
+      size *= d;
+    }
+    const size_t nbytes = (size * meta.itemsize() + kArenaAlignment - 1) /
+        kArenaAlignment * kArenaAlignment;
+    if (nbytes > 0) {
+      intervals.push_back(
+          {blob, range.second.first, range.second.second, nbytes});
+    }
+  }
+
+  // Greedy by size: place the largest blobs first, each in the smallest gap
+  // left between the blobs already placed whose lifetimes overlap with its
+  // own, or above all of them.
+  std::sort(
+      intervals.begin(),
+      intervals.end(),
+      [](const Interval& a, const Interval& b) {
+        return a.nbytes != b.nbytes ? a.nbytes > b.nbytes
+                                    : a.first < b.first;
+      });
+  std::vector<std::pair<size_t, size_t>> offsets;
+  for (size_t i = 0; i < intervals.size(); i++) {
+    const auto& interval = intervals[i];
+    std::vector<std::pair<size_t, size_t>> used;
+    for (size_t j = 0; j < i; j++) {
+      if (intervals[j].first <= interval.last &&
+          interval.first <= intervals[j].last) {
+        used.push_back(offsets[j]);
+      }
+    }
+    std::sort(used.begin(), used.end());
+    size_t best = 0;
+    size_t best_gap = 0;
+    bool found = false;
+    size_t top = 0;
+    for (const auto& u : used) {
+      if (u.first > top) {
+        const size_t gap = u.first - top;
+        if (gap >= interval.nbytes && (!found || gap < best_gap)) {
+          best = top;
+          best_gap = gap;
+          found = true;
+        }
+      }
+      top = std::max(top, u.first + u.second);
+    }
+    offsets.emplace_back(found ? best : top, interval.nbytes);
+    plan.placements.push_back(
+        {interval.blob, shapes[interval.blob], offsets.back().first,
+         interval.nbytes});
+    plan.arena_nbytes = std::max(
+        plan.arena_nbytes, offsets.back().first + interval.nbytes);
+    plan.blobs_nbytes += interval.nbytes;
+  }
+
+  LOG(INFO) << "Planned an arena of " << plan.arena_nbytes << " bytes for "
+            << plan.placements.size() << " blobs of " << plan.blobs_nbytes
+            << " bytes";
+  return plan;
+}
+
+namespace {
+
+// Frees the tensors of ws whose data lies in arena, such as the blobs a
+// previous plan placed there.
+void free_arena_placements(Workspace* ws, const string& arena_blob) {
+  const auto* holder = ws->GetBlob(arena_blob);
+  if (!holder || !holder->IsType<TensorCPU>() ||
+      holder->Get<TensorCPU>().capacity_nbytes() == 0) {
+    return;
+  }
+  const auto& arena = holder->Get<TensorCPU>();
+  const auto begin = reinterpret_cast<uintptr_t>(arena.raw_data());
+  const auto end = begin + arena.capacity_nbytes();
+  for (const auto& name : ws->Blobs()) {
+    auto* blob = ws->GetBlob(name);
+    if (name == arena_blob || !blob->IsType<TensorCPU>()) {
+      continue;
+    }
+    auto* tensor = blob->GetMutable<TensorCPU>();
+    if (!tensor->shares_data() || tensor->capacity_nbytes() == 0) {
+      continue;
+    }
+    const auto data = reinterpret_cast<uintptr_t>(tensor->raw_data());
+    if (data >= begin && data < end) {
+      tensor->FreeMemory();
+    }
+  }
+}
+
+} // namespace
+
+void apply_arena_plan(
+    const ArenaPlan& plan,
+    Workspace* ws,
+    const string& arena_blob) {
+  free_arena_placements(ws, arena_blob);
+
+  // The arena tensor and every blob placed in it share ownership of the
+  // buffer, which is freed once none of them uses it any more.
+  auto allocation = GetCPUAllocator()->New(plan.arena_nbytes);
+  std::shared_ptr<void> buffer(allocation.first, allocation.second);
+  auto* base = static_cast<uint8_t*>(buffer.get());
+  const auto keep_buffer = [buffer](void*) {};
+
+  auto* arena = ws->CreateBlob(arena_blob)->GetMutable<TensorCPU>();
+  arena->Resize(plan.arena_nbytes);
+  arena->ShareExternalPointer(
+      base, TypeMeta::Make<uint8_t>(), plan.arena_nbytes, keep_buffer);
+  for (const auto& placement : plan.placements) {
+    auto* tensor = ws->CreateBlob(placement.blob)->GetMutable<TensorCPU>();
+    tensor->Resize(std::vector<TIndex>(
+        placement.shape.dims().begin(), placement.shape.dims().end()));
+    tensor->ShareExternalPointer(
+        base + placement.offset,
+        DataTypeToTypeMeta(placement.shape.data_type()),
+        placement.nbytes,
+        keep_buffer);
+  }
+}
+
 } // memonger
 } // caffe2
@@ -4,6 +4,7 @@
 #include <unordered_set>
 
 #include "caffe2/core/common.h"
+#include "caffe2/core/operator.h"
 #include "caffe2/core/workspace.h"
 #include "caffe2/proto/caffe2.pb.h"
 
@@ -23,6 +24,41 @@ NetDef compute_blob_recycling_for_dag(
     const std::unordered_set<string>& dont_share_blob_names,
     const std::unordered_map<string, vector<int>>& blob_shapes);
 
+// Layout of the intermediate CPU blobs of an inference net in one arena.
+struct ArenaPlan {
+  struct Placement {
+    string blob;
+    // Inferred shape and type the blob is allocated with.
+    TensorShape shape;
+    size_t offset;
+    size_t nbytes;
+  };
+  std::vector<Placement> placements;
+  // Size of the arena, and the total size of the blobs placed in it.
+  size_t arena_nbytes = 0;
+  size_t blobs_nbytes = 0;
+};
+
+// Infers the shapes of the blobs of a simple net from the shapes of its
+// inputs, and assigns every intermediate CPU tensor an offset in a single
+// arena such that tensors that are alive at the same time don't overlap.
+// Blobs in static_blobs, external inputs and outputs and blobs whose shape
+// or type can't be inferred are left out.
+ArenaPlan plan_inference_arena(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const CaffeMap<string, TensorShape>& input_shapes);
+
+// Allocates the arena of plan as a tensor in blob arena_blob of ws, and makes
+// the planned blobs tensors of their inferred shape that alias into it.
+// Running the net with the planned input shapes then doesn't allocate; a
+// tensor that grows beyond its slot reallocates on its own. The blobs keep the
+// arena alive. Tensors placed in the previous arena of arena_blob are freed.
+void apply_arena_plan(
+    const ArenaPlan& plan,
+    Workspace* ws,
+    const string& arena_blob = "__arena__");
+
 } // memonger
 } // caffe2
 
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "caffe2/core/memonger.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Y = X + 1, or the sum of all inputs + 1.
+class ArenaTestOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  using Operator<CPUContext>::Operator;
+
+  bool RunOnDevice() override {
+    auto* Y = Output(0);
+    std::vector<float> sum(Input(0).size(), 1.0f);
+    for (int i = 0; i < InputSize(); i++) {
+      const float* X = Input(i).data<float>();
+      for (size_t j = 0; j < sum.size(); j++) {
+        sum[j] += X[j];
+      }
+    }
+    Y->ResizeLike(Input(0));
+    std::copy(sum.begin(), sum.end(), Y->mutable_data<float>());
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(ArenaTest, ArenaTestOp);
+OPERATOR_SCHEMA(ArenaTest)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .IdenticalTypeAndShapeOfInput(0);
+
+void AddOp(
+    NetDef* net,
+    const string& type,
+    const vector<string>& inputs,
+    const string& output) {
+  auto* op = net->add_op();
+  op->set_type(type);
+  for (const auto& input : inputs) {
+    op->add_input(input);
+  }
+  op->add_output(output);
+}
+
+CaffeMap<string, TensorShape> InputShape(const vector<TIndex>& dims) {
+  TensorShape shape;
+  for (const auto d : dims) {
+    shape.add_dims(d);
+  }
+  return {{"in", shape}};
+}
+
+const memonger::ArenaPlan::Placement& FindPlacement(
+    const memonger::ArenaPlan& plan,
+    const string& blob) {
+  for (const auto& placement : plan.placements) {
+    if (placement.blob == blob) {
+      return placement;
+    }
+  }
+  CAFFE_THROW("Blob not planned: ", blob);
+}
+
+// in -> a -> b -> c -> out, and optionally out = a + c.
+NetDef ChainNet(bool skip) {
+  NetDef net;
+  net.set_name("chain");
+  net.add_external_input("in");
+  net.add_external_output("out");
+  AddOp(&net, "ArenaTest", {"in"}, "a");
+  AddOp(&net, "ArenaTest", {"a"}, "b");
+  AddOp(&net, "ArenaTest", {"b"}, "c");
+  AddOp(
+      &net,
+      "ArenaTest",
+      skip ? vector<string>{"c", "a"} : vector<string>{"c"},
+      "out");
+  return net;
+}
+
+} // namespace
+
+TEST(MemongerTest, ArenaPlanReusesDeadBlobs) {
+  // 4 x 16 floats, one 256 byte slot per blob
+  auto plan = memonger::plan_inference_arena(
+      ChainNet(false), {}, InputShape({4, 16}));
+  ASSERT_EQ(3, plan.placements.size());
+  EXPECT_EQ(3 * 256, plan.blobs_nbytes);
+  EXPECT_EQ(2 * 256, plan.arena_nbytes);
+  EXPECT_EQ(FindPlacement(plan, "a").offset, FindPlacement(plan, "c").offset);
+  EXPECT_NE(FindPlacement(plan, "a").offset, FindPlacement(plan, "b").offset);
+  EXPECT_EQ(2, FindPlacement(plan, "b").shape.dims_size());
+
+  // a is alive until the last op now, and c can't take its place
+  plan =
+      memonger::plan_inference_arena(ChainNet(true), {}, InputShape({4, 16}));
+  EXPECT_EQ(3 * 256, plan.arena_nbytes);
+
+  plan = memonger::plan_inference_arena(
+      ChainNet(true), {"b"}, InputShape({4, 16}));
+  EXPECT_EQ(2, plan.placements.size());
+  EXPECT_EQ(2 * 256, plan.arena_nbytes);
+
+  auto dag = ChainNet(false);
+  dag.set_type("dag");
+  EXPECT_EQ(0, memonger::plan_inference_arena(dag, {}, InputShape({4, 16}))
+                   .placements.size());
+}
+
+TEST(MemongerTest, ArenaPlanBestFit) {
+  // When z is written, a (4 KB) and e (1 KB) are dead and leave gaps between
+  // b, d and f. z (1 KB) takes the one that fits it best.
+  NetDef net;
+  net.add_external_input("big");
+  net.add_external_input("small");
+  net.add_external_output("out");
+  AddOp(&net, "ArenaTest", {"big"}, "a");
+  AddOp(&net, "ArenaTest", {"big"}, "b");
+  AddOp(&net, "ArenaTest", {"small"}, "d");
+  AddOp(&net, "ArenaTest", {"small"}, "e");
+  AddOp(&net, "ArenaTest", {"small"}, "f");
+  AddOp(&net, "ArenaTest", {"big", "a"}, "u");
+  AddOp(&net, "ArenaTest", {"small", "e"}, "v");
+  AddOp(&net, "ArenaTest", {"small"}, "z");
+  AddOp(&net, "ArenaTest", {"big", "b"}, "w");
+  AddOp(&net, "ArenaTest", {"z", "d", "f"}, "out");
+  TensorShape big, small;
+  big.add_dims(1024);
+  small.add_dims(256);
+  const auto plan = memonger::plan_inference_arena(
+      net, {"u", "v", "w"}, {{"big", big}, {"small", small}});
+  EXPECT_EQ(6, plan.placements.size());
+  EXPECT_EQ(FindPlacement(plan, "e").offset, FindPlacement(plan, "z").offset);
+  EXPECT_EQ(2 * 4096 + 3 * 1024, plan.arena_nbytes);
+}
+
+TEST(MemongerTest, ArenaPlanRunsWithoutAllocating) {
+  Workspace ws;
+  auto* in = ws.CreateBlob("in")->GetMutable<TensorCPU>();
+  in->Resize(4, 16);
+  std::fill(in->mutable_data<float>(), in->mutable_data<float>() + 64, 1.0f);
+
+  auto net_def = ChainNet(true);
+  const auto plan =
+      memonger::plan_inference_arena(net_def, {}, InputShape({4, 16}));
+  memonger::apply_arena_plan(plan, &ws);
+  const auto* arena =
+      ws.GetBlob("__arena__")->Get<TensorCPU>().data<uint8_t>();
+  auto* net = ws.CreateNet(net_def);
+  for (int run = 0; run < 2; run++) {
+    ASSERT_TRUE(net->Run());
+    for (const auto& placement : plan.placements) {
+      EXPECT_EQ(
+          arena + placement.offset,
+          ws.GetBlob(placement.blob)->Get<TensorCPU>().raw_data());
+    }
+    // a = 2, b = 3, c = 4, out = 7
+    const auto& out = ws.GetBlob("out")->Get<TensorCPU>();
+    for (int i = 0; i < out.size(); i++) {
+      EXPECT_EQ(7.0f, out.data<float>()[i]);
+    }
+  }
+}
+
+TEST(MemongerTest, ArenaPlanReapplies) {
+  Workspace ws;
+  auto* in = ws.CreateBlob("in")->GetMutable<TensorCPU>();
+  in->Resize(4, 16);
+  std::fill(in->mutable_data<float>(), in->mutable_data<float>() + 64, 1.0f);
+
+  auto net_def = ChainNet(true);
+  const auto plan =
+      memonger::plan_inference_arena(net_def, {}, InputShape({4, 16}));
+  memonger::apply_arena_plan(plan, &ws);
+  // The blobs of the previous plan no longer alias its arena.
+  memonger::apply_arena_plan(memonger::ArenaPlan(), &ws);
+  for (const auto& placement : plan.placements) {
+    EXPECT_EQ(
+        0, ws.GetBlob(placement.blob)->Get<TensorCPU>().capacity_nbytes());
+  }
+
+  memonger::apply_arena_plan(plan, &ws);
+  // The placed blobs keep the arena alive.
+  ws.GetBlob("__arena__")->Reset();
+  auto* net = ws.CreateNet(net_def);
+  ASSERT_TRUE(net->Run());
+  const auto& out = ws.GetBlob("out")->Get<TensorCPU>();
+  for (int i = 0; i < out.size(); i++) {
+    EXPECT_EQ(7.0f, out.data<float>()[i]);
+  }
+}
+
+} // namespace caffe2
@@ -1,6 +1,7 @@
 #include "caffe2/core/operator.h"
 
 #include <algorithm>
+#include <memory>
 
 #include "caffe2/core/init.h"
 #include "caffe2/core/logging.h"
@@ -13,6 +14,7 @@
 #include "caffe2/proto/caffe2.pb.h"
 #include "caffe2/utils/proto_utils.h"
 #include "caffe2/utils/string_utils.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
 
 CAFFE2_DEFINE_int(
     caffe2_operator_max_engine_name_length,
@@ -23,9 +25,32 @@ CAFFE2_DEFINE_bool(
     false,
     "If set, disable implicit engine preferences. This is useful for unit "
     "testing and debugging cases.");
+CAFFE2_DEFINE_bool(
+    caffe2_intra_op_parallelism,
+    false,
+    "If set, CPU operators split large Im2Col, Transpose, reduction, "
+    "broadcast and elementwise math functions over a thread pool shared by "
+    "all of them. Meant for latency bound nets that run one at a time, e.g. "
+    "in a Predictor.");
 
 namespace caffe2 {
 
+ThreadPool* GetIntraOpThreadPool() {
+  static std::unique_ptr<ThreadPool> pool = []() {
+    auto p = ThreadPool::defaultThreadPool();
+    // Users size their shards themselves.
+    p->setMinWorkSize(1);
+    return p;
+  }();
+  return pool.get();
+}
+
+void SetIntraOpThreadPool(CPUContext* context) {
+  if (FLAGS_caffe2_intra_op_parallelism) {
+    context->set_thread_pool(GetIntraOpThreadPool());
+  }
+}
+
 OperatorBase::OperatorBase(const OperatorDef& operator_def, Workspace* ws)
     : operator_ws_(ws),
       operator_def_(std::make_shared<OperatorDef>(operator_def)),
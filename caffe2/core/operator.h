@@ -365,6 +365,18 @@ class OperatorBase : public Observable<OperatorBase> {
 #define OUTPUT_TAGS(first_input, ...)                                          \
   enum _OutputTags { first_input = 0, __VA_ARGS__ }
 
+// The one thread pool that CPU operators split their work over, whether
+// through the math functions of their context or with a num_threads argument.
+// Work run on it must not run more work on it, which would deadlock.
+ThreadPool* GetIntraOpThreadPool();
+
+// Hands CPU operator contexts the thread pool that math functions split
+// their work over if --caffe2_intra_op_parallelism is set. Other contexts
+// have no such pool.
+template <class Context>
+inline void SetIntraOpThreadPool(Context* /* context */) {}
+void SetIntraOpThreadPool(CPUContext* context);
+
 // Operator is the class that you usually want to derive, if your operator will
 // run on different devices. You should then implement the RunOnDevice()
 // function.
@@ -373,6 +385,7 @@ class Operator : public OperatorBase {
  public:
   explicit Operator(const OperatorDef& operator_def, Workspace* ws)
       : OperatorBase(operator_def, ws), context_(operator_def.device_option()) {
+    SetIntraOpThreadPool(&context_);
     // In the constructor, we switch to the device so that the child class
     // constructors will run on that device.
     context_.SwitchToDevice(0);
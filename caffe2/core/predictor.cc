@@ -1,5 +1,6 @@
 #include "caffe2/core/predictor.h"
 #ifdef CAFFE2_OPTIMIZER
+#include "caffe2/opt/constant_folding.h"
 #include "caffe2/opt/optimizer.h"
 #endif
 
@@ -86,7 +87,8 @@ Predictor::Predictor(
     const NetDef& run_net,
     Workspace* parent,
     bool run_init,
-    int optimization)
+    int optimization,
+    const std::unordered_set<std::string>& inputs)
     : run_net_(run_net), ws_(parent) {
 
   if (run_init) {
@@ -99,6 +101,13 @@ Predictor::Predictor(
   if (optimization) {
 #ifdef CAFFE2_OPTIMIZER
     try {
+      // Subgraphs that only depend on parameters are computed here once.
+      // The init_net they are appended to has already run, so it is dropped.
+      if (!inputs.empty()) {
+        NetDef folded_init_net(init_net);
+        run_net_ =
+            opt::foldConstants(run_net_, &folded_init_net, &ws_, inputs);
+      }
       run_net_ = opt::optimize(run_net_, &ws_, optimization);
     } catch (const std::exception& e) {
       LOG(WARNING) << "Optimization pass failed: " << e.what();
@@ -112,14 +121,14 @@ Predictor::Predictor(
   const auto& initialized_vec = ws_.Blobs();
   const std::unordered_set<std::string> initialized{initialized_vec.begin(),
                                                     initialized_vec.end()};
-  for (const auto& name : run_net.external_input()) {
+  for (const auto& name : run_net_.external_input()) {
     if (!initialized.count(name)) {
       auto* blob = ws_.CreateBlob(name);
       blob->template GetMutable<TensorCPU>();
     }
   }
 
-  CAFFE_ENFORCE(ws_.CreateNet(run_net));
+  CAFFE_ENFORCE(ws_.CreateNet(run_net_));
 }
 
 bool Predictor::run(const TensorVector& inputs, TensorVector* outputs) {
@@ -21,13 +21,18 @@ class Predictor {
       bool run_init = true);
 
   // Runs the `init_net` once, then saves the `run_net` to be executed
-  // in `::run`
+  // in `::run`. With a nonzero `optimization` level, the passes of
+  // caffe2/opt/optimizer.h are applied, and if the blobs fed in `::run` are
+  // listed in `inputs`, parts of `run_net` that only depend on `init_net` are
+  // computed once here. Without `inputs` nothing is folded, since `init_net`
+  // usually fills the inputs with placeholders too.
   Predictor(
       const NetDef& init_net,
       const NetDef& run_net,
       Workspace* parent = nullptr,
       bool run_init = true,
-      int optimization = 0);
+      int optimization = 0,
+      const std::unordered_set<std::string>& inputs = {});
 
   ~Predictor() {}
 
@@ -3,6 +3,7 @@
 #include "caffe2/core/predictor.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/utils/math.h"
+#include "caffe2/utils/proto_utils.h"
 
 #include <gtest/gtest.h>
 
@@ -201,6 +202,43 @@ TEST_F(PredictorTest, SimpleBatchSizedMapInput) {
   EXPECT_NEAR(output.front()->data<float>()[4], 0.1209, 1E-4);
 }
 
+// init_net fills the input with a placeholder, as mobile_exporter.py does,
+// which must not be folded into the optimized net.
+TEST_F(PredictorTest, OptimizedWithPlaceholderInput) {
+  auto init = parseNetDef(initSpec);
+  *init.add_op() = CreateOperatorDef(
+      "ConstantFill",
+      "",
+      {},
+      {"data"},
+      {MakeArgument<vector<int>>("shape", {1, 4}),
+       MakeArgument<float>("value", 0.0)});
+  auto run = parseNetDef(predictSpec);
+  run.mutable_op(0)->set_input(1, "W_scaled");
+  *run.add_op() = CreateOperatorDef("Scale", "", {"W"}, {"W_scaled"});
+  std::swap(*run.mutable_op(0), *run.mutable_op(1));
+
+  auto inputData = randomTensor({1, 4}, ctx_.get());
+  Predictor::TensorVector input{inputData->template GetMutable<TensorCPU>()};
+  Predictor::TensorVector expected;
+  ASSERT_TRUE(p_->run(input, &expected));
+  for (const auto& inputs :
+       {std::unordered_set<std::string>{},
+        std::unordered_set<std::string>{"data"}}) {
+    Predictor p(init, run, nullptr, true, 1, inputs);
+    Predictor::TensorVector output;
+    ASSERT_TRUE(p.run(input, &output));
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_EQ(output.front()->dims(), expected.front()->dims());
+    for (int i = 0; i < output.front()->size(); ++i) {
+      EXPECT_NEAR(
+          output.front()->data<float>()[i],
+          expected.front()->data<float>()[i],
+          1E-4);
+    }
+  }
+}
+
 class PredictorMetaNetDefTest : public testing::Test {
  public:
   void SetUp() override {
@@ -0,0 +1,73 @@
+#include "caffe2/observers/calibration_observer.h"
+
+#include <algorithm>
+
+namespace caffe2 {
+
+CalibrationOperatorObserver::CalibrationOperatorObserver(
+    OperatorBase* op,
+    CalibrationNetObserver* netObserver)
+    : ObserverBase<OperatorBase>(op), netObserver_(netObserver) {
+  CAFFE_ENFORCE(netObserver_, "Observers can't operate outside of the net");
+}
+
+void CalibrationOperatorObserver::Start() {}
+
+void CalibrationOperatorObserver::Stop() {
+  if (!subject_->has_debug_def()) {
+    return;
+  }
+  const auto& def = subject_->debug_def();
+  // Inputs are recorded too so that external inputs of the net, which no
+  // operator produces, get a range.
+  for (int i = 0; i < subject_->InputSize(); ++i) {
+    netObserver_->update(def.input(i), subject_->Inputs()[i]);
+  }
+  for (int i = 0; i < subject_->OutputSize(); ++i) {
+    netObserver_->update(def.output(i), subject_->Outputs()[i]);
+  }
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>>
+CalibrationOperatorObserver::rnnCopy(OperatorBase* subject, int rnn_order)
+    const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new CalibrationOperatorObserver(subject, netObserver_));
+}
+
+void CalibrationNetObserver::Start() {}
+
+void CalibrationNetObserver::Stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++runs_;
+}
+
+void CalibrationNetObserver::update(const std::string& name, const Blob* blob) {
+  if (!blob->IsType<TensorCPU>()) {
+    return;
+  }
+  const auto& tensor = blob->Get<TensorCPU>();
+  if (!tensor.IsType<float>() || tensor.size() == 0) {
+    return;
+  }
+  const float* data = tensor.data<float>();
+  const auto minmax = std::minmax_element(data, data + tensor.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& range = ranges_[name];
+  range.min = std::min(range.min, *minmax.first);
+  range.max = std::max(range.max, *minmax.second);
+}
+
+std::unordered_map<std::string, TensorRange>
+CalibrationNetObserver::tensorRanges() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ranges_;
+}
+
+std::string CalibrationNetObserver::debugInfo() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return "Recorded ranges of " + caffe2::to_string(ranges_.size()) +
+      " tensors over " + caffe2::to_string(runs_) + " runs.";
+}
+
+} // namespace caffe2
@@ -0,0 +1,73 @@
+#ifndef CAFFE2_OBSERVERS_CALIBRATION_OBSERVER_H_
+#define CAFFE2_OBSERVERS_CALIBRATION_OBSERVER_H_
+
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+namespace caffe2 {
+
+// Running range of the values a blob took over all observed runs.
+struct TensorRange {
+  float min = std::numeric_limits<float>::max();
+  float max = std::numeric_limits<float>::lowest();
+};
+
+class CalibrationNetObserver;
+class CalibrationOperatorObserver final : public ObserverBase<OperatorBase> {
+ public:
+  explicit CalibrationOperatorObserver(OperatorBase* op) = delete;
+  CalibrationOperatorObserver(
+      OperatorBase* op,
+      CalibrationNetObserver* netObserver);
+  ~CalibrationOperatorObserver() {}
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+ private:
+  CalibrationNetObserver* netObserver_;
+};
+
+// Records the min/max of every float CPU tensor read or written by the
+// operators of a net, across all runs. Run the net over a representative
+// sample of inputs and hand tensorRanges() to opt::quantizeInt8 to pick
+// per-tensor scales and zero points.
+class CalibrationNetObserver final : public OperatorAttachingNetObserver<
+                                         CalibrationOperatorObserver,
+                                         CalibrationNetObserver> {
+ public:
+  explicit CalibrationNetObserver(NetBase* subject_)
+      : OperatorAttachingNetObserver<
+            CalibrationOperatorObserver,
+            CalibrationNetObserver>(subject_, this) {}
+  ~CalibrationNetObserver() {}
+
+  std::unordered_map<std::string, TensorRange> tensorRanges() const;
+  std::string debugInfo() override;
+
+  friend class CalibrationOperatorObserver;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  void update(const std::string& name, const Blob* blob);
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, TensorRange> ranges_;
+  int runs_ = 0;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OBSERVERS_CALIBRATION_OBSERVER_H_
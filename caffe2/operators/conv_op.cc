@@ -173,6 +173,9 @@ OPERATOR_SCHEMA(Conv)
     .CostInferenceFunction(OpSchema::CostInferenceFunctionType(
         ConvPoolOpBase<CPUContext>::CostInferenceForConv))
     .FillUsing(ConvDocGenerator(""))
+    .Arg(
+        "activation",
+        "*(type: string; default: \"\")* \"Relu\", \"Sigmoid\" or \"Tanh\" to apply that activation to $Y$ together with the bias. CPU only.")
     .InheritOnnxSchema("Conv");
 
 REGISTER_CPU_OPERATOR(Conv1D, ConvOp<float, CPUContext>);
@@ -1,12 +1,16 @@
 #ifndef CAFFE2_OPERATORS_CONV_OP_H_
 #define CAFFE2_OPERATORS_CONV_OP_H_
 
+#include <type_traits>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/operators/conv_op_shared.h"
 #include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/fused_activation.h"
 
 CAFFE2_DECLARE_bool(caffe2_force_shared_col_buffer);
+CAFFE2_DECLARE_int(caffe2_conv_col_buffer_band_size);
 
 namespace caffe2 {
 
@@ -15,12 +19,18 @@ class ConvOp final : public ConvPoolOpBase<Context> {
  public:
   USE_CONV_POOL_BASE_FUNCTIONS(Context);
   ConvOp(const OperatorDef& operator_def, Workspace* ws)
-      : ConvPoolOpBase<Context>(operator_def, ws) {
+      : ConvPoolOpBase<Context>(operator_def, ws),
+        activation_(StringToFusedActivation(
+            OperatorBase::GetSingleArgument<string>("activation", ""))) {
     // Since this is the default convolution implementation, we will
     // use CAFFE_ENFORCE instead of OPERATOR_NEEDS_FEATURE.
     CAFFE_ENFORCE(
         group_ == 1 || order_ == StorageOrder::NCHW,
         "Group convolution only supports NCHW order right now.");
+    CAFFE_ENFORCE(
+        activation_ == FusedActivation::NONE ||
+            (std::is_same<Context, CPUContext>::value),
+        "Fused activations are only supported on CPU.");
 
     // Create shared buffer mutex in the constructor
     // to avoid race-condition in DAGNet.
@@ -34,6 +44,36 @@ class ConvOp final : public ConvPoolOpBase<Context> {
   bool RunOnDeviceWithOrderNHWC() override;
 
  private:
+  // Number of output rows per im2col band of a 2d convolution, see
+  // caffe2_conv_col_buffer_band_size
+  int ColBufferBandRows(int kernel_dim, int output_h, int output_w) const;
+
+  // Im2Col of output rows [row_begin, row_begin + rows) of one image
+  void Im2ColBandNCHW(
+      int channels,
+      int height,
+      int width,
+      int row_begin,
+      int rows,
+      const T* img_data,
+      T* col_data);
+  void Im2ColBandNHWC(
+      int channels,
+      int height,
+      int width,
+      int row_begin,
+      int rows,
+      const T* img_data,
+      T* col_data);
+
+  // Adds the bias, if there is one, to the M x image_size output of one
+  // image and applies the fused activation to it.
+  void AddBiasAndActivationNCHW(int M, int image_size, T* Y);
+  // The same for a rows x M output. bias_multiplier_ must hold at least
+  // `rows` ones when there is a bias.
+  void AddBiasAndActivationNHWC(int rows, int M, T* Y);
+
+  const FusedActivation activation_;
   Tensor<Context> col_buffer_;
   Tensor<Context> bias_multiplier_;
   Tensor<Context> img_shape_device_;
@@ -2,6 +2,9 @@
 #ifndef CAFFE2_OPERATORS_CONV_OP_IMPL_H_
 #define CAFFE2_OPERATORS_CONV_OP_IMPL_H_
 
+#include <algorithm>
+#include <type_traits>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/flags.h"
 #include "caffe2/core/logging.h"
@@ -81,12 +84,87 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   }
   T* Ydata = Y->template mutable_data<T>();
 
+  // 1x1 convolutions without padding or stride read every input pixel once,
+  // in the layout Gemm expects, so the input is the Gemm operand itself.
+  if (Is1x1Kernel() && !HasPad() && !HasStride()) {
+    const T* filter_data = filter.template data<T>();
+    for (int image_id = 0; image_id < N; ++image_id) {
+      for (int group_id = 0; group_id < group_; ++group_id) {
+        math::Gemm<T, Context>(
+            CblasNoTrans,
+            CblasNoTrans,
+            M / group_,
+            output_image_size,
+            kernel_dim,
+            1,
+            filter_data + group_id * filter_offset,
+            Xdata + group_id * input_offset,
+            0,
+            Ydata + group_id * output_offset,
+            &context_);
+      }
+      AddBiasAndActivationNCHW(M, output_image_size, Ydata);
+      Xdata += input_offset * group_;
+      Ydata += output_offset * group_;
+    }
+    return true;
+  }
+
+  const int band_rows = kernel_.size() == 2
+      ? ColBufferBandRows(kernel_dim, output_dims[0], output_dims[1])
+      : 0;
+  if (band_rows > 0 && band_rows < output_dims[0]) {
+    buffer_shape = {kernel_dim, band_rows, output_dims[1]};
+  }
+
   auto f = [&](Tensor<Context>* col_buffer) {
     col_buffer->Resize(buffer_shape);
     T* col_buffer_data = col_buffer->template mutable_data<T>();
     // Im2Col, followed by gemm.
     for (int image_id = 0; image_id < N; ++image_id) {
       for (int group_id = 0; group_id < group_; ++group_id) {
+        if (band_rows > 0 && band_rows < output_dims[0]) {
+          for (int row = 0; row < output_dims[0]; row += band_rows) {
+            const int rows = std::min(band_rows, output_dims[0] - row);
+            Im2ColBandNCHW(
+                C / group_,
+                input_dims[0],
+                input_dims[1],
+                row,
+                rows,
+                Xdata + group_id * input_offset,
+                col_buffer_data);
+            math::GemmEx<T, Context>(
+                CblasNoTrans,
+                CblasNoTrans,
+                M / group_,
+                rows * output_dims[1],
+                kernel_dim,
+                1,
+                filter.template data<T>() + group_id * filter_offset,
+                kernel_dim,
+                col_buffer_data,
+                rows * output_dims[1],
+                0,
+                Ydata + group_id * output_offset + row * output_dims[1],
+                output_image_size,
+                &context_);
+            if (activation_ != FusedActivation::NONE) {
+              // Finish the band while it is still in cache.
+              const T* bias_data = InputSize() == 3
+                  ? Input(BIAS).template data<T>() + group_id * (M / group_)
+                  : nullptr;
+              BiasActivationNCHW<T>(
+                  M / group_,
+                  rows * output_dims[1],
+                  output_image_size,
+                  bias_data,
+                  activation_,
+                  Ydata + group_id * output_offset + row * output_dims[1]);
+            }
+          }
+          continue;
+        }
         if (kernel_.size() == 2) {
           math::Im2Col<T, Context, StorageOrder::NCHW>(
               C / group_,
@@ -134,22 +212,12 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
             Ydata + group_id * output_offset,
             &context_);
       }
-      if (InputSize() == 3) {
-        // Bias term can be carried out outside the group definition
-        // to be efficient.
-        auto* bias_data = Input(BIAS).template data<T>();
-        math::Gemm<T, Context>(
-            CblasNoTrans,
-            CblasNoTrans,
-            M,
-            output_image_size,
-            1,
-            1,
-            bias_data,
-            bias_multiplier_.template data<T>(),
-            1,
-            Ydata,
-            &context_);
+      // Bias term can be carried out outside the group definition
+      // to be efficient. Banded outputs have had their epilogue already
+      // when there is an activation.
+      if (band_rows <= 0 || band_rows >= output_dims[0] ||
+          activation_ == FusedActivation::NONE) {
+        AddBiasAndActivationNCHW(M, output_image_size, Ydata);
       }
       Xdata += input_offset * group_;
       Ydata += output_offset * group_;
@@ -226,18 +294,42 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
             bias_multiplier_.template mutable_data<T>(),
             &context_);
       }
-      math::Gemm<T, Context>(
-          CblasNoTrans,
-          CblasNoTrans,
-          N * H * W,
-          M,
-          1,
-          1,
-          bias_multiplier_.template data<T>(),
-          bias.template data<T>(),
-          1,
-          Ydata,
-          &context_);
+    }
+    AddBiasAndActivationNHWC(N * H * W, M, Ydata);
+  } else if (kernel_dim == C && !HasPad()) {
+    // Strided 1x1 convolution: every output row reads every stride_w-th
+    // pixel of an input row, which Gemm can read in place with a leading
+    // dimension of stride_w * C.
+    if (InputSize() == 3) {
+      const auto& bias = Input(BIAS);
+      CAFFE_ENFORCE(1 == bias.ndim());
+      CAFFE_ENFORCE(bias.dim32(0) == M);
+      ConvPoolOpBase<Context>::template SetBiasMultiplier<T>(
+          output_image_size, &bias_multiplier_);
+    }
+    const int output_h = Y->dim32(1);
+    const int output_w = Y->dim32(2);
+    for (int image_id = 0; image_id < N; ++image_id) {
+      for (int row = 0; row < output_h; ++row) {
+        math::GemmEx<T, Context>(
+            CblasNoTrans,
+            CblasTrans,
+            output_w,
+            M,
+            C,
+            1,
+            Xdata + row * stride_h() * W * C,
+            stride_w() * C,
+            filter.template data<T>(),
+            C,
+            0,
+            Ydata + row * output_w * M,
+            M,
+            &context_);
+      }
+      AddBiasAndActivationNHWC(output_image_size, M, Ydata);
+      Xdata += input_offset;
+      Ydata += output_offset;
     }
   } else {
     if (InputSize() == 3) {
@@ -247,7 +339,46 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
       ConvPoolOpBase<Context>::template SetBiasMultiplier<T>(
           output_image_size, &bias_multiplier_);
     }
+    const int output_h = Y->dim32(1);
+    const int output_w = Y->dim32(2);
+    const int band_rows = ColBufferBandRows(kernel_dim, output_h, output_w);
     auto f = [&](Tensor<Context>* col_buffer) {
+      if (band_rows > 0 && band_rows < output_h) {
+        col_buffer->Resize(
+            vector<TIndex>{band_rows, output_w, kernel_h(), kernel_w(), C});
+        T* col_buffer_data = col_buffer->template mutable_data<T>();
+        // Im2Col and gemm for one band of output rows at a time. The rows of
+        // the output that a band produces are contiguous in NHWC.
+        for (int image_id = 0; image_id < N; ++image_id) {
+          for (int row = 0; row < output_h; row += band_rows) {
+            const int rows = std::min(band_rows, output_h - row);
+            Im2ColBandNHWC(C, H, W, row, rows, Xdata, col_buffer_data);
+            math::Gemm<T, Context>(
+                CblasNoTrans,
+                CblasTrans,
+                rows * output_w,
+                M,
+                kernel_dim,
+                1,
+                col_buffer_data,
+                filter.template data<T>(),
+                0,
+                Ydata + row * output_w * M,
+                &context_);
+            if (activation_ != FusedActivation::NONE) {
+              // Finish the band while it is still in cache.
+              AddBiasAndActivationNHWC(
+                  rows * output_w, M, Ydata + row * output_w * M);
+            }
+          }
+          if (activation_ == FusedActivation::NONE) {
+            AddBiasAndActivationNHWC(output_image_size, M, Ydata);
+          }
+          Xdata += input_offset;
+          Ydata += output_offset;
+        }
+        return;
+      }
       col_buffer->Resize(
           vector<TIndex>{Y->dim32(1), Y->dim32(2), kernel_h(), kernel_w(), C});
       T* col_buffer_data = col_buffer->template mutable_data<T>();
@@ -283,21 +414,7 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
             0,
             Ydata,
             &context_);
-        if (InputSize() == 3) {
-          // Bias term
-          math::Gemm<T, Context>(
-              CblasNoTrans,
-              CblasNoTrans,
-              output_image_size,
-              M,
-              1,
-              1,
-              bias_multiplier_.template data<T>(),
-              Input(BIAS).template data<T>(),
-              1,
-              Ydata,
-              &context_);
-        }
+        AddBiasAndActivationNHWC(output_image_size, M, Ydata);
         Xdata += input_offset;
         Ydata += output_offset;
       }
@@ -311,6 +428,153 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
   return true;
 }
 
+template <typename T, class Context>
+int ConvOp<T, Context>::ColBufferBandRows(
+    int kernel_dim,
+    int output_h,
+    int output_w) const {
+  // Banding only pays off when the whole col buffer would not stay in cache,
+  // and costs a kernel launch per band on GPUs. Bands are padded like the
+  // image, which needs the padding to be smaller than the kernel.
+  const int dkernel_h = dilation_h() * (kernel_h() - 1) + 1;
+  if (!std::is_same<Context, CPUContext>::value ||
+      FLAGS_caffe2_conv_col_buffer_band_size <= 0 || pad_t() >= dkernel_h ||
+      pad_b() >= dkernel_h) {
+    return output_h;
+  }
+  return std::max(
+      1,
+      std::min(
+          output_h,
+          FLAGS_caffe2_conv_col_buffer_band_size / (kernel_dim * output_w)));
+}
+
+template <typename T, class Context>
+void ConvOp<T, Context>::AddBiasAndActivationNCHW(
+    const int M,
+    const int image_size,
+    T* Y) {
+  const T* bias = InputSize() == 3 ? Input(BIAS).template data<T>() : nullptr;
+  if (activation_ != FusedActivation::NONE) {
+    BiasActivationNCHW<T>(M, image_size, image_size, bias, activation_, Y);
+  } else if (bias != nullptr) {
+    math::Gemm<T, Context>(
+        CblasNoTrans,
+        CblasNoTrans,
+        M,
+        image_size,
+        1,
+        1,
+        bias,
+        bias_multiplier_.template data<T>(),
+        1,
+        Y,
+        &context_);
+  }
+}
+
+template <typename T, class Context>
+void ConvOp<T, Context>::AddBiasAndActivationNHWC(
+    const int rows,
+    const int M,
+    T* Y) {
+  const T* bias = InputSize() == 3 ? Input(BIAS).template data<T>() : nullptr;
+  if (activation_ != FusedActivation::NONE) {
+    BiasActivationNHWC<T>(rows, M, bias, activation_, Y);
+  } else if (bias != nullptr) {
+    math::Gemm<T, Context>(
+        CblasNoTrans,
+        CblasNoTrans,
+        rows,
+        M,
+        1,
+        1,
+        bias_multiplier_.template data<T>(),
+        bias,
+        1,
+        Y,
+        &context_);
+  }
+}
+
+// The band of output rows [row_begin, row_begin + rows) reads the input rows
+// starting at row_begin * stride_h - pad_t. It is the Im2Col of those input
+// rows, with top and bottom padding for the rows that are outside the image.
+template <typename T, class Context>
+void ConvOp<T, Context>::Im2ColBandNCHW(
+    int channels,
+    int height,
+    int width,
+    int row_begin,
+    int rows,
+    const T* img_data,
+    T* col_data) {
+  const int dkernel_h = dilation_h() * (kernel_h() - 1) + 1;
+  const int first = row_begin * stride_h() - pad_t();
+  const int last = (row_begin + rows - 1) * stride_h() - pad_t() + dkernel_h;
+  const int begin = std::max(first, 0);
+  const int end = std::min(last, height);
+  const int output_w =
+      (width + pad_l() + pad_r() - (dilation_w() * (kernel_w() - 1) + 1)) /
+          stride_w() +
+      1;
+  const int band_size = kernel_h() * kernel_w() * rows * output_w;
+  // Im2Col assumes that channels are height * width apart, so every channel
+  // is a separate call.
+  for (int c = 0; c < channels; ++c) {
+    math::Im2Col<T, Context, StorageOrder::NCHW>(
+        1,
+        end - begin,
+        width,
+        kernel_h(),
+        kernel_w(),
+        dilation_h(),
+        dilation_w(),
+        begin - first,
+        pad_l(),
+        last - end,
+        pad_r(),
+        stride_h(),
+        stride_w(),
+        img_data + (c * height + begin) * width,
+        col_data + c * band_size,
+        &context_);
+  }
+}
+
+template <typename T, class Context>
+void ConvOp<T, Context>::Im2ColBandNHWC(
+    int channels,
+    int height,
+    int width,
+    int row_begin,
+    int rows,
+    const T* img_data,
+    T* col_data) {
+  const int dkernel_h = dilation_h() * (kernel_h() - 1) + 1;
+  const int first = row_begin * stride_h() - pad_t();
+  const int last = (row_begin + rows - 1) * stride_h() - pad_t() + dkernel_h;
+  const int begin = std::max(first, 0);
+  const int end = std::min(last, height);
+  math::Im2Col<T, Context, StorageOrder::NHWC>(
+      channels,
+      end - begin,
+      width,
+      kernel_h(),
+      kernel_w(),
+      dilation_h(),
+      dilation_w(),
+      begin - first,
+      pad_l(),
+      last - end,
+      pad_r(),
+      stride_h(),
+      stride_w(),
+      img_data + begin * width * channels,
+      col_data,
+      &context_);
+}
+
 template <typename T, class Context>
 bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   auto& X = Input(INPUT);
@@ -355,7 +619,11 @@ bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   col_buffer_shape.push_back(C / group_ * kernel_dims_size);
   col_buffer_shape.insert(
       col_buffer_shape.end(), output_dims.begin(), output_dims.end());
-  col_buffer_.Resize(col_buffer_shape);
+  // See ConvOp: 1x1 convolutions without padding or stride need no im2col
+  const bool skip_im2col = Is1x1Kernel() && !HasPad() && !HasStride();
+  if (!skip_im2col) {
+    col_buffer_.Resize(col_buffer_shape);
+  }
 
   if (kernel_.size() != 2) {
     SetDeviceTensor(img_shape, &img_shape_device_);
@@ -367,7 +635,8 @@ bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   const T* Xdata = X.template data<T>();
   const T* filter_data = filter.template data<T>();
   const T* dYdata = dY.template data<T>();
-  T* col_buffer_data = col_buffer_.template mutable_data<T>();
+  T* col_buffer_data =
+      skip_im2col ? nullptr : col_buffer_.template mutable_data<T>();
   T* dfilter_data = dfilter->template mutable_data<T>();
 
   // Pre-setting the gradients to zero.
@@ -394,7 +663,10 @@ bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
     for (int group_id = 0; group_id < group_; ++group_id) {
       // When we compute the gradient with respect to the filters, we need to do
       // im2col to allow gemm-type computation.
-      if (kernel_.size() == 2) {
+      const T* col_data = col_buffer_data;
+      if (skip_im2col) {
+        col_data = Xdata + group_id * input_offset;
+      } else if (kernel_.size() == 2) {
         math::Im2Col<T, Context, StorageOrder::NCHW>(
             C / group_,
             input_dims[0],
@@ -436,7 +708,7 @@ bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
           output_image_size,
           1,
           dYdata + group_id * output_offset,
-          col_buffer_data,
+          col_data,
           1,
           dfilter_data + group_id * filter_offset,
           &context_);
@@ -465,7 +737,8 @@ bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
     dYdata = dY.template data<T>();
     for (int image_id = 0; image_id < N; ++image_id) {
       for (int group_id = 0; group_id < group_; ++group_id) {
-        // Compute gradient into col_buffer.
+        // Compute gradient into col_buffer, or directly into dX if there is
+        // no im2col.
         math::Gemm<T, Context>(
             CblasTrans,
             CblasNoTrans,
@@ -476,9 +749,11 @@ bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
             filter_data + group_id * filter_offset,
             dYdata,
             0,
-            col_buffer_data,
+            skip_im2col ? dXdata : col_buffer_data,
             &context_);
-        if (kernel_.size() == 2) {
+        if (skip_im2col) {
+          // Already in dX
+        } else if (kernel_.size() == 2) {
           math::Col2Im<T, Context, StorageOrder::NCHW>(
               C / group_,
               input_dims[0],
@@ -7,6 +7,12 @@ CAFFE2_DEFINE_bool(
     caffe2_force_shared_col_buffer,
     false,
     "Always use the shared col buffer");
+CAFFE2_DEFINE_int(
+    caffe2_conv_col_buffer_band_size,
+    1 << 16,
+    "On CPU, Conv does im2col for bands of output rows whose col buffer has "
+    "at most this many elements, so that it stays in cache for the Gemm. "
+    "0 disables banding");
 
 namespace caffe2 {
 
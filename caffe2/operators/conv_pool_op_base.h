@@ -1,6 +1,7 @@
 #ifndef CAFFE2_OPERATORS_CONV_POOL_OP_BASE_H_
 #define CAFFE2_OPERATORS_CONV_POOL_OP_BASE_H_
 
+#include <algorithm>
 #include <vector>
 
 #include "caffe2/core/context.h"
@@ -718,6 +719,21 @@ class ConvPoolOpBase : public Operator<Context> {
     return dilation_[1];
   }
 
+  bool HasPad() const {
+    return std::any_of(
+        pads_.begin(), pads_.end(), [](int pad) { return pad != 0; });
+  }
+
+  bool HasStride() const {
+    return std::any_of(
+        stride_.begin(), stride_.end(), [](int stride) { return stride != 1; });
+  }
+
+  bool Is1x1Kernel() const {
+    return std::all_of(
+        kernel_.begin(), kernel_.end(), [](int kernel) { return kernel == 1; });
+  }
+
  private:
  inline void AllocateAndCopy(const vector<int>& vec, Tensor<Context>& tensor) {
       tensor.Resize(vec.size());
@@ -740,6 +756,9 @@ class ConvPoolOpBase : public Operator<Context> {
   using ConvPoolOpBase<Context>::dilation_;        \
   using ConvPoolOpBase<Context>::dilation_h;       \
   using ConvPoolOpBase<Context>::dilation_w;       \
+  using ConvPoolOpBase<Context>::HasPad;           \
+  using ConvPoolOpBase<Context>::HasStride;        \
+  using ConvPoolOpBase<Context>::Is1x1Kernel;      \
   using ConvPoolOpBase<Context>::stride_;          \
   using ConvPoolOpBase<Context>::stride_h;         \
   using ConvPoolOpBase<Context>::stride_w;         \
@@ -43,7 +43,8 @@ class ExpandOp final : public Operator<Context> {
       CAFFE_ENFORCE(
           shape_x == 1 || shape_y == 1 || shape_x == shape_y,
           "Dimensions format invalid.");
-      Y_dims.push_back(std::max(shape_x, shape_y));
+      // A dim of 1 takes the size of the other one, which may be 0.
+      Y_dims.push_back(shape_x == 1 ? shape_y : shape_x);
     }
     std::reverse(Y_dims.begin(), Y_dims.end());
     Y->Resize(Y_dims);
@@ -236,6 +236,9 @@ Y:
     .Arg(
         "float16_compute",
         "*(type: bool; default: False)* Whether to use float-16 compute kernel.")
+    .Arg(
+        "activation",
+        "*(type: string; default: \"\")* \"Relu\", \"Sigmoid\" or \"Tanh\" to apply that activation to $Y$ together with the bias. CPU only.")
     .Input(
         0,
         "X",
@@ -1,8 +1,11 @@
 #ifndef CAFFE2_OPERATORS_FULLY_CONNECTED_OP_H_
 #define CAFFE2_OPERATORS_FULLY_CONNECTED_OP_H_
 
+#include <type_traits>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/operators/fused_activation.h"
 #include "caffe2/utils/conversions.h"
 #include "caffe2/utils/math.h"
 
@@ -21,7 +24,14 @@ class FullyConnectedOp final : public Operator<Context> {
         axis_(OperatorBase::GetSingleArgument<int32_t>("axis", 1)),
         axis_w_(OperatorBase::GetSingleArgument<int32_t>("axis_w", 1)),
         float16_compute_(
-            OperatorBase::GetSingleArgument<bool>("float16_compute", false)) {}
+            OperatorBase::GetSingleArgument<bool>("float16_compute", false)),
+        activation_(StringToFusedActivation(
+            OperatorBase::GetSingleArgument<string>("activation", ""))) {
+    CAFFE_ENFORCE(
+        activation_ == FusedActivation::NONE ||
+            (std::is_same<Context, CPUContext>::value),
+        "Fused activations are only supported on CPU.");
+  }
   ~FullyConnectedOp() {}
 
   template <
@@ -103,6 +113,12 @@ class FullyConnectedOp final : public Operator<Context> {
         Y->template mutable_data<T_Y>(),
         &context_,
         math_type);
+    if (activation_ != FusedActivation::NONE) {
+      // Bias and activation in one pass over Y
+      AddBiasAndActivation(
+          M, N, b.template data<T_B>(), Y->template mutable_data<T_Y>());
+      return true;
+    }
     // Add bias term
     if (bias_multiplier_.size() != M) {
       // If the helper bias multiplier is not M, reshape and fill it with one.
@@ -147,6 +163,17 @@ class FullyConnectedOp final : public Operator<Context> {
   Tensor<Context> bias_multiplier_;
 
   bool float16_compute_;
+  const FusedActivation activation_;
+
+ private:
+  // Fused activations only exist for float, see the constructor.
+  void AddBiasAndActivation(int M, int N, const float* b, float* Y) {
+    BiasActivationNHWC<float>(M, N, b, activation_, Y);
+  }
+  template <typename T_B, typename T_Y>
+  void AddBiasAndActivation(int, int, const T_B*, T_Y*) {
+    CAFFE_THROW("Fused activations are only supported for float.");
+  }
 };
 
 template <
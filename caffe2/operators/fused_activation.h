@@ -0,0 +1,96 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ACTIVATION_H_
+#define CAFFE2_OPERATORS_FUSED_ACTIVATION_H_
+
+#include <string>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+// Activation applied by Conv and FC to their output together with the bias,
+// set by the "activation" argument (see caffe2/opt/fusion.h). Only the CPU
+// implementations support it.
+enum class FusedActivation { NONE, RELU, SIGMOID, TANH };
+
+inline FusedActivation StringToFusedActivation(const std::string& str) {
+  if (str == "") {
+    return FusedActivation::NONE;
+  } else if (str == "Relu") {
+    return FusedActivation::RELU;
+  } else if (str == "Sigmoid") {
+    return FusedActivation::SIGMOID;
+  } else if (str == "Tanh") {
+    return FusedActivation::TANH;
+  }
+  CAFFE_THROW("Unknown fused activation: ", str);
+}
+
+// y = activation(x) for an Eigen array expression x. Every coefficient of y
+// only depends on the same coefficient of x, so x may read y.
+template <typename Expr, typename Dst>
+void AssignFusedActivation(
+    const FusedActivation activation,
+    const Expr& x,
+    Dst y) {
+  using T = typename Dst::Scalar;
+  switch (activation) {
+    case FusedActivation::NONE:
+      y = x;
+      break;
+    case FusedActivation::RELU:
+      y = x.cwiseMax(T(0));
+      break;
+    case FusedActivation::SIGMOID:
+      y = ((-x).exp() + T(1)).inverse();
+      break;
+    case FusedActivation::TANH:
+      y = T(1) - T(2) * ((x * T(2)).exp() + T(1)).inverse();
+      break;
+  }
+}
+
+// Y = activation(Y + bias) for `channels` rows of `size` elements each, one
+// bias per row, with rows `stride` elements apart. This is the epilogue of
+// an NCHW output, or of a band of its rows. bias may be null.
+template <typename T>
+void BiasActivationNCHW(
+    const int channels,
+    const int size,
+    const int stride,
+    const T* bias,
+    const FusedActivation activation,
+    T* Y) {
+  for (int c = 0; c < channels; ++c) {
+    EigenVectorArrayMap<T> Y_arr(Y + c * stride, size);
+    if (bias != nullptr) {
+      AssignFusedActivation(activation, Y_arr + bias[c], Y_arr);
+    } else {
+      AssignFusedActivation(activation, Y_arr, Y_arr);
+    }
+  }
+}
+
+// Y = activation(Y + bias) for a row-major rows x channels matrix, i.e. an
+// NHWC or FC output, with one bias per column. bias may be null.
+template <typename T>
+void BiasActivationNHWC(
+    const int rows,
+    const int channels,
+    const T* bias,
+    const FusedActivation activation,
+    T* Y) {
+  EigenArrayMap<T> Y_arr(Y, channels, rows);
+  if (bias != nullptr) {
+    AssignFusedActivation(
+        activation,
+        Y_arr.colwise() + ConstEigenVectorArrayMap<T>(bias, channels),
+        Y_arr);
+  } else {
+    AssignFusedActivation(activation, Y_arr, Y_arr);
+  }
+}
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ACTIVATION_H_
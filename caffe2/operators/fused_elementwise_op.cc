@@ -0,0 +1,224 @@
+#include "caffe2/operators/fused_elementwise_op.h"
+
+#include <algorithm>
+
+#include "caffe2/operators/elementwise_ops_utils.h"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+constexpr int FusedElementwiseOp::kBlockSize;
+
+namespace {
+
+// Elements [begin, begin + n) of an array that repeats `src` every `period`
+// elements. Points into src when the block doesn't wrap around, and is
+// copied to buffer otherwise.
+const float* RepeatedBlock(
+    const float* src,
+    const int period,
+    const int begin,
+    const int n,
+    float* buffer) {
+  int offset = begin % period;
+  if (offset + n <= period) {
+    return src + offset;
+  }
+  for (int i = 0; i < n;) {
+    const int count = std::min(n - i, period - offset);
+    std::copy(src + offset, src + offset + count, buffer + i);
+    i += count;
+    offset = 0;
+  }
+  return buffer;
+}
+
+} // namespace
+
+FusedElementwiseOp::FusedElementwiseOp(
+    const OperatorDef& operator_def,
+    Workspace* ws)
+    : Operator<CPUContext>(operator_def, ws), broadcast_(InputSize()) {
+  const auto types = OperatorBase::GetRepeatedArgument<string>("steps");
+  const auto operands = OperatorBase::GetRepeatedArgument<int>("operands");
+  CAFFE_ENFORCE(!types.empty(), "FusedElementwise needs at least one step.");
+  CAFFE_ENFORCE_EQ(types.size(), operands.size());
+  for (int i = 0; i < types.size(); ++i) {
+    Step step;
+    step.activation = FusedActivation::NONE;
+    step.operand = operands[i];
+    if (types[i] == "Add") {
+      step.type = StepType::ADD;
+    } else if (types[i] == "Mul") {
+      step.type = StepType::MUL;
+    } else {
+      step.type = StepType::ACTIVATION;
+      step.activation = StringToFusedActivation(types[i]);
+      CAFFE_ENFORCE(
+          step.activation != FusedActivation::NONE,
+          "Empty FusedElementwise step.");
+    }
+    if (step.type != StepType::ACTIVATION) {
+      CAFFE_ENFORCE(
+          step.operand >= 0 && step.operand < InputSize(),
+          "Invalid operand of step ",
+          i,
+          ": ",
+          step.operand);
+    }
+    steps_.push_back(step);
+  }
+}
+
+bool FusedElementwiseOp::RunOnDevice() {
+  const auto& X = Input(0);
+  std::vector<int> Y_dims(X.dims().begin(), X.dims().end());
+  for (const auto& step : steps_) {
+    if (step.type != StepType::ACTIVATION) {
+      const auto& dims = Input(step.operand).dims();
+      Y_dims = elementwise_ops_utils::ComputeBinaryBroadcastForwardDims(
+          Y_dims, std::vector<int>(dims.begin(), dims.end()));
+    }
+  }
+  int size = 1;
+  for (const int d : Y_dims) {
+    size *= d;
+  }
+
+  // Every input is read as a scalar or, when its dimensions are trailing
+  // ones of the output, as an array repeated every `period` elements. The
+  // ones broadcast along other dimensions, or smaller ones that the output is
+  // written to, are copied to the output shape.
+  auto* Y = Output(0);
+  std::vector<const float*> data(InputSize(), nullptr);
+  std::vector<int> periods(InputSize(), size);
+  std::vector<float> scalars(InputSize(), 0.f);
+  for (int i = 0; i < InputSize(); ++i) {
+    const auto& input = Input(i);
+    std::vector<int> dims(input.dims().begin(), input.dims().end());
+    const auto first = std::find_if(
+        dims.begin(), dims.end(), [](const int d) { return d != 1; });
+    const auto ndim = dims.end() - first;
+    if (input.size() == 1) {
+      scalars[i] = input.data<float>()[0];
+    } else if (
+        std::equal(first, dims.end(), Y_dims.end() - ndim) &&
+        (input.size() == size || &input != Y)) {
+      data[i] = input.data<float>();
+      periods[i] = input.size();
+    } else {
+      broadcast_[i].Resize(Y_dims);
+      math::Broadcast<float, CPUContext>(
+          dims.size(),
+          dims.data(),
+          Y_dims.size(),
+          Y_dims.data(),
+          input.data<float>(),
+          broadcast_[i].mutable_data<float>(),
+          &context_);
+      data[i] = broadcast_[i].data<float>();
+    }
+  }
+
+  // The output may share memory with any full-size input, which keeps its
+  // memory through Resize and has each block read before it is written.
+  Y->Resize(Y_dims);
+  float* Y_data = Y->mutable_data<float>();
+  float buffer[kBlockSize];
+  float operand_buffer[kBlockSize];
+  for (int begin = 0; begin < size; begin += kBlockSize) {
+    const int n = std::min(kBlockSize, size - begin);
+    // Elements [begin, begin + n) of input i
+    auto block = [&](const int i) {
+      return data[i] == nullptr
+          ? nullptr
+          : RepeatedBlock(data[i], periods[i], begin, n, operand_buffer);
+    };
+    EigenVectorArrayMap<float> acc(buffer, n);
+    const float* first = block(0);
+    if (first != nullptr) {
+      acc = ConstEigenVectorArrayMap<float>(first, n);
+    } else {
+      acc.setConstant(scalars[0]);
+    }
+    for (const auto& step : steps_) {
+      const float* operand =
+          step.type == StepType::ACTIVATION ? nullptr : block(step.operand);
+      switch (step.type) {
+        case StepType::ADD:
+          if (operand != nullptr) {
+            acc += ConstEigenVectorArrayMap<float>(operand, n);
+          } else {
+            acc += scalars[step.operand];
+          }
+          break;
+        case StepType::MUL:
+          if (operand != nullptr) {
+            acc *= ConstEigenVectorArrayMap<float>(operand, n);
+          } else {
+            acc *= scalars[step.operand];
+          }
+          break;
+        case StepType::ACTIVATION:
+          AssignFusedActivation(step.activation, acc, acc);
+          break;
+      }
+    }
+    EigenVectorArrayMap<float>(Y_data + begin, n) = acc;
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(FusedElementwise, FusedElementwiseOp);
+
+OPERATOR_SCHEMA(FusedElementwise)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .AllowInplace([](int /* in */, int /* out */) { return true; })
+    .TensorInferenceFunction([](const OperatorDef& def,
+                                const vector<TensorShape>& in) {
+      ArgumentHelper helper(def);
+      const auto types = helper.GetRepeatedArgument<string>("steps");
+      const auto operands = helper.GetRepeatedArgument<int>("operands");
+      vector<int> dims(in[0].dims().begin(), in[0].dims().end());
+      for (int i = 0; i < types.size() && i < operands.size(); ++i) {
+        if (types[i] == "Add" || types[i] == "Mul") {
+          const auto& operand = in.at(operands[i]);
+          dims = elementwise_ops_utils::ComputeBinaryBroadcastForwardDims(
+              dims, vector<int>(operand.dims().begin(), operand.dims().end()));
+        }
+      }
+      vector<TensorShape> out(1);
+      for (const int d : dims) {
+        out[0].add_dims(d);
+      }
+      out[0].set_data_type(in[0].data_type());
+      return out;
+    })
+    .SetDoc(R"DOC(
+Evaluates a chain of elementwise operators on the CPU in a single pass over
+memory, a block of elements at a time. It replaces chains such as
+`Sigmoid(Add(Mul(X, A), B))` found by the elementwise fusion pass in
+caffe2/opt/fusion.h, which avoids writing and re-reading every intermediate
+tensor.
+
+Starting from the first input, each step is applied to the result of the
+previous one. `Add` and `Mul` steps take their second operand from the input
+given in `operands` and broadcast numpy-style. `Relu`, `Sigmoid` and `Tanh`
+steps are unary, and their entry in `operands` is ignored.
+)DOC")
+    .Arg(
+        "steps",
+        "*(type: [string])* Operator of each step: \"Add\", \"Mul\", \"Relu\", "
+        "\"Sigmoid\" or \"Tanh\".")
+    .Arg(
+        "operands",
+        "*(type: [int])* For each step, the input index of its second operand, "
+        "or -1 for unary steps.")
+    .Input(0, "X", "First operand of the chain.")
+    .Input(1, "operands", "*(optional)* Other operands of the binary steps.")
+    .Output(0, "Y", "Result of the last step.");
+
+SHOULD_NOT_DO_GRADIENT(FusedElementwise);
+
+} // namespace caffe2
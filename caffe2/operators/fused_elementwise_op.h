@@ -0,0 +1,43 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
+#define CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
+
+#include <string>
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/operators/fused_activation.h"
+
+namespace caffe2 {
+
+// Runs a chain of elementwise operators, each consuming the result of the
+// previous one, as a single pass over memory. See the schema for arguments.
+class FusedElementwiseOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  FusedElementwiseOp(const OperatorDef& operator_def, Workspace* ws);
+
+  bool RunOnDevice() override;
+
+ private:
+  enum class StepType { ADD, MUL, ACTIVATION };
+
+  struct Step {
+    StepType type;
+    FusedActivation activation;
+    // Input index of the other operand of ADD and MUL
+    int operand;
+  };
+
+  // Elements of the output processed at a time, small enough for the
+  // intermediate results to stay in L1.
+  static constexpr int kBlockSize = 1024;
+
+  std::vector<Step> steps_;
+  // Inputs broadcast to the output shape, for the ones that need it
+  std::vector<TensorCPU> broadcast_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
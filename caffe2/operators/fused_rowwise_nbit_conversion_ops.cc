@@ -0,0 +1,116 @@
+#include "caffe2/operators/fused_rowwise_nbit_conversion_ops.h"
+#include "caffe2/core/registry.h"
+
+namespace caffe2 {
+
+namespace {
+
+template <int BIT_RATE>
+vector<TensorShape> FloatToFusedNBitRowwiseQuantizedShapeInference(
+    const OperatorDef& /* def */,
+    const vector<TensorShape>& in) {
+  vector<TensorShape> out;
+  TensorShape X = in[0];
+  X.set_dims(1, FusedNBitRowwiseRowBytes(BIT_RATE, X.dims(1)));
+  out.push_back(std::move(X));
+  out[0].set_data_type(TensorProto_DataType_UINT8);
+  return out;
+}
+
+template <int BIT_RATE>
+vector<TensorShape> FusedNBitRowwiseQuantizedToFloatShapeInference(
+    const OperatorDef& /* def */,
+    const vector<TensorShape>& in) {
+  vector<TensorShape> out;
+  TensorShape X = in[0];
+  X.set_dims(1, (X.dims(1) - 2 * sizeof(float16)) * (8 / BIT_RATE));
+  out.push_back(std::move(X));
+  out[0].set_data_type(TensorProto_DataType_FLOAT);
+  return out;
+}
+
+} // namespace
+
+REGISTER_CPU_OPERATOR(
+    FloatToFused4BitRowwiseQuantized,
+    FloatToFusedNBitRowwiseQuantizedOp<4, CPUContext>);
+OPERATOR_SCHEMA(FloatToFused4BitRowwiseQuantized)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .TensorInferenceFunction(FloatToFusedNBitRowwiseQuantizedShapeInference<4>)
+    .SetDoc(R"DOC(
+Applies 4-bit row-wise quantization by determining the range
+(maximum - minimum) and offset (minimum value) of each row in the input
+matrix, and then scaling each element to a 4-bit number between 0 and
+15. Two quantized values are packed into every byte, the first one in the
+lower 4 bits. To later de-quantize values, the scale (range / 15) and
+offset (bias) are stored alongside the data as 16-bit floats: the last 4
+bytes of each row in the output matrix are the scale followed by the bias,
+and all preceding bytes encode the quantized values. A row of N values
+thus takes ceil(N / 2) + 4 bytes, about an eighth of the float input.
+)DOC")
+    .Input(0, "input", "Float32 input data")
+    .Output(0, "output", "Fused scale, bias and quantized data");
+NO_GRADIENT(FloatToFused4BitRowwiseQuantized);
+
+REGISTER_CPU_OPERATOR(
+    Fused4BitRowwiseQuantizedToFloat,
+    FusedNBitRowwiseQuantizedToFloatOp<4, CPUContext>);
+OPERATOR_SCHEMA(Fused4BitRowwiseQuantizedToFloat)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .TensorInferenceFunction(FusedNBitRowwiseQuantizedToFloatShapeInference<4>)
+    .SetDoc(R"DOC(
+De-quantizes the result of the FloatToFused4BitRowwiseQuantized operator.
+The input is expected to encode the scale as a 16-bit float in the second
+to the last 2 bytes of each row, followed by the bias as a 16-bit float in
+the last 2 bytes, and two quantized values in each of the preceding bytes of
+the row. The output has two columns per byte of quantized values, so rows
+quantized from an odd number of values get one trailing column of padding.
+)DOC")
+    .Input(
+        0,
+        "scale_bias_quantized_input",
+        "Fused scale, bias and quantized data")
+    .Output(0, "float_output", "Float32 data");
+NO_GRADIENT(Fused4BitRowwiseQuantizedToFloat);
+
+REGISTER_CPU_OPERATOR(
+    FloatToFused2BitRowwiseQuantized,
+    FloatToFusedNBitRowwiseQuantizedOp<2, CPUContext>);
+OPERATOR_SCHEMA(FloatToFused2BitRowwiseQuantized)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .TensorInferenceFunction(FloatToFusedNBitRowwiseQuantizedShapeInference<2>)
+    .SetDoc(R"DOC(
+Applies 2-bit row-wise quantization, the same way as
+FloatToFused4BitRowwiseQuantized does with 4 bits: each element is scaled to
+a number between 0 and 3, four of which are packed into every byte starting
+from the lowest bits, and the scale (range / 3) and bias of each row are
+appended as 16-bit floats. A row of N values thus takes ceil(N / 4) + 4
+bytes.
+)DOC")
+    .Input(0, "input", "Float32 input data")
+    .Output(0, "output", "Fused scale, bias and quantized data");
+NO_GRADIENT(FloatToFused2BitRowwiseQuantized);
+
+REGISTER_CPU_OPERATOR(
+    Fused2BitRowwiseQuantizedToFloat,
+    FusedNBitRowwiseQuantizedToFloatOp<2, CPUContext>);
+OPERATOR_SCHEMA(Fused2BitRowwiseQuantizedToFloat)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .TensorInferenceFunction(FusedNBitRowwiseQuantizedToFloatShapeInference<2>)
+    .SetDoc(R"DOC(
+De-quantizes the result of the FloatToFused2BitRowwiseQuantized operator.
+The output has four columns per byte of quantized values, so rows quantized
+from a number of values that is not a multiple of 4 get trailing columns of
+padding.
+)DOC")
+    .Input(
+        0,
+        "scale_bias_quantized_input",
+        "Fused scale, bias and quantized data")
+    .Output(0, "float_output", "Float32 data");
+NO_GRADIENT(Fused2BitRowwiseQuantizedToFloat);
+} // namespace caffe2
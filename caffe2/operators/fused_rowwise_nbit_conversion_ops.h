@@ -0,0 +1,178 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
+#define CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/conversions.h"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+#define IS_LITTLE_ENDIAN                                      \
+  [] {                                                        \
+    const int32_t kValue = 1;                                 \
+    return reinterpret_cast<const uint8_t*>(&kValue)[0] == 1; \
+  }()
+
+// Number of bytes in a fused row of `columns` values quantized with
+// `bit_rate` bits each: the packed values, then a float16 scale and bias.
+inline TIndex FusedNBitRowwiseRowBytes(int bit_rate, TIndex columns) {
+  const int num_elem_per_byte = 8 / bit_rate;
+  return (columns + num_elem_per_byte - 1) / num_elem_per_byte +
+      2 * sizeof(float16);
+}
+
+template <int BIT_RATE, class Context>
+class FloatToFusedNBitRowwiseQuantizedOp : public Operator<Context> {
+ public:
+  static_assert(
+      BIT_RATE == 4 || BIT_RATE == 2,
+      "Only 4-bit and 2-bit quantization is supported");
+  static constexpr int kNumElemPerByte = 8 / BIT_RATE;
+  static constexpr int kMaxQuantizedValue = (1 << BIT_RATE) - 1;
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(FloatToFusedNBitRowwiseQuantizedOp)
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE(IS_LITTLE_ENDIAN, "Unsupported endianness");
+
+    const auto& input = Input(DATA_FLOAT);
+    auto* output = Output(DATA_FUSED_SCALE_BIAS);
+
+    CAFFE_ENFORCE_EQ(input.ndim(), 2, "Expect input to be a matrix");
+    const auto input_rows = input.dim(0);
+    const auto input_columns = input.dim(1);
+    CAFFE_ENFORCE_GT(input_columns, 0, "Expect input to have columns");
+
+    // The "fused" representation stores the scale and bias with the row-wise
+    // quantized data in one tensor. Every byte holds 8 / BIT_RATE values,
+    // starting from the lowest bits, and the last 4 bytes of each row are the
+    // scale and the bias as float16.
+    // | ... packed data ... | scale | bias |
+    // |   packed_columns    |  2B   |  2B  |
+    const std::vector<TIndex> output_dimensions = {
+        input_rows, FusedNBitRowwiseRowBytes(BIT_RATE, input_columns)};
+    output->Resize(output_dimensions);
+
+    const auto* input_data = input.template data<float>();
+    auto* output_data = output->template mutable_data<uint8_t>();
+    const auto output_columns = output->dim(1);
+    const auto packed_columns = output_columns - 2 * sizeof(float16);
+
+    for (TIndex row = 0; row < input_rows; ++row) {
+      const float* input_row = input_data + row * input_columns;
+      uint8_t* output_row = output_data + row * output_columns;
+      float16* output_row_scale_bias =
+          reinterpret_cast<float16*>(output_row + packed_columns);
+
+      float minimum_element =
+          *std::min_element(input_row, input_row + input_columns);
+      const float maximum_element =
+          *std::max_element(input_row, input_row + input_columns);
+      // Round the bias to float16 first so that the quantized values are
+      // offsets from the bias the lookup will actually use.
+      const float16 bias = convert::To<float, float16>(minimum_element);
+      minimum_element = convert::To<float16, float>(bias);
+      const float range = maximum_element - minimum_element;
+
+      float16 scale = convert::To<float, float16>(
+          range == 0 ? 1.0f : range / kMaxQuantizedValue);
+      float inverse_scale = 1.0f / convert::To<float16, float>(scale);
+      if (std::isinf(inverse_scale)) {
+        // The scale underflowed in float16; every value rounds to the bias.
+        scale = convert::To<float, float16>(1.0f);
+        inverse_scale = 1.0f;
+      }
+      output_row_scale_bias[0] = scale;
+      output_row_scale_bias[1] = bias;
+
+      std::fill(output_row, output_row + packed_columns, 0);
+      for (TIndex column = 0; column < input_columns; ++column) {
+        const float scaled = std::nearbyint(
+            (input_row[column] - minimum_element) * inverse_scale);
+        const uint8_t quantized = static_cast<uint8_t>(std::max(
+            0.0f, std::min(scaled, static_cast<float>(kMaxQuantizedValue))));
+        output_row[column / kNumElemPerByte] |=
+            quantized << ((column % kNumElemPerByte) * BIT_RATE);
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  INPUT_TAGS(DATA_FLOAT);
+  OUTPUT_TAGS(DATA_FUSED_SCALE_BIAS);
+};
+
+template <int BIT_RATE, class Context>
+class FusedNBitRowwiseQuantizedToFloatOp : public Operator<Context> {
+ public:
+  static_assert(
+      BIT_RATE == 4 || BIT_RATE == 2,
+      "Only 4-bit and 2-bit quantization is supported");
+  static constexpr int kNumElemPerByte = 8 / BIT_RATE;
+  static constexpr uint8_t kMask = (1 << BIT_RATE) - 1;
+
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(FusedNBitRowwiseQuantizedToFloatOp)
+
+  bool RunOnDevice() override {
+    CAFFE_ENFORCE(IS_LITTLE_ENDIAN, "Unsupported endianness");
+
+    const auto& input = Input(DATA_FUSED_SCALE_BIAS);
+    auto* output = Output(DATA_FLOAT);
+
+    CAFFE_ENFORCE_EQ(input.ndim(), 2, "Expect input to be a matrix");
+    const auto input_rows = input.dim(0);
+    const auto input_columns = input.dim(1);
+    CAFFE_ENFORCE_GT(
+        input_columns,
+        2 * sizeof(float16),
+        "Expect input to have more than 4 columns");
+
+    // The last 4 bytes per row are the scale and the bias. Every other byte
+    // holds 8 / BIT_RATE values; padding values at the end of odd-length
+    // rows are de-quantized as well.
+    const auto packed_columns = input_columns - 2 * sizeof(float16);
+    const std::vector<TIndex> output_dimensions = {
+        input_rows, static_cast<TIndex>(packed_columns * kNumElemPerByte)};
+    output->Resize(output_dimensions);
+    const auto output_columns = output->dim(1);
+
+    const auto* input_data = input.template data<uint8_t>();
+    auto* output_data = output->template mutable_data<float>();
+
+    for (TIndex row = 0; row < input_rows; ++row) {
+      const uint8_t* input_row = input_data + row * input_columns;
+      const float16* input_row_scale_bias =
+          reinterpret_cast<const float16*>(input_row + packed_columns);
+      const float scale = convert::To<float16, float>(input_row_scale_bias[0]);
+      const float bias = convert::To<float16, float>(input_row_scale_bias[1]);
+
+      float* output_row = output_data + row * output_columns;
+      for (TIndex column = 0; column < output_columns; ++column) {
+        const uint8_t quantized = (input_row[column / kNumElemPerByte] >>
+                                   ((column % kNumElemPerByte) * BIT_RATE)) &
+            kMask;
+        output_row[column] = quantized * scale + bias;
+      }
+    }
+    return true;
+  }
+
+ private:
+  INPUT_TAGS(DATA_FUSED_SCALE_BIAS);
+  OUTPUT_TAGS(DATA_FLOAT);
+};
+
+#undef IS_LITTLE_ENDIAN
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ROWWISE_NBIT_CONVERSION_OPS_H_
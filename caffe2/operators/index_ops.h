@@ -0,0 +1,214 @@
+#ifndef CAFFE2_OPERATORS_INDEX_OPS_H_
+#define CAFFE2_OPERATORS_INDEX_OPS_H_
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/core/typeid.h"
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
+
+namespace caffe2 {
+
+using TIndexValue = int64_t;
+
+struct IndexBase {
+ public:
+  IndexBase(TIndexValue maxElements, const TypeMeta& type)
+    : maxElements_{maxElements}
+    , meta_(type)
+    , frozen_{false} {}
+
+  void Freeze() { frozen_ = true; }
+
+  bool isFrozen() const {
+    return frozen_;
+  }
+
+  int64_t maxElements() const {
+    return maxElements_;
+  }
+
+  virtual ~IndexBase() {}
+
+  const TypeMeta& Type() const { return meta_; }
+
+  TIndexValue Size() {
+    return nextId_.load();
+  }
+
+ protected:
+  // Reserves the next id, failing once maxElements is reached.
+  TIndexValue NewId() {
+    auto id = nextId_.load();
+    do {
+      CAFFE_ENFORCE(id < maxElements_, "Dict max size reached");
+    } while (!nextId_.compare_exchange_weak(id, id + 1));
+    return id;
+  }
+
+  int64_t maxElements_;
+  TypeMeta meta_;
+  std::atomic<TIndexValue> nextId_{1};
+  std::atomic<bool> frozen_{false};
+};
+
+// Maps keys to ids 1, 2, ... in order of first appearance. Keys are spread
+// over kNumShards open-addressing tables, each with its own mutex, so that
+// concurrent Get calls only contend when they touch the same shard. Once
+// frozen, lookups take no locks at all.
+template<typename T>
+struct Index: IndexBase {
+  static constexpr int kNumShards = 64;
+
+  explicit Index(TIndexValue maxElements)
+    : IndexBase(maxElements, TypeMeta::Make<T>()) {}
+
+  // Looks up a batch of keys, inserting the ones not present yet unless the
+  // index is frozen, in which case they get 0. New keys are assigned ids in
+  // the order they appear in `keys`.
+  void Get(const T* keys, TIndexValue* values, size_t numKeys) {
+    if (frozen_) {
+      Find(keys, values, numKeys);
+      return;
+    }
+    // Look up all keys first, taking each shard lock once per batch. In the
+    // steady state nearly every key is found here.
+    std::vector<uint32_t> order;
+    std::array<size_t, kNumShards + 1> offsets;
+    GroupByShard(keys, numKeys, &order, &offsets);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) {
+        continue;
+      }
+      auto& shard = shards_[s];
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (size_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        const auto i = order[j];
+        auto it = shard.dict.find(keys[i]);
+        values[i] = it != shard.dict.end() ? it->second : 0;
+      }
+    }
+    // Then insert the misses in input order. Another thread may have added
+    // them in the meantime, so look them up again under the lock.
+    for (size_t i = 0; i < numKeys; ++i) {
+      if (values[i] != 0) {
+        continue;
+      }
+      auto& shard = shards_[ShardOf(keys[i])];
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = shard.dict.find(keys[i]);
+      if (it != shard.dict.end()) {
+        values[i] = it->second;
+      } else {
+        values[i] = NewId();
+        shard.dict.emplace(keys[i], values[i]);
+      }
+    }
+  }
+
+  // Looks up a batch of keys without inserting; missing keys get 0. Only
+  // safe to call concurrently with other Get/Find calls once frozen.
+  void Find(const T* keys, TIndexValue* values, size_t numKeys) const {
+    for (size_t i = 0; i < numKeys; ++i) {
+      const auto& dict = shards_[ShardOf(keys[i])].dict;
+      auto it = dict.find(keys[i]);
+      values[i] = it != dict.end() ? it->second : 0;
+    }
+  }
+
+  bool Load(const T* keys, size_t numKeys) {
+    CAFFE_ENFORCE(
+        numKeys <= maxElements_,
+        "Cannot load index: Tensor is larger than max_elements.");
+    std::array<ska::flat_hash_map<T, TIndexValue>, kNumShards> dicts;
+    for (size_t i = 0; i < numKeys; ++i) {
+      CAFFE_ENFORCE(
+          dicts[ShardOf(keys[i])].emplace(keys[i], i + 1).second,
+          "Repeated elements found: cannot load into dictionary.");
+    }
+    // assume no `get` is inflight while this happens
+    {
+      auto locks = LockAll();
+      // let the old dicts get destructed outside of the lock
+      for (int s = 0; s < kNumShards; ++s) {
+        shards_[s].dict.swap(dicts[s]);
+      }
+      nextId_ = numKeys + 1;
+    }
+    return true;
+  }
+
+  template<typename Ctx>
+  bool Store(Tensor<Ctx>* out) {
+    auto locks = LockAll();
+    out->Resize(nextId_ - 1);
+    auto outData = out->template mutable_data<T>();
+    for (const auto& shard : shards_) {
+      for (const auto& entry : shard.dict) {
+        outData[entry.second - 1] = entry.first;
+      }
+    }
+    return true;
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    ska::flat_hash_map<T, TIndexValue> dict;
+  };
+
+  static size_t ShardOf(const T& key) {
+    // std::hash is the identity for integers; mix the bits so that strided
+    // ids don't all land in the same shard.
+    const uint64_t h =
+        static_cast<uint64_t>(std::hash<T>()(key)) * 0x9E3779B97F4A7C15ull;
+    return h >> (64 - 6);
+  }
+  static_assert(kNumShards == 1 << 6, "ShardOf assumes 64 shards");
+
+  // Stable counting sort of the key positions by shard: the keys of shard s
+  // are order[offsets[s]] .. order[offsets[s + 1] - 1].
+  static void GroupByShard(
+      const T* keys,
+      size_t numKeys,
+      std::vector<uint32_t>* order,
+      std::array<size_t, kNumShards + 1>* offsets) {
+    CAFFE_ENFORCE_LE(numKeys, std::numeric_limits<uint32_t>::max());
+    std::vector<uint8_t> shardOf(numKeys);
+    offsets->fill(0);
+    for (size_t i = 0; i < numKeys; ++i) {
+      shardOf[i] = ShardOf(keys[i]);
+      ++(*offsets)[shardOf[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      (*offsets)[s + 1] += (*offsets)[s];
+    }
+    std::array<size_t, kNumShards> next;
+    std::copy(offsets->begin(), offsets->end() - 1, next.begin());
+    order->resize(numKeys);
+    for (size_t i = 0; i < numKeys; ++i) {
+      (*order)[next[shardOf[i]]++] = i;
+    }
+  }
+
+  std::vector<std::unique_lock<std::mutex>> LockAll() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(kNumShards);
+    for (auto& shard : shards_) {
+      locks.emplace_back(shard.mutex);
+    }
+    return locks;
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INDEX_OPS_H_
@@ -1,5 +1,9 @@
 #include "caffe2/operators/order_switch_ops.h"
 
+#include <array>
+
+#include "caffe2/utils/math.h"
+
 namespace caffe2 {
 
 template <>
@@ -9,17 +13,15 @@ bool NHWC2NCHWOp<float, CPUContext>::RunOnDevice() {
   CAFFE_ENFORCE(X.ndim() == 4);
   const int N = X.dim32(0), H = X.dim32(1), W = X.dim32(2), C = X.dim32(3);
   Y->Resize(N, C, H, W);
-  const float* Xdata = X.data<float>();
-  float* Ydata = Y->mutable_data<float>();
-  for (int n = 0; n < N; ++n) {
-    for (int h = 0; h < H; ++h) {
-      for (int w = 0; w < W; ++w) {
-        for (int c = 0; c < C; ++c) {
-          Ydata[((n * C + c) * H + h) * W + w] = *(Xdata++);
-        }
-      }
-    }
-  }
+  const std::array<int, 4> dims = {N, H, W, C};
+  const std::array<int, 4> axes = {0, 3, 1, 2};
+  math::Transpose<float, CPUContext>(
+      4,
+      dims.data(),
+      axes.data(),
+      X.data<float>(),
+      Y->mutable_data<float>(),
+      &context_);
   return true;
 }
 
@@ -30,17 +32,15 @@ bool NCHW2NHWCOp<float, CPUContext>::RunOnDevice() {
   CAFFE_ENFORCE(X.ndim() == 4);
   const int N = X.dim32(0), C = X.dim32(1), H = X.dim32(2), W = X.dim32(3);
   Y->Resize(N, H, W, C);
-  const float* Xdata = X.data<float>();
-  float* Ydata = Y->mutable_data<float>();
-  for (int n = 0; n < N; ++n) {
-    for (int c = 0; c < C; ++c) {
-      for (int h = 0; h < H; ++h) {
-        for (int w = 0; w < W; ++w) {
-          Ydata[((n * H + h) * W + w) * C + c] = *(Xdata++);
-        }
-      }
-    }
-  }
+  const std::array<int, 4> dims = {N, C, H, W};
+  const std::array<int, 4> axes = {0, 2, 3, 1};
+  math::Transpose<float, CPUContext>(
+      4,
+      dims.data(),
+      axes.data(),
+      X.data<float>(),
+      Y->mutable_data<float>(),
+      &context_);
   return true;
 }
 
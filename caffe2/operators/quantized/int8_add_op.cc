@@ -0,0 +1,38 @@
+#include "caffe2/operators/quantized/int8_add_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Add, int8::Int8AddOp<int8::Activation::NONE>);
+REGISTER_CPU_OPERATOR(Int8AddRelu, int8::Int8AddOp<int8::Activation::RELU>);
+
+OPERATOR_SCHEMA(Int8Add)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}, {1, 0}})
+    .IdenticalTypeAndShapeOfInput(0)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Performs element-wise binary Add of two Int8 tensors of the same shape. The
+inputs may have different quantization parameters; both are rescaled in fixed
+point and the sum is requantized to the output scale.
+)DOC")
+    .Input(0, "A", "First operand.")
+    .Input(1, "B", "Second operand, of the same shape as A.")
+    .Output(0, "C", "Result, has same dimensions and type as A");
+
+OPERATOR_SCHEMA(Int8AddRelu)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}, {1, 0}})
+    .IdenticalTypeAndShapeOfInput(0)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Same as Int8Add, with a Relu fused into the requantization clamp.
+)DOC")
+    .Input(0, "A", "First operand.")
+    .Input(1, "B", "Second operand, of the same shape as A.")
+    .Output(0, "C", "Result, has same dimensions and type as A");
+
+} // namespace caffe2
@@ -0,0 +1,76 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_ADD_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_ADD_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// Elementwise addition of two tensors with arbitrary quantization. Both
+// inputs are shifted left by kLeftShift bits to keep precision, rescaled to a
+// common scale with fixed-point multipliers, summed, and then requantized to
+// the output scale.
+template <Activation Ac>
+class Int8AddOp final : public Operator<CPUContext> {
+ public:
+  Int8AddOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override {
+    const auto& A = Inputs()[0]->Get<Int8TensorCPU>();
+    const auto& B = Inputs()[1]->Get<Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(
+        A.t.dims(), B.t.dims(), "Int8Add does not support broadcasting");
+
+    const double twice_max_scale = 2.0 * std::max(A.scale, B.scale);
+    int32_t A_multiplier, B_multiplier;
+    int A_shift, B_shift;
+    QuantizeMultiplierSmallerThanOne(
+        A.scale / twice_max_scale, &A_multiplier, &A_shift);
+    QuantizeMultiplierSmallerThanOne(
+        B.scale / twice_max_scale, &B_multiplier, &B_shift);
+    const Requantization requantize(
+        twice_max_scale / ((1 << kLeftShift) * Y_scale_), Y_zero_point_, Ac);
+    const int32_t A_zero_point = A.zero_point;
+    const int32_t B_zero_point = B.zero_point;
+
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    Y->t.ResizeLike(A.t);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    const uint8_t* A_data = A.t.data<uint8_t>();
+    const uint8_t* B_data = B.t.data<uint8_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    for (TIndex i = 0; i < Y->t.size(); ++i) {
+      const int32_t a = (static_cast<int32_t>(A_data[i]) - A_zero_point) *
+          (1 << kLeftShift);
+      const int32_t b = (static_cast<int32_t>(B_data[i]) - B_zero_point) *
+          (1 << kLeftShift);
+      Y_data[i] = requantize(
+          MultiplyByQuantizedMultiplierSmallerThanOne(
+              a, A_multiplier, A_shift) +
+          MultiplyByQuantizedMultiplierSmallerThanOne(
+              b, B_multiplier, B_shift));
+    }
+    return true;
+  }
+
+ private:
+  static constexpr int kLeftShift = 20;
+
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_ADD_OP_H_
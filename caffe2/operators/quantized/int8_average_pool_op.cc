@@ -0,0 +1,21 @@
+#include "caffe2/operators/quantized/int8_average_pool_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8AveragePool, int8::Int8AveragePoolOp);
+
+OPERATOR_SCHEMA(Int8AveragePool)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+AveragePool consumes an input blob X in NHWC order and applies average pooling
+across the blob according to kernel sizes, stride sizes, and pad lengths
+defined by the ConvPoolOpBase operator. Padded elements are excluded from the
+average.
+)DOC")
+    .Input(0, "X", "Int8 input tensor of shape (N, H, W, C).")
+    .Output(0, "Y", "Int8 output tensor of shape (N, H_out, W_out, C).");
+
+} // namespace caffe2
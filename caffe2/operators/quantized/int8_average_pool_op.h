@@ -0,0 +1,104 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_AVERAGE_POOL_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_AVERAGE_POOL_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// Sums zero-point-adjusted inputs over each window in int32 and folds the
+// division by the window size into the requantization multiplier. Windows
+// clipped by padding only count the elements they cover, so there is one
+// multiplier per possible element count.
+class Int8AveragePoolOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8AveragePoolOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {
+    OPERATOR_NEEDS_FEATURE(
+        this->order_ == StorageOrder::NHWC,
+        "Int8AveragePool only supports NHWC order");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+    const int N = X.t.dim32(0);
+    const int H = X.t.dim32(1);
+    const int W = X.t.dim32(2);
+    const int C = X.t.dim32(3);
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), C);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    const int H_out = Y->t.dim32(1);
+    const int W_out = Y->t.dim32(2);
+
+    // The accumulator is pre-shifted so the per-window multiplier stays
+    // below one even when the output scale matches the input scale.
+    const int window_size = kernel_h() * kernel_w();
+    requantize_.resize(window_size + 1);
+    for (int count = 1; count <= window_size; ++count) {
+      requantize_[count] = Requantization(
+          static_cast<double>(X.scale) /
+              (static_cast<double>(Y_scale_) * count * (1 << kAccShift)),
+          Y_zero_point_);
+    }
+
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    const int32_t X_zero_point = X.zero_point;
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    acc_.resize(C);
+    for (int n = 0; n < N; ++n) {
+      const uint8_t* X_image = X_data + static_cast<size_t>(n) * H * W * C;
+      for (int h_out = 0; h_out < H_out; ++h_out) {
+        const int h_start = std::max(h_out * stride_h() - pad_t(), 0);
+        const int h_end =
+            std::min(h_out * stride_h() - pad_t() + kernel_h(), H);
+        for (int w_out = 0; w_out < W_out; ++w_out) {
+          const int w_start = std::max(w_out * stride_w() - pad_l(), 0);
+          const int w_end =
+              std::min(w_out * stride_w() - pad_l() + kernel_w(), W);
+          const int count = (h_end - h_start) * (w_end - w_start);
+          std::fill(acc_.begin(), acc_.end(), -count * X_zero_point);
+          for (int h = h_start; h < h_end; ++h) {
+            for (int w = w_start; w < w_end; ++w) {
+              const uint8_t* x = X_image + (h * W + w) * C;
+              for (int c = 0; c < C; ++c) {
+                acc_[c] += x[c];
+              }
+            }
+          }
+          const Requantization& requantize = requantize_[count];
+          for (int c = 0; c < C; ++c) {
+            Y_data[c] = requantize(acc_[c] * (1 << kAccShift));
+          }
+          Y_data += C;
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr int kAccShift = 8;
+
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  std::vector<Requantization> requantize_;
+  std::vector<int32_t> acc_;
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_AVERAGE_POOL_OP_H_
@@ -0,0 +1,20 @@
+#include "caffe2/operators/quantized/int8_concat_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Concat, int8::Int8ConcatOp);
+
+OPERATOR_SCHEMA(Int8Concat)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .Arg("axis", "Which axis to concat on, defaults to 3 (channels in NHWC)")
+    .SetDoc(R"DOC(
+Concatenate a list of Int8 tensors into a single tensor along the given axis.
+Inputs with quantization parameters different from the output are requantized
+while being copied.
+)DOC")
+    .Output(0, "concat_result", "Concatenated tensor");
+
+} // namespace caffe2
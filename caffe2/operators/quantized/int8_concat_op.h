@@ -0,0 +1,92 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_CONCAT_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_CONCAT_OP_H_
+
+#include <cstring>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// Inputs whose quantization matches the output are copied as is; the others
+// are requantized through a 256-entry lookup table while being copied.
+class Int8ConcatOp final : public Operator<CPUContext> {
+ public:
+  Int8ConcatOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        axis_(OperatorBase::GetSingleArgument<int>("axis", 3)),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override {
+    const auto& X0 = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    const int canonical_axis = X0.t.canonical_axis_index(axis_);
+    vector<TIndex> Y_dims = X0.t.dims();
+    for (int i = 1; i < InputSize(); ++i) {
+      const auto& Xi = Inputs()[i]->Get<Int8TensorCPU>();
+      CAFFE_ENFORCE_EQ(Xi.t.ndim(), X0.t.ndim());
+      for (int d = 0; d < X0.t.ndim(); ++d) {
+        if (d != canonical_axis) {
+          CAFFE_ENFORCE_EQ(
+              Xi.t.dim(d),
+              X0.t.dim(d),
+              "Int8Concat inputs must match on all dimensions but axis");
+        }
+      }
+      Y_dims[canonical_axis] += Xi.t.dim(canonical_axis);
+    }
+    Y->t.Resize(Y_dims);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+
+    const TIndex outer = Y->t.size_to_dim(canonical_axis);
+    const TIndex Y_inner = Y->t.size_from_dim(canonical_axis);
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    uint8_t table[256];
+    TIndex offset = 0;
+    for (int i = 0; i < InputSize(); ++i) {
+      const auto& Xi = Inputs()[i]->Get<Int8TensorCPU>();
+      const TIndex X_inner = Xi.t.size_from_dim(canonical_axis);
+      const uint8_t* X_data = Xi.t.data<uint8_t>();
+      const bool same_quantization =
+          Xi.scale == Y_scale_ && Xi.zero_point == Y_zero_point_;
+      if (!same_quantization) {
+        BuildLookupTable(
+            Xi.scale,
+            Xi.zero_point,
+            Y_scale_,
+            Y_zero_point_,
+            [](float x) { return x; },
+            table);
+      }
+      for (TIndex o = 0; o < outer; ++o) {
+        const uint8_t* x = X_data + o * X_inner;
+        uint8_t* y = Y_data + o * Y_inner + offset;
+        if (same_quantization) {
+          std::memcpy(y, x, X_inner);
+        } else {
+          LookupTable(table, x, X_inner, y);
+        }
+      }
+      offset += X_inner;
+    }
+    return true;
+  }
+
+ private:
+  int axis_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_CONCAT_OP_H_
@@ -0,0 +1,41 @@
+#include "caffe2/operators/quantized/int8_conv_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Conv, int8::Int8ConvOp<int8::Activation::NONE>);
+REGISTER_CPU_OPERATOR(Int8ConvRelu, int8::Int8ConvOp<int8::Activation::RELU>);
+
+OPERATOR_SCHEMA(Int8Conv)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+The convolution operator consumes an input vector, a 2D filter blob
+and a bias blob and computes the output, in NHWC order. The filter is an
+Int8 tensor of shape (M, kernel_h, kernel_w, C / group) and the bias an int32
+Int8 tensor of shape (M) with scale = X_scale * W_scale and zero_point = 0.
+
+Products are accumulated in int32 and requantized to
+(Y_scale, Y_zero_point) as each output is produced. 1x1 convolutions with unit
+stride and no padding skip the im2col step.
+)DOC")
+    .Input(0, "X", "Int8 input tensor of shape (N, H, W, C).")
+    .Input(1, "W", "Int8 filter of shape (M, kernel_h, kernel_w, C / group).")
+    .Input(2, "b", "int32 bias of shape (M).")
+    .Output(0, "Y", "Int8 output tensor of shape (N, H_out, W_out, M).");
+
+OPERATOR_SCHEMA(Int8ConvRelu)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Same as Int8Conv, with a Relu fused into the requantization clamp.
+)DOC")
+    .Input(0, "X", "Int8 input tensor of shape (N, H, W, C).")
+    .Input(1, "W", "Int8 filter of shape (M, kernel_h, kernel_w, C / group).")
+    .Input(2, "b", "int32 bias of shape (M).")
+    .Output(0, "Y", "Int8 output tensor of shape (N, H_out, W_out, M).");
+
+} // namespace caffe2
@@ -0,0 +1,168 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_CONV_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_CONV_OP_H_
+
+#include <cstring>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// NHWC convolution on uint8 data. The filter is laid out as
+// M x kernel_h x kernel_w x (C / group), so every output channel is one
+// contiguous row and each output pixel is a dot product with the matching
+// im2col row. Padding is filled with the input zero point, which contributes
+// nothing to the zero-point-adjusted accumulator.
+template <Activation Ac>
+class Int8ConvOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8ConvOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {
+    OPERATOR_NEEDS_FEATURE(
+        this->order_ == StorageOrder::NHWC,
+        "Int8Conv only supports NHWC order");
+    CAFFE_ENFORCE_EQ(kernel_.size(), 2, "Int8Conv only supports 2D kernels");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    const auto& W = Inputs()[1]->Get<Int8TensorCPU>();
+    const auto& B = Inputs()[2]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+    CAFFE_ENFORCE_EQ(W.t.ndim(), 4);
+    const int N = X.t.dim32(0);
+    const int H = X.t.dim32(1);
+    const int W_in = X.t.dim32(2);
+    const int C = X.t.dim32(3);
+    const int M = W.t.dim32(0);
+    CAFFE_ENFORCE_EQ(C % group_, 0);
+    CAFFE_ENFORCE_EQ(M % group_, 0);
+    const int C_per_group = C / group_;
+    const int M_per_group = M / group_;
+    CAFFE_ENFORCE_EQ(W.t.dim32(1), kernel_h());
+    CAFFE_ENFORCE_EQ(W.t.dim32(2), kernel_w());
+    CAFFE_ENFORCE_EQ(W.t.dim32(3), C_per_group);
+    CAFFE_ENFORCE_EQ(B.t.size(), M, "Dimension mismatch between B and W");
+    CAFFE_ENFORCE(
+        B.t.IsType<int32_t>() && B.zero_point == 0,
+        "Int8Conv bias must be int32 with a zero point of 0");
+
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), M);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    const int H_out = Y->t.dim32(1);
+    const int W_out = Y->t.dim32(2);
+    const int HW_out = H_out * W_out;
+    const int K = kernel_h() * kernel_w() * C_per_group;
+
+    const Requantization requantize(
+        static_cast<double>(X.scale) * W.scale / Y_scale_, Y_zero_point_, Ac);
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    const uint8_t* W_data = W.t.data<uint8_t>();
+    const int32_t* B_data = B.t.data<int32_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+
+    const bool is_1x1 = kernel_h() == 1 && kernel_w() == 1 &&
+        stride_h() == 1 && stride_w() == 1 && pad_t() == 0 && pad_l() == 0 &&
+        pad_b() == 0 && pad_r() == 0 && group_ == 1;
+    if (is_1x1) {
+      // Every input pixel is already an im2col row.
+      GemmNT(
+          N * HW_out,
+          M,
+          K,
+          X_data,
+          X.zero_point,
+          W_data,
+          W.zero_point,
+          B_data,
+          requantize,
+          Y_data,
+          M);
+      return true;
+    }
+
+    col_buffer_.resize(static_cast<size_t>(HW_out) * K);
+    for (int n = 0; n < N; ++n) {
+      const uint8_t* X_image = X_data + static_cast<size_t>(n) * H * W_in * C;
+      uint8_t* Y_image = Y_data + static_cast<size_t>(n) * HW_out * M;
+      for (int g = 0; g < group_; ++g) {
+        Im2Col(
+            X_image + g * C_per_group,
+            H,
+            W_in,
+            C,
+            C_per_group,
+            H_out,
+            W_out,
+            static_cast<uint8_t>(X.zero_point),
+            col_buffer_.data());
+        GemmNT(
+            HW_out,
+            M_per_group,
+            K,
+            col_buffer_.data(),
+            X.zero_point,
+            W_data + static_cast<size_t>(g) * M_per_group * K,
+            W.zero_point,
+            B_data + g * M_per_group,
+            requantize,
+            Y_image + g * M_per_group,
+            M);
+      }
+    }
+    return true;
+  }
+
+ private:
+  // Gathers the receptive field of every output pixel into one row of `col`,
+  // in (kernel_h, kernel_w, channel) order to match the filter layout.
+  void Im2Col(
+      const uint8_t* X,
+      int H,
+      int W,
+      int C,
+      int C_per_group,
+      int H_out,
+      int W_out,
+      uint8_t pad_value,
+      uint8_t* col) {
+    for (int h_out = 0; h_out < H_out; ++h_out) {
+      for (int w_out = 0; w_out < W_out; ++w_out) {
+        for (int kh = 0; kh < kernel_h(); ++kh) {
+          const int h = h_out * stride_h() - pad_t() + kh * dilation_h();
+          for (int kw = 0; kw < kernel_w(); ++kw) {
+            const int w = w_out * stride_w() - pad_l() + kw * dilation_w();
+            if (h >= 0 && h < H && w >= 0 && w < W) {
+              std::memcpy(col, X + (h * W + w) * C, C_per_group);
+            } else {
+              std::memset(col, pad_value, C_per_group);
+            }
+            col += C_per_group;
+          }
+        }
+      }
+    }
+  }
+
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  std::vector<uint8_t> col_buffer_;
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_CONV_OP_H_
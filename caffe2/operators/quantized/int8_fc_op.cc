@@ -0,0 +1,45 @@
+#include "caffe2/operators/quantized/int8_fc_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8FC, int8::Int8FCOp<int8::Activation::NONE>);
+REGISTER_CPU_OPERATOR(Int8FCRelu, int8::Int8FCOp<int8::Activation::RELU>);
+
+OPERATOR_SCHEMA(Int8FC)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .Arg("axis", "(int32_t) default to 1; describes the axis of the inputs")
+    .Arg("axis_w", "(int32_t) default to 1; describes the axis of the weights")
+    .SetDoc(R"DOC(
+Computes the result of passing an input vector X into a fully
+connected layer with 2D weight matrix W and 1D bias vector b. That is,
+the layer computes Y = X * W^T + b, where X has size (M x K),
+W has size (N x K), b has size (N), and Y has size (M x N).
+
+X and W are uint8 Int8 tensors, b is an int32 Int8 tensor with
+scale = X_scale * W_scale and zero_point = 0. Products are accumulated in
+int32 and requantized to (Y_scale, Y_zero_point) as they are produced.
+)DOC")
+    .Input(0, "X", "input tensor that's coerced into a 2D matrix of size (MxK)")
+    .Input(1, "W", "2D weight tensor of size (NxK)")
+    .Input(2, "b", "1D int32 bias tensor of size N")
+    .Output(0, "Y", "2D output tensor");
+
+OPERATOR_SCHEMA(Int8FCRelu)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .Arg("axis", "(int32_t) default to 1; describes the axis of the inputs")
+    .Arg("axis_w", "(int32_t) default to 1; describes the axis of the weights")
+    .SetDoc(R"DOC(
+Same as Int8FC, with a Relu fused into the requantization clamp.
+)DOC")
+    .Input(0, "X", "input tensor that's coerced into a 2D matrix of size (MxK)")
+    .Input(1, "W", "2D weight tensor of size (NxK)")
+    .Input(2, "b", "1D int32 bias tensor of size N")
+    .Output(0, "Y", "2D output tensor");
+
+} // namespace caffe2
@@ -0,0 +1,79 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_FC_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_FC_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+template <Activation Ac>
+class Int8FCOp final : public Operator<CPUContext> {
+ public:
+  Int8FCOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        axis_(OperatorBase::GetSingleArgument<int32_t>("axis", 1)),
+        axis_w_(OperatorBase::GetSingleArgument<int32_t>("axis_w", 1)),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    const auto& W = Inputs()[1]->Get<Int8TensorCPU>();
+    const auto& B = Inputs()[2]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+
+    const auto canonical_axis = X.t.canonical_axis_index(axis_);
+    const int N = X.t.size_to_dim(canonical_axis);
+    const int K = X.t.size_from_dim(canonical_axis);
+    const auto canonical_axis_w = W.t.canonical_axis_index(axis_w_);
+    const int M = W.t.size_to_dim(canonical_axis_w);
+    CAFFE_ENFORCE_EQ(
+        K,
+        W.t.size_from_dim(canonical_axis_w),
+        "Dimension mismatch between X and W");
+    CAFFE_ENFORCE_EQ(B.t.size(), M, "Dimension mismatch between B and W");
+    CAFFE_ENFORCE(
+        B.t.IsType<int32_t>() && B.zero_point == 0,
+        "Int8FC bias must be int32 with a zero point of 0");
+
+    vector<TIndex> Y_shape(
+        X.t.dims().cbegin(), X.t.dims().cbegin() + canonical_axis);
+    Y_shape.push_back(M);
+    Y->t.Resize(Y_shape);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+
+    const Requantization requantize(
+        static_cast<double>(X.scale) * W.scale / Y_scale_, Y_zero_point_, Ac);
+    GemmNT(
+        N,
+        M,
+        K,
+        X.t.data<uint8_t>(),
+        X.zero_point,
+        W.t.data<uint8_t>(),
+        W.zero_point,
+        B.t.data<int32_t>(),
+        requantize,
+        Y->t.mutable_data<uint8_t>(),
+        M);
+    return true;
+  }
+
+ private:
+  int32_t axis_;
+  int32_t axis_w_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_FC_OP_H_
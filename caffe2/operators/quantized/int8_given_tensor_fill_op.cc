@@ -0,0 +1,34 @@
+#include "caffe2/operators/quantized/int8_given_tensor_fill_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8GivenTensorFill, int8::Int8GivenTensorFillOp);
+REGISTER_CPU_OPERATOR(Int8GivenIntTensorFill, int8::Int8GivenIntTensorFillOp);
+
+OPERATOR_SCHEMA(Int8GivenTensorFill)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg("values", "Input array of type char(byte)")
+    .Arg("shape", "Input tensor shape")
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Creates uint8 tensor with given shape and quantization parameters, and fills
+it with the given values.
+)DOC");
+
+OPERATOR_SCHEMA(Int8GivenIntTensorFill)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg("values", "Input array of type int32")
+    .Arg("shape", "Input tensor shape")
+    .Arg("Y_scale", "Output tensor quantization scale")
+    .Arg("Y_zero_point", "Output tensor quantization offset")
+    .SetDoc(R"DOC(
+Creates quantized tensor of type int32 with scale and zero point info.
+)DOC");
+
+NO_GRADIENT(Int8GivenTensorFill);
+NO_GRADIENT(Int8GivenIntTensorFill);
+
+} // namespace caffe2
@@ -0,0 +1,77 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_GIVEN_TENSOR_FILL_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_GIVEN_TENSOR_FILL_OP_H_
+
+#include <cstring>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// Creates an Int8TensorCPU of uint8 values from the raw bytes of the
+// "values" string argument. Used to feed quantized weights into a net.
+class Int8GivenTensorFillOp final : public Operator<CPUContext> {
+ public:
+  Int8GivenTensorFillOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        zero_point_(OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)),
+        shape_(OperatorBase::GetRepeatedArgument<TIndex>("shape")),
+        values_(OperatorBase::GetSingleArgument<string>("values", "")) {}
+
+  bool RunOnDevice() override {
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    Y->t.Resize(shape_);
+    CAFFE_ENFORCE_EQ(
+        Y->t.size(), values_.size(), "Shape does not match the given values");
+    Y->scale = scale_;
+    Y->zero_point = zero_point_;
+    std::memcpy(Y->t.mutable_data<uint8_t>(), values_.data(), values_.size());
+    return true;
+  }
+
+ private:
+  float scale_;
+  int32_t zero_point_;
+  vector<TIndex> shape_;
+  string values_;
+};
+
+// Same as Int8GivenTensorFill for int32 values, e.g. Int8FC and Int8Conv
+// biases.
+class Int8GivenIntTensorFillOp final : public Operator<CPUContext> {
+ public:
+  Int8GivenIntTensorFillOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        zero_point_(OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)),
+        shape_(OperatorBase::GetRepeatedArgument<TIndex>("shape")),
+        values_(OperatorBase::GetRepeatedArgument<int32_t>("values")) {}
+
+  bool RunOnDevice() override {
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    Y->t.Resize(shape_);
+    CAFFE_ENFORCE_EQ(
+        Y->t.size(), values_.size(), "Shape does not match the given values");
+    Y->scale = scale_;
+    Y->zero_point = zero_point_;
+    std::copy(
+        values_.begin(), values_.end(), Y->t.mutable_data<int32_t>());
+    return true;
+  }
+
+ private:
+  float scale_;
+  int32_t zero_point_;
+  vector<TIndex> shape_;
+  vector<int32_t> values_;
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_GIVEN_TENSOR_FILL_OP_H_
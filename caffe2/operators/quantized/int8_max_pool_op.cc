@@ -0,0 +1,19 @@
+#include "caffe2/operators/quantized/int8_max_pool_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8MaxPool, int8::Int8MaxPoolOp);
+
+OPERATOR_SCHEMA(Int8MaxPool)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+MaxPool consumes an input blob X in NHWC order and applies max pooling across
+the blob according to kernel sizes, stride sizes, and pad lengths defined by
+the ConvPoolOpBase operator. The output has the same quantization parameters
+as the input.
+)DOC")
+    .Input(0, "X", "Int8 input tensor of shape (N, H, W, C).")
+    .Output(0, "Y", "Int8 output tensor of shape (N, H_out, W_out, C).");
+
+} // namespace caffe2
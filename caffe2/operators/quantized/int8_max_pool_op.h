@@ -0,0 +1,74 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_MAX_POOL_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_MAX_POOL_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// Max is monotonic in the quantized value, so the output keeps the input
+// quantization parameters. The NHWC layout lets the channel loop run over
+// contiguous bytes, which compiles to packed unsigned byte max.
+class Int8MaxPoolOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8MaxPoolOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws) {
+    OPERATOR_NEEDS_FEATURE(
+        this->order_ == StorageOrder::NHWC,
+        "Int8MaxPool only supports NHWC order");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+    const int N = X.t.dim32(0);
+    const int H = X.t.dim32(1);
+    const int W = X.t.dim32(2);
+    const int C = X.t.dim32(3);
+    ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), C);
+    Y->scale = X.scale;
+    Y->zero_point = X.zero_point;
+    const int H_out = Y->t.dim32(1);
+    const int W_out = Y->t.dim32(2);
+
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    for (int n = 0; n < N; ++n) {
+      const uint8_t* X_image = X_data + static_cast<size_t>(n) * H * W * C;
+      for (int h_out = 0; h_out < H_out; ++h_out) {
+        const int h_start = std::max(h_out * stride_h() - pad_t(), 0);
+        const int h_end =
+            std::min(h_out * stride_h() - pad_t() + kernel_h(), H);
+        for (int w_out = 0; w_out < W_out; ++w_out) {
+          const int w_start = std::max(w_out * stride_w() - pad_l(), 0);
+          const int w_end =
+              std::min(w_out * stride_w() - pad_l() + kernel_w(), W);
+          std::fill(Y_data, Y_data + C, 0);
+          for (int h = h_start; h < h_end; ++h) {
+            for (int w = w_start; w < w_end; ++w) {
+              const uint8_t* x = X_image + (h * W + w) * C;
+              for (int c = 0; c < C; ++c) {
+                Y_data[c] = std::max(Y_data[c], x[c]);
+              }
+            }
+          }
+          Y_data += C;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_MAX_POOL_OP_H_
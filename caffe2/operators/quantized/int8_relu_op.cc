@@ -0,0 +1,21 @@
+#include "caffe2/operators/quantized/int8_relu_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Relu, int8::Int8ReluOp);
+
+OPERATOR_SCHEMA(Int8Relu)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .IdenticalTypeAndShape()
+    .SetDoc(R"DOC(
+Relu takes one input data (Tensor) and produces one output data
+(Tensor) where the rectified linear function, y = max(0, x), is applied to
+the tensor elementwise. The output has the same quantization parameters as
+the input.
+)DOC")
+    .Input(0, "X", "Int8 Tensor X.")
+    .Output(0, "Y", "Int8 Tensor Y.");
+
+} // namespace caffe2
@@ -0,0 +1,51 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_RELU_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_RELU_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// Relu is a clamp at the zero point, so the output keeps the input
+// quantization parameters and no requantization is needed.
+class Int8ReluOp final : public Operator<CPUContext> {
+ public:
+  Int8ReluOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+
+  bool RunOnDevice() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    Y->t.ResizeLike(X.t);
+    Y->scale = X.scale;
+    Y->zero_point = X.zero_point;
+    const uint8_t* X_data = X.t.data<uint8_t>();
+    uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+    const uint8_t zero = static_cast<uint8_t>(X.zero_point);
+    const TIndex n = X.t.size();
+    TIndex i = 0;
+#ifdef __SSE2__
+    const __m128i vzero = _mm_set1_epi8(static_cast<char>(zero));
+    for (; i + 16 <= n; i += 16) {
+      const __m128i vx =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(X_data + i));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(Y_data + i), _mm_max_epu8(vx, vzero));
+    }
+#endif
+    for (; i < n; ++i) {
+      Y_data[i] = std::max(X_data[i], zero);
+    }
+    return true;
+  }
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_RELU_OP_H_
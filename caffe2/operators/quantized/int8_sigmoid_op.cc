@@ -0,0 +1,27 @@
+#include "caffe2/operators/quantized/int8_sigmoid_op.h"
+
+namespace caffe2 {
+
+REGISTER_CPU_OPERATOR(Int8Sigmoid, int8::Int8SigmoidOp);
+
+OPERATOR_SCHEMA(Int8Sigmoid)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .IdenticalTypeAndShape()
+    .Arg("Y_scale", "Output tensor quantization scale (default 1/256)")
+    .Arg("Y_zero_point", "Output tensor quantization offset (default 0)")
+    .SetDoc(R"DOC(
+Apply the Sigmoid function element-wise to the input tensor. This is often used
+as a non-linear activation function in a neural network. The sigmoid function
+is defined as:
+
+$$Sigmoid(x) = \frac{1}{1+\exp(-x)}$$
+
+The output is computed through a 256-entry lookup table on the quantized
+input values.
+)DOC")
+    .Input(0, "X", "Int8 Tensor X.")
+    .Output(0, "Y", "Int8 Tensor Y.");
+
+} // namespace caffe2
@@ -0,0 +1,65 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_SIGMOID_OP_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_SIGMOID_OP_H_
+
+#include <cmath>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+namespace int8 {
+
+// A uint8 input can only take 256 values, so sigmoid is evaluated once per
+// value into a lookup table that is rebuilt only when the input quantization
+// changes.
+class Int8SigmoidOp final : public Operator<CPUContext> {
+ public:
+  Int8SigmoidOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        Y_scale_(
+            OperatorBase::GetSingleArgument<float>("Y_scale", 1.0f / 256.0f)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override {
+    const auto& X = Inputs()[0]->Get<Int8TensorCPU>();
+    if (X.scale != table_scale_ || X.zero_point != table_zero_point_) {
+      BuildLookupTable(
+          X.scale,
+          X.zero_point,
+          Y_scale_,
+          Y_zero_point_,
+          [](float x) { return 1.0f / (1.0f + std::exp(-x)); },
+          table_);
+      table_scale_ = X.scale;
+      table_zero_point_ = X.zero_point;
+    }
+    // Set after reading X's parameters, since Y may alias X.
+    auto* Y = Outputs()[0]->GetMutable<Int8TensorCPU>();
+    Y->t.ResizeLike(X.t);
+    Y->scale = Y_scale_;
+    Y->zero_point = Y_zero_point_;
+    LookupTable(
+        table_,
+        X.t.data<uint8_t>(),
+        X.t.size(),
+        Y->t.mutable_data<uint8_t>());
+    return true;
+  }
+
+ private:
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  float table_scale_{0};
+  int32_t table_zero_point_{-1};
+  uint8_t table_[256];
+};
+
+} // namespace int8
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_SIGMOID_OP_H_
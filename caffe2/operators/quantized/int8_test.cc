@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+namespace {
+
+void RandomInt8(
+    Workspace* ws,
+    const string& name,
+    const vector<TIndex>& dims,
+    float scale,
+    int32_t zero_point) {
+  static std::mt19937 gen(2018);
+  std::uniform_int_distribution<int> dist(0, 255);
+  auto* t = ws->CreateBlob(name)->GetMutable<int8::Int8TensorCPU>();
+  t->t.Resize(dims);
+  t->scale = scale;
+  t->zero_point = zero_point;
+  uint8_t* data = t->t.mutable_data<uint8_t>();
+  for (TIndex i = 0; i < t->t.size(); ++i) {
+    data[i] = dist(gen);
+  }
+}
+
+// Int32 bias, stored along with its float equivalent in `float_name`.
+void RandomBias(
+    Workspace* ws,
+    const string& name,
+    const string& float_name,
+    TIndex size,
+    float scale) {
+  static std::mt19937 gen(2019);
+  std::uniform_int_distribution<int32_t> dist(-1000, 1000);
+  auto* t = ws->CreateBlob(name)->GetMutable<int8::Int8TensorCPU>();
+  t->t.Resize(size);
+  t->scale = scale;
+  t->zero_point = 0;
+  auto* f = ws->CreateBlob(float_name)->GetMutable<TensorCPU>();
+  f->Resize(size);
+  int32_t* data = t->t.mutable_data<int32_t>();
+  float* float_data = f->mutable_data<float>();
+  for (TIndex i = 0; i < size; ++i) {
+    data[i] = dist(gen);
+    float_data[i] = data[i] * scale;
+  }
+}
+
+void RunOp(
+    Workspace* ws,
+    const string& type,
+    const vector<string>& inputs,
+    const vector<string>& outputs,
+    const vector<Argument>& args = {}) {
+  const auto def = CreateOperatorDef(type, "", inputs, outputs, args);
+  unique_ptr<OperatorBase> op(CreateOperator(def, ws));
+  EXPECT_NE(nullptr, op.get());
+  EXPECT_TRUE(op->Run());
+}
+
+void Dequantize(Workspace* ws, const string& name) {
+  RunOp(ws, "Int8Dequantize", {name}, {name + "_f"});
+}
+
+// Quantizes the float reference `ref` with the parameters of the int8 result
+// `out` and checks that they differ by at most one step.
+void ExpectNear(Workspace* ws, const string& out, const string& ref) {
+  const auto& Y = ws->GetBlob(out)->Get<int8::Int8TensorCPU>();
+  RunOp(
+      ws,
+      "Int8Quantize",
+      {ref},
+      {ref + "_q"},
+      {MakeArgument<float>("Y_scale", Y.scale),
+       MakeArgument<int>("Y_zero_point", Y.zero_point)});
+  const auto& Y_ref = ws->GetBlob(ref + "_q")->Get<int8::Int8TensorCPU>();
+  ASSERT_EQ(Y.t.dims(), Y_ref.t.dims());
+  const uint8_t* y = Y.t.data<uint8_t>();
+  const uint8_t* y_ref = Y_ref.t.data<uint8_t>();
+  for (TIndex i = 0; i < Y.t.size(); ++i) {
+    EXPECT_NEAR(y[i], y_ref[i], 1) << "at index " << i;
+  }
+}
+
+} // namespace
+
+TEST(Int8, QuantizeDequantize) {
+  Workspace ws;
+  RandomInt8(&ws, "X", {2, 3, 4, 5}, 0.5, 100);
+  Dequantize(&ws, "X");
+  RunOp(
+      &ws,
+      "Int8Quantize",
+      {"X_f"},
+      {"Y"},
+      {MakeArgument<float>("Y_scale", 0.5),
+       MakeArgument<int>("Y_zero_point", 100)});
+  const auto& X = ws.GetBlob("X")->Get<int8::Int8TensorCPU>();
+  const auto& Y = ws.GetBlob("Y")->Get<int8::Int8TensorCPU>();
+  for (TIndex i = 0; i < X.t.size(); ++i) {
+    EXPECT_EQ(X.t.data<uint8_t>()[i], Y.t.data<uint8_t>()[i]);
+  }
+}
+
+TEST(Int8, Conv) {
+  for (const int kernel : {1, 3}) {
+    Workspace ws;
+    RandomInt8(&ws, "X", {2, 9, 10, 8}, 0.02, 120);
+    RandomInt8(&ws, "W", {6, kernel, kernel, 8}, 0.01, 130);
+    RandomBias(&ws, "B", "B_f", 6, 0.02 * 0.01);
+    Dequantize(&ws, "X");
+    Dequantize(&ws, "W");
+    const vector<Argument> args = {
+        MakeArgument<int>("kernel", kernel),
+        MakeArgument<int>("stride", kernel == 3 ? 2 : 1),
+        MakeArgument<int>("pad", kernel / 2),
+        MakeArgument<string>("order", "NHWC")};
+    vector<Argument> int8_args = args;
+    int8_args.push_back(MakeArgument<float>("Y_scale", 0.05));
+    int8_args.push_back(MakeArgument<int>("Y_zero_point", 10));
+    RunOp(&ws, "Int8Conv", {"X", "W", "B"}, {"Y"}, int8_args);
+    RunOp(&ws, "Conv", {"X_f", "W_f", "B_f"}, {"Y_ref"}, args);
+    ExpectNear(&ws, "Y", "Y_ref");
+  }
+}
+
+TEST(Int8, ConvRelu) {
+  Workspace ws;
+  RandomInt8(&ws, "X", {1, 7, 7, 4}, 0.02, 120);
+  RandomInt8(&ws, "W", {5, 3, 3, 4}, 0.01, 130);
+  RandomBias(&ws, "B", "B_f", 5, 0.02 * 0.01);
+  Dequantize(&ws, "X");
+  Dequantize(&ws, "W");
+  const vector<Argument> args = {MakeArgument<int>("kernel", 3),
+                                 MakeArgument<string>("order", "NHWC")};
+  vector<Argument> int8_args = args;
+  int8_args.push_back(MakeArgument<float>("Y_scale", 0.05));
+  int8_args.push_back(MakeArgument<int>("Y_zero_point", 128));
+  RunOp(&ws, "Int8ConvRelu", {"X", "W", "B"}, {"Y"}, int8_args);
+  RunOp(&ws, "Conv", {"X_f", "W_f", "B_f"}, {"Y_conv"}, args);
+  RunOp(&ws, "Relu", {"Y_conv"}, {"Y_ref"});
+  ExpectNear(&ws, "Y", "Y_ref");
+}
+
+TEST(Int8, FC) {
+  Workspace ws;
+  RandomInt8(&ws, "X", {5, 37}, 0.02, 120);
+  RandomInt8(&ws, "W", {11, 37}, 0.01, 130);
+  RandomBias(&ws, "B", "B_f", 11, 0.02 * 0.01);
+  Dequantize(&ws, "X");
+  Dequantize(&ws, "W");
+  RunOp(
+      &ws,
+      "Int8FC",
+      {"X", "W", "B"},
+      {"Y"},
+      {MakeArgument<float>("Y_scale", 0.1),
+       MakeArgument<int>("Y_zero_point", 128)});
+  RunOp(&ws, "FC", {"X_f", "W_f", "B_f"}, {"Y_ref"});
+  ExpectNear(&ws, "Y", "Y_ref");
+}
+
+TEST(Int8, Add) {
+  Workspace ws;
+  RandomInt8(&ws, "A", {3, 4, 5, 6}, 0.03, 100);
+  RandomInt8(&ws, "B", {3, 4, 5, 6}, 0.05, 140);
+  Dequantize(&ws, "A");
+  Dequantize(&ws, "B");
+  RunOp(
+      &ws,
+      "Int8Add",
+      {"A", "B"},
+      {"Y"},
+      {MakeArgument<float>("Y_scale", 0.08),
+       MakeArgument<int>("Y_zero_point", 128)});
+  RunOp(&ws, "Add", {"A_f", "B_f"}, {"Y_ref"});
+  ExpectNear(&ws, "Y", "Y_ref");
+}
+
+TEST(Int8, Relu) {
+  Workspace ws;
+  RandomInt8(&ws, "X", {3, 41}, 0.03, 100);
+  Dequantize(&ws, "X");
+  RunOp(&ws, "Int8Relu", {"X"}, {"Y"});
+  RunOp(&ws, "Relu", {"X_f"}, {"Y_ref"});
+  ExpectNear(&ws, "Y", "Y_ref");
+}
+
+TEST(Int8, Sigmoid) {
+  Workspace ws;
+  RandomInt8(&ws, "X", {3, 41}, 0.05, 128);
+  Dequantize(&ws, "X");
+  RunOp(&ws, "Int8Sigmoid", {"X"}, {"Y"});
+  RunOp(&ws, "Sigmoid", {"X_f"}, {"Y_ref"});
+  ExpectNear(&ws, "Y", "Y_ref");
+}
+
+TEST(Int8, Pool) {
+  for (const char* type : {"MaxPool", "AveragePool"}) {
+    Workspace ws;
+    RandomInt8(&ws, "X", {2, 9, 10, 16}, 0.02, 120);
+    Dequantize(&ws, "X");
+    const vector<Argument> args = {MakeArgument<int>("kernel", 3),
+                                   MakeArgument<int>("stride", 2),
+                                   MakeArgument<int>("pad", 1),
+                                   MakeArgument<string>("order", "NHWC")};
+    vector<Argument> int8_args = args;
+    int8_args.push_back(MakeArgument<float>("Y_scale", 0.02));
+    int8_args.push_back(MakeArgument<int>("Y_zero_point", 120));
+    RunOp(&ws, string("Int8") + type, {"X"}, {"Y"}, int8_args);
+    RunOp(&ws, type, {"X_f"}, {"Y_ref"}, args);
+    ExpectNear(&ws, "Y", "Y_ref");
+  }
+}
+
+TEST(Int8, Concat) {
+  Workspace ws;
+  RandomInt8(&ws, "A", {2, 3, 4, 5}, 0.02, 120);
+  RandomInt8(&ws, "B", {2, 3, 4, 7}, 0.03, 100);
+  Dequantize(&ws, "A");
+  Dequantize(&ws, "B");
+  RunOp(
+      &ws,
+      "Int8Concat",
+      {"A", "B"},
+      {"Y"},
+      {MakeArgument<float>("Y_scale", 0.02),
+       MakeArgument<int>("Y_zero_point", 120)});
+  RunOp(
+      &ws,
+      "Concat",
+      {"A_f", "B_f"},
+      {"Y_ref", "split"},
+      {MakeArgument<string>("order", "NHWC")});
+  ExpectNear(&ws, "Y", "Y_ref");
+}
+
+} // namespace caffe2
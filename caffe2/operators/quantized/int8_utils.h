@@ -0,0 +1,231 @@
+#ifndef CAFFE2_OPERATORS_QUANTIZED_INT8_UTILS_H_
+#define CAFFE2_OPERATORS_QUANTIZED_INT8_UTILS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/tensor_int8.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Quantization scheme shared by all Int8* operators:
+//
+//   real_value = scale * (quantized_value - zero_point)
+//
+// Activations and weights are stored as uint8_t, biases as int32_t with
+// scale = X_scale * W_scale and zero_point = 0. Kernels accumulate products
+// of zero-point-adjusted operands in int32_t and requantize the accumulator
+// to the output scale with a fixed-point multiplier in the epilogue, so no
+// float math is done in the inner loops.
+
+enum class Activation : uint8_t { NONE = 0, RELU = 1 };
+
+// Same as the rounding used by gemmlowp / TFLite: the high 32 bits of 2*a*b,
+// rounded to nearest.
+inline int32_t SaturatingRoundingDoublingHighMul(int32_t a, int32_t b) {
+  const bool overflow = a == b && a == std::numeric_limits<int32_t>::min();
+  const int64_t ab_64 = static_cast<int64_t>(a) * static_cast<int64_t>(b);
+  const int32_t nudge = ab_64 >= 0 ? (1 << 30) : (1 - (1 << 30));
+  const int32_t ab_x2_high32 =
+      static_cast<int32_t>((ab_64 + nudge) / (1ll << 31));
+  return overflow ? std::numeric_limits<int32_t>::max() : ab_x2_high32;
+}
+
+inline int32_t RoundingDivideByPOT(int32_t x, int exponent) {
+  DCHECK_GE(exponent, 0);
+  DCHECK_LE(exponent, 31);
+  const int32_t mask = (1ll << exponent) - 1;
+  const int32_t remainder = x & mask;
+  const int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+inline int32_t MultiplyByQuantizedMultiplierSmallerThanOne(
+    int32_t x,
+    int32_t quantized_multiplier,
+    int right_shift) {
+  return RoundingDivideByPOT(
+      SaturatingRoundingDoublingHighMul(x, quantized_multiplier), right_shift);
+}
+
+// Decomposes a real multiplier in (0, 1) into a Q31 fixed-point multiplier
+// and a right shift, such that
+//   real_multiplier ~= quantized_multiplier * 2^(-31 - right_shift).
+inline void QuantizeMultiplierSmallerThanOne(
+    double real_multiplier,
+    int32_t* quantized_multiplier,
+    int* right_shift) {
+  CAFFE_ENFORCE(
+      real_multiplier > 0.0 && real_multiplier < 1.0,
+      "Requantization multiplier must be in (0, 1), got ",
+      real_multiplier);
+  int s = 0;
+  // Bring the real multiplier into [1/2, 1).
+  while (real_multiplier < 0.5) {
+    real_multiplier *= 2.0;
+    s++;
+  }
+  int64_t q = static_cast<int64_t>(std::round(real_multiplier * (1ll << 31)));
+  DCHECK_LE(q, 1ll << 31);
+  // Rounding may have produced exactly 2^31.
+  if (q == (1ll << 31)) {
+    q /= 2;
+    s--;
+  }
+  CAFFE_ENFORCE_GE(s, 0);
+  // Multipliers this small round every accumulator to zero anyway.
+  if (s > 31) {
+    s = 31;
+    q = 0;
+  }
+  *quantized_multiplier = static_cast<int32_t>(q);
+  *right_shift = s;
+}
+
+// Fixed-point requantization of an int32_t accumulator to uint8_t, fused with
+// the output zero point and activation clamp.
+struct Requantization {
+  int32_t multiplier{0};
+  int shift{0};
+  int32_t zero_point{0};
+  int32_t qmin{0};
+  int32_t qmax{255};
+
+  Requantization() {}
+
+  Requantization(
+      double real_multiplier,
+      int32_t output_zero_point,
+      Activation activation = Activation::NONE)
+      : zero_point(output_zero_point) {
+    QuantizeMultiplierSmallerThanOne(real_multiplier, &multiplier, &shift);
+    qmin = activation == Activation::RELU ? output_zero_point : 0;
+    qmax = 255;
+  }
+
+  inline uint8_t operator()(int32_t acc) const {
+    const int32_t v =
+        MultiplyByQuantizedMultiplierSmallerThanOne(acc, multiplier, shift) +
+        zero_point;
+    return static_cast<uint8_t>(std::min(std::max(v, qmin), qmax));
+  }
+};
+
+inline uint8_t QuantizeUint8(float scale, int32_t zero_point, float value) {
+  const int32_t qmin = std::numeric_limits<uint8_t>::min();
+  const int32_t qmax = std::numeric_limits<uint8_t>::max();
+  const int32_t q =
+      static_cast<int32_t>(std::nearbyint(value / scale)) + zero_point;
+  return static_cast<uint8_t>(std::min(std::max(q, qmin), qmax));
+}
+
+// int32_t dot product of two uint8_t vectors after subtracting their zero
+// points. Operands are widened to 16 bits in registers; since the adjusted
+// values fit in 9 bits, the pairwise sums computed by pmaddwd cannot
+// overflow.
+inline int32_t Dot(
+    const uint8_t* a,
+    int32_t a_zero_point,
+    const uint8_t* b,
+    int32_t b_zero_point,
+    int n) {
+  int i = 0;
+  int32_t acc = 0;
+#ifdef __SSE2__
+  const __m128i vzero = _mm_setzero_si128();
+  const __m128i va_zero_point =
+      _mm_set1_epi16(static_cast<int16_t>(a_zero_point));
+  const __m128i vb_zero_point =
+      _mm_set1_epi16(static_cast<int16_t>(b_zero_point));
+  __m128i vacc = _mm_setzero_si128();
+  for (; i + 8 <= n; i += 8) {
+    const __m128i va = _mm_sub_epi16(
+        _mm_unpacklo_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i)), vzero),
+        va_zero_point);
+    const __m128i vb = _mm_sub_epi16(
+        _mm_unpacklo_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i)), vzero),
+        vb_zero_point);
+    vacc = _mm_add_epi32(vacc, _mm_madd_epi16(va, vb));
+  }
+  vacc =
+      _mm_add_epi32(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(1, 0, 3, 2)));
+  vacc =
+      _mm_add_epi32(vacc, _mm_shuffle_epi32(vacc, _MM_SHUFFLE(2, 3, 0, 1)));
+  acc = _mm_cvtsi128_si32(vacc);
+#endif
+  for (; i < n; ++i) {
+    acc += (static_cast<int32_t>(a[i]) - a_zero_point) *
+        (static_cast<int32_t>(b[i]) - b_zero_point);
+  }
+  return acc;
+}
+
+// Computes Y[m, n] = requantize(dot(A[m, :], B[n, :]) + bias[n]) for
+// row-major uint8_t A (M x K) and B (N x K), i.e. Y = A * B^T. Requantization
+// is applied to each accumulator as soon as it is produced, so the int32_t
+// result never goes back to memory.
+inline void GemmNT(
+    int M,
+    int N,
+    int K,
+    const uint8_t* A,
+    int32_t A_zero_point,
+    const uint8_t* B,
+    int32_t B_zero_point,
+    const int32_t* bias,
+    const Requantization& requantize,
+    uint8_t* Y,
+    int ldy) {
+  for (int m = 0; m < M; ++m) {
+    const uint8_t* a = A + m * K;
+    uint8_t* y = Y + m * ldy;
+    for (int n = 0; n < N; ++n) {
+      int32_t acc = Dot(a, A_zero_point, B + n * K, B_zero_point, K);
+      if (bias) {
+        acc += bias[n];
+      }
+      y[n] = requantize(acc);
+    }
+  }
+}
+
+// Builds a 256-entry lookup table mapping every uint8_t input to the output
+// quantization through `f`, which operates on real values.
+template <typename F>
+inline void BuildLookupTable(
+    float X_scale,
+    int32_t X_zero_point,
+    float Y_scale,
+    int32_t Y_zero_point,
+    F f,
+    uint8_t* table) {
+  for (int i = 0; i < 256; ++i) {
+    const float x = X_scale * static_cast<float>(i - X_zero_point);
+    table[i] = QuantizeUint8(Y_scale, Y_zero_point, f(x));
+  }
+}
+
+inline void LookupTable(
+    const uint8_t* table,
+    const uint8_t* X,
+    int n,
+    uint8_t* Y) {
+  for (int i = 0; i < n; ++i) {
+    Y[i] = table[X[i]];
+  }
+}
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_QUANTIZED_INT8_UTILS_H_
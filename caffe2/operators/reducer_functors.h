@@ -3,6 +3,7 @@
 #define CAFFE2_OPERATORS_RECUDER_FUNCTORS_H_
 
 #include <array>
+#include <limits>
 
 #include "caffe2/core/context.h"
 #include "caffe2/core/tensor.h"
@@ -16,6 +17,18 @@ namespace caffe2 {
 // special implementation
 ////////////////////////////////////////////////////////////////////////////////
 
+// Element-wise max of the slices of `in`, which is never below lowest(), as
+// with a running max starting there. Empty and all -inf segments thus have a
+// finite max, and x - max is never (-inf) - (-inf).
+template <typename T>
+Eigen::Array<T, Eigen::Dynamic, 1> RangeMax(const ConstEigenArrayMap<T>& in) {
+  if (in.cols() == 0) {
+    return Eigen::Array<T, Eigen::Dynamic, 1>::Constant(
+        in.rows(), std::numeric_limits<T>::lowest());
+  }
+  return in.rowwise().maxCoeff().max(std::numeric_limits<T>::lowest());
+}
+
 // Put forward and backward in the same template?
 template <typename T, class Context>
 class SumRangeReducer;
@@ -82,17 +95,11 @@ class LogSumExpRangeReducer<T, CPUContext> {
       const T* in,
       T* out,
       CPUContext* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      T max_value = std::numeric_limits<T>::lowest();
-      for (int i = 0; i < blocks; ++i) {
-        max_value = std::max(max_value, in[i * block_size + j]);
-      }
-      T scaled_exp_sum = 0;
-      for (int i = 0; i < blocks; ++i) {
-        scaled_exp_sum += std::exp(in[i * block_size + j] - max_value);
-      }
-      *(out++) = std::log(scaled_exp_sum) + max_value;
-    }
+    // Work on whole slices, so that every step vectorizes along block_size
+    ConstEigenArrayMap<T> in_arr(in, block_size, blocks);
+    const Eigen::Array<T, Eigen::Dynamic, 1> max_value = RangeMax(in_arr);
+    EigenVectorArrayMap<T>(out, block_size) =
+        (in_arr.colwise() - max_value).exp().rowwise().sum().log() + max_value;
   }
   T r{1};
 };
@@ -108,14 +115,13 @@ class LogSumExpRangeReducerGradient {
       const T* data_in, // I
       const T* data_out, // O
       Context* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      const T out_grad = *(segment_grad++);
-      const T offset = *(data_out++);
-      for (int i = 0; i < blocks; ++i) {
-        auto idx = i * block_size + j;
-        data_grad[idx] = out_grad * std::exp(data_in[idx] - offset);
-      }
-    }
+    ConstEigenVectorArrayMap<T> out_grad(segment_grad, block_size);
+    ConstEigenVectorArrayMap<T> offset(data_out, block_size);
+    EigenArrayMap<T>(data_grad, block_size, blocks) =
+        (ConstEigenArrayMap<T>(data_in, block_size, blocks).colwise() - offset)
+            .exp()
+            .colwise() *
+        out_grad;
   }
 };
 
@@ -144,18 +150,11 @@ class LogMeanExpRangeReducer<T, CPUContext> {
       const T* in,
       T* out,
       CPUContext* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      T max_value = std::numeric_limits<T>::lowest();
-      for (int i = 0; i < blocks; ++i) {
-        max_value = std::max(max_value, in[i * block_size + j]);
-      }
-      T scaled_exp_sum = 0;
-      for (int i = 0; i < blocks; ++i) {
-        scaled_exp_sum += std::exp(in[i * block_size + j] - max_value);
-      }
-      scaled_exp_sum /= blocks;
-      *(out++) = std::log(scaled_exp_sum) + max_value;
-    }
+    ConstEigenArrayMap<T> in_arr(in, block_size, blocks);
+    const Eigen::Array<T, Eigen::Dynamic, 1> max_value = RangeMax(in_arr);
+    EigenVectorArrayMap<T>(out, block_size) =
+        (in_arr.colwise() - max_value).exp().rowwise().mean().log() +
+        max_value;
   }
 };
 
@@ -170,14 +169,14 @@ class LogMeanExpRangeReducerGradient {
       const T* data_in, // I
       const T* data_out, // O
       Context* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      const T out_grad = *(segment_grad++);
-      const T offset = *(data_out++);
-      for (int i = 0; i < blocks; ++i) {
-        auto idx = i * block_size + j;
-        data_grad[idx] = out_grad * std::exp(data_in[idx] - offset) / blocks;
-      }
-    }
+    const Eigen::Array<T, Eigen::Dynamic, 1> out_grad =
+        ConstEigenVectorArrayMap<T>(segment_grad, block_size) / blocks;
+    ConstEigenVectorArrayMap<T> offset(data_out, block_size);
+    EigenArrayMap<T>(data_grad, block_size, blocks) =
+        (ConstEigenArrayMap<T>(data_in, block_size, blocks).colwise() - offset)
+            .exp()
+            .colwise() *
+        out_grad;
   }
 };
 
@@ -206,13 +205,8 @@ class MeanRangeReducer<T, CPUContext> {
       const T* in,
       T* out,
       CPUContext* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      T avg_value = 0;
-      for (int i = 0; i < blocks; ++i) {
-        avg_value += in[i * block_size + j] / blocks;
-      }
-      *(out++) = avg_value;
-    }
+    EigenVectorArrayMap<T>(out, block_size) =
+        ConstEigenArrayMap<T>(in, block_size, blocks).rowwise().mean();
   }
 };
 
@@ -227,13 +221,10 @@ class MeanRangeReducerGradient {
       const T* /*data_in*/, // I
       const T* /*data_out*/, // O
       Context* /*context*/) {
-    const auto in_grad = 1.0 / blocks;
-    for (int j = 0; j < block_size; ++j) {
-      const T out_grad = *(segment_grad++);
-      for (int i = 0; i < blocks; ++i) {
-        auto idx = i * block_size + j;
-        data_grad[idx] = out_grad * in_grad;
-      }
+    const Eigen::Array<T, Eigen::Dynamic, 1> in_grad =
+        ConstEigenVectorArrayMap<T>(segment_grad, block_size) / blocks;
+    for (TIndex i = 0; i < blocks; ++i) {
+      EigenVectorArrayMap<T>(data_grad + block_size * i, block_size) = in_grad;
     }
   }
 };
@@ -265,13 +256,8 @@ class MaxRangeReducer<T, CPUContext> {
       const T* in,
       T* out,
       CPUContext* /*context*/) {
-    for (int j = 0; j < block_size; ++j) {
-      T max_value = std::numeric_limits<T>::lowest();
-      for (int i = 0; i < blocks; ++i) {
-        max_value = std::max(max_value, in[i * block_size + j]);
-      }
-      *(out++) = max_value;
-    }
+    EigenVectorArrayMap<T>(out, block_size) =
+        RangeMax(ConstEigenArrayMap<T>(in, block_size, blocks));
   }
 };
 
@@ -286,17 +272,13 @@ class MaxRangeReducerGradient {
       const T* data_in, // I
       const T* data_out, // O
       Context* /*context*/) {
-    std::memset(
-        static_cast<void*>(data_grad), 0, blocks * block_size * sizeof(T));
-    for (int j = 0; j < block_size; ++j) {
-      const T out_grad = *(segment_grad++);
-      const T out = data_out[j];
-      for (int i = 0; i < blocks; ++i) {
-        auto idx = i * block_size + j;
-        if (out == data_in[idx]) {
-          data_grad[idx] = out_grad;
-        }
-      }
+    ConstEigenVectorArrayMap<T> out_grad(segment_grad, block_size);
+    ConstEigenVectorArrayMap<T> out(data_out, block_size);
+    for (TIndex i = 0; i < blocks; ++i) {
+      EigenVectorArrayMap<T>(data_grad + block_size * i, block_size) =
+          (ConstEigenVectorArrayMap<T>(data_in + block_size * i, block_size) ==
+           out)
+              .select(out_grad, T(0));
     }
   }
 };
@@ -818,9 +800,10 @@ class MaxReducerGradient : public BaseReducerGradient {
       TIndex /*offset*/,
       Context* /*context*/,
       const int /*length*/) {
-    for (TIndex i = 0; i < meta.block_size; ++i) {
-      data_grad[i] = data[i] == forward_output[i] ? s_grad_[i] : 0;
-    }
+    EigenVectorArrayMap<T>(data_grad, meta.block_size) =
+        (ConstEigenVectorArrayMap<T>(data, meta.block_size) ==
+         ConstEigenVectorArrayMap<T>(forward_output, meta.block_size))
+            .select(ConstEigenVectorArrayMap<T>(s_grad_, meta.block_size), T(0));
   }
 
  private:
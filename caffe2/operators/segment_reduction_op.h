@@ -1,10 +1,13 @@
 #ifndef CAFFE2_OPERATORS_SEGMENT_REDUCTION_OP_H_
 #define CAFFE2_OPERATORS_SEGMENT_REDUCTION_OP_H_
 
+#include <algorithm>
+
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/operators/reducer_functors.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
 
 namespace caffe2 {
 
@@ -27,6 +30,80 @@ class BaseInputAccessor {
   const void* data_ = nullptr;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Multi-threading helpers: ops that take a `num_threads` argument split their
+// segments between that many threads of GetIntraOpThreadPool(). The work
+// functions run on those threads must not throw, so inputs are validated
+// before.
+////////////////////////////////////////////////////////////////////////////////
+
+// Fills offsets with the num_segments + 1 positions at which the segments
+// described by lengths start, the last one being the total length.
+template <typename TLengths>
+void LengthsToSegmentOffsets(
+    const TLengths* lengths,
+    TIndex num_segments,
+    vector<TIndex>* offsets) {
+  offsets->resize(num_segments + 1);
+  (*offsets)[0] = 0;
+  for (TIndex i = 0; i < num_segments; ++i) {
+    CAFFE_ENFORCE_GE(lengths[i], 0, "LENGTHS must be non-negative");
+    (*offsets)[i + 1] = (*offsets)[i] + lengths[i];
+  }
+}
+
+// Runs f(begin, end) over up to num_shards contiguous ranges of segments
+// covering all of them. Segment lengths are usually skewed, so the ranges are
+// cut to hold about the same number of slices rather than of segments.
+template <typename F>
+void ParallelForSegments(
+    const vector<TIndex>& offsets,
+    int num_shards,
+    const F& f) {
+  const TIndex num_segments = offsets.size() - 1;
+  const TIndex total = offsets.back();
+  num_shards = std::min<TIndex>(num_shards, num_segments);
+  if (num_shards <= 1 || total == 0) {
+    f(0, num_segments);
+    return;
+  }
+  vector<TIndex> bounds(num_shards + 1);
+  bounds[0] = 0;
+  for (int s = 1; s < num_shards; ++s) {
+    const TIndex first_slice = total * s / num_shards;
+    bounds[s] =
+        std::lower_bound(offsets.begin(), offsets.end() - 1, first_slice) -
+        offsets.begin();
+  }
+  bounds[num_shards] = num_segments;
+  GetIntraOpThreadPool()->run(
+      [&](int /* unused */, size_t shard) {
+        if (bounds[shard] < bounds[shard + 1]) {
+          f(bounds[shard], bounds[shard + 1]);
+        }
+      },
+      num_shards);
+}
+
+// Runs f(begin, end) over up to num_shards equal ranges covering [0, n).
+template <typename F>
+void ParallelForRange(TIndex n, int num_shards, const F& f) {
+  num_shards = std::min<TIndex>(num_shards, n);
+  if (num_shards <= 1) {
+    f(0, n);
+    return;
+  }
+  GetIntraOpThreadPool()->run(
+      [&](int /* unused */, size_t shard) {
+        f(n * shard / num_shards, n * (shard + 1) / num_shards);
+      },
+      num_shards);
+}
+
+static constexpr const char* kSegmentNumThreadsDoc =
+    "Number of threads to reduce the segments with (default 1). Segments are "
+    "split so that every thread gets about the same number of input slices.";
+
 ////////////////////////////////////////////////////////////////////////////////
 // Range reducer ops: leverage that input segment is continuous and allow
 // reducer functors to do something special
@@ -49,7 +126,10 @@ template <
 class AbstractSortedSegmentRangeOp : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractSortedSegmentRangeOp);
+
+  AbstractSortedSegmentRangeOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     auto& dataInput = Input(DATA);
@@ -86,26 +166,30 @@ class AbstractSortedSegmentRangeOp : public Operator<Context> {
 
     // Assume the segments are sorted and there are no gaps
     CAFFE_ENFORCE_EQ(0, s_ids[0], "Indices must be sorted and not have gaps");
-    for (TIndex i = 0; i < N;) {
-      TIndex start = i;
-      for (++i; i < N && s_ids[start] == s_ids[i]; ++i)
-        ;
-
-      RangeReducer()(
-          block_size,
-          i - start,
-          inputAccessor_.getBlockPtr(block_size, start, i - start),
-          out + block_size * s_ids[start],
-          &context_);
-
-      // check correctness of the next segment
-      if (i < N) {
+    offsets_.resize(K + 1);
+    offsets_[0] = 0;
+    for (TIndex i = 1; i < N; ++i) {
+      if (s_ids[i] != s_ids[i - 1]) {
         CAFFE_ENFORCE_EQ(
-            s_ids[start] + 1,
+            s_ids[i - 1] + 1,
             s_ids[i],
             "Indices must be sorted and not have gaps");
+        offsets_[s_ids[i]] = i;
       }
     }
+    offsets_[K] = N;
+
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex k = begin; k < end; ++k) {
+        RangeReducer()(
+            block_size,
+            offsets_[k + 1] - offsets_[k],
+            inputAccessor_.getBlockPtr(
+                block_size, offsets_[k], offsets_[k + 1] - offsets_[k]),
+            out + block_size * k,
+            &context_);
+      }
+    });
     return true;
   }
 
@@ -113,6 +197,9 @@ class AbstractSortedSegmentRangeOp : public Operator<Context> {
   INPUT_TAGS(DATA, SEGMENT_IDS);
 
  private:
+  int num_threads_;
+  // member field to reuse memory
+  vector<TIndex> offsets_;
   InputAccessor inputAccessor_;
 };
 
@@ -124,7 +211,12 @@ template <
 class AbstractSortedSegmentRangeGradientOp : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractSortedSegmentRangeGradientOp);
+
+  AbstractSortedSegmentRangeGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     // TODO(azzolini): avoid using input/output if not used by a particular op
@@ -160,35 +252,43 @@ class AbstractSortedSegmentRangeGradientOp : public Operator<Context> {
     // repeat the check from forward op
     CAFFE_ENFORCE_EQ(
         K - 1, s_ids[N - 1], "Indices must be sorted and not have gaps");
-    for (TIndex i = 0; i < N;) {
-      TIndex start = i;
-      for (++i; i < N && s_ids[start] == s_ids[i]; ++i)
-        ;
-
-      auto expanded_idx = block_size * start;
-      auto reduced_idx = block_size * s_ids[start];
-      RangeReducerGradient()(
-          block_size,
-          i - start,
-          s_grads + reduced_idx,
-          out + expanded_idx,
-          d_in + expanded_idx,
-          d_out + reduced_idx,
-          &context_);
-
-      // check correctness of the next segment
-      if (i < N) {
+    offsets_.resize(K + 1);
+    offsets_[0] = 0;
+    for (TIndex i = 1; i < N; ++i) {
+      if (s_ids[i] != s_ids[i - 1]) {
         CAFFE_ENFORCE_EQ(
-            s_ids[start] + 1,
+            s_ids[i - 1] + 1,
             s_ids[i],
             "Indices must be sorted and not have gaps");
+        offsets_[s_ids[i]] = i;
       }
     }
+    offsets_[K] = N;
+
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex k = begin; k < end; ++k) {
+        auto expanded_idx = block_size * offsets_[k];
+        auto reduced_idx = block_size * k;
+        RangeReducerGradient()(
+            block_size,
+            offsets_[k + 1] - offsets_[k],
+            s_grads + reduced_idx,
+            out + expanded_idx,
+            d_in + expanded_idx,
+            d_out + reduced_idx,
+            &context_);
+      }
+    });
     return true;
   }
 
   static constexpr int kNumInputs = 4;
   INPUT_TAGS(DATA_IN, DATA_OUT, SEGMENT_GRADS, SEGMENT_IDS);
+
+ private:
+  int num_threads_;
+  // member field to reuse memory
+  vector<TIndex> offsets_;
 };
 
 template <typename T, typename SIndex, typename Context, typename ReducerDef>
@@ -222,6 +322,7 @@ i.e. `SEGMENT_IDS[-1]+1`. Other dimensions are inherited from the input tensor.
         "OUTPUT",
         "Aggregated tensor with the first dimension of K and the "
         "other dimentsions inherited from DATA");
+    schema.Arg("num_threads", kSegmentNumThreadsDoc);
   }
   using ForwardOp = AbstractSortedSegmentRangeOp<
       T,
@@ -997,7 +1098,8 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
 
   AbstractUnsortedSegmentOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
-        OP_SINGLE_ARG(int, "num_segments", num_segments_, -1) {}
+        OP_SINGLE_ARG(int, "num_segments", num_segments_, -1),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     if (SparseFused) {
@@ -1028,7 +1130,7 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
     TIndex N = segment_ids.dim(0);
     const TIndex M = data.dim(0);
 
-    const IndexType* idxs;
+    const IndexType* idxs = nullptr;
     if (SparseFused) { // static if
       auto& indices = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indices.ndim(), "INDICES must be a vector");
@@ -1084,12 +1186,9 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
     TIndex out_block_size = output->size_from_dim(1);
     T* out = output->template mutable_data<T>();
 
-    reducers_.clear();
-    reducers_.reserve(K);
-    for (TIndex i = 0; i < K; ++i) {
-      reducers_.emplace_back(ctx, out + out_block_size * i, &context_);
-    }
-
+    // Group the slices by segment with a counting sort that keeps their order
+    // within every segment, so that segments can be reduced independently.
+    offsets_.assign(K + 1, 0);
     for (TIndex i = 0; i < N; ++i) {
       auto s_id = s_ids[i];
       CAFFE_ENFORCE(
@@ -1098,7 +1197,6 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
           s_id,
           ", range 0 to ",
           K);
-      IndexType idx;
       if (SparseFused) { // static if
         CAFFE_ENFORCE(
             0 <= idxs[i] && idxs[i] < M,
@@ -1106,19 +1204,30 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
             idxs[i],
             ", range 0 to ",
             M);
-        idx = idxs[i];
-      } else {
-        idx = i;
       }
-      reducers_[s_id].template process<FixedSize>(
-          ctx, inputAccessor_.getBlockPtr(in_block_size, idx), i, &context_);
+      ++offsets_[s_id + 1];
     }
-
-    for (TIndex i = 0; i < K; ++i) {
-      reducers_[i].template finish<FixedSize>(ctx, &context_);
+    for (TIndex k = 0; k < K; ++k) {
+      offsets_[k + 1] += offsets_[k];
     }
-    // call reducers destructors (if there is any)
-    reducers_.clear();
+    next_.assign(offsets_.begin(), offsets_.end() - 1);
+    order_.resize(N);
+    for (TIndex i = 0; i < N; ++i) {
+      order_[next_[s_ids[i]]++] = i;
+    }
+
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex k = begin; k < end; ++k) {
+        Reducer reducer(ctx, out + out_block_size * k, &context_);
+        for (TIndex j = offsets_[k]; j < offsets_[k + 1]; ++j) {
+          const TIndex i = order_[j];
+          const TIndex idx = SparseFused ? idxs[i] : i;
+          reducer.template process<FixedSize>(
+              ctx, inputAccessor_.getBlockPtr(in_block_size, idx), i, &context_);
+        }
+        reducer.template finish<FixedSize>(ctx, &context_);
+      }
+    });
     return true;
   }
 
@@ -1131,8 +1240,11 @@ class AbstractUnsortedSegmentOp : public Operator<Context> {
 
  private:
   TIndex num_segments_;
-  // member field to reuse memory
-  vector<Reducer> reducers_;
+  int num_threads_;
+  // member fields to reuse memory
+  vector<TIndex> offsets_;
+  vector<TIndex> next_;
+  vector<TIndex> order_;
   InputAccessor inputAccessor_;
 };
 
@@ -1141,7 +1253,12 @@ template <typename T, typename SIndex, class Context, class ReducerGradient>
 class AbstractUnsortedSegmentGradientOp : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractUnsortedSegmentGradientOp);
+
+  AbstractUnsortedSegmentGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     // If more complicated fixed size logic becomes necessary, it can be moved
@@ -1187,16 +1304,18 @@ class AbstractUnsortedSegmentGradientOp : public Operator<Context> {
     T* out = data_grads->template mutable_data<T>();
 
     if (ReducerGradient::computeLength()) {
-      segment_length_.resize(K, 0);
-      for (int i = 0; i < N; ++i) {
-        auto s_id = s_ids[i];
-        CAFFE_ENFORCE(
-            0 <= s_id && s_id < K,
-            "Segment id out of range: ",
-            s_id,
-            ", range 0 to ",
-            K);
-        segment_length_[s_ids[i]]++;
+      segment_length_.assign(K, 0);
+    }
+    for (TIndex i = 0; i < N; ++i) {
+      auto s_id = s_ids[i];
+      CAFFE_ENFORCE(
+          0 <= s_id && s_id < K,
+          "Segment id out of range: ",
+          s_id,
+          ", range 0 to ",
+          K);
+      if (ReducerGradient::computeLength()) {
+        segment_length_[s_id]++;
       }
     }
 
@@ -1206,16 +1325,19 @@ class AbstractUnsortedSegmentGradientOp : public Operator<Context> {
       reducers_.emplace_back(ctx, s_grads + s_block_size * i, &context_);
     }
 
-    for (TIndex i = 0; i < N; ++i) {
-      auto s_id = s_ids[i];
-      if (ReducerGradient::computeLength()) {
-        reducers_[s_id].template fillGrad<FixedSize>(
-            ctx, out + d_block_size * i, i, &context_, segment_length_[s_id]);
-      } else {
-        reducers_[s_id].template fillGrad<FixedSize>(
-            ctx, out + d_block_size * i, i, &context_, 0);
+    // Every slice gets its own gradient, so they can be split evenly.
+    ParallelForRange(N, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex i = begin; i < end; ++i) {
+        auto s_id = s_ids[i];
+        if (ReducerGradient::computeLength()) {
+          reducers_[s_id].template fillGrad<FixedSize>(
+              ctx, out + d_block_size * i, i, &context_, segment_length_[s_id]);
+        } else {
+          reducers_[s_id].template fillGrad<FixedSize>(
+              ctx, out + d_block_size * i, i, &context_, 0);
+        }
       }
-    }
+    });
     // call reducers destructors (if there is any)
     reducers_.clear();
     return true;
@@ -1233,6 +1355,7 @@ class AbstractUnsortedSegmentGradientOp : public Operator<Context> {
   };
 
  private:
+  int num_threads_;
   // member field to reuse memory
   vector<ReducerGradient> reducers_;
   vector<int> segment_length_;
@@ -1262,6 +1385,7 @@ tensor.
         "num_segments",
         "Optional int argument specifying the number of output segments and "
         "thus the first dimension of the output");
+    schema.Arg("num_threads", kSegmentNumThreadsDoc);
     schema.Input(0, "DATA", "Input tensor, slices of which are aggregated.");
     schema.Input(
         Reducer::kInputCount,
@@ -1336,6 +1460,7 @@ tensor.
         "OUTPUT",
         "Aggregated output tensor. Has the first dimension of equal to the "
         "number of segments.");
+    schema.Arg("num_threads", kSegmentNumThreadsDoc);
     ReducerDef::PopulateSchema(schema);
   }
   using Reducer = typename ReducerDef::template Reducer<T, Context>;
@@ -1391,7 +1516,10 @@ template <
 class AbstractLengthsOp : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractLengthsOp);
+
+  AbstractLengthsOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     if (SparseFused) {
@@ -1424,7 +1552,7 @@ class AbstractLengthsOp : public Operator<Context> {
     TIndex dataToReduceSize;
     const TIndex outputSize = lengthsInput.dim(0);
 
-    const IndexType* indices;
+    const IndexType* indices = nullptr;
     if (SparseFused) { // static if
       auto& indicesInput = Input(INDICES);
       CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
@@ -1462,44 +1590,39 @@ class AbstractLengthsOp : public Operator<Context> {
     TIndex out_block_size = output->size_from_dim(1);
     TData* out = output->template mutable_data<TData>();
 
-    TIndex dataIndex = 0;
-    for (TIndex rangeIndex = 0; rangeIndex < outputSize; ++rangeIndex) {
-      Reducer reducer(ctx, out + out_block_size * rangeIndex, &context_);
-      for (TIndex start = dataIndex; dataIndex < start + lengths[rangeIndex];
-           ++dataIndex) {
-        IndexType idx;
-        if (SparseFused) { // static if
-          idx = indices[dataIndex];
-          CAFFE_ENFORCE(
-              0 <= idx && idx < dataSize,
-              "The ",
-              dataIndex,
-              "th index from the input indices is out of bounds: ",
-              idx,
-              " vs. valid range 0 to ",
-              dataSize);
-        } else {
-          idx = dataIndex;
-          CAFFE_ENFORCE(
-              0 <= idx && idx < dataSize,
-              "When calculating the ",
-              rangeIndex,
-              "th output with length=",
-              lengths[rangeIndex],
-              ", the index is out of bounds: ",
-              idx,
-              " vs. valid range 0 to ",
-              dataSize);
-        }
-
-        const TData* input = inputAccessor_.getBlockPtr(in_block_size, idx);
-        reducer.template process<FixedSize>(ctx, input, dataIndex, &context_);
+    LengthsToSegmentOffsets(lengths, outputSize, &offsets_);
+    CAFFE_ENFORCE(
+        offsets_[outputSize] == dataToReduceSize,
+        offsets_[outputSize],
+        " != ",
+        dataToReduceSize);
+    if (SparseFused) { // static if
+      for (TIndex dataIndex = 0; dataIndex < dataToReduceSize; ++dataIndex) {
+        CAFFE_ENFORCE(
+            0 <= indices[dataIndex] && indices[dataIndex] < dataSize,
+            "The ",
+            dataIndex,
+            "th index from the input indices is out of bounds: ",
+            indices[dataIndex],
+            " vs. valid range 0 to ",
+            dataSize);
       }
-      reducer.template finish<FixedSize>(ctx, &context_);
     }
-    CAFFE_ENFORCE(
-        dataIndex == dataToReduceSize, dataIndex, " != ", dataToReduceSize);
 
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex rangeIndex = begin; rangeIndex < end; ++rangeIndex) {
+        Reducer reducer(ctx, out + out_block_size * rangeIndex, &context_);
+        for (TIndex dataIndex = offsets_[rangeIndex];
+             dataIndex < offsets_[rangeIndex + 1];
+             ++dataIndex) {
+          const TIndex idx = SparseFused ? indices[dataIndex] : dataIndex;
+          const TData* input = inputAccessor_.getBlockPtr(in_block_size, idx);
+          reducer.template process<FixedSize>(
+              ctx, input, dataIndex, &context_);
+        }
+        reducer.template finish<FixedSize>(ctx, &context_);
+      }
+    });
     return true;
   }
 
@@ -1511,6 +1634,9 @@ class AbstractLengthsOp : public Operator<Context> {
   static constexpr int kNumInputs = Reducer::kInputCount + kSelfInputs;
 
  private:
+  int num_threads_;
+  // member field to reuse memory
+  vector<TIndex> offsets_;
   InputAccessor inputAccessor_;
 };
 
@@ -1531,7 +1657,10 @@ template <
 class AbstractLengthsGradientOp : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractLengthsGradientOp);
+
+  AbstractLengthsGradientOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     // If more complicated fixed size logic becomes necessary, it can be moved
@@ -1548,14 +1677,12 @@ class AbstractLengthsGradientOp : public Operator<Context> {
     auto* dataGradsOutput = Output(0);
 
     CAFFE_ENFORCE(lengthsInput.ndim() == 1, "LENGTHS must be a vector");
-    TIndex reducedDataSize = 0;
     TIndex numSegments = lengthsInput.dim(0);
     CAFFE_ENFORCE(segmentGradsInput.ndim() > 0);
     CAFFE_ENFORCE(numSegments == segmentGradsInput.dim(0));
     const TLengths* lengths = lengthsInput.template data<TLengths>();
-    for (TIndex i = 0; i < numSegments; ++i) {
-      reducedDataSize += lengths[i];
-    }
+    LengthsToSegmentOffsets(lengths, numSegments, &offsets_);
+    TIndex reducedDataSize = offsets_[numSegments];
 
     typename ReducerGradient::Meta ctx(segmentGradsInput, 1);
     for (int i = 0; i < ReducerGradient::originalInputs().size(); ++i) {
@@ -1581,22 +1708,22 @@ class AbstractLengthsGradientOp : public Operator<Context> {
     TIndex segmentBlockSize = segmentGradsInput.size_from_dim(1);
     T* dataGrads = dataGradsOutput->template mutable_data<T>();
 
-    TIndex dataIndex = 0;
-    for (TIndex rangeIndex = 0; rangeIndex < numSegments; ++rangeIndex) {
-      ReducerGradient reducer(
-          ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
-      for (TIndex start = dataIndex; dataIndex < start + lengths[rangeIndex];
-           ++dataIndex) {
-        reducer.template fillGrad<FixedSize>(
-            ctx,
-            dataGrads + dataGradsBlockSize * dataIndex,
-            dataIndex,
-            &context_,
-            lengths[rangeIndex]);
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex rangeIndex = begin; rangeIndex < end; ++rangeIndex) {
+        ReducerGradient reducer(
+            ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
+        for (TIndex dataIndex = offsets_[rangeIndex];
+             dataIndex < offsets_[rangeIndex + 1];
+             ++dataIndex) {
+          reducer.template fillGrad<FixedSize>(
+              ctx,
+              dataGrads + dataGradsBlockSize * dataIndex,
+              dataIndex,
+              &context_,
+              lengths[rangeIndex]);
+        }
       }
-    }
-    CAFFE_ENFORCE(
-        dataIndex == reducedDataSize, dataIndex, " != ", reducedDataSize);
+    });
     return true;
   }
 
@@ -1611,6 +1738,11 @@ class AbstractLengthsGradientOp : public Operator<Context> {
     LENGTHS,
     INDICES
   };
+
+ private:
+  int num_threads_;
+  // member field to reuse memory
+  vector<TIndex> offsets_;
 };
 
 // Version of gradient that requires the main input and thus needs to receive
@@ -1625,7 +1757,12 @@ template <
 class AbstractLengthsWithMainInputGradientOp : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractLengthsWithMainInputGradientOp);
+
+  AbstractLengthsWithMainInputGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     if (SparseFused) {
@@ -1691,28 +1828,32 @@ class AbstractLengthsWithMainInputGradientOp : public Operator<Context> {
 
     const T* data = dataInput.template data<T>();
 
-    TIndex dataIndex = 0;
-    for (TIndex rangeIndex = 0; rangeIndex < numSegments; ++rangeIndex) {
-      ReducerGradient reducer(
-          ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
-      for (TIndex start = dataIndex; dataIndex < start + lengths[rangeIndex];
-           ++dataIndex) {
-        IndexType data_pos;
-        // No range checking, should've been verified in forward pass
-        if (SparseFused) { // static if
-          data_pos = indices[dataIndex];
-        } else {
-          data_pos = dataIndex;
+    LengthsToSegmentOffsets(lengths, numSegments, &offsets_);
+    CAFFE_ENFORCE(
+        offsets_[numSegments] == dataToReduceSize,
+        offsets_[numSegments],
+        " != ",
+        dataToReduceSize);
+
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex rangeIndex = begin; rangeIndex < end; ++rangeIndex) {
+        ReducerGradient reducer(
+            ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
+        for (TIndex dataIndex = offsets_[rangeIndex];
+             dataIndex < offsets_[rangeIndex + 1];
+             ++dataIndex) {
+          // No range checking, should've been verified in forward pass
+          const TIndex data_pos = SparseFused ? indices[dataIndex] : dataIndex;
+          reducer.template fillGradWithMainInput<FixedSize>(
+              ctx,
+              data + dataGradsBlockSize * data_pos,
+              dataGrads + dataGradsBlockSize * dataIndex,
+              dataIndex,
+              &context_,
+              lengths[rangeIndex]);
         }
-        reducer.template fillGradWithMainInput<FixedSize>(
-            ctx,
-            data + dataGradsBlockSize * data_pos,
-            dataGrads + dataGradsBlockSize * dataIndex,
-            dataIndex,
-            &context_,
-            lengths[rangeIndex]);
       }
-    }
+    });
     return true;
   }
 
@@ -1729,6 +1870,11 @@ class AbstractLengthsWithMainInputGradientOp : public Operator<Context> {
     DATA_INPUT,
     INDICES,
   };
+
+ private:
+  int num_threads_;
+  // member field to reuse memory
+  vector<TIndex> offsets_;
 };
 
 // Version of gradient that requires the main input as well as the output of the
@@ -1738,7 +1884,12 @@ class AbstractLengthsWithMainInputAndForwardOutputGradientOp
     : public Operator<Context> {
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
-  USE_SIMPLE_CTOR_DTOR(AbstractLengthsWithMainInputAndForwardOutputGradientOp);
+
+  AbstractLengthsWithMainInputAndForwardOutputGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        OP_SINGLE_ARG(int, "num_threads", num_threads_, 1) {}
 
   bool RunOnDevice() override {
     // If more complicated fixed size logic becomes necessary, it can be moved
@@ -1789,23 +1940,32 @@ class AbstractLengthsWithMainInputAndForwardOutputGradientOp
 
     const T* data = dataInput.template data<T>();
 
-    TIndex dataIndex = 0;
-    for (TIndex rangeIndex = 0; rangeIndex < numSegments; ++rangeIndex) {
-      ReducerGradient reducer(
-          ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
-      for (TIndex start = dataIndex; dataIndex < start + lengths[rangeIndex];
-           ++dataIndex) {
-        // No range checking, should've been verified in forward pass
-        reducer.template fillGradWithMainInputAndForwardOutput<FixedSize>(
-            ctx,
-            data + dataGradsBlockSize * dataIndex,
-            dataGrads + dataGradsBlockSize * dataIndex,
-            forwardOutput + segmentBlockSize * rangeIndex,
-            dataIndex,
-            &context_,
-            lengths[rangeIndex]);
+    LengthsToSegmentOffsets(lengths, numSegments, &offsets_);
+    CAFFE_ENFORCE(
+        offsets_[numSegments] == dataToReduceSize,
+        offsets_[numSegments],
+        " != ",
+        dataToReduceSize);
+
+    ParallelForSegments(offsets_, num_threads_, [&](TIndex begin, TIndex end) {
+      for (TIndex rangeIndex = begin; rangeIndex < end; ++rangeIndex) {
+        ReducerGradient reducer(
+            ctx, segmentGrads + segmentBlockSize * rangeIndex, &context_);
+        for (TIndex dataIndex = offsets_[rangeIndex];
+             dataIndex < offsets_[rangeIndex + 1];
+             ++dataIndex) {
+          // No range checking, should've been verified in forward pass
+          reducer.template fillGradWithMainInputAndForwardOutput<FixedSize>(
+              ctx,
+              data + dataGradsBlockSize * dataIndex,
+              dataGrads + dataGradsBlockSize * dataIndex,
+              forwardOutput + segmentBlockSize * rangeIndex,
+              dataIndex,
+              &context_,
+              lengths[rangeIndex]);
+        }
       }
-    }
+    });
     return true;
   }
 
@@ -1822,6 +1982,11 @@ class AbstractLengthsWithMainInputAndForwardOutputGradientOp
     LENGTHS,
     DATA_INPUT,
   };
+
+ private:
+  int num_threads_;
+  // member field to reuse memory
+  vector<TIndex> offsets_;
 };
 
 // base implementation of sparse/non-sparse gradient computation
@@ -1922,6 +2087,7 @@ segments, i.e. len(*LENGTHS*).
         0,
         "OUTPUT",
         "Aggregated output tensor. Has the first dimension of len(LENGTHS) ");
+    schema.Arg("num_threads", kSegmentNumThreadsDoc);
     schema.TensorInferenceFunction(
         [](const OperatorDef& def, const vector<TensorShape>& in) {
           vector<TensorShape> out(0);
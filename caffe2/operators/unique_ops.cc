@@ -16,6 +16,7 @@
 
 #include "caffe2/operators/unique_ops.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace caffe2 {
@@ -63,7 +64,42 @@ bool UniqueOp<CPUContext>::DoRunWithType() {
   return true;
 }
 
+template <typename T>
+bool SparseHashUniqueOp::DoRunWithType() {
+  auto& inputTensor = Input(0);
+  // use dim32 to enforce that it's fine to have remapping of type int
+  int N = inputTensor.dim32(0);
+  CAFFE_ENFORCE_EQ(inputTensor.ndim(), 1, "Input should be a vector");
+  auto* uniqueTensor = Output(UNIQUE);
+
+  int* remapping = nullptr;
+  if (REMAPPING < OutputSize()) {
+    auto* remappingTensor = Output(REMAPPING);
+    remappingTensor->ResizeLike(inputTensor);
+    remapping = remappingTensor->template mutable_data<int>();
+  }
+
+  const T* input = inputTensor.template data<T>();
+  ska::flat_hash_map<T, int> positions;
+  std::vector<T> unique;
+  for (int i = 0; i < N; ++i) {
+    auto it = positions.emplace(input[i], unique.size());
+    if (it.second) {
+      unique.push_back(input[i]);
+    }
+    if (remapping) {
+      remapping[i] = it.first->second;
+    }
+  }
+  uniqueTensor->Resize(unique.size());
+  std::copy(
+      unique.begin(), unique.end(), uniqueTensor->template mutable_data<T>());
+  return true;
+}
+
 REGISTER_CPU_OPERATOR(Unique, UniqueOp<CPUContext>);
+// Used by DeduplicateGradientSlices
+REGISTER_CPU_OPERATOR_WITH_ENGINE(Unique, SparseHash, SparseHashUniqueOp);
 
 OPERATOR_SCHEMA(Unique)
     .NumInputs(1)
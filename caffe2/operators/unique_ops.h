@@ -23,6 +23,7 @@
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/types.h"
+#include "caffe2/utils/flat_hash_map/flat_hash_map.h"
 #include "caffe2/utils/math.h"
 
 namespace caffe2 {
@@ -55,6 +56,29 @@ class UniqueOp : public Operator<Context> {
   OUTPUT_TAGS(UNIQUE, REMAPPING);
 };
 
+/**
+ * Same as UniqueOp, but deduplicates with a hash table in one pass over the
+ * indices instead of sorting them, which is much cheaper when a few indices
+ * repeat many times. Unique indices are in the order of their first
+ * occurrence.
+ */
+class SparseHashUniqueOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  SparseHashUniqueOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(this, Input(0));
+  }
+
+  template <typename T>
+  bool DoRunWithType();
+
+ public:
+  OUTPUT_TAGS(UNIQUE, REMAPPING);
+};
+
 } // namespace caffe2
 
 #endif // CAFFE_OPERATORS_UNIQUE_OPS_H_
@@ -0,0 +1,265 @@
+#include "caffe2/opt/constant_folding.h"
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_map>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace opt {
+
+const std::unordered_set<std::string>& impureOperators() {
+  static const std::unordered_set<std::string> types{
+      // random
+      "Dropout",
+      "GaussianFill",
+      "MSRAFill",
+      "ReservoirSampling",
+      "SortAndShuffle",
+      "UniformFill",
+      "UniformIntFill",
+      "UniqueUniformFill",
+      "WeightedSample",
+      "WeightedSampleDequeueBlobs",
+      "XavierFill",
+      // readers, queues and counters, which advance state they hold
+      "AtomicIter",
+      "CountDown",
+      "CountUp",
+      "DequeueBlobs",
+      "DequeueRebatchingQueue",
+      "EnqueueBlobs",
+      "EnqueueRebatchingQueue",
+      "ImageInput",
+      "Iter",
+      "ReadNextBatch",
+      "ReadRandomBatch",
+      "SafeDequeueBlobs",
+      "SafeEnqueueBlobs",
+      "TensorProtosDBInput",
+      "TextFileReaderRead",
+      "VideoInput",
+      // side effects
+      "Allgather",
+      "Allreduce",
+      "Barrier",
+      "Broadcast",
+      "CreateCommonWorld",
+      "Load",
+      "Print",
+      "Reduce",
+      "Save"};
+  return types;
+}
+
+bool isImpureOperator(const std::string& type) {
+  return impureOperators().count(type);
+}
+
+namespace {
+
+bool runsNets(const OperatorDef& op) {
+  for (const auto& arg : op.arg()) {
+    if (arg.has_n() || arg.nets_size()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Blobs that `op` may write, including in the nets it runs
+void collectOutputs(
+    const OperatorDef& op,
+    std::unordered_set<std::string>* outputs) {
+  outputs->insert(op.output().begin(), op.output().end());
+  for (const auto& arg : op.arg()) {
+    if (arg.has_n()) {
+      for (const auto& nested : arg.n().op()) {
+        collectOutputs(nested, outputs);
+      }
+    }
+    for (const auto& net : arg.nets()) {
+      for (const auto& nested : net.op()) {
+        collectOutputs(nested, outputs);
+      }
+    }
+  }
+}
+
+void countWriters(
+    const OperatorDef& op,
+    int delta,
+    std::unordered_map<std::string, int>* writers) {
+  std::unordered_set<std::string> outputs;
+  collectOutputs(op, &outputs);
+  for (const auto& output : outputs) {
+    (*writers)[output] += delta;
+  }
+}
+
+class ConstantFolder {
+ public:
+  ConstantFolder(
+      const NetDef& net,
+      NetDef* init_net,
+      Workspace* ws,
+      const std::unordered_set<std::string>& inputs)
+      : init_net_(init_net), ws_(ws), inputs_(inputs) {
+    for (const auto& op : init_net->op()) {
+      for (const auto& output : op.output()) {
+        if (!inputs.count(output)) {
+          constants_.insert(output);
+        }
+      }
+    }
+    for (const auto& op : net.op()) {
+      countWriters(op, 1, &writers_);
+    }
+  }
+
+  NetDef run(const NetDef& net) {
+    NetDef folded(net);
+    folded.clear_op();
+    // If operators with a constant condition push their branch to the front.
+    std::deque<OperatorDef> ops(net.op().begin(), net.op().end());
+    while (!ops.empty()) {
+      OperatorDef op = std::move(ops.front());
+      ops.pop_front();
+      const auto* condition =
+          op.type() == "If" && op.input_size() ? getConstant(op.input(0))
+                                               : nullptr;
+      if (condition && condition->IsType<bool>() && condition->size() == 1) {
+        const char* branch =
+            condition->data<bool>()[0] ? "then_net" : "else_net";
+        const auto taken =
+            ArgumentHelper(op).GetSingleArgument<NetDef>(branch, NetDef());
+        countWriters(op, -1, &writers_);
+        for (auto it = taken.op().rbegin(); it != taken.op().rend(); ++it) {
+          countWriters(*it, 1, &writers_);
+          ops.push_front(*it);
+        }
+        continue;
+      }
+      if (canFold(op) && evaluate(op)) {
+        countWriters(op, -1, &writers_);
+        constants_.insert(op.output().begin(), op.output().end());
+        *init_net_->add_op() = op;
+        continue;
+      }
+      *folded.add_op() = op;
+    }
+    declareExternalInputs(&folded);
+    return folded;
+  }
+
+ private:
+  // Written by init_net and not by the remaining ops of the net
+  const TensorCPU* getConstant(const std::string& name) const {
+    const auto it = writers_.find(name);
+    if (!constants_.count(name) || (it != writers_.end() && it->second != 0) ||
+        !ws_->HasBlob(name) || !ws_->GetBlob(name)->IsType<TensorCPU>()) {
+      return nullptr;
+    }
+    return &ws_->GetBlob(name)->Get<TensorCPU>();
+  }
+
+  bool canFold(const OperatorDef& op) const {
+    if (op.output_size() == 0 || runsNets(op) ||
+        isImpureOperator(op.type()) ||
+        (op.has_device_option() && op.device_option().device_type() != CPU)) {
+      return false;
+    }
+    for (const auto& input : op.input()) {
+      if (!getConstant(input)) {
+        return false;
+      }
+    }
+    // In-place operators would be applied again every time init_net runs.
+    for (const auto& output : op.output()) {
+      if (writers_.at(output) != 1 || constants_.count(output) ||
+          inputs_.count(output) ||
+          std::find(op.input().begin(), op.input().end(), output) !=
+              op.input().end()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Runs `op` in a scratch workspace, so that nothing but CPU tensor outputs
+  // ever reaches ws_, and moves them there.
+  bool evaluate(const OperatorDef& op) {
+    Workspace scratch(ws_);
+    for (const auto& output : op.output()) {
+      scratch.CreateLocalBlob(output);
+    }
+    try {
+      if (!scratch.RunOperatorOnce(op)) {
+        return false;
+      }
+    } catch (const std::exception& e) {
+      // The error is left for the net to report when it runs.
+      VLOG(1) << "Not folding " << op.type() << ": " << e.what();
+      return false;
+    }
+    for (const auto& output : op.output()) {
+      if (!scratch.GetBlob(output)->IsType<TensorCPU>()) {
+        return false;
+      }
+    }
+    for (const auto& output : op.output()) {
+      ws_->CreateBlob(output)->swap(*scratch.GetBlob(output));
+    }
+    return true;
+  }
+
+  // Folded blobs, and the blobs read by inlined branches, are now inputs of
+  // the net. Nets that declare no inputs aren't checked when created.
+  void declareExternalInputs(NetDef* net) const {
+    if (net->external_input_size() == 0) {
+      return;
+    }
+    std::set<std::string> known(
+        net->external_input().begin(), net->external_input().end());
+    auto declare = [&](const std::string& name) {
+      if (known.insert(name).second) {
+        net->add_external_input(name);
+      }
+    };
+    for (const auto& op : net->op()) {
+      for (const auto& input : op.input()) {
+        declare(input);
+      }
+      known.insert(op.output().begin(), op.output().end());
+    }
+    for (const auto& output : net->external_output()) {
+      declare(output);
+    }
+  }
+
+  NetDef* init_net_;
+  Workspace* ws_;
+  const std::unordered_set<std::string>& inputs_;
+  std::unordered_set<std::string> constants_;
+  // Number of operators left in the net that may write each blob
+  std::unordered_map<std::string, int> writers_;
+};
+
+} // namespace
+
+NetDef foldConstants(
+    const NetDef& net,
+    NetDef* init_net,
+    Workspace* ws,
+    const std::unordered_set<std::string>& inputs) {
+  CAFFE_ENFORCE(init_net);
+  CAFFE_ENFORCE(ws);
+  return ConstantFolder(net, init_net, ws, inputs).run(net);
+}
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,40 @@
+#ifndef CAFFE2_OPT_CONSTANT_FOLDING_H_
+#define CAFFE2_OPT_CONSTANT_FOLDING_H_
+
+#include <string>
+#include <unordered_set>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/proto/caffe2.pb.h"
+
+namespace caffe2 {
+namespace opt {
+
+// Operators that aren't a function of their inputs, or that do more than write
+// their outputs: random operators, readers, queues and counters, and operators
+// with side effects such as Print, Save or collectives. They must run exactly
+// once each time their net runs, so they are neither folded nor recomputed.
+const std::unordered_set<std::string>& impureOperators();
+bool isImpureOperator(const std::string& type);
+
+// Evaluates once the operators of `net` that only depend on blobs written by
+// `init_net`, which must already have been run in `ws`. Their results are
+// stored in `ws`, the operators are appended to `init_net`, and the returned
+// net no longer runs them. If operators whose condition is constant are
+// replaced by the branch they take, or removed when there is none.
+//
+// Blobs in `inputs` are fed at run time and never constant, even if
+// `init_net` writes them. Operators are only folded if they run on the CPU,
+// are pure, read and write CPU tensors, and are the only writer of
+// their outputs in `net`.
+NetDef foldConstants(
+    const NetDef& net,
+    NetDef* init_net,
+    Workspace* ws,
+    const std::unordered_set<std::string>& inputs = {});
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_CONSTANT_FOLDING_H_
@@ -0,0 +1,199 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/opt/constant_folding.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+void AddOp(
+    NetDef* net,
+    const string& type,
+    const vector<string>& inputs,
+    const vector<string>& outputs,
+    const vector<Argument>& args = {}) {
+  *net->add_op() = CreateOperatorDef(type, "", inputs, outputs, args);
+}
+
+void AddFill(NetDef* net, const string& name, const vector<float>& values) {
+  AddOp(
+      net,
+      "GivenTensorFill",
+      {},
+      {name},
+      {MakeArgument<vector<int>>("shape", {int(values.size())}),
+       MakeArgument<vector<float>>("values", values)});
+}
+
+Argument NetArgument(const string& name, const NetDef& net) {
+  Argument arg;
+  arg.set_name(name);
+  *arg.mutable_n() = net;
+  return arg;
+}
+
+vector<string> OpTypes(const NetDef& net) {
+  vector<string> types;
+  for (const auto& op : net.op()) {
+    types.push_back(op.type());
+  }
+  return types;
+}
+
+vector<float> GetData(Workspace* ws, const string& name) {
+  const auto& tensor = ws->GetBlob(name)->Get<TensorCPU>();
+  return vector<float>(
+      tensor.data<float>(), tensor.data<float>() + tensor.size());
+}
+
+bool IsExternalInput(const NetDef& net, const string& name) {
+  return std::find(
+             net.external_input().begin(), net.external_input().end(), name) !=
+      net.external_input().end();
+}
+
+} // namespace
+
+TEST(ConstantFoldingTest, FoldsParameterSubgraphs) {
+  NetDef init_net;
+  AddFill(&init_net, "W", {1, 2, 3, 4, 5, 6});
+  AddFill(&init_net, "b1", {1, 2, 3});
+  AddFill(&init_net, "b2", {10, 20, 30});
+  NetDef net;
+  net.set_name("folded");
+  net.add_external_input("X");
+  net.add_external_input("W");
+  net.add_external_input("b1");
+  net.add_external_input("b2");
+  net.add_external_output("Y");
+  AddOp(
+      &net,
+      "Reshape",
+      {"W"},
+      {"W_2d", "W_shape"},
+      {MakeArgument<vector<int64_t>>("shape", {2, 3})});
+  AddOp(&net, "Transpose", {"W_2d"}, {"W_t"});
+  AddOp(&net, "Sum", {"b1", "b2"}, {"b"});
+  AddOp(&net, "FC", {"X", "W_t", "b"}, {"Y"});
+
+  Workspace ws;
+  ASSERT_TRUE(ws.RunNetOnce(init_net));
+  auto folded = opt::foldConstants(net, &init_net, &ws);
+  EXPECT_EQ(vector<string>({"FC"}), OpTypes(folded));
+  EXPECT_EQ(
+      vector<string>({"GivenTensorFill",
+                      "GivenTensorFill",
+                      "GivenTensorFill",
+                      "Reshape",
+                      "Transpose",
+                      "Sum"}),
+      OpTypes(init_net));
+  EXPECT_TRUE(IsExternalInput(folded, "W_t"));
+  EXPECT_TRUE(IsExternalInput(folded, "b"));
+  EXPECT_EQ(vector<float>({1, 4, 2, 5, 3, 6}), GetData(&ws, "W_t"));
+  EXPECT_EQ(vector<float>({11, 22, 33}), GetData(&ws, "b"));
+
+  auto* X = ws.CreateBlob("X")->GetMutable<TensorCPU>();
+  X->Resize(1, 2);
+  std::fill(X->mutable_data<float>(), X->mutable_data<float>() + 2, 1.f);
+  ASSERT_TRUE(ws.RunNetOnce(folded));
+  EXPECT_EQ(vector<float>({16, 29, 42}), GetData(&ws, "Y"));
+}
+
+TEST(ConstantFoldingTest, KeepsOperatorsThatAreNotConstant) {
+  NetDef init_net;
+  AddFill(&init_net, "W", {1, 2, 3});
+  AddFill(&init_net, "X", {0, 0, 0});
+  AddFill(&init_net, "counter", {0});
+  NetDef net;
+  // Reads an input, which init_net only allocates.
+  AddOp(&net, "Relu", {"X"}, {"X_relu"});
+  // Random
+  AddOp(
+      &net,
+      "UniformFill",
+      {},
+      {"noise"},
+      {MakeArgument<vector<int>>("shape", {3})});
+  // In-place on a parameter
+  AddOp(&net, "Scale", {"counter"}, {"counter"});
+  // Y is written twice, and W is overwritten by the net.
+  AddOp(&net, "Relu", {"W"}, {"Y"});
+  AddOp(&net, "Relu", {"X"}, {"Y"});
+  AddOp(&net, "Sigmoid", {"W"}, {"W_sigmoid"});
+  AddOp(&net, "Relu", {"X"}, {"W"});
+
+  Workspace ws;
+  ASSERT_TRUE(ws.RunNetOnce(init_net));
+  const auto ops = net.op_size();
+  auto folded = opt::foldConstants(net, &init_net, &ws, {"X"});
+  EXPECT_EQ(ops, folded.op_size());
+  EXPECT_EQ(3, init_net.op_size());
+}
+
+TEST(ConstantFoldingTest, RemovesDeadBranches) {
+  NetDef init_net;
+  AddFill(&init_net, "W", {-1, 2});
+  AddOp(
+      &init_net,
+      "ConstantFill",
+      {},
+      {"true"},
+      {MakeArgument<vector<int>>("shape", {1}),
+       MakeArgument<bool>("value", true),
+       MakeArgument<int>("dtype", TensorProto_DataType_BOOL)});
+  AddOp(
+      &init_net,
+      "ConstantFill",
+      {},
+      {"false"},
+      {MakeArgument<vector<int>>("shape", {1}),
+       MakeArgument<bool>("value", false),
+       MakeArgument<int>("dtype", TensorProto_DataType_BOOL)});
+
+  NetDef then_net;
+  AddOp(&then_net, "Relu", {"W"}, {"W_relu"});
+  AddOp(&then_net, "Mul", {"X", "W_relu"}, {"Y"});
+  NetDef else_net;
+  AddOp(&else_net, "Sigmoid", {"X"}, {"Y"});
+
+  NetDef net;
+  net.set_name("branches");
+  net.add_external_input("X");
+  net.add_external_input("true");
+  net.add_external_input("false");
+  net.add_external_output("Y");
+  AddOp(
+      &net,
+      "If",
+      {"true", "X", "W"},
+      {"Y"},
+      {NetArgument("then_net", then_net),
+       NetArgument("else_net", else_net)});
+  // No else_net
+  AddOp(
+      &net,
+      "If",
+      {"false", "X"},
+      {"Y"},
+      {NetArgument("then_net", else_net)});
+
+  Workspace ws;
+  ASSERT_TRUE(ws.RunNetOnce(init_net));
+  auto folded = opt::foldConstants(net, &init_net, &ws);
+  ASSERT_EQ(vector<string>({"Mul"}), OpTypes(folded));
+  EXPECT_EQ("W_relu", folded.op(0).input(1));
+  EXPECT_TRUE(IsExternalInput(folded, "W_relu"));
+  EXPECT_EQ(vector<float>({0, 2}), GetData(&ws, "W_relu"));
+
+  auto* X = ws.CreateBlob("X")->GetMutable<TensorCPU>();
+  X->Resize(2);
+  std::fill(X->mutable_data<float>(), X->mutable_data<float>() + 2, 3.f);
+  ASSERT_TRUE(ws.RunNetOnce(folded));
+  EXPECT_EQ(vector<float>({0, 6}), GetData(&ws, "Y"));
+}
+
+} // namespace caffe2
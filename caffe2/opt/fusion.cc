@@ -1,90 +1,542 @@
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/fusion.h"
 #include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include "nomnigraph/Transformations/Match.h"
+
+#include <cmath>
 
 namespace caffe2 {
 namespace opt {
 
 using namespace nom;
 
-// $$ X_{bn} = \frac{s(X - m)}{\sqrt{\sigma + \epsilon}} + b_{bn}$$
-// $$ X_{conv} = X * W + b_{conv} $$
-// thus, substituting $X$ with $X_{conv}$ in the BN equation we get:
-// $$X_{bn} = X * \frac{sW}{\sqrt{\sigma + \epsilon}} + \frac{s(b_{conv} - m)}{\sqrt{\sigma + \epsilon}} + b_{bn}$$
-// or
-// $$ W' = W\frac{s}{\sqrt{\sigma + \epsilon}}$$
-// $$ b' = (b_{conv} - m)\frac{s}{\sqrt{\sigma + \epsilon}} + b_{bn}$$
-bool fuseConvBNHelper(repr::NNModule* nn, caffe2::Workspace* ws) {
-  for (auto node_pair : repr::nn::dataIterator<repr::Conv>(nn->dataFlow)) {
-    repr::NNGraph::NodeRef convNode;
-    repr::Conv* conv;
-    std::tie(conv, convNode) = node_pair;
-
-    auto output = repr::nn::getOutputs(convNode).front();
-    auto consumers = repr::nn::getConsumers(output);
-    if (consumers.size() != 1) {
-      continue;
+namespace {
+
+const OperatorDef* getOpDef(repr::NNGraph::NodeRef node) {
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return &dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+}
+
+OperatorDef* getMutableOpDef(repr::NNGraph::NodeRef node) {
+  auto* annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getMutableAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return dyn_cast<Caffe2Annotation>(annotation)->getMutableOperatorDef();
+}
+
+std::string getName(repr::NNGraph::NodeRef node) {
+  return repr::nn::get<repr::NeuralNetData>(node)->getName();
+}
+
+// Pattern operators are GenericOperators named after the caffe2 type they
+// match. Pattern tensors match any tensor.
+struct OperatorTypeEquality {
+  static bool equal(
+      const repr::NNGraph::NodeRef& pattern,
+      const repr::NNGraph::NodeRef& node) {
+    if (repr::nn::is<repr::NeuralNetData>(pattern)) {
+      return repr::nn::is<repr::NeuralNetData>(node);
     }
-    auto consumer = consumers.front();
-    if (!repr::nn::is<repr::BatchNormalization>(consumer)) {
-      continue;
+    if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+      return false;
     }
-    auto bnNode = consumer;
-    auto bn = repr::nn::get<repr::BatchNormalization>(bnNode);
+    const auto* def = getOpDef(node);
+    return def &&
+        def->type() == repr::nn::get<repr::GenericOperator>(pattern)->getName();
+  }
+};
 
-    auto convInputs = repr::nn::getInputs(convNode);
-    if (convInputs.size() < 3) {
-      assert(0 && "Invalid convolution input size (TODO: optional bias)");
-      continue;
+// Operators that fusion can hand to the default CPU implementation. Operators
+// without a device option run on the device of the net.
+bool isDefaultCPUOp(const OperatorDef& def, const DeviceOption& netDevice) {
+  const auto& device =
+      def.has_device_option() ? def.device_option() : netDevice;
+  return def.engine().empty() && device.device_type() == CPU;
+}
+
+bool hasSingleConsumer(repr::NNGraph::NodeRef tensor) {
+  return repr::nn::getConsumers(tensor).size() == 1;
+}
+
+const TensorCPU* getFloatTensor(Workspace* ws, const std::string& name) {
+  if (!ws->HasBlob(name)) {
+    return nullptr;
+  }
+  const auto* blob = ws->GetBlob(name);
+  if (!blob->IsType<TensorCPU>() || !blob->Get<TensorCPU>().IsType<float>()) {
+    return nullptr;
+  }
+  return &blob->Get<TensorCPU>();
+}
+
+// Whether `norm` normalizes the output channels of the Conv or FC `op`.
+bool normalizesOutputChannels(const OperatorDef& op, const OperatorDef& norm) {
+  const auto order = ArgumentHelper::GetSingleArgument<OperatorDef, string>(
+      norm, "order", "NCHW");
+  if (op.type() == "Conv") {
+    return order ==
+        ArgumentHelper::GetSingleArgument<OperatorDef, string>(
+               op, "order", "NCHW");
+  }
+  // FC outputs are (M, N) with the axis argument at its default, and have
+  // their N channels last.
+  return order == "NHWC" ||
+      ArgumentHelper::GetSingleArgument<OperatorDef, int>(op, "axis", 1) == 1;
+}
+
+// Y = X * scale + shift per output channel, with (scale, shift) from a
+// SpatialBN in test mode
+// $$ scale = \frac{s}{\sqrt{\sigma + \epsilon}}, shift = b_{bn} - m \cdot scale $$
+// or an AffineChannel, which is that directly. Folded into the op by
+// $$ W' = W \cdot scale, b' = b \cdot scale + shift $$
+bool foldNormalization(
+    repr::NNModule* nn,
+    Workspace* ws,
+    const std::unordered_set<std::string>& externalOutputs,
+    repr::NNGraph::NodeRef opNode,
+    repr::NNGraph::NodeRef normNode) {
+  const auto* op = getOpDef(opNode);
+  const auto* norm = getOpDef(normNode);
+  const auto output = repr::nn::getOutputs(opNode).front();
+  // An activation would have to be applied after the normalization.
+  if (!op || !norm || externalOutputs.count(getName(output)) ||
+      ArgumentHelper::HasArgument(*op, "activation") ||
+      !normalizesOutputChannels(*op, *norm) ||
+      repr::nn::getOutputs(normNode).size() != 1) {
+    return false;
+  }
+  // Only folds weights owned by this op, which are always CPU float tensors
+  // in the workspace.
+  const auto opInputs = repr::nn::getInputs(opNode);
+  const auto normInputs = repr::nn::getInputs(normNode);
+  if (opInputs.size() < 2 ||
+      (norm->type() == "SpatialBN" ? normInputs.size() != 5
+                                   : normInputs.size() != 3)) {
+    return false;
+  }
+  for (size_t i = 1; i < opInputs.size(); ++i) {
+    if (!hasSingleConsumer(opInputs[i]) ||
+        !getFloatTensor(ws, getName(opInputs[i]))) {
+      return false;
+    }
+  }
+  for (size_t i = 1; i < normInputs.size(); ++i) {
+    if (!getFloatTensor(ws, getName(normInputs[i]))) {
+      return false;
+    }
+  }
+
+  auto* W = ws->GetBlob(getName(opInputs[1]))->GetMutable<TensorCPU>();
+  const int axis_w =
+      ArgumentHelper::GetSingleArgument<OperatorDef, int>(*op, "axis_w", 1);
+  const int channels = op->type() == "Conv"
+      ? W->dim32(0)
+      : W->size_to_dim(W->canonical_axis_index(axis_w));
+  for (size_t i = 1; i < normInputs.size(); ++i) {
+    if (getFloatTensor(ws, getName(normInputs[i]))->size() != channels) {
+      return false;
+    }
+  }
+  std::string biasName;
+  if (opInputs.size() > 2) {
+    biasName = getName(opInputs[2]);
+    if (getFloatTensor(ws, biasName)->size() != channels) {
+      return false;
+    }
+  } else {
+    biasName = getName(opInputs[1]) + "_bias";
+    if (ws->HasBlob(biasName)) {
+      return false;
+    }
+    auto* bias = ws->CreateBlob(biasName)->GetMutable<TensorCPU>();
+    bias->Resize(channels);
+    std::fill(
+        bias->mutable_data<float>(), bias->mutable_data<float>() + channels, 0);
+    auto biasNode =
+        nn->dataFlow.createNode(util::make_unique<repr::Tensor>(biasName));
+    nn->dataFlow.createEdge(biasNode, opNode);
+  }
+
+  auto getData = [&](int index) {
+    return getFloatTensor(ws, getName(normInputs[index]))->data<float>();
+  };
+  std::vector<float> scale(getData(1), getData(1) + channels);
+  std::vector<float> shift(getData(2), getData(2) + channels);
+  if (norm->type() == "SpatialBN") {
+    const float epsilon =
+        ArgumentHelper::GetSingleArgument<OperatorDef, float>(
+            *norm, "epsilon", 1e-5f);
+    const float* mean = getData(3);
+    const float* var = getData(4);
+    for (int c = 0; c < channels; ++c) {
+      scale[c] /= std::sqrt(var[c] + epsilon);
+      shift[c] -= mean[c] * scale[c];
+    }
+  }
+
+  float* W_data = W->mutable_data<float>();
+  float* b_data =
+      ws->GetBlob(biasName)->GetMutable<TensorCPU>()->mutable_data<float>();
+  const int inner = W->size() / channels;
+  for (int c = 0; c < channels; ++c) {
+    for (int i = 0; i < inner; ++i) {
+      W_data[c * inner + i] *= scale[c];
+    }
+    b_data[c] = b_data[c] * scale[c] + shift[c];
+  }
+
+  fuseIntoProducer(nn, opNode, normNode);
+  return true;
+}
+
+bool isElementwiseActivation(const std::string& type) {
+  return type == "Relu" || type == "Sigmoid" || type == "Tanh";
+}
+
+bool isFusibleElementwise(
+    repr::NNGraph::NodeRef node,
+    const DeviceOption& netDevice) {
+  if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+    return false;
+  }
+  const auto* def = getOpDef(node);
+  if (!def || !isDefaultCPUOp(*def, netDevice) || def->output_size() != 1 ||
+      repr::nn::getOutputs(node).size() != 1) {
+    return false;
+  }
+  if (isElementwiseActivation(def->type())) {
+    return repr::nn::getInputs(node).size() == 1;
+  }
+  // Legacy broadcasting isn't numpy-style, which FusedElementwise implements.
+  return (def->type() == "Add" || def->type() == "Mul") &&
+      repr::nn::getInputs(node).size() == 2 &&
+      !ArgumentHelper::GetSingleArgument<OperatorDef, bool>(
+          *def, "broadcast", false);
+}
+
+// The operator after `node` on a chain, or nullptr if the chain ends there.
+repr::NNGraph::NodeRef nextElementwise(
+    repr::NNGraph::NodeRef node,
+    const std::unordered_set<std::string>& externalOutputs,
+    const DeviceOption& netDevice) {
+  const auto output = repr::nn::getOutputs(node).front();
+  if (externalOutputs.count(getName(output)) || !hasSingleConsumer(output)) {
+    return nullptr;
+  }
+  const auto next = repr::nn::getConsumers(output).front();
+  if (!isFusibleElementwise(next, netDevice)) {
+    return nullptr;
+  }
+  // Mul(x, x) uses the intermediate result twice.
+  const auto inputs = repr::nn::getInputs(next);
+  if (inputs.size() == 2 && inputs[0] == inputs[1]) {
+    return nullptr;
+  }
+  return next;
+}
+
+// Replaces `chain` by one FusedElementwise operator, which runs where the
+// last operator of the chain did. Returns false if an operator in between
+// overwrites one of its inputs.
+bool fuseElementwiseChain(
+    repr::NNModule* nn,
+    const std::vector<repr::NNGraph::NodeRef>& chain) {
+  const auto* head = getOpDef(chain.front());
+  OperatorDef fused;
+  fused.set_type("FusedElementwise");
+  fused.set_name(head->name());
+  if (head->has_device_option()) {
+    fused.mutable_device_option()->CopyFrom(head->device_option());
+  }
+
+  // Input 0 is the first input of the head, then the other operands.
+  auto value = repr::nn::getInputs(chain.front()).front();
+  std::vector<repr::NNGraph::NodeRef> inputs = {value};
+  std::vector<std::string> steps;
+  std::vector<int> operands;
+  for (const auto node : chain) {
+    steps.push_back(getOpDef(node)->type());
+    int operand = -1;
+    for (const auto input : repr::nn::getInputs(node)) {
+      if (input == value) {
+        value = nullptr;
+        continue;
+      }
+      operand = std::find(inputs.begin(), inputs.end(), input) - inputs.begin();
+      if (operand == inputs.size()) {
+        inputs.push_back(input);
+      }
     }
+    operands.push_back(operand);
+    value = repr::nn::getOutputs(node).front();
+  }
+  fused.add_arg()->CopyFrom(MakeArgument("steps", steps));
+  fused.add_arg()->CopyFrom(MakeArgument("operands", operands));
 
-    auto bnInputs = repr::nn::getInputs(bnNode);
-    if (bnInputs.size() < 5) {
-      assert(0 && "Invalid batch normalization input size");
+  std::unordered_set<std::string> inputNames;
+  for (const auto input : inputs) {
+    inputNames.insert(getName(input));
+  }
+  const std::unordered_set<repr::NNGraph::NodeRef> chainNodes(
+      chain.begin(), chain.end());
+  repr::BasicBlockType<repr::NNGraph>* block = nullptr;
+  for (auto& bbNode : nn->controlFlow.getMutableNodes()) {
+    auto bb = repr::nn::get<repr::BasicBlockType<repr::NNGraph>>(bbNode);
+    if (!bb->hasInstruction(chain.back())) {
       continue;
     }
+    if (!bb->hasInstruction(chain.front())) {
+      return false;
+    }
+    block = bb;
+    const auto& instrs = bb->getInstructions();
+    auto it = std::find(instrs.begin(), instrs.end(), chain.front());
+    for (; *it != chain.back(); ++it) {
+      if (chainNodes.count(*it)) {
+        continue;
+      }
+      for (const auto output : repr::nn::getOutputs(*it)) {
+        if (inputNames.count(getName(output))) {
+          return false;
+        }
+      }
+    }
+  }
 
-#define EXPOSE_TENSOR_DATA(name, index, inputs)                              \
-  auto name = repr::nn::get<repr::Tensor>(inputs[index]);                    \
-  assert(ws->HasBlob(name->getName()) && "Blob not in workspace");           \
-  auto name##Tensor = ws->GetBlob(name->getName())->GetMutable<TensorCPU>(); \
-  auto name##Data = name##Tensor->mutable_data<float>();
+  auto fusedNode =
+      nn->dataFlow.createNode(util::make_unique<repr::GenericOperator>(
+          fused.type()));
+  auto annotation = util::make_unique<Caffe2Annotation>();
+  annotation->setOperatorDef(fused);
+  repr::nn::get<repr::NeuralNetOperator>(fusedNode)->setAnnotation(
+      std::move(annotation));
+  for (const auto input : inputs) {
+    nn->dataFlow.createEdge(input, fusedNode);
+  }
+  nn->dataFlow.createEdge(fusedNode, value);
+  if (block) {
+    block->insertInstructionBefore(fusedNode, chain.back());
+  }
 
-    EXPOSE_TENSOR_DATA(filter, 1, convInputs);
-    EXPOSE_TENSOR_DATA(biasConv, 2, convInputs);
+  for (const auto node : chain) {
+    const auto output = repr::nn::getOutputs(node).front();
+    nn->dataFlow.deleteNode(node);
+    if (output != value) {
+      nn->dataFlow.deleteNode(output);
+    }
+  }
+  return true;
+}
 
-    EXPOSE_TENSOR_DATA(scale, 1, bnInputs);
-    EXPOSE_TENSOR_DATA(biasBN, 2, bnInputs);
-    EXPOSE_TENSOR_DATA(mean, 3, bnInputs);
-    EXPOSE_TENSOR_DATA(variance, 4, bnInputs);
+} // namespace
 
-#undef EXPOSE_TENSOR_DATA
+std::vector<std::vector<repr::NNGraph::NodeRef>> matchOperatorChains(
+    repr::NNModule* nn,
+    const std::vector<std::string>& types) {
+  CAFFE_ENFORCE(!types.empty());
+  repr::NNGraph pattern;
+  repr::NNGraph::NodeRef last = nullptr;
+  for (const auto& type : types) {
+    auto op =
+        pattern.createNode(util::make_unique<repr::GenericOperator>(type));
+    if (last) {
+      auto tensor = pattern.createNode(util::make_unique<repr::Tensor>(""));
+      pattern.createEdge(last, tensor);
+      pattern.createEdge(tensor, op);
+    }
+    last = op;
+  }
 
-    // Assume M{CHW,HWC}
-    auto chwDim = filterTensor->dim32(1) * filterTensor->dim32(2) *
-        filterTensor->dim32(3);
-    for (auto c = 0; c < filterTensor->dim32(0); ++c) {
-      float coeff =
-          scaleData[c] / std::sqrt(varianceData[c] + bn->getEpsilon());
-      for (auto i = 0; i < chwDim; ++i) {
-        filterData[c * chwDim + i] *= coeff;
+  nom::Match<repr::NNGraph, OperatorTypeEquality> match(pattern);
+  std::vector<std::vector<repr::NNGraph::NodeRef>> chains;
+  for (const auto& subgraph : match.match(nn->dataFlow)) {
+    // Subgraphs are unordered. The chain starts at the only operator none of
+    // whose inputs are in the subgraph.
+    std::vector<repr::NNGraph::NodeRef> chain;
+    for (const auto node : subgraph.getNodes()) {
+      if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+        continue;
+      }
+      const auto inputs = repr::nn::getInputs(node);
+      if (std::none_of(inputs.begin(), inputs.end(), [&](
+                           repr::NNGraph::NodeRef input) {
+            return subgraph.hasNode(input);
+          })) {
+        chain.push_back(node);
+        break;
+      }
+    }
+    bool valid = !chain.empty();
+    while (valid && chain.size() < types.size()) {
+      const auto outputs = repr::nn::getOutputs(chain.back());
+      valid = outputs.size() == 1 && subgraph.hasNode(outputs.front()) &&
+          hasSingleConsumer(outputs.front());
+      if (valid) {
+        chain.push_back(repr::nn::getConsumers(outputs.front()).front());
       }
-      auto bias = (biasConvData[c] - meanData[c]) * coeff + biasBNData[c];
-      biasConvData[c] = bias;
     }
+    if (valid) {
+      chains.push_back(chain);
+    }
+  }
+  return chains;
+}
 
-    nn->dataFlow.deleteNode(bnNode);
-    return true;
+void fuseIntoProducer(
+    repr::NNModule* nn,
+    repr::NNGraph::NodeRef node,
+    repr::NNGraph::NodeRef consumer) {
+  auto node_output = repr::nn::getOutputs(node).front();
+  auto consumer_output = repr::nn::getOutputs(consumer).front();
+  auto output_tensor = repr::nn::get<repr::Tensor>(consumer_output);
+  auto output_node = consumer_output;
+  bool inplace = false;
+  for (auto input : repr::nn::getInputs(node)) {
+    if (getName(input) == output_tensor->getName()) {
+      inplace = true;
+    }
+  }
+
+  // The producer cannot be in-place
+  if (!inplace) {
+    nn->dataFlow.replaceNode(node_output, consumer_output);
+    nn->dataFlow.deleteNode(consumer);
+    nn->dataFlow.deleteNode(node_output);
+  } else {
+    nn->dataFlow.replaceNode(consumer_output, node_output);
+    output_tensor = repr::nn::get<repr::Tensor>(node_output);
+    output_node = node_output;
+    nn->dataFlow.deleteNode(consumer);
+    nn->dataFlow.deleteNode(consumer_output);
+  }
+
+  // We may have accidentally made the next op in-place
+  // In future iterations of transformations this won't be an issue,
+  // but current caffe2 predictor usage requires things like
+  // external_input and output to be unchanged.
+  bool rectify_inplace = false;
+  for (auto& next : repr::nn::getConsumers(output_node)) {
+    for (auto& next_output : repr::nn::getOutputs(next)) {
+      auto name = repr::nn::get<repr::Tensor>(next_output)->getName();
+      if (name == output_tensor->getName()) {
+        rectify_inplace = true;
+      }
+    }
+  }
+  if (rectify_inplace) {
+    auto new_output = nn->dataFlow.createNode(
+        make_unique<repr::Tensor>(output_tensor->getName() + "_fusion_fix"));
+    nn->dataFlow.replaceNode(output_node, new_output);
   }
-  return false;
 }
 
-void fuseConvBN(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
-  while (fuseConvBNHelper(nn, ws)) {
+void fuseNormalization(
+    repr::NNModule* nn,
+    caffe2::Workspace* ws,
+    const std::unordered_set<std::string>& externalOutputs) {
+  for (const std::string op : {"Conv", "FC"}) {
+    for (const std::string norm : {"SpatialBN", "AffineChannel"}) {
+      // Every fold deletes nodes, so match again after each.
+      bool changed = true;
+      while (changed) {
+        changed = false;
+        for (const auto& chain : matchOperatorChains(nn, {op, norm})) {
+          if (foldNormalization(nn, ws, externalOutputs, chain[0], chain[1])) {
+            changed = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws) {
+  fuseNormalization(nn, ws);
+}
+
+void fuseBiasActivation(
+    repr::NNModule* nn,
+    const std::unordered_set<std::string>& externalOutputs,
+    const DeviceOption& netDevice) {
+  for (const std::string op : {"Conv", "FC"}) {
+    for (const std::string activation : {"Relu", "Sigmoid", "Tanh"}) {
+      bool changed = true;
+      while (changed) {
+        changed = false;
+        for (const auto& chain : matchOperatorChains(nn, {op, activation})) {
+          auto* def = getMutableOpDef(chain[0]);
+          const auto output = repr::nn::getOutputs(chain[0]).front();
+          if (!def || !isDefaultCPUOp(*def, netDevice) ||
+              ArgumentHelper::HasArgument(*def, "activation") ||
+              externalOutputs.count(getName(output)) ||
+              repr::nn::getOutputs(chain[1]).size() != 1) {
+            continue;
+          }
+          def->add_arg()->CopyFrom(MakeArgument("activation", activation));
+          fuseIntoProducer(nn, chain[0], chain[1]);
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+}
+
+void fuseElementwise(
+    repr::NNModule* nn,
+    const std::unordered_set<std::string>& externalOutputs,
+    const DeviceOption& netDevice) {
+  std::vector<std::vector<repr::NNGraph::NodeRef>> chains;
+  std::unordered_set<repr::NNGraph::NodeRef> chained;
+  for (const auto node : nn->dataFlow.getMutableNodes()) {
+    if (!isFusibleElementwise(node, netDevice)) {
+      continue;
+    }
+    // Chains start at an operator that doesn't continue another one.
+    const auto inputs = repr::nn::getInputs(node);
+    if (std::any_of(
+            inputs.begin(), inputs.end(), [&](repr::NNGraph::NodeRef input) {
+              if (!repr::nn::hasProducer(input)) {
+                return false;
+              }
+              const auto producer = repr::nn::getProducer(input);
+              return isFusibleElementwise(producer, netDevice) &&
+                  nextElementwise(producer, externalOutputs, netDevice) ==
+                  node;
+            })) {
+      continue;
+    }
+    std::vector<repr::NNGraph::NodeRef> chain = {node};
+    for (auto next = nextElementwise(node, externalOutputs, netDevice); next;
+         next = nextElementwise(next, externalOutputs, netDevice)) {
+      chain.push_back(next);
+    }
+    const bool hasActivation =
+        std::any_of(chain.begin(), chain.end(), [](repr::NNGraph::NodeRef n) {
+          return isElementwiseActivation(getOpDef(n)->type());
+        });
+    if (chain.size() > 1 && hasActivation) {
+      chains.push_back(chain);
+    }
+  }
+  for (const auto& chain : chains) {
+    fuseElementwiseChain(nn, chain);
   }
 }
 
 REGISTER_WS_OPT_PASS_FROM_FUNC(FuseConvBN, fuseConvBN);
+REGISTER_WS_OPT_PASS_FROM_FUNC(FuseNormalization, fuseNormalization);
+REGISTER_OPT_PASS_FROM_FUNC(FuseBiasActivation, fuseBiasActivation);
+REGISTER_OPT_PASS_FROM_FUNC(FuseElementwise, fuseElementwise);
 
 } // namespace opt
 } // namespace caffe2
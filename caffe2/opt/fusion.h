@@ -17,6 +17,10 @@
 #ifndef CAFFE2_OPT_FUSION_H_
 #define CAFFE2_OPT_FUSION_H_
 
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 #include "caffe2/core/workspace.h"
 #include "nomnigraph/Representations/NeuralNet.h"
 
@@ -25,8 +29,47 @@ namespace opt {
 
 using namespace nom;
 
+// Finds chains of operators with the given caffe2 types, using nom::Match.
+// Each chain is in order, and the single output of every operator but the
+// last is only read by the next operator.
+std::vector<std::vector<repr::NNGraph::NodeRef>> matchOperatorChains(
+    repr::NNModule* nn,
+    const std::vector<std::string>& types);
+
+// Removes `consumer`, which reads the single output of `node`, and makes
+// `node` write the output of `consumer` instead.
+void fuseIntoProducer(
+    repr::NNModule* nn,
+    repr::NNGraph::NodeRef node,
+    repr::NNGraph::NodeRef consumer);
+
+// Folds inference SpatialBN and AffineChannel into the weights and bias of a
+// preceding Conv or FC, by rewriting them in `ws`. A Conv without a bias gets
+// a new "<filter>_bias" blob. Weights read by other operators are left alone.
+void fuseNormalization(
+    repr::NNModule* nn,
+    caffe2::Workspace* ws,
+    const std::unordered_set<std::string>& externalOutputs = {});
 void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws);
 
+// Moves a Relu, Sigmoid or Tanh following a CPU Conv or FC into the
+// "activation" argument of the Conv or FC, which then applies it together
+// with the bias, while the output is still in cache. Operators without a
+// device option run on `netDevice`, the device option of the net.
+void fuseBiasActivation(
+    repr::NNModule* nn,
+    const std::unordered_set<std::string>& externalOutputs = {},
+    const DeviceOption& netDevice = DeviceOption());
+
+// Replaces chains of CPU Add, Mul, Relu, Sigmoid and Tanh, where every
+// intermediate result is only read by the next operator, with a single
+// FusedElementwise operator. Only chains containing one of the float-only
+// activations are fused, which makes every tensor on them float.
+void fuseElementwise(
+    repr::NNModule* nn,
+    const std::unordered_set<std::string>& externalOutputs = {},
+    const DeviceOption& netDevice = DeviceOption());
+
 // Generic activation fusion helper.
 //
 // \tparam OperationT The operator to be fused.
@@ -73,43 +116,7 @@ void fuseActivation(
     }
 
     // Ready to fuse
-    auto relu_output = relu_outputs.front();
-    auto output_tensor = repr::nn::get<repr::Tensor>(relu_output);
-    auto output_node = relu_output;
-    auto input_tensor =
-        repr::nn::get<repr::Tensor>(repr::nn::getInputs(conv_node).front());
-
-    // Conv cannot be in-place
-    if (output_tensor->getName() != input_tensor->getName()) {
-      nn->dataFlow.replaceNode(conv_output, relu_output);
-      nn->dataFlow.deleteNode(relu_node);
-      nn->dataFlow.deleteNode(conv_output);
-    } else {
-      nn->dataFlow.replaceNode(relu_output, conv_output);
-      output_tensor = repr::nn::get<repr::Tensor>(conv_output);
-      output_node = conv_output;
-      nn->dataFlow.deleteNode(relu_node);
-      nn->dataFlow.deleteNode(relu_output);
-    }
-
-    // We may have accidentally made the next op in-place
-    // In future iterations of transformations this won't be an issue,
-    // but current caffe2 predictor usage requires things like
-    // external_input and output to be unchanged.
-    bool rectify_inplace = false;
-    for (auto& consumer : repr::nn::getConsumers(output_node)) {
-      for (auto& consumer_output : repr::nn::getOutputs(consumer)) {
-        auto co_name = repr::nn::get<repr::Tensor>(consumer_output)->getName();
-        if (co_name == output_tensor->getName()) {
-          rectify_inplace = true;
-        }
-      }
-    }
-    if (rectify_inplace) {
-      auto new_output = nn->dataFlow.createNode(
-          make_unique<repr::Tensor>(output_tensor->getName() + "_fusion_fix"));
-      nn->dataFlow.replaceNode(output_node, new_output);
-    }
+    fuseIntoProducer(nn, conv_node, relu_node);
 
     // Application specific logic for postprocessing the conv node
     postprocess(conv_node);
@@ -0,0 +1,260 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/core/net.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/fusion.h"
+#include "caffe2/opt/optimizer.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+CAFFE2_DECLARE_int(caffe2_conv_col_buffer_band_size);
+
+namespace caffe2 {
+
+namespace {
+
+void FillRandom(
+    Workspace* ws,
+    const string& name,
+    vector<TIndex> dims,
+    float min = -1.f,
+    float max = 1.f) {
+  static std::mt19937 gen(2018);
+  std::uniform_real_distribution<float> dist(min, max);
+  auto* t = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+  t->Resize(dims);
+  float* data = t->mutable_data<float>();
+  for (TIndex i = 0; i < t->size(); ++i) {
+    data[i] = dist(gen);
+  }
+}
+
+void AddOp(
+    NetDef* net,
+    const string& type,
+    const vector<string>& inputs,
+    const string& output,
+    const vector<Argument>& args = {}) {
+  *net->add_op() = CreateOperatorDef(type, "", inputs, {output}, args);
+}
+
+// Runs `net` with every blob of `ws` as input, optimizes it and runs it again,
+// and checks that "Y" didn't change. Returns the optimized net.
+NetDef RunOptimized(Workspace* ws, NetDef net) {
+  net.set_name("reference");
+  net.clear_external_input();
+  for (const auto& name : ws->Blobs()) {
+    net.add_external_input(name);
+  }
+  EXPECT_TRUE(ws->RunNetOnce(net));
+  TensorCPU Y_ref;
+  Y_ref.CopyFrom(ws->GetBlob("Y")->Get<TensorCPU>());
+  auto optimized = opt::optimize(net, ws, 1);
+  optimized.set_name("optimized");
+  EXPECT_TRUE(ws->RunNetOnce(optimized));
+  const auto& Y = ws->GetBlob("Y")->Get<TensorCPU>();
+  EXPECT_EQ(Y_ref.dims(), Y.dims());
+  for (TIndex i = 0; i < Y.size(); ++i) {
+    EXPECT_NEAR(Y_ref.data<float>()[i], Y.data<float>()[i], 1e-4);
+  }
+  return optimized;
+}
+
+vector<string> OpTypes(const NetDef& net) {
+  vector<string> types;
+  for (const auto& op : net.op()) {
+    types.push_back(op.type());
+  }
+  return types;
+}
+
+// Conv (no bias) -> SpatialBN -> Relu -> FC -> AffineChannel -> Sigmoid
+NetDef ConvBNReluFCNet(const string& order) {
+  NetDef net;
+  AddOp(
+      &net,
+      "Conv",
+      {"X", "W"},
+      "Y_conv",
+      {MakeArgument<int>("kernel", 3),
+       MakeArgument<int>("pad", 1),
+       MakeArgument<string>("order", order)});
+  AddOp(
+      &net,
+      "SpatialBN",
+      {"Y_conv", "scale", "bias", "mean", "var"},
+      "Y_bn",
+      {MakeArgument<int>("is_test", 1), MakeArgument<string>("order", order)});
+  AddOp(&net, "Relu", {"Y_bn"}, "Y_relu");
+  AddOp(&net, "FC", {"Y_relu", "W_fc", "b_fc"}, "Y_fc");
+  AddOp(&net, "AffineChannel", {"Y_fc", "scale_fc", "bias_fc"}, "Y_affine");
+  AddOp(&net, "Sigmoid", {"Y_affine"}, "Y");
+  net.add_external_output("Y");
+  return net;
+}
+
+void FillConvBNReluFC(Workspace* ws, const string& order) {
+  if (order == "NCHW") {
+    FillRandom(ws, "X", {2, 4, 8, 8});
+    FillRandom(ws, "W", {6, 4, 3, 3});
+  } else {
+    FillRandom(ws, "X", {2, 8, 8, 4});
+    FillRandom(ws, "W", {6, 3, 3, 4});
+  }
+  FillRandom(ws, "scale", {6});
+  FillRandom(ws, "bias", {6});
+  FillRandom(ws, "mean", {6});
+  FillRandom(ws, "var", {6}, 0.5f, 1.f);
+  FillRandom(ws, "W_fc", {5, 6 * 8 * 8});
+  FillRandom(ws, "b_fc", {5});
+  FillRandom(ws, "scale_fc", {5});
+  FillRandom(ws, "bias_fc", {5});
+}
+
+} // namespace
+
+TEST(FusionTest, ConvBNReluFC) {
+  for (const string order : {"NCHW", "NHWC"}) {
+    for (const int band_size : {0, 4 * 9 * 8 * 3}) {
+      // Banded convolutions apply the activation one band at a time.
+      FLAGS_caffe2_conv_col_buffer_band_size = band_size;
+      Workspace ws;
+      FillConvBNReluFC(&ws, order);
+      auto net = RunOptimized(&ws, ConvBNReluFCNet(order));
+      ASSERT_EQ(vector<string>({"Conv", "FC"}), OpTypes(net));
+      EXPECT_EQ(3, net.op(0).input_size());
+      EXPECT_EQ("W_bias", net.op(0).input(2));
+      EXPECT_EQ(
+          "Relu",
+          ArgumentHelper(net.op(0)).GetSingleArgument<string>(
+              "activation", ""));
+      EXPECT_EQ("Y_relu", net.op(0).output(0));
+      EXPECT_EQ(
+          "Sigmoid",
+          ArgumentHelper(net.op(1)).GetSingleArgument<string>(
+              "activation", ""));
+      EXPECT_EQ("Y", net.op(1).output(0));
+    }
+  }
+  FLAGS_caffe2_conv_col_buffer_band_size = 0;
+}
+
+TEST(FusionTest, SharedWeightsAreNotFolded) {
+  Workspace ws;
+  FillConvBNReluFC(&ws, "NCHW");
+  FillRandom(&ws, "X2", {2, 4, 8, 8});
+  auto net = ConvBNReluFCNet("NCHW");
+  AddOp(
+      &net,
+      "Conv",
+      {"X2", "W"},
+      "Y2",
+      {MakeArgument<int>("kernel", 3), MakeArgument<int>("pad", 1)});
+  net.add_external_output("Y2");
+  net = RunOptimized(&ws, net);
+  EXPECT_EQ(
+      vector<string>({"Conv", "SpatialBN", "Relu", "FC", "Conv"}),
+      OpTypes(net));
+}
+
+TEST(FusionTest, ElementwiseChain) {
+  Workspace ws;
+  FillRandom(&ws, "X", {4, 3, 100});
+  FillRandom(&ws, "A", {3, 100});
+  FillRandom(&ws, "B", {3, 1});
+  FillRandom(&ws, "C", {1});
+  NetDef net;
+  AddOp(&net, "Mul", {"X", "A"}, "T1");
+  AddOp(&net, "Add", {"B", "T1"}, "T2");
+  AddOp(&net, "Tanh", {"T2"}, "T3");
+  AddOp(&net, "Mul", {"T3", "C"}, "T4");
+  AddOp(&net, "Relu", {"T4"}, "T5");
+  AddOp(&net, "Add", {"T5", "X"}, "Y");
+  net.add_external_output("Y");
+  net = RunOptimized(&ws, net);
+  ASSERT_EQ(vector<string>({"FusedElementwise"}), OpTypes(net));
+  EXPECT_EQ(vector<string>({"X", "A", "B", "C"}),
+            vector<string>(net.op(0).input().begin(), net.op(0).input().end()));
+  EXPECT_EQ(
+      vector<int>({1, 2, -1, 3, -1, 0}),
+      ArgumentHelper(net.op(0)).GetRepeatedArgument<int>("operands"));
+}
+
+TEST(FusionTest, ElementwiseChainBoundaries) {
+  Workspace ws;
+  FillRandom(&ws, "X", {16});
+  FillRandom(&ws, "A", {16});
+  NetDef net;
+  // T3 and T7 are outputs of the net, and T4 is read twice.
+  AddOp(&net, "Add", {"X", "A"}, "T1");
+  AddOp(&net, "Mul", {"T1", "A"}, "T2");
+  AddOp(&net, "Relu", {"T2"}, "T3");
+  AddOp(&net, "Sigmoid", {"T3"}, "T4");
+  AddOp(&net, "Mul", {"T4", "T4"}, "T5");
+  AddOp(&net, "Tanh", {"T5"}, "T6");
+  AddOp(&net, "Add", {"T6", "A"}, "T7");
+  // Without an activation the tensors might not be float.
+  AddOp(&net, "Add", {"T7", "A"}, "T8");
+  AddOp(&net, "Mul", {"T8", "X"}, "Y");
+  net.add_external_output("T3");
+  net.add_external_output("T7");
+  net.add_external_output("Y");
+  net = RunOptimized(&ws, net);
+  EXPECT_EQ(
+      vector<string>({"FusedElementwise",
+                      "Sigmoid",
+                      "FusedElementwise",
+                      "Add",
+                      "Mul"}),
+      OpTypes(net));
+  EXPECT_EQ("T3", net.op(0).output(0));
+  EXPECT_EQ(
+      vector<int>({0, -1, 1}),
+      ArgumentHelper(net.op(2)).GetRepeatedArgument<int>("operands"));
+}
+
+TEST(FusionTest, NetDeviceOption) {
+  NetDef net;
+  AddOp(&net, "FC", {"X", "W", "b"}, "Y_fc");
+  AddOp(&net, "Relu", {"Y_fc"}, "Y_relu");
+  AddOp(&net, "Mul", {"Y_relu", "A"}, "Y_mul");
+  AddOp(&net, "Sigmoid", {"Y_mul"}, "Y");
+  net.add_external_output("Y");
+  const vector<string> unfused({"FC", "Relu", "Mul", "Sigmoid"});
+  // The operators have no device option of their own, and run on the GPU.
+  net.mutable_device_option()->set_device_type(CUDA);
+  EXPECT_EQ(unfused, OpTypes(opt::optimize(net, 1)));
+  net.mutable_device_option()->set_device_type(CPU);
+  EXPECT_EQ(
+      vector<string>({"FC", "FusedElementwise"}),
+      OpTypes(opt::optimize(net, 1)));
+}
+
+TEST(FusionTest, MatchOperatorChains) {
+  NetDef net;
+  AddOp(&net, "Conv", {"X", "W"}, "Y1");
+  AddOp(&net, "Relu", {"Y1"}, "Y2");
+  AddOp(&net, "Conv", {"Y2", "W"}, "Y3");
+  AddOp(&net, "Relu", {"Y3"}, "Y4");
+  AddOp(&net, "Sigmoid", {"Y3"}, "Y5");
+  auto nn = convertToNNModule(net);
+  auto chains = opt::matchOperatorChains(&nn, {"Conv", "Relu"});
+  // The second Conv has two consumers.
+  ASSERT_EQ(1, chains.size());
+  ASSERT_EQ(2, chains[0].size());
+  EXPECT_EQ(
+      "Y1",
+      nom::repr::nn::get<nom::repr::Tensor>(
+          nom::repr::nn::getInputs(chains[0][1]).front())
+          ->getName());
+  EXPECT_EQ(0, opt::matchOperatorChains(&nn, {"Relu", "Conv", "Sigmoid"})
+                   .size());
+  EXPECT_EQ(3, opt::matchOperatorChains(&nn, {"Conv", "Relu", "Conv"})
+                   .front()
+                   .size());
+}
+
+} // namespace caffe2
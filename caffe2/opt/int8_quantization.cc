@@ -0,0 +1,390 @@
+#include "caffe2/opt/int8_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+namespace opt {
+
+using namespace nom;
+
+TensorQuantizationParams chooseQuantizationParams(float min, float max) {
+  min = std::min(min, 0.f);
+  max = std::max(max, 0.f);
+  TensorQuantizationParams params;
+  params.scale = (max - min) / 255.f;
+  if (params.scale == 0.f) {
+    params.scale = 1.f;
+  }
+  const float zero_point = std::nearbyint(-min / params.scale);
+  params.zero_point =
+      static_cast<int32_t>(std::min(std::max(zero_point, 0.f), 255.f));
+  return params;
+}
+
+namespace {
+
+OperatorDef* getMutableOpDef(repr::NNGraph::NodeRef node) {
+  auto* nnOp = repr::nn::get<repr::NeuralNetOperator>(node);
+  auto* annotation = nnOp->getMutableAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return dyn_cast<Caffe2Annotation>(annotation)->getMutableOperatorDef();
+}
+
+std::string getName(repr::NNGraph::NodeRef node) {
+  return repr::nn::get<repr::NeuralNetData>(node)->getName();
+}
+
+bool hasWeights(const std::string& int8Type) {
+  return int8Type == "Int8Conv" || int8Type == "Int8FC";
+}
+
+// Ops whose output quantization is determined by their input or fixed by the
+// op, rather than chosen from the calibrated output range.
+bool hasFixedOutputQuantization(const std::string& int8Type) {
+  return int8Type == "Int8Relu" || int8Type == "Int8MaxPool" ||
+      int8Type == "Int8Sigmoid";
+}
+
+bool isNHWC(const OperatorDef& op) {
+  return ArgumentHelper::GetSingleArgument<OperatorDef, std::string>(
+             op, "order", "NCHW") == "NHWC";
+}
+
+// Returns the Int8* operator implementing `op`, or "" if there is none.
+std::string getInt8Type(const OperatorDef& op) {
+  const auto& type = op.type();
+  if (type == "Conv") {
+    const auto kernels =
+        ArgumentHelper::GetRepeatedArgument<OperatorDef, int>(op, "kernels");
+    if (op.input_size() != 3 || !isNHWC(op) ||
+        (!kernels.empty() && kernels.size() != 2)) {
+      return "";
+    }
+    return "Int8Conv";
+  }
+  if (type == "FC") {
+    return op.input_size() == 3 ? "Int8FC" : "";
+  }
+  if (type == "MaxPool" || type == "AveragePool") {
+    return isNHWC(op) ? "Int8" + type : "";
+  }
+  if (type == "Relu" || type == "Sigmoid" || type == "Concat") {
+    return "Int8" + type;
+  }
+  if ((type == "Add" || type == "Sum") && op.input_size() == 2 &&
+      !ArgumentHelper::GetSingleArgument<OperatorDef, bool>(
+          op, "broadcast", false)) {
+    return "Int8Add";
+  }
+  return "";
+}
+
+const TensorCPU* getFloatTensor(Workspace* ws, const std::string& name) {
+  if (!ws->HasBlob(name)) {
+    return nullptr;
+  }
+  const auto* blob = ws->GetBlob(name);
+  if (!blob->IsType<TensorCPU>() || !blob->Get<TensorCPU>().IsType<float>()) {
+    return nullptr;
+  }
+  return &blob->Get<TensorCPU>();
+}
+
+TensorQuantizationParams getWeightParams(const TensorCPU& W) {
+  const float* data = W.data<float>();
+  const auto minmax = std::minmax_element(data, data + W.size());
+  return chooseQuantizationParams(*minmax.first, *minmax.second);
+}
+
+// Moves edge `e` to start at `newTail`. The edge object itself is kept, so
+// its position among the head's inputs (i.e. the input index) is unchanged.
+void moveEdgeTail(repr::NNGraph::EdgeRef e, repr::NNGraph::NodeRef newTail) {
+  e->tail()->removeOutEdge(e);
+  e->setTail(newTail);
+  newTail->addOutEdge(e);
+}
+
+repr::NNGraph::NodeRef createOperatorNode(
+    repr::NNModule* nn,
+    const OperatorDef& def) {
+  auto node =
+      nn->dataFlow.createNode(util::make_unique<repr::GenericOperator>(
+          def.type()));
+  auto annotation = util::make_unique<Caffe2Annotation>();
+  annotation->setOperatorDef(def);
+  repr::nn::get<repr::NeuralNetOperator>(node)->setAnnotation(
+      std::move(annotation));
+  return node;
+}
+
+void quantizeWeight(
+    Workspace* ws,
+    const TensorCPU& W,
+    const TensorQuantizationParams& params,
+    const std::string& name,
+    NetDef* initNet) {
+  auto* W_int8 = ws->CreateBlob(name)->GetMutable<int8::Int8TensorCPU>();
+  W_int8->scale = params.scale;
+  W_int8->zero_point = params.zero_point;
+  W_int8->t.ResizeLike(W);
+  const float* W_data = W.data<float>();
+  uint8_t* W_int8_data = W_int8->t.mutable_data<uint8_t>();
+  for (TIndex i = 0; i < W.size(); ++i) {
+    const float q =
+        std::nearbyint(W_data[i] / params.scale) + params.zero_point;
+    W_int8_data[i] = static_cast<uint8_t>(std::min(std::max(q, 0.f), 255.f));
+  }
+  if (initNet) {
+    *initNet->add_op() = CreateOperatorDef(
+        "Int8GivenTensorFill",
+        "",
+        std::vector<std::string>{},
+        std::vector<std::string>{name},
+        std::vector<Argument>{
+            MakeArgument<std::string>(
+                "values",
+                std::string(
+                    reinterpret_cast<const char*>(W_int8_data), W.size())),
+            MakeArgument<std::vector<int64_t>>("shape", W.dims()),
+            MakeArgument<float>("Y_scale", params.scale),
+            MakeArgument<int>("Y_zero_point", params.zero_point)});
+  }
+}
+
+void quantizeBias(
+    Workspace* ws,
+    const TensorCPU& b,
+    float scale,
+    const std::string& name,
+    NetDef* initNet) {
+  auto* b_int8 = ws->CreateBlob(name)->GetMutable<int8::Int8TensorCPU>();
+  b_int8->scale = scale;
+  b_int8->zero_point = 0;
+  b_int8->t.ResizeLike(b);
+  const float* b_data = b.data<float>();
+  int32_t* b_int8_data = b_int8->t.mutable_data<int32_t>();
+  for (TIndex i = 0; i < b.size(); ++i) {
+    b_int8_data[i] = static_cast<int32_t>(std::nearbyint(b_data[i] / scale));
+  }
+  if (initNet) {
+    *initNet->add_op() = CreateOperatorDef(
+        "Int8GivenIntTensorFill",
+        "",
+        std::vector<std::string>{},
+        std::vector<std::string>{name},
+        std::vector<Argument>{
+            MakeArgument<std::vector<int>>(
+                "values",
+                std::vector<int>(b_int8_data, b_int8_data + b.size())),
+            MakeArgument<std::vector<int64_t>>("shape", b.dims()),
+            MakeArgument<float>("Y_scale", scale),
+            MakeArgument<int>("Y_zero_point", 0)});
+  }
+}
+
+} // namespace
+
+void quantizeInt8(
+    repr::NNModule* nn,
+    Workspace* ws,
+    const TensorRanges& ranges,
+    const std::unordered_set<std::string>& externalOutputs,
+    NetDef* initNet) {
+  auto getParams = [&](repr::NNGraph::NodeRef data) {
+    const auto& range = ranges.at(getName(data));
+    return chooseQuantizationParams(range.first, range.second);
+  };
+  auto hasRange = [&](repr::NNGraph::NodeRef data) {
+    return ranges.count(getName(data)) > 0;
+  };
+
+  // 1. Pick the operators to convert.
+  std::unordered_map<repr::NNGraph::NodeRef, std::string> int8Types;
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    if (!repr::nn::is<repr::NeuralNetOperator>(node)) {
+      continue;
+    }
+    const auto* op = getMutableOpDef(node);
+    if (!op) {
+      continue;
+    }
+    const auto int8Type = getInt8Type(*op);
+    if (int8Type.empty()) {
+      continue;
+    }
+    const auto inputs = repr::nn::getInputs(node);
+    const auto outputs = repr::nn::getOutputs(node);
+    const size_t numActivations = hasWeights(int8Type) ? 1 : inputs.size();
+    bool ok = !outputs.empty() && hasRange(outputs[0]);
+    for (size_t i = 0; ok && i < numActivations; ++i) {
+      ok = hasRange(inputs[i]);
+    }
+    if (!ok) {
+      continue;
+    }
+    if (int8Type == "Int8Concat") {
+      // Int8Concat does not produce the split_info output.
+      if (outputs.size() > 2 ||
+          (outputs.size() == 2 &&
+           (repr::nn::hasConsumer(outputs[1]) ||
+            externalOutputs.count(getName(outputs[1]))))) {
+        continue;
+      }
+    }
+    if (int8Type == "Int8Add") {
+      // Int8Add doesn't broadcast; rely on the shapes seen in calibration.
+      const auto* A = getFloatTensor(ws, getName(inputs[0]));
+      const auto* B = getFloatTensor(ws, getName(inputs[1]));
+      if (!A || !B || A->dims() != B->dims()) {
+        continue;
+      }
+    }
+    if (hasWeights(int8Type)) {
+      const auto* W = getFloatTensor(ws, getName(inputs[1]));
+      const auto* b = getFloatTensor(ws, getName(inputs[2]));
+      if (!W || !b || W->size() == 0) {
+        continue;
+      }
+      // The requantization multiplier must be below one.
+      const float multiplier = getParams(inputs[0]).scale *
+          getWeightParams(*W).scale / getParams(outputs[0]).scale;
+      if (!(multiplier < 1.f)) {
+        continue;
+      }
+    }
+    int8Types[node] = int8Type;
+  }
+
+  // 2. Collect the activations around them before any edge moves.
+  std::vector<repr::NNGraph::NodeRef> activations;
+  std::unordered_set<repr::NNGraph::NodeRef> seen;
+  for (const auto& kv : int8Types) {
+    const auto inputs = repr::nn::getInputs(kv.first);
+    const size_t numActivations = hasWeights(kv.second) ? 1 : inputs.size();
+    for (size_t i = 0; i < numActivations; ++i) {
+      if (seen.insert(inputs[i]).second) {
+        activations.push_back(inputs[i]);
+      }
+    }
+    const auto output = repr::nn::getOutputs(kv.first).front();
+    if (seen.insert(output).second) {
+      activations.push_back(output);
+    }
+  }
+
+  // 3. Convert the operators and their weights.
+  for (const auto& kv : int8Types) {
+    auto node = kv.first;
+    const auto& int8Type = kv.second;
+    auto* op = getMutableOpDef(node);
+    const auto inputs = repr::nn::getInputs(node);
+    const auto outputs = repr::nn::getOutputs(node);
+    const auto inEdges = node->getInEdges();
+
+    if (hasWeights(int8Type)) {
+      const auto& W = *getFloatTensor(ws, getName(inputs[1]));
+      const auto& b = *getFloatTensor(ws, getName(inputs[2]));
+      const auto W_params = getWeightParams(W);
+      const auto W_name = getName(inputs[1]) + "_int8";
+      const auto b_name = getName(inputs[2]) + "_int8";
+      quantizeWeight(ws, W, W_params, W_name, initNet);
+      quantizeBias(
+          ws, b, getParams(inputs[0]).scale * W_params.scale, b_name, initNet);
+      moveEdgeTail(
+          inEdges[1],
+          nn->dataFlow.createNode(util::make_unique<repr::Tensor>(W_name)));
+      moveEdgeTail(
+          inEdges[2],
+          nn->dataFlow.createNode(util::make_unique<repr::Tensor>(b_name)));
+    }
+
+    if (int8Type == "Int8Concat") {
+      if (!ArgumentHelper::HasArgument(*op, "axis")) {
+        AddArgument<int>("axis", isNHWC(*op) ? 3 : 1, op);
+      }
+      if (outputs.size() == 2) {
+        nn->dataFlow.deleteNode(outputs[1]);
+      }
+    }
+
+    if (!hasFixedOutputQuantization(int8Type)) {
+      const auto Y_params = getParams(outputs[0]);
+      AddArgument<float>("Y_scale", Y_params.scale, op);
+      AddArgument<int>("Y_zero_point", Y_params.zero_point, op);
+    }
+    op->set_type(int8Type);
+    op->clear_engine();
+  }
+
+  // 4. Rename int8 activations and insert (de)quantization at boundaries.
+  auto isInt8Op = [&](repr::NNGraph::NodeRef node) {
+    return int8Types.count(node) > 0;
+  };
+  for (auto data : activations) {
+    const std::string name = getName(data);
+    if (repr::nn::hasProducer(data) &&
+        isInt8Op(repr::nn::getProducer(data))) {
+      auto int8Data =
+          nn->dataFlow.createNode(util::make_unique<repr::Tensor>(
+              name + "_int8"));
+      nn->dataFlow.replaceNode(data, int8Data);
+      nn->dataFlow.deleteNode(data);
+
+      std::vector<repr::NNGraph::EdgeRef> fp32Edges;
+      for (auto e : int8Data->getOutEdges()) {
+        if (!isInt8Op(e->head())) {
+          fp32Edges.push_back(e);
+        }
+      }
+      if (fp32Edges.empty() && !int8Data->getOutEdges().empty() &&
+          !externalOutputs.count(name)) {
+        continue;
+      }
+      OperatorDef dequantize;
+      dequantize.set_type("Int8Dequantize");
+      auto dequantizeNode = createOperatorNode(nn, dequantize);
+      auto fp32Data =
+          nn->dataFlow.createNode(util::make_unique<repr::Tensor>(name));
+      nn->dataFlow.createEdge(int8Data, dequantizeNode);
+      nn->dataFlow.createEdge(dequantizeNode, fp32Data);
+      for (auto e : fp32Edges) {
+        moveEdgeTail(e, fp32Data);
+      }
+    } else {
+      std::vector<repr::NNGraph::EdgeRef> int8Edges;
+      for (auto e : data->getOutEdges()) {
+        if (isInt8Op(e->head())) {
+          int8Edges.push_back(e);
+        }
+      }
+      if (int8Edges.empty()) {
+        continue;
+      }
+      const auto params = getParams(data);
+      OperatorDef quantize;
+      quantize.set_type("Int8Quantize");
+      AddArgument<float>("Y_scale", params.scale, &quantize);
+      AddArgument<int>("Y_zero_point", params.zero_point, &quantize);
+      auto quantizeNode = createOperatorNode(nn, quantize);
+      auto int8Data =
+          nn->dataFlow.createNode(util::make_unique<repr::Tensor>(
+              name + "_int8"));
+      nn->dataFlow.createEdge(data, quantizeNode);
+      nn->dataFlow.createEdge(quantizeNode, int8Data);
+      for (auto e : int8Edges) {
+        moveEdgeTail(e, int8Data);
+      }
+    }
+  }
+}
+
+} // namespace opt
+} // namespace caffe2
@@ -0,0 +1,54 @@
+#ifndef CAFFE2_OPT_INT8_QUANTIZATION_H_
+#define CAFFE2_OPT_INT8_QUANTIZATION_H_
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/proto/caffe2.pb.h"
+#include "nomnigraph/Representations/NeuralNet.h"
+
+namespace caffe2 {
+namespace opt {
+
+struct TensorQuantizationParams {
+  float scale;
+  int32_t zero_point;
+};
+
+// Maps a blob name to the (min, max) of the values it took during
+// calibration, e.g. as recorded by CalibrationNetObserver.
+using TensorRanges =
+    std::unordered_map<std::string, std::pair<float, float>>;
+
+// Picks an asymmetric uint8 quantization covering [min, max] and zero, so
+// that zero is exactly representable (required for padding and Relu).
+TensorQuantizationParams chooseQuantizationParams(float min, float max);
+
+// Rewrites every operator that has an Int8* counterpart, calibration ranges
+// for all of its activations and (for Conv/FC) float weights in `ws` into
+// the int8 version.
+//
+// - Weights and biases are quantized into new "<name>_int8" blobs in `ws`.
+//   If `initNet` is given, Int8GivenTensorFill/Int8GivenIntTensorFill ops
+//   recreating them are appended to it so the result can be deployed.
+// - Activations passed between int8 ops are renamed to "<name>_int8".
+//   Int8Quantize is inserted where an fp32 tensor feeds an int8 op and
+//   Int8Dequantize where an int8 tensor feeds an fp32 op or leaves the net,
+//   writing to the original name so fp32 consumers and `externalOutputs`
+//   are unaffected.
+//
+// Convolutions and pools are only converted when they are NHWC.
+void quantizeInt8(
+    nom::repr::NNModule* nn,
+    Workspace* ws,
+    const TensorRanges& ranges,
+    const std::unordered_set<std::string>& externalOutputs = {},
+    NetDef* initNet = nullptr);
+
+} // namespace opt
+} // namespace caffe2
+
+#endif // CAFFE2_OPT_INT8_QUANTIZATION_H_
@@ -0,0 +1,148 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/observers/calibration_observer.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/int8_quantization.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace caffe2 {
+
+namespace {
+
+void FillRandom(Workspace* ws, const string& name, vector<TIndex> dims) {
+  static std::mt19937 gen(2018);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  auto* t = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+  t->Resize(dims);
+  float* data = t->mutable_data<float>();
+  for (TIndex i = 0; i < t->size(); ++i) {
+    data[i] = dist(gen);
+  }
+}
+
+NetDef ConvReluFCNet() {
+  NetDef net;
+  net.set_name("fp32");
+  *net.add_op() = CreateOperatorDef(
+      "Conv",
+      "",
+      vector<string>{"X", "W", "b"},
+      vector<string>{"Y_conv"},
+      vector<Argument>{MakeArgument<int>("kernel", 3),
+                       MakeArgument<int>("pad", 1),
+                       MakeArgument<string>("order", "NHWC")});
+  *net.add_op() = CreateOperatorDef(
+      "Relu", "", vector<string>{"Y_conv"}, vector<string>{"Y_relu"});
+  *net.add_op() = CreateOperatorDef(
+      "FC", "", vector<string>{"Y_relu", "W_fc", "b_fc"}, vector<string>{"Y"});
+  net.add_external_input("X");
+  net.add_external_output("Y");
+  return net;
+}
+
+} // namespace
+
+TEST(Int8QuantizationTest, ConvReluFC) {
+  Workspace ws;
+  FillRandom(&ws, "X", {2, 6, 6, 4});
+  FillRandom(&ws, "W", {8, 3, 3, 4});
+  FillRandom(&ws, "b", {8});
+  FillRandom(&ws, "W_fc", {5, 6 * 6 * 8});
+  FillRandom(&ws, "b_fc", {5});
+
+  auto net = ConvReluFCNet();
+  auto* fp32Net = ws.CreateNet(net);
+  ASSERT_NE(fp32Net, nullptr);
+  auto* observer = fp32Net->AttachObserver(
+      caffe2::make_unique<CalibrationNetObserver>(fp32Net));
+  ASSERT_TRUE(fp32Net->Run());
+  opt::TensorRanges ranges;
+  for (const auto& kv :
+       static_cast<const CalibrationNetObserver*>(observer)->tensorRanges()) {
+    ranges[kv.first] = std::make_pair(kv.second.min, kv.second.max);
+  }
+  fp32Net->DetachObserver(observer);
+  EXPECT_EQ(ranges.count("X"), 1);
+  EXPECT_EQ(ranges.count("Y_relu"), 1);
+  EXPECT_GE(ranges["Y_relu"].first, 0.f);
+  TensorCPU Y_ref;
+  Y_ref.CopyFrom(ws.GetBlob("Y")->Get<TensorCPU>());
+
+  auto nn = convertToNNModule(net);
+  NetDef initNet;
+  opt::quantizeInt8(&nn, &ws, ranges, {"Y"}, &initNet);
+  auto int8Net = convertToCaffe2Proto(nn, net);
+  int8Net.set_name("int8");
+
+  vector<string> types;
+  for (const auto& op : int8Net.op()) {
+    types.push_back(op.type());
+  }
+  EXPECT_EQ(
+      types,
+      (vector<string>{"Int8Quantize",
+                      "Int8Conv",
+                      "Int8Relu",
+                      "Int8FC",
+                      "Int8Dequantize"}));
+  EXPECT_EQ(int8Net.op(1).input(1), "W_int8");
+  EXPECT_EQ(int8Net.op(3).input(2), "b_fc_int8");
+  EXPECT_EQ(int8Net.op(4).output(0), "Y");
+  EXPECT_EQ(initNet.op_size(), 4);
+
+  // The init net must reproduce the weights quantized into the workspace.
+  Workspace initWs;
+  ASSERT_TRUE(initWs.RunNetOnce(initNet));
+  const auto& W = ws.GetBlob("W_int8")->Get<int8::Int8TensorCPU>();
+  const auto& W_init = initWs.GetBlob("W_int8")->Get<int8::Int8TensorCPU>();
+  EXPECT_EQ(W.scale, W_init.scale);
+  EXPECT_EQ(W.zero_point, W_init.zero_point);
+  ASSERT_EQ(W.t.dims(), W_init.t.dims());
+  for (TIndex i = 0; i < W.t.size(); ++i) {
+    EXPECT_EQ(W.t.data<uint8_t>()[i], W_init.t.data<uint8_t>()[i]);
+  }
+
+  ws.GetBlob("Y")->Reset();
+  ASSERT_TRUE(ws.RunNetOnce(int8Net));
+  const auto& Y = ws.GetBlob("Y")->Get<TensorCPU>();
+  ASSERT_EQ(Y.dims(), Y_ref.dims());
+  const float tolerance = 0.05f *
+      (ranges["Y"].second - std::min(ranges["Y"].first, 0.f));
+  for (TIndex i = 0; i < Y.size(); ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], Y_ref.data<float>()[i], tolerance);
+  }
+}
+
+TEST(Int8QuantizationTest, SkipsUncalibratedOps) {
+  Workspace ws;
+  FillRandom(&ws, "W", {8, 3, 3, 4});
+  FillRandom(&ws, "b", {8});
+  FillRandom(&ws, "W_fc", {5, 6 * 6 * 8});
+  FillRandom(&ws, "b_fc", {5});
+  auto net = ConvReluFCNet();
+  // No range for the FC output: the FC stays in fp32 and is fed through an
+  // Int8Dequantize of the Relu output.
+  opt::TensorRanges ranges = {{"X", {-1.f, 1.f}},
+                              {"Y_conv", {-3.f, 3.f}},
+                              {"Y_relu", {0.f, 3.f}}};
+  auto nn = convertToNNModule(net);
+  opt::quantizeInt8(&nn, &ws, ranges, {"Y"});
+  auto int8Net = convertToCaffe2Proto(nn, net);
+  vector<string> types;
+  for (const auto& op : int8Net.op()) {
+    types.push_back(op.type());
+  }
+  EXPECT_EQ(
+      types,
+      (vector<string>{
+          "Int8Quantize", "Int8Conv", "Int8Relu", "Int8Dequantize", "FC"}));
+  EXPECT_EQ(int8Net.op(4).input(0), "Y_relu");
+  EXPECT_EQ(int8Net.op(4).input(1), "W_fc");
+}
+
+} // namespace caffe2
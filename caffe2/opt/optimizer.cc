@@ -1,5 +1,7 @@
 #include "caffe2/opt/optimizer.h"
 
+#include <unordered_set>
+
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/mobile.h"
 #include "caffe2/opt/fusion.h"
@@ -7,23 +9,33 @@
 namespace caffe2 {
 namespace opt {
 
-void workspaceOptimizations(nom::repr::NNModule* nn, Workspace* ws, int level) {
+void workspaceOptimizations(
+    nom::repr::NNModule* nn,
+    Workspace* ws,
+    int level,
+    const std::unordered_set<std::string>& externalOutputs) {
   switch (level) {
     case 1:
-      opt::fuseConvBN(nn, ws);
+      opt::fuseNormalization(nn, ws, externalOutputs);
     case 0:
     default:
       break;
   }
 }
 
-void graphOptimzations(nom::repr::NNModule* nn, int level) {
+void graphOptimzations(
+    nom::repr::NNModule* nn,
+    int level,
+    const std::unordered_set<std::string>& externalOutputs,
+    const DeviceOption& netDevice) {
   switch (level) {
     case 1:
 #ifdef USE_NNPACK 
       opt::addNNPACK(nn, false);
       opt::fuseNNPACKConvRelu(nn);
 #endif
+      opt::fuseBiasActivation(nn, externalOutputs, netDevice);
+      opt::fuseElementwise(nn, externalOutputs, netDevice);
     case 0:
     default:
       break;
@@ -32,14 +44,37 @@ void graphOptimzations(nom::repr::NNModule* nn, int level) {
 
 NetDef optimize(NetDef net, Workspace* ws, int level) {
   auto nn = convertToNNModule(net);
-  graphOptimzations(&nn, level);
-  workspaceOptimizations(&nn, ws, level);
-  return convertToCaffe2Proto(nn, net);
+  const std::unordered_set<std::string> externalOutputs(
+      net.external_output().begin(), net.external_output().end());
+  // Normalizations are folded first, so that the activations following them
+  // can be fused.
+  const auto blobs = ws->Blobs();
+  const std::unordered_set<std::string> oldBlobs(blobs.begin(), blobs.end());
+  workspaceOptimizations(&nn, ws, level, externalOutputs);
+  graphOptimzations(&nn, level, externalOutputs, net.device_option());
+  auto optimized = convertToCaffe2Proto(nn, net);
+  // Blobs added to the workspace, such as biases created by folding a
+  // normalization, are inputs of the net.
+  std::unordered_set<std::string> newInputs;
+  for (const auto& op : optimized.op()) {
+    for (const auto& input : op.input()) {
+      if (!oldBlobs.count(input) && ws->HasBlob(input) &&
+          newInputs.insert(input).second) {
+        optimized.add_external_input(input);
+      }
+    }
+  }
+  return optimized;
 }
 
 NetDef optimize(NetDef net, int level) {
   auto nn = convertToNNModule(net);
-  graphOptimzations(&nn, level);
+  graphOptimzations(
+      &nn,
+      level,
+      std::unordered_set<std::string>(
+          net.external_output().begin(), net.external_output().end()),
+      net.device_option());
   return convertToCaffe2Proto(nn, net);
 }
 
@@ -0,0 +1,2779 @@
+//// --------------------------
+//// ATTENTION:
+//// THIS CODE IS AUTOGENERATED
+//// BY hp_emblookup_codegen.py
+//// DO NOT MODIFY!!!
+//// --------------------------
+
+#include <caffe2/core/common.h>
+#include <caffe2/core/types.h>
+#include <immintrin.h>
+#include "caffe2/perfkernels/cvtsh_ss_bugfix.h"
+
+namespace caffe2 {
+
+template <bool IS_WEIGHT_POSITIONAL>
+static void Fused4BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  const int32_t prefdist_T0 = 16;
+  const int32_t packed_block_size = (block_size + 1) / 2;
+  const int32_t fused_block_size = packed_block_size + 4;
+  const __m256i vshift = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+  const __m256i vmask = _mm256_set1_epi32(15);
+  if (block_size == 128) {
+    // unrolling 16 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      __m256 vop64 = _mm256_setzero_ps();
+      __m256 vop72 = _mm256_setzero_ps();
+      __m256 vop80 = _mm256_setzero_ps();
+      __m256 vop88 = _mm256_setzero_ps();
+      __m256 vop96 = _mm256_setzero_ps();
+      __m256 vop104 = _mm256_setzero_ps();
+      __m256 vop112 = _mm256_setzero_ps();
+      __m256 vop120 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (16))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (20))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (24))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (28))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+        vop64 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (32))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop64, vbio));
+        vop72 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (36))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop72, vbio));
+        vop80 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (40))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop80, vbio));
+        vop88 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (44))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop88, vbio));
+        vop96 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (48))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop96, vbio));
+        vop104 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (52))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop104, vbio));
+        vop112 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (56))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop112, vbio));
+        vop120 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (60))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop120, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+        vop64 = _mm256_mul_ps(vop64, vlen_inv);
+        vop72 = _mm256_mul_ps(vop72, vlen_inv);
+        vop80 = _mm256_mul_ps(vop80, vlen_inv);
+        vop88 = _mm256_mul_ps(vop88, vlen_inv);
+        vop96 = _mm256_mul_ps(vop96, vlen_inv);
+        vop104 = _mm256_mul_ps(vop104, vlen_inv);
+        vop112 = _mm256_mul_ps(vop112, vlen_inv);
+        vop120 = _mm256_mul_ps(vop120, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+      _mm256_storeu_ps(&op[64], vop64);
+      _mm256_storeu_ps(&op[72], vop72);
+      _mm256_storeu_ps(&op[80], vop80);
+      _mm256_storeu_ps(&op[88], vop88);
+      _mm256_storeu_ps(&op[96], vop96);
+      _mm256_storeu_ps(&op[104], vop104);
+      _mm256_storeu_ps(&op[112], vop112);
+      _mm256_storeu_ps(&op[120], vop120);
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (16))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (20))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (24))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (28))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+    }
+  } else {
+    // generic code
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(op + j, _mm256_setzero_ps());
+      }
+      for (; j < block_size; j++) {
+        op[j] = 0.0f;
+      }
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j],
+              _mm256_fmadd_ps(
+                  vwgt,
+                  _mm256_cvtepi32_ps(
+                      _mm256_and_si256(
+                          _mm256_srlv_epi32(
+                              _mm256_set1_epi32(
+                                  *reinterpret_cast<const int32_t*>(
+                                      ip + (j / 2))),
+                              vshift),
+                          vmask)),
+                  _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+          _mm_prefetch((&ip_next_T0[j / 2]), _MM_HINT_T0);
+        }
+        for (; j < block_size; j++) {
+          op[j] += wgt * ((float)((ip[j / 2] >> ((j % 2) * 4)) & 15)) + bio;
+        }
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        float len_inv = 1.0f / lengths[rangeIndex];
+        __m256 vlen_inv = _mm256_set1_ps(len_inv);
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));
+        }
+        for (; j < block_size; j++) {
+          op[j] = len_inv * op[j];
+        }
+      }
+    }
+  }
+}
+void Fused4BitRowwiseEmbeddingLookup_int32_t_uint8_t_float_false__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused4BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma<false>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+void Fused4BitRowwiseEmbeddingLookup_int32_t_uint8_t_float_true__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused4BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma<true>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+
+template <bool IS_WEIGHT_POSITIONAL>
+static void Fused4BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  const int64_t prefdist_T0 = 16;
+  const int64_t packed_block_size = (block_size + 1) / 2;
+  const int64_t fused_block_size = packed_block_size + 4;
+  const __m256i vshift = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+  const __m256i vmask = _mm256_set1_epi32(15);
+  if (block_size == 128) {
+    // unrolling 16 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      __m256 vop64 = _mm256_setzero_ps();
+      __m256 vop72 = _mm256_setzero_ps();
+      __m256 vop80 = _mm256_setzero_ps();
+      __m256 vop88 = _mm256_setzero_ps();
+      __m256 vop96 = _mm256_setzero_ps();
+      __m256 vop104 = _mm256_setzero_ps();
+      __m256 vop112 = _mm256_setzero_ps();
+      __m256 vop120 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (16))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (20))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (24))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (28))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+        vop64 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (32))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop64, vbio));
+        vop72 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (36))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop72, vbio));
+        vop80 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (40))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop80, vbio));
+        vop88 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (44))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop88, vbio));
+        vop96 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (48))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop96, vbio));
+        vop104 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (52))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop104, vbio));
+        vop112 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (56))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop112, vbio));
+        vop120 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (60))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop120, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+        vop64 = _mm256_mul_ps(vop64, vlen_inv);
+        vop72 = _mm256_mul_ps(vop72, vlen_inv);
+        vop80 = _mm256_mul_ps(vop80, vlen_inv);
+        vop88 = _mm256_mul_ps(vop88, vlen_inv);
+        vop96 = _mm256_mul_ps(vop96, vlen_inv);
+        vop104 = _mm256_mul_ps(vop104, vlen_inv);
+        vop112 = _mm256_mul_ps(vop112, vlen_inv);
+        vop120 = _mm256_mul_ps(vop120, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+      _mm256_storeu_ps(&op[64], vop64);
+      _mm256_storeu_ps(&op[72], vop72);
+      _mm256_storeu_ps(&op[80], vop80);
+      _mm256_storeu_ps(&op[88], vop88);
+      _mm256_storeu_ps(&op[96], vop96);
+      _mm256_storeu_ps(&op[104], vop104);
+      _mm256_storeu_ps(&op[112], vop112);
+      _mm256_storeu_ps(&op[120], vop120);
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (16))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (20))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (24))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (28))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const int32_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+    }
+  } else {
+    // generic code
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(op + j, _mm256_setzero_ps());
+      }
+      for (; j < block_size; j++) {
+        op[j] = 0.0f;
+      }
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j],
+              _mm256_fmadd_ps(
+                  vwgt,
+                  _mm256_cvtepi32_ps(
+                      _mm256_and_si256(
+                          _mm256_srlv_epi32(
+                              _mm256_set1_epi32(
+                                  *reinterpret_cast<const int32_t*>(
+                                      ip + (j / 2))),
+                              vshift),
+                          vmask)),
+                  _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+          _mm_prefetch((&ip_next_T0[j / 2]), _MM_HINT_T0);
+        }
+        for (; j < block_size; j++) {
+          op[j] += wgt * ((float)((ip[j / 2] >> ((j % 2) * 4)) & 15)) + bio;
+        }
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        float len_inv = 1.0f / lengths[rangeIndex];
+        __m256 vlen_inv = _mm256_set1_ps(len_inv);
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));
+        }
+        for (; j < block_size; j++) {
+          op[j] = len_inv * op[j];
+        }
+      }
+    }
+  }
+}
+void Fused4BitRowwiseEmbeddingLookup_int64_t_uint8_t_float_false__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused4BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma<false>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+void Fused4BitRowwiseEmbeddingLookup_int64_t_uint8_t_float_true__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused4BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma<true>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+
+template <bool IS_WEIGHT_POSITIONAL>
+static void Fused2BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  const int32_t prefdist_T0 = 16;
+  const int32_t packed_block_size = (block_size + 3) / 4;
+  const int32_t fused_block_size = packed_block_size + 4;
+  const __m256i vshift = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+  const __m256i vmask = _mm256_set1_epi32(3);
+  if (block_size == 128) {
+    // unrolling 16 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      __m256 vop64 = _mm256_setzero_ps();
+      __m256 vop72 = _mm256_setzero_ps();
+      __m256 vop80 = _mm256_setzero_ps();
+      __m256 vop88 = _mm256_setzero_ps();
+      __m256 vop96 = _mm256_setzero_ps();
+      __m256 vop104 = _mm256_setzero_ps();
+      __m256 vop112 = _mm256_setzero_ps();
+      __m256 vop120 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (6))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (10))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (14))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+        vop64 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (16))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop64, vbio));
+        vop72 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (18))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop72, vbio));
+        vop80 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (20))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop80, vbio));
+        vop88 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (22))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop88, vbio));
+        vop96 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (24))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop96, vbio));
+        vop104 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (26))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop104, vbio));
+        vop112 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (28))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop112, vbio));
+        vop120 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (30))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop120, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+        vop64 = _mm256_mul_ps(vop64, vlen_inv);
+        vop72 = _mm256_mul_ps(vop72, vlen_inv);
+        vop80 = _mm256_mul_ps(vop80, vlen_inv);
+        vop88 = _mm256_mul_ps(vop88, vlen_inv);
+        vop96 = _mm256_mul_ps(vop96, vlen_inv);
+        vop104 = _mm256_mul_ps(vop104, vlen_inv);
+        vop112 = _mm256_mul_ps(vop112, vlen_inv);
+        vop120 = _mm256_mul_ps(vop120, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+      _mm256_storeu_ps(&op[64], vop64);
+      _mm256_storeu_ps(&op[72], vop72);
+      _mm256_storeu_ps(&op[80], vop80);
+      _mm256_storeu_ps(&op[88], vop88);
+      _mm256_storeu_ps(&op[96], vop96);
+      _mm256_storeu_ps(&op[104], vop104);
+      _mm256_storeu_ps(&op[112], vop112);
+      _mm256_storeu_ps(&op[120], vop120);
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (6))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (10))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (14))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (6))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+    }
+  } else {
+    // generic code
+    int32_t dataInd = 0;
+    for (int32_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(op + j, _mm256_setzero_ps());
+      }
+      for (; j < block_size; j++) {
+        op[j] = 0.0f;
+      }
+      for (int32_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int32_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int32_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int32_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j],
+              _mm256_fmadd_ps(
+                  vwgt,
+                  _mm256_cvtepi32_ps(
+                      _mm256_and_si256(
+                          _mm256_srlv_epi32(
+                              _mm256_set1_epi32(
+                                  *reinterpret_cast<const uint16_t*>(
+                                      ip + (j / 4))),
+                              vshift),
+                          vmask)),
+                  _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+          _mm_prefetch((&ip_next_T0[j / 4]), _MM_HINT_T0);
+        }
+        for (; j < block_size; j++) {
+          op[j] += wgt * ((float)((ip[j / 4] >> ((j % 4) * 2)) & 3)) + bio;
+        }
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        float len_inv = 1.0f / lengths[rangeIndex];
+        __m256 vlen_inv = _mm256_set1_ps(len_inv);
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));
+        }
+        for (; j < block_size; j++) {
+          op[j] = len_inv * op[j];
+        }
+      }
+    }
+  }
+}
+void Fused2BitRowwiseEmbeddingLookup_int32_t_uint8_t_float_false__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused2BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma<false>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+void Fused2BitRowwiseEmbeddingLookup_int32_t_uint8_t_float_true__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int32_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused2BitRowwiseEmbeddingLookup_int32_t_uint8_t_float__avx2_fma<true>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+
+template <bool IS_WEIGHT_POSITIONAL>
+static void Fused2BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  const int64_t prefdist_T0 = 16;
+  const int64_t packed_block_size = (block_size + 3) / 4;
+  const int64_t fused_block_size = packed_block_size + 4;
+  const __m256i vshift = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+  const __m256i vmask = _mm256_set1_epi32(3);
+  if (block_size == 128) {
+    // unrolling 16 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      __m256 vop64 = _mm256_setzero_ps();
+      __m256 vop72 = _mm256_setzero_ps();
+      __m256 vop80 = _mm256_setzero_ps();
+      __m256 vop88 = _mm256_setzero_ps();
+      __m256 vop96 = _mm256_setzero_ps();
+      __m256 vop104 = _mm256_setzero_ps();
+      __m256 vop112 = _mm256_setzero_ps();
+      __m256 vop120 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (6))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (10))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (14))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+        vop64 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (16))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop64, vbio));
+        vop72 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (18))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop72, vbio));
+        vop80 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (20))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop80, vbio));
+        vop88 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (22))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop88, vbio));
+        vop96 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (24))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop96, vbio));
+        vop104 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (26))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop104, vbio));
+        vop112 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (28))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop112, vbio));
+        vop120 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (30))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop120, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+        vop64 = _mm256_mul_ps(vop64, vlen_inv);
+        vop72 = _mm256_mul_ps(vop72, vlen_inv);
+        vop80 = _mm256_mul_ps(vop80, vlen_inv);
+        vop88 = _mm256_mul_ps(vop88, vlen_inv);
+        vop96 = _mm256_mul_ps(vop96, vlen_inv);
+        vop104 = _mm256_mul_ps(vop104, vlen_inv);
+        vop112 = _mm256_mul_ps(vop112, vlen_inv);
+        vop120 = _mm256_mul_ps(vop120, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+      _mm256_storeu_ps(&op[64], vop64);
+      _mm256_storeu_ps(&op[72], vop72);
+      _mm256_storeu_ps(&op[80], vop80);
+      _mm256_storeu_ps(&op[88], vop88);
+      _mm256_storeu_ps(&op[96], vop96);
+      _mm256_storeu_ps(&op[104], vop104);
+      _mm256_storeu_ps(&op[112], vop112);
+      _mm256_storeu_ps(&op[120], vop120);
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      __m256 vop32 = _mm256_setzero_ps();
+      __m256 vop40 = _mm256_setzero_ps();
+      __m256 vop48 = _mm256_setzero_ps();
+      __m256 vop56 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (6))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+        vop32 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (8))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop32, vbio));
+        vop40 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (10))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop40, vbio));
+        vop48 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (12))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop48, vbio));
+        vop56 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (14))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop56, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+        vop32 = _mm256_mul_ps(vop32, vlen_inv);
+        vop40 = _mm256_mul_ps(vop40, vlen_inv);
+        vop48 = _mm256_mul_ps(vop48, vlen_inv);
+        vop56 = _mm256_mul_ps(vop56, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+      _mm256_storeu_ps(&op[32], vop32);
+      _mm256_storeu_ps(&op[40], vop40);
+      _mm256_storeu_ps(&op[48], vop48);
+      _mm256_storeu_ps(&op[56], vop56);
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      __m256 vop16 = _mm256_setzero_ps();
+      __m256 vop24 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+        vop16 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (4))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop16, vbio));
+        vop24 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (6))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop24, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+        vop16 = _mm256_mul_ps(vop16, vlen_inv);
+        vop24 = _mm256_mul_ps(vop24, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+      _mm256_storeu_ps(&op[16], vop16);
+      _mm256_storeu_ps(&op[24], vop24);
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      __m256 vop0 = _mm256_setzero_ps();
+      __m256 vop8 = _mm256_setzero_ps();
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        vop0 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (0))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop0, vbio));
+        _mm_prefetch((&ip_next_T0[0]), _MM_HINT_T0);
+        vop8 = _mm256_fmadd_ps(
+            vwgt,
+            _mm256_cvtepi32_ps(
+                _mm256_and_si256(
+                    _mm256_srlv_epi32(
+                        _mm256_set1_epi32(
+                            *reinterpret_cast<const uint16_t*>(ip + (2))),
+                        vshift),
+                    vmask)),
+            _mm256_add_ps(vop8, vbio));
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        __m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);
+        vop0 = _mm256_mul_ps(vop0, vlen_inv);
+        vop8 = _mm256_mul_ps(vop8, vlen_inv);
+      }
+      _mm256_storeu_ps(&op[0], vop0);
+      _mm256_storeu_ps(&op[8], vop8);
+    }
+  } else {
+    // generic code
+    int64_t dataInd = 0;
+    for (int64_t rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {
+      float* op = &out[rangeIndex * block_size];
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        _mm256_storeu_ps(op + j, _mm256_setzero_ps());
+      }
+      for (; j < block_size; j++) {
+        op[j] = 0.0f;
+      }
+      for (int64_t start = dataInd; dataInd < start + lengths[rangeIndex];
+           ++dataInd) {
+        const int64_t idx = indices[dataInd];
+        CAFFE_ENFORCE(
+            idx >= 0 && idx < data_size,
+            "Index ",
+            dataInd,
+            " is out of bounds: ",
+            idx,
+            ", range 0 to ",
+            data_size);
+        float wgt = 1.f;
+        float bio;
+        if (weights) {
+          wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];
+        }
+        const float16* scale_bias = reinterpret_cast<const float16*>(
+            &input[idx * fused_block_size + packed_block_size]);
+        bio = wgt * _cvtsh_ss(scale_bias[1].x);
+        wgt = wgt * _cvtsh_ss(scale_bias[0].x);
+        __m256 vbio = _mm256_set1_ps(bio);
+        __m256 vwgt = _mm256_set1_ps(wgt);
+        const uint8_t* ip = &input[idx * fused_block_size];
+        const int64_t next_T0 = (dataInd < index_size - prefdist_T0)
+            ? (dataInd + prefdist_T0)
+            : dataInd;
+        const int64_t idx_pref_T0 = indices[next_T0];
+        CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);
+        const uint8_t* ip_next_T0 = &input[idx_pref_T0 * fused_block_size];
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j],
+              _mm256_fmadd_ps(
+                  vwgt,
+                  _mm256_cvtepi32_ps(
+                      _mm256_and_si256(
+                          _mm256_srlv_epi32(
+                              _mm256_set1_epi32(
+                                  *reinterpret_cast<const uint16_t*>(
+                                      ip + (j / 4))),
+                              vshift),
+                          vmask)),
+                  _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));
+          _mm_prefetch((&ip_next_T0[j / 4]), _MM_HINT_T0);
+        }
+        for (; j < block_size; j++) {
+          op[j] += wgt * ((float)((ip[j / 4] >> ((j % 4) * 2)) & 3)) + bio;
+        }
+      }
+      if (normalize_by_lengths && lengths[rangeIndex]) {
+        float len_inv = 1.0f / lengths[rangeIndex];
+        __m256 vlen_inv = _mm256_set1_ps(len_inv);
+        j = 0;
+        for (; j + 8 <= block_size; j += 8) {
+          _mm256_storeu_ps(
+              &op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));
+        }
+        for (; j < block_size; j++) {
+          op[j] = len_inv * op[j];
+        }
+      }
+    }
+  }
+}
+void Fused2BitRowwiseEmbeddingLookup_int64_t_uint8_t_float_false__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused2BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma<false>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+void Fused2BitRowwiseEmbeddingLookup_int64_t_uint8_t_float_true__avx2_fma(
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const uint8_t* input,
+    const int64_t* indices,
+    const int* lengths,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out) {
+  Fused2BitRowwiseEmbeddingLookup_int64_t_uint8_t_float__avx2_fma<true>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      lengths,
+      weights,
+      normalize_by_lengths,
+      out);
+}
+
+} // namespace caffe2
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * Embedding lookup with reduction over N-bit rowwise quantized data.
+ *
+ * `input` of size data_size * (packed_block_size + 4B)
+ * `indices` of size index_size
+ * `lengths` of size output_size
+ * `weights` nullptr or array of size index_size
+ * `out` of size output_size * block_size
+ * sum(lengths[i]) == index_size
+ *
+ * Each row of `input` packs block_size values of bit_rate bits, 8 / bit_rate
+ * of them per byte starting from the lowest bits, into
+ * packed_block_size = ceil(block_size * bit_rate / 8) bytes. They are
+ * followed by the scale and the bias of the row as float16 (2 bytes each).
+ * bit_rate must be 4 or 2.
+ *
+ * Behavior is the same as Fused8BitRowwiseEmbeddingLookup otherwise, i.e.
+ * every looked up value is de-quantized as value * scale + bias before it is
+ * weighted and summed into `out`.
+ */
+
+template <
+    typename IndexType,
+    typename InType,
+    typename OutType,
+    bool IS_WEIGHT_POSITIONAL = false>
+void FusedNBitRowwiseEmbeddingLookup(
+    const int bit_rate,
+    const TIndex block_size,
+    const TIndex output_size,
+    const TIndex index_size,
+    const TIndex data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int* lengths,
+    const float* weights, // optional, can be null for non-weighted sum
+    bool normalize_by_lengths,
+    OutType* out);
+} // namespace caffe2
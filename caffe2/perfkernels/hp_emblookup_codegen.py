@@ -264,13 +264,247 @@ def generic(IndexType, InType, OutType, use_weights, isa, fused):
     return code
 
 
+# N-bit fused rowwise tables pack 8 / bit_rate values per byte, lowest bits
+# first, followed by a float16 scale and a float16 bias per row. Eight values
+# take bit_rate bytes, which are broadcast to all lanes and shifted into place.
+def nbit_scale_bias(IndexType, OutType):
+    code = []
+    code.append(OutType + " wgt = 1.f;")
+    code.append(OutType + " bio;")
+    code.append("if (weights) {")
+    code.append(
+        "wgt = weights[IS_WEIGHT_POSITIONAL ? (dataInd - start) : dataInd];")
+    code.append("}")
+    code.append(
+        'const float16* scale_bias = reinterpret_cast<const float16*>('
+        '&input[idx * fused_block_size + packed_block_size]);')
+    code.append("bio = wgt * _cvtsh_ss(scale_bias[1].x);")
+    code.append("wgt = wgt * _cvtsh_ss(scale_bias[0].x);")
+    code.append("__m256 vbio = _mm256_set1_ps(bio);")
+    code.append("__m256 vwgt = _mm256_set1_ps(wgt);")
+
+    code.append("const uint8_t *ip = &input[idx * fused_block_size];")
+    code.append(
+        'const {} next_T0 = (dataInd < index_size - prefdist_T0)'
+        ' ? (dataInd + prefdist_T0) : dataInd;'.format(IndexType)
+    )
+    code.append("const  " + IndexType + " idx_pref_T0 = indices[next_T0];")
+    code.append(
+        "CAFFE_ENFORCE(idx_pref_T0 >= 0 && idx_pref_T0 < data_size);")
+    code.append(
+        "const uint8_t *ip_next_T0 = &input[idx_pref_T0 * fused_block_size];")
+    return code
+
+
+def nbit_load(bit_rate, offset):
+    word = "int32_t" if bit_rate == 4 else "uint16_t"
+    return (
+        "_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srlv_epi32("
+        "_mm256_set1_epi32(*reinterpret_cast<const {}*>(ip + ({}))), vshift),"
+        " vmask))".format(word, offset)
+    )
+
+
+def unroll_nbit(uf, IndexType, OutType, bit_rate):
+    code = []
+    code.append("// unrolling " + str(uf) + " times")
+    code.append(IndexType + " dataInd = 0;")
+    code.append("for (" + IndexType +
+                " rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {")
+    code.append(OutType + " *op = &out[rangeIndex * block_size];")
+    for i in range(0, uf):
+        j = 8 * i
+        code.append("__m256 vop" + str(j) + " = _mm256_setzero_ps();")
+
+    # inner loop
+    code.append("for (" + IndexType +
+                " start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {")
+    code.append("const  " + IndexType + " idx = indices[dataInd];")
+    code.append(
+        'CAFFE_ENFORCE(idx >=0 && idx < data_size, "Index ", dataInd, "'
+        ' is out of bounds: ", idx, ", range 0 to ", data_size);')
+    code.extend(nbit_scale_bias(IndexType, OutType))
+
+    for i in range(0, uf):
+        j = 8 * i
+        cachelinesize = 64
+        byteoffset = j * bit_rate // 8
+        code.append(
+            "vop%d = _mm256_fmadd_ps(vwgt, %s, _mm256_add_ps(vop%d, vbio));"
+            % (j, nbit_load(bit_rate, byteoffset), j))
+        if byteoffset % cachelinesize == 0:
+            code.append(
+                "_mm_prefetch((&ip_next_T0[%d]), _MM_HINT_T0);" % (byteoffset))
+    code.append("}")
+
+    # Empty segments produce zeros, also when normalized.
+    code.append("if (normalize_by_lengths && lengths[rangeIndex]) {")
+    # inv of length
+    code.append(
+        "__m256 vlen_inv = _mm256_set1_ps(1.0f / lengths[rangeIndex]);")
+    for i in range(0, uf):
+        j = 8 * i
+        code.append(
+            "vop" + str(j) + " = _mm256_mul_ps(vop" + str(j) + ", vlen_inv);")
+    code.append("}")
+    for i in range(0, uf):
+        j = 8 * i
+        code.append(
+            "_mm256_storeu_ps(&op[" + str(j) + "], vop" + str(j) + ");")
+
+    code.append("}")
+    return code
+
+
+def generic_nbit(IndexType, OutType, bit_rate):
+    elems_per_byte = 8 // bit_rate
+    code = []
+    code.append(IndexType + " dataInd = 0;")
+    code.append("for (" + IndexType +
+                " rangeIndex = 0; rangeIndex < output_size; ++rangeIndex) {")
+    code.append(OutType + " *op = &out[rangeIndex * block_size];")
+
+    # initialize to 0
+    code.append("TIndex j = 0;")
+    code.append("for(; j + 8 <= block_size; j += 8) {")
+    code.append("_mm256_storeu_ps(op + j, _mm256_setzero_ps());")
+    code.append("}")
+    code.append("for(; j < block_size; j++) {")
+    code.append("op[j] = 0.0f;")
+    code.append("}")
+
+    # inner loop
+    code.append("for (" + IndexType +
+                " start = dataInd; dataInd < start + lengths[rangeIndex]; ++dataInd) {")
+    code.append("const  " + IndexType + " idx = indices[dataInd];")
+    code.append(
+        'CAFFE_ENFORCE(idx >=0 && idx < data_size, "Index ", dataInd, "' +
+        ' is out of bounds: ", idx, ", range 0 to ", data_size);')
+    code.extend(nbit_scale_bias(IndexType, OutType))
+
+    # compute and store main loop
+    code.append("j = 0;")
+    code.append("for(; j + 8 <= block_size; j += 8) {")
+    code.append(
+        "_mm256_storeu_ps(&op[j], _mm256_fmadd_ps(vwgt, %s,"
+        " _mm256_add_ps(_mm256_loadu_ps(&op[j]), vbio)));"
+        % nbit_load(bit_rate, "j / %d" % elems_per_byte))
+    code.append(
+        "_mm_prefetch((&ip_next_T0[j / %d]), _MM_HINT_T0);" % elems_per_byte)
+    code.append("}")
+    # leftover
+    code.append("for(; j < block_size; j++) {")
+    code.append(
+        "op[j] += wgt * ((float)((ip[j / %d] >> ((j %% %d) * %d)) & %d)) + bio;"
+        % (elems_per_byte, elems_per_byte, bit_rate, (1 << bit_rate) - 1))
+    code.append("}")
+
+    code.append("}")
+
+    code.append("if (normalize_by_lengths && lengths[rangeIndex]) {")
+    code.append("float len_inv = 1.0f / lengths[rangeIndex];")
+    code.append("__m256 vlen_inv = _mm256_set1_ps(len_inv);")
+    code.append("j = 0;")
+    code.append("for(; j + 8 <= block_size; j += 8) {")
+    code.append(
+        "_mm256_storeu_ps(&op[j], _mm256_mul_ps(_mm256_loadu_ps(&op[j]), vlen_inv));")
+    code.append("}")
+    code.append("for(; j < block_size; j++) {")
+    code.append("op[j] = len_inv * op[j];")
+    code.append("}")
+
+    code.append("}")
+
+    code.append("}")
+    return code
+
+
+def fused_nbit(IndexType, OutType, bit_rate):
+    code = []
+    code.append('template <bool IS_WEIGHT_POSITIONAL>')
+    fn_base = 'Fused{}BitRowwiseEmbeddingLookup_{}_uint8_t_{}'.format(
+        bit_rate, IndexType, OutType
+    )
+    suffix = '__avx2_fma'
+    code.append("static void " + fn_base + suffix + "(")
+
+    args = []
+    args.append("const TIndex block_size,")
+    args.append("const TIndex output_size,")
+    args.append("const TIndex index_size,")
+    args.append("const TIndex data_size,")
+    args.append("const uint8_t* input,")
+    args.append("const " + IndexType + "* indices,")
+    args.append("const int* lengths,")
+    args.append("const float* weights,")
+    args.append("bool normalize_by_lengths,")
+    args.append(OutType + "* out)")
+    code += args
+
+    code.append("{")
+    code.append("const " + IndexType + " prefdist_T0 = 16;")
+    # block_size is the number of elements, packed_block_size the number of
+    # bytes they take and fused_block_size the size of an entire row,
+    # including the float16 scale and bias.
+    code.append(
+        "const {} packed_block_size = (block_size + {}) / {};".format(
+            IndexType, 8 // bit_rate - 1, 8 // bit_rate))
+    code.append(
+        "const {} fused_block_size = packed_block_size + 4;".format(IndexType))
+    code.append(
+        "const __m256i vshift = _mm256_setr_epi32({});".format(
+            ", ".join(str(bit_rate * k) for k in range(8))))
+    code.append(
+        "const __m256i vmask = _mm256_set1_epi32({});".format(
+            (1 << bit_rate) - 1))
+
+    code.append("if (block_size == 128) {")
+    code += unroll_nbit(16, IndexType, OutType, bit_rate)
+    code.append("} else if (block_size == 64) {")
+    code += unroll_nbit(8, IndexType, OutType, bit_rate)
+    code.append("} else if (block_size == 32) {")
+    code += unroll_nbit(4, IndexType, OutType, bit_rate)
+    code.append("} else if (block_size == 16) {")
+    code += unroll_nbit(2, IndexType, OutType, bit_rate)
+    code.append("} else {")
+    code.append("// generic code")
+    code += generic_nbit(IndexType, OutType, bit_rate)
+    code.append("}")
+
+    code.append("}")
+
+    for is_weight_positional in ['false', 'true']:
+        code.append(
+            "void " + fn_base + "_" + is_weight_positional + suffix + "(")
+        code += args
+        code.append("{")
+        code.append(fn_base + suffix + "<" + is_weight_positional + ">(")
+        code.append("block_size,")
+        code.append("output_size,")
+        code.append("index_size,")
+        code.append("data_size,")
+        code.append("input,")
+        code.append("indices,")
+        code.append("lengths,")
+        code.append("weights,")
+        code.append("normalize_by_lengths,")
+        code.append("out);")
+        code.append("}")
+
+    code.append("\n")
+    return code
+
+
 # start main code
 parser = argparse.ArgumentParser()
 parser.add_argument('-f', '--filename', help="file name")
 parser.add_argument('--fused', action='store_true')
+parser.add_argument('--fused-nbit', action='store_true')
 opts = parser.parse_args()
 if opts.filename:
     filename = opts.filename
+elif opts.fused_nbit:
+    filename = "embedding_lookup_fused_nbit_rowwise_avx2.cc"
 elif opts.fused:
     filename = "embedding_lookup_fused_8bit_rowwise_avx2.cc"
 else:
@@ -283,6 +517,8 @@ options = [["int32_t", "float", "float"],
            ["int64_t", "float16", "float"],
            ["int32_t", "uint8_t", "float"],
            ["int64_t", "uint8_t", "float"]]
+if opts.fused_nbit:
+    options = []
 
 code = []
 # includes
@@ -296,6 +532,8 @@ code.append("//// --------------------------\n\n")
 code.append("#include <caffe2/core/types.h>")
 code.append("#include <caffe2/core/common.h>")
 code.append("#include <immintrin.h>")
+if opts.fused_nbit:
+    code.append("#include \"caffe2/perfkernels/cvtsh_ss_bugfix.h\"")
 code.append("\n")
 
 code.append("namespace caffe2 {\n")
@@ -386,6 +624,11 @@ for o in options:
 
     code.append("\n")
 
+if opts.fused_nbit:
+    for bit_rate in [4, 2]:
+        for IndexType in ["int32_t", "int64_t"]:
+            code += fused_nbit(IndexType, "float", bit_rate)
+
 code.append("} // namespace caffe2")
 
 for c in code:
@@ -0,0 +1,282 @@
+#include "caffe2/perfkernels/sparse_optimizers.h"
+
+#include <cmath>
+
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+// Base implementations. The AVX2 versions in sparse_optimizers_avx2.cc are
+// generated by sparse_optimizers_codegen.py and mirror these loops.
+
+template <typename IndexType>
+static bool SparseAdagradBase(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const IndexType* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  for (TIndex i = 0; i < index_size; ++i) {
+    const TIndex idx = indices[i];
+    if (idx < 0 || idx >= param_rows) {
+      return false;
+    }
+    if (idx < row_begin || idx >= row_end) {
+      continue;
+    }
+    const float* g = grad + i * block_size;
+    float* w = param + idx * block_size;
+    float* h = moment + idx * block_size;
+    for (TIndex j = 0; j < block_size; ++j) {
+      const float gj = g[j];
+      const float hj = h[j] = h[j] + gj * gj;
+      w[j] = w[j] + lr * gj / (std::sqrt(hj) + epsilon);
+    }
+  }
+  return true;
+}
+
+template <typename IndexType>
+static bool RowWiseSparseAdagradBase(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const IndexType* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  for (TIndex i = 0; i < index_size; ++i) {
+    const TIndex idx = indices[i];
+    if (idx < 0 || idx >= param_rows) {
+      return false;
+    }
+    if (idx < row_begin || idx >= row_end) {
+      continue;
+    }
+    const float* g = grad + i * block_size;
+    float* w = param + idx * block_size;
+    float hs = 0.f;
+    for (TIndex j = 0; j < block_size; ++j) {
+      hs += g[j] * g[j];
+    }
+    const float hi = moment[idx] = moment[idx] + hs / block_size;
+    const float step = lr / (std::sqrt(hi) + epsilon);
+    for (TIndex j = 0; j < block_size; ++j) {
+      w[j] = w[j] + g[j] * step;
+    }
+  }
+  return true;
+}
+
+template <typename IndexType>
+static bool SparseAdamBase(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const IndexType* indices,
+    const float* grad,
+    float* param,
+    float* moment1,
+    float* moment2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr_correction) {
+  for (TIndex i = 0; i < index_size; ++i) {
+    const TIndex idx = indices[i];
+    if (idx < 0 || idx >= param_rows) {
+      return false;
+    }
+    if (idx < row_begin || idx >= row_end) {
+      continue;
+    }
+    const float* g = grad + i * block_size;
+    float* w = param + idx * block_size;
+    float* m1 = moment1 + idx * block_size;
+    float* m2 = moment2 + idx * block_size;
+    for (TIndex j = 0; j < block_size; ++j) {
+      const float gj = g[j];
+      const float mj = m1[j] = m1[j] * beta1 + gj * (1 - beta1);
+      const float vj = m2[j] = m2[j] * beta2 + gj * gj * (1 - beta2);
+      w[j] = w[j] + lr_correction * mj / (std::sqrt(vj) + epsilon);
+    }
+  }
+  return true;
+}
+
+#define ADAGRAD_SPECIALIZATION(Name, IndexType)                            \
+  bool Name##_##IndexType##__base(                                         \
+      const TIndex block_size,                                             \
+      const TIndex index_size,                                             \
+      const TIndex param_rows,                                             \
+      const TIndex row_begin,                                              \
+      const TIndex row_end,                                                \
+      const IndexType* indices,                                            \
+      const float* grad,                                                   \
+      float* param,                                                        \
+      float* moment,                                                       \
+      float epsilon,                                                       \
+      float lr) {                                                          \
+    return Name##Base<IndexType>(                                          \
+        block_size,                                                        \
+        index_size,                                                        \
+        param_rows,                                                        \
+        row_begin,                                                         \
+        row_end,                                                           \
+        indices,                                                           \
+        grad,                                                              \
+        param,                                                             \
+        moment,                                                            \
+        epsilon,                                                           \
+        lr);                                                               \
+  }                                                                        \
+  template <>                                                              \
+  bool Name<IndexType>(                                                    \
+      const TIndex block_size,                                             \
+      const TIndex index_size,                                             \
+      const TIndex param_rows,                                             \
+      const TIndex row_begin,                                              \
+      const TIndex row_end,                                                \
+      const IndexType* indices,                                            \
+      const float* grad,                                                   \
+      float* param,                                                        \
+      float* moment,                                                       \
+      float epsilon,                                                       \
+      float lr) {                                                          \
+    AVX2_FMA_DO(                                                           \
+        Name##_##IndexType,                                                \
+        block_size,                                                        \
+        index_size,                                                        \
+        param_rows,                                                        \
+        row_begin,                                                         \
+        row_end,                                                           \
+        indices,                                                           \
+        grad,                                                              \
+        param,                                                             \
+        moment,                                                            \
+        epsilon,                                                           \
+        lr);                                                               \
+    BASE_DO(                                                               \
+        Name##_##IndexType,                                                \
+        block_size,                                                        \
+        index_size,                                                        \
+        param_rows,                                                        \
+        row_begin,                                                         \
+        row_end,                                                           \
+        indices,                                                           \
+        grad,                                                              \
+        param,                                                             \
+        moment,                                                            \
+        epsilon,                                                           \
+        lr);                                                               \
+  }
+
+ADAGRAD_SPECIALIZATION(SparseAdagrad, int32_t);
+ADAGRAD_SPECIALIZATION(SparseAdagrad, int64_t);
+ADAGRAD_SPECIALIZATION(RowWiseSparseAdagrad, int32_t);
+ADAGRAD_SPECIALIZATION(RowWiseSparseAdagrad, int64_t);
+
+#undef ADAGRAD_SPECIALIZATION
+
+#define ADAM_SPECIALIZATION(IndexType)                                     \
+  bool SparseAdam_##IndexType##__base(                                     \
+      const TIndex block_size,                                             \
+      const TIndex index_size,                                             \
+      const TIndex param_rows,                                             \
+      const TIndex row_begin,                                              \
+      const TIndex row_end,                                                \
+      const IndexType* indices,                                            \
+      const float* grad,                                                   \
+      float* param,                                                        \
+      float* moment1,                                                      \
+      float* moment2,                                                      \
+      float beta1,                                                         \
+      float beta2,                                                         \
+      float epsilon,                                                       \
+      float lr_correction) {                                               \
+    return SparseAdamBase<IndexType>(                                      \
+        block_size,                                                        \
+        index_size,                                                        \
+        param_rows,                                                        \
+        row_begin,                                                         \
+        row_end,                                                           \
+        indices,                                                           \
+        grad,                                                              \
+        param,                                                             \
+        moment1,                                                           \
+        moment2,                                                           \
+        beta1,                                                             \
+        beta2,                                                             \
+        epsilon,                                                           \
+        lr_correction);                                                    \
+  }                                                                        \
+  template <>                                                              \
+  bool SparseAdam<IndexType>(                                              \
+      const TIndex block_size,                                             \
+      const TIndex index_size,                                             \
+      const TIndex param_rows,                                             \
+      const TIndex row_begin,                                              \
+      const TIndex row_end,                                                \
+      const IndexType* indices,                                            \
+      const float* grad,                                                   \
+      float* param,                                                        \
+      float* moment1,                                                      \
+      float* moment2,                                                      \
+      float beta1,                                                         \
+      float beta2,                                                         \
+      float epsilon,                                                       \
+      float lr_correction) {                                               \
+    AVX2_FMA_DO(                                                           \
+        SparseAdam_##IndexType,                                            \
+        block_size,                                                        \
+        index_size,                                                        \
+        param_rows,                                                        \
+        row_begin,                                                         \
+        row_end,                                                           \
+        indices,                                                           \
+        grad,                                                              \
+        param,                                                             \
+        moment1,                                                           \
+        moment2,                                                           \
+        beta1,                                                             \
+        beta2,                                                             \
+        epsilon,                                                           \
+        lr_correction);                                                    \
+    BASE_DO(                                                               \
+        SparseAdam_##IndexType,                                            \
+        block_size,                                                        \
+        index_size,                                                        \
+        param_rows,                                                        \
+        row_begin,                                                         \
+        row_end,                                                           \
+        indices,                                                           \
+        grad,                                                              \
+        param,                                                             \
+        moment1,                                                           \
+        moment2,                                                           \
+        beta1,                                                             \
+        beta2,                                                             \
+        epsilon,                                                           \
+        lr_correction);                                                    \
+  }
+
+ADAM_SPECIALIZATION(int32_t);
+ADAM_SPECIALIZATION(int64_t);
+
+#undef ADAM_SPECIALIZATION
+
+} // namespace caffe2
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * In-place sparse optimizer updates.
+ *
+ * `grad` has index_size rows of block_size elements; row i is the gradient
+ * of row indices[i] of `param`, which has param_rows rows. Rows are updated
+ * in the order they appear in `indices`, so repeated indices accumulate.
+ *
+ * Only rows in [row_begin, row_end) are updated, which lets callers split
+ * one update over threads working on disjoint row ranges; pass
+ * [0, param_rows) to update all of them.
+ *
+ * Return false if an index is out of [0, param_rows). Rows before the bad
+ * index may already have been updated.
+ */
+
+// moment has the shape of param:
+//   moment[r] += g^2
+//   param[r] += lr * g / (sqrt(moment[r]) + epsilon)
+template <typename IndexType>
+bool SparseAdagrad(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const IndexType* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr);
+
+// moment has one value per row of param:
+//   moment[r] += mean(g^2)
+//   param[r] += lr * g / (sqrt(moment[r]) + epsilon)
+template <typename IndexType>
+bool RowWiseSparseAdagrad(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const IndexType* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr);
+
+// moment1 and moment2 have the shape of param:
+//   moment1[r] = moment1[r] * beta1 + g * (1 - beta1)
+//   moment2[r] = moment2[r] * beta2 + g^2 * (1 - beta2)
+//   param[r] += lr_correction * moment1[r] / (sqrt(moment2[r]) + epsilon)
+template <typename IndexType>
+bool SparseAdam(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const IndexType* indices,
+    const float* grad,
+    float* param,
+    float* moment1,
+    float* moment2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr_correction);
+
+} // namespace caffe2
@@ -0,0 +1,3399 @@
+//// --------------------------
+//// ATTENTION:
+//// THIS CODE IS AUTOGENERATED
+//// BY sparse_optimizers_codegen.py
+//// DO NOT MODIFY!!!
+//// --------------------------
+
+#include <caffe2/core/common.h>
+#include <caffe2/core/types.h>
+#include <immintrin.h>
+#include <cmath>
+
+namespace caffe2 {
+
+bool SparseAdagrad_int32_t__avx2_fma(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const int32_t* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  const TIndex prefdist_T0 = 16;
+  const __m256 vepsilon = _mm256_set1_ps(epsilon);
+  const __m256 vlr = _mm256_set1_ps(lr);
+  if (block_size == 128) {
+    // unrolling 16 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 16), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 16, vh);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 24), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 24, vh);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 32), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 32, vh);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 40), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 40, vh);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 48), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 48, vh);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 56), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 56, vh);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 64);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 64), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 64, vh);
+        _mm256_storeu_ps(
+            w + 64,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 64),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[64]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[64]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 72);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 72), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 72, vh);
+        _mm256_storeu_ps(
+            w + 72,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 72),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 80);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 80), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 80, vh);
+        _mm256_storeu_ps(
+            w + 80,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 80),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[80]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[80]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 88);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 88), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 88, vh);
+        _mm256_storeu_ps(
+            w + 88,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 88),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 96);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 96), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 96, vh);
+        _mm256_storeu_ps(
+            w + 96,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 96),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[96]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[96]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 104);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 104), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 104, vh);
+        _mm256_storeu_ps(
+            w + 104,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 104),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 112);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 112), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 112, vh);
+        _mm256_storeu_ps(
+            w + 112,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 112),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[112]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[112]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 120);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 120), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 120, vh);
+        _mm256_storeu_ps(
+            w + 120,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 120),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 16), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 16, vh);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 24), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 24, vh);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 32), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 32, vh);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 40), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 40, vh);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 48), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 48, vh);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 56), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 56, vh);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 16), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 16, vh);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 24), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 24, vh);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else {
+    // generic code
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        {
+          const __m256 vg = _mm256_loadu_ps(g + j);
+          const __m256 vh =
+              _mm256_add_ps(_mm256_loadu_ps(h + j), _mm256_mul_ps(vg, vg));
+          _mm256_storeu_ps(h + j, vh);
+          _mm256_storeu_ps(
+              w + j,
+              _mm256_add_ps(
+                  _mm256_loadu_ps(w + j),
+                  _mm256_div_ps(
+                      _mm256_mul_ps(vlr, vg),
+                      _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+        }
+        _mm_prefetch((&w_next[j]), _MM_HINT_T0);
+        _mm_prefetch((&h_next[j]), _MM_HINT_T0);
+      }
+      for (; j < block_size; ++j) {
+        const float gj = g[j];
+        const float hj = h[j] = h[j] + gj * gj;
+        w[j] = w[j] + lr * gj / (std::sqrt(hj) + epsilon);
+      }
+    }
+  }
+  return true;
+}
+
+bool SparseAdagrad_int64_t__avx2_fma(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const int64_t* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  const TIndex prefdist_T0 = 16;
+  const __m256 vepsilon = _mm256_set1_ps(epsilon);
+  const __m256 vlr = _mm256_set1_ps(lr);
+  if (block_size == 128) {
+    // unrolling 16 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 16), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 16, vh);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 24), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 24, vh);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 32), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 32, vh);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 40), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 40, vh);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 48), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 48, vh);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 56), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 56, vh);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 64);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 64), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 64, vh);
+        _mm256_storeu_ps(
+            w + 64,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 64),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[64]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[64]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 72);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 72), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 72, vh);
+        _mm256_storeu_ps(
+            w + 72,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 72),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 80);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 80), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 80, vh);
+        _mm256_storeu_ps(
+            w + 80,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 80),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[80]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[80]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 88);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 88), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 88, vh);
+        _mm256_storeu_ps(
+            w + 88,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 88),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 96);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 96), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 96, vh);
+        _mm256_storeu_ps(
+            w + 96,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 96),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[96]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[96]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 104);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 104), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 104, vh);
+        _mm256_storeu_ps(
+            w + 104,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 104),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 112);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 112), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 112, vh);
+        _mm256_storeu_ps(
+            w + 112,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 112),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[112]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[112]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 120);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 120), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 120, vh);
+        _mm256_storeu_ps(
+            w + 120,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 120),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 16), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 16, vh);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 24), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 24, vh);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 32), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 32, vh);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 40), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 40, vh);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 48), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 48, vh);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 56), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 56, vh);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 16), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 16, vh);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 24), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 24, vh);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 0), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 0, vh);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&h_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vh =
+            _mm256_add_ps(_mm256_loadu_ps(h + 8), _mm256_mul_ps(vg, vg));
+        _mm256_storeu_ps(h + 8, vh);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr, vg),
+                    _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+      }
+    }
+  } else {
+    // generic code
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* h = moment + idx * block_size;
+      float* h_next = moment + idx_pref_T0 * block_size;
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        {
+          const __m256 vg = _mm256_loadu_ps(g + j);
+          const __m256 vh =
+              _mm256_add_ps(_mm256_loadu_ps(h + j), _mm256_mul_ps(vg, vg));
+          _mm256_storeu_ps(h + j, vh);
+          _mm256_storeu_ps(
+              w + j,
+              _mm256_add_ps(
+                  _mm256_loadu_ps(w + j),
+                  _mm256_div_ps(
+                      _mm256_mul_ps(vlr, vg),
+                      _mm256_add_ps(_mm256_sqrt_ps(vh), vepsilon))));
+        }
+        _mm_prefetch((&w_next[j]), _MM_HINT_T0);
+        _mm_prefetch((&h_next[j]), _MM_HINT_T0);
+      }
+      for (; j < block_size; ++j) {
+        const float gj = g[j];
+        const float hj = h[j] = h[j] + gj * gj;
+        w[j] = w[j] + lr * gj / (std::sqrt(hj) + epsilon);
+      }
+    }
+  }
+  return true;
+}
+
+bool RowWiseSparseAdagrad_int32_t__avx2_fma(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const int32_t* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  const TIndex prefdist_T0 = 16;
+  if (block_size == 128) {
+    // unrolling 16 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      const __m256 vg2 = _mm256_loadu_ps(g + 16);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg2, vg2));
+      const __m256 vg3 = _mm256_loadu_ps(g + 24);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg3, vg3));
+      const __m256 vg4 = _mm256_loadu_ps(g + 32);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg4, vg4));
+      const __m256 vg5 = _mm256_loadu_ps(g + 40);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg5, vg5));
+      const __m256 vg6 = _mm256_loadu_ps(g + 48);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg6, vg6));
+      const __m256 vg7 = _mm256_loadu_ps(g + 56);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg7, vg7));
+      const __m256 vg8 = _mm256_loadu_ps(g + 64);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg8, vg8));
+      const __m256 vg9 = _mm256_loadu_ps(g + 72);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg9, vg9));
+      const __m256 vg10 = _mm256_loadu_ps(g + 80);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg10, vg10));
+      const __m256 vg11 = _mm256_loadu_ps(g + 88);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg11, vg11));
+      const __m256 vg12 = _mm256_loadu_ps(g + 96);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg12, vg12));
+      const __m256 vg13 = _mm256_loadu_ps(g + 104);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg13, vg13));
+      const __m256 vg14 = _mm256_loadu_ps(g + 112);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg14, vg14));
+      const __m256 vg15 = _mm256_loadu_ps(g + 120);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg15, vg15));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+      _mm256_storeu_ps(
+          w + 16,
+          _mm256_add_ps(_mm256_loadu_ps(w + 16), _mm256_mul_ps(vg2, vstep)));
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 24,
+          _mm256_add_ps(_mm256_loadu_ps(w + 24), _mm256_mul_ps(vg3, vstep)));
+      _mm256_storeu_ps(
+          w + 32,
+          _mm256_add_ps(_mm256_loadu_ps(w + 32), _mm256_mul_ps(vg4, vstep)));
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 40,
+          _mm256_add_ps(_mm256_loadu_ps(w + 40), _mm256_mul_ps(vg5, vstep)));
+      _mm256_storeu_ps(
+          w + 48,
+          _mm256_add_ps(_mm256_loadu_ps(w + 48), _mm256_mul_ps(vg6, vstep)));
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 56,
+          _mm256_add_ps(_mm256_loadu_ps(w + 56), _mm256_mul_ps(vg7, vstep)));
+      _mm256_storeu_ps(
+          w + 64,
+          _mm256_add_ps(_mm256_loadu_ps(w + 64), _mm256_mul_ps(vg8, vstep)));
+      _mm_prefetch((&w_next[64]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 72,
+          _mm256_add_ps(_mm256_loadu_ps(w + 72), _mm256_mul_ps(vg9, vstep)));
+      _mm256_storeu_ps(
+          w + 80,
+          _mm256_add_ps(_mm256_loadu_ps(w + 80), _mm256_mul_ps(vg10, vstep)));
+      _mm_prefetch((&w_next[80]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 88,
+          _mm256_add_ps(_mm256_loadu_ps(w + 88), _mm256_mul_ps(vg11, vstep)));
+      _mm256_storeu_ps(
+          w + 96,
+          _mm256_add_ps(_mm256_loadu_ps(w + 96), _mm256_mul_ps(vg12, vstep)));
+      _mm_prefetch((&w_next[96]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 104,
+          _mm256_add_ps(_mm256_loadu_ps(w + 104), _mm256_mul_ps(vg13, vstep)));
+      _mm256_storeu_ps(
+          w + 112,
+          _mm256_add_ps(_mm256_loadu_ps(w + 112), _mm256_mul_ps(vg14, vstep)));
+      _mm_prefetch((&w_next[112]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 120,
+          _mm256_add_ps(_mm256_loadu_ps(w + 120), _mm256_mul_ps(vg15, vstep)));
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      const __m256 vg2 = _mm256_loadu_ps(g + 16);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg2, vg2));
+      const __m256 vg3 = _mm256_loadu_ps(g + 24);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg3, vg3));
+      const __m256 vg4 = _mm256_loadu_ps(g + 32);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg4, vg4));
+      const __m256 vg5 = _mm256_loadu_ps(g + 40);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg5, vg5));
+      const __m256 vg6 = _mm256_loadu_ps(g + 48);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg6, vg6));
+      const __m256 vg7 = _mm256_loadu_ps(g + 56);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg7, vg7));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+      _mm256_storeu_ps(
+          w + 16,
+          _mm256_add_ps(_mm256_loadu_ps(w + 16), _mm256_mul_ps(vg2, vstep)));
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 24,
+          _mm256_add_ps(_mm256_loadu_ps(w + 24), _mm256_mul_ps(vg3, vstep)));
+      _mm256_storeu_ps(
+          w + 32,
+          _mm256_add_ps(_mm256_loadu_ps(w + 32), _mm256_mul_ps(vg4, vstep)));
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 40,
+          _mm256_add_ps(_mm256_loadu_ps(w + 40), _mm256_mul_ps(vg5, vstep)));
+      _mm256_storeu_ps(
+          w + 48,
+          _mm256_add_ps(_mm256_loadu_ps(w + 48), _mm256_mul_ps(vg6, vstep)));
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 56,
+          _mm256_add_ps(_mm256_loadu_ps(w + 56), _mm256_mul_ps(vg7, vstep)));
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      const __m256 vg2 = _mm256_loadu_ps(g + 16);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg2, vg2));
+      const __m256 vg3 = _mm256_loadu_ps(g + 24);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg3, vg3));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+      _mm256_storeu_ps(
+          w + 16,
+          _mm256_add_ps(_mm256_loadu_ps(w + 16), _mm256_mul_ps(vg2, vstep)));
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 24,
+          _mm256_add_ps(_mm256_loadu_ps(w + 24), _mm256_mul_ps(vg3, vstep)));
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+    }
+  } else {
+    // generic code
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        const __m256 vg = _mm256_loadu_ps(g + j);
+        vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg, vg));
+      }
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      for (; j < block_size; ++j) {
+        hs += g[j] * g[j];
+      }
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        {
+          const __m256 vg = _mm256_loadu_ps(g + j);
+          _mm256_storeu_ps(
+              w + j,
+              _mm256_add_ps(_mm256_loadu_ps(w + j), _mm256_mul_ps(vg, vstep)));
+        }
+        _mm_prefetch((&w_next[j]), _MM_HINT_T0);
+      }
+      for (; j < block_size; ++j) {
+        const float gj = g[j];
+        w[j] = w[j] + gj * step;
+      }
+    }
+  }
+  return true;
+}
+
+bool RowWiseSparseAdagrad_int64_t__avx2_fma(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const int64_t* indices,
+    const float* grad,
+    float* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  const TIndex prefdist_T0 = 16;
+  if (block_size == 128) {
+    // unrolling 16 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      const __m256 vg2 = _mm256_loadu_ps(g + 16);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg2, vg2));
+      const __m256 vg3 = _mm256_loadu_ps(g + 24);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg3, vg3));
+      const __m256 vg4 = _mm256_loadu_ps(g + 32);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg4, vg4));
+      const __m256 vg5 = _mm256_loadu_ps(g + 40);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg5, vg5));
+      const __m256 vg6 = _mm256_loadu_ps(g + 48);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg6, vg6));
+      const __m256 vg7 = _mm256_loadu_ps(g + 56);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg7, vg7));
+      const __m256 vg8 = _mm256_loadu_ps(g + 64);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg8, vg8));
+      const __m256 vg9 = _mm256_loadu_ps(g + 72);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg9, vg9));
+      const __m256 vg10 = _mm256_loadu_ps(g + 80);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg10, vg10));
+      const __m256 vg11 = _mm256_loadu_ps(g + 88);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg11, vg11));
+      const __m256 vg12 = _mm256_loadu_ps(g + 96);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg12, vg12));
+      const __m256 vg13 = _mm256_loadu_ps(g + 104);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg13, vg13));
+      const __m256 vg14 = _mm256_loadu_ps(g + 112);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg14, vg14));
+      const __m256 vg15 = _mm256_loadu_ps(g + 120);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg15, vg15));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+      _mm256_storeu_ps(
+          w + 16,
+          _mm256_add_ps(_mm256_loadu_ps(w + 16), _mm256_mul_ps(vg2, vstep)));
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 24,
+          _mm256_add_ps(_mm256_loadu_ps(w + 24), _mm256_mul_ps(vg3, vstep)));
+      _mm256_storeu_ps(
+          w + 32,
+          _mm256_add_ps(_mm256_loadu_ps(w + 32), _mm256_mul_ps(vg4, vstep)));
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 40,
+          _mm256_add_ps(_mm256_loadu_ps(w + 40), _mm256_mul_ps(vg5, vstep)));
+      _mm256_storeu_ps(
+          w + 48,
+          _mm256_add_ps(_mm256_loadu_ps(w + 48), _mm256_mul_ps(vg6, vstep)));
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 56,
+          _mm256_add_ps(_mm256_loadu_ps(w + 56), _mm256_mul_ps(vg7, vstep)));
+      _mm256_storeu_ps(
+          w + 64,
+          _mm256_add_ps(_mm256_loadu_ps(w + 64), _mm256_mul_ps(vg8, vstep)));
+      _mm_prefetch((&w_next[64]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 72,
+          _mm256_add_ps(_mm256_loadu_ps(w + 72), _mm256_mul_ps(vg9, vstep)));
+      _mm256_storeu_ps(
+          w + 80,
+          _mm256_add_ps(_mm256_loadu_ps(w + 80), _mm256_mul_ps(vg10, vstep)));
+      _mm_prefetch((&w_next[80]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 88,
+          _mm256_add_ps(_mm256_loadu_ps(w + 88), _mm256_mul_ps(vg11, vstep)));
+      _mm256_storeu_ps(
+          w + 96,
+          _mm256_add_ps(_mm256_loadu_ps(w + 96), _mm256_mul_ps(vg12, vstep)));
+      _mm_prefetch((&w_next[96]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 104,
+          _mm256_add_ps(_mm256_loadu_ps(w + 104), _mm256_mul_ps(vg13, vstep)));
+      _mm256_storeu_ps(
+          w + 112,
+          _mm256_add_ps(_mm256_loadu_ps(w + 112), _mm256_mul_ps(vg14, vstep)));
+      _mm_prefetch((&w_next[112]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 120,
+          _mm256_add_ps(_mm256_loadu_ps(w + 120), _mm256_mul_ps(vg15, vstep)));
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      const __m256 vg2 = _mm256_loadu_ps(g + 16);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg2, vg2));
+      const __m256 vg3 = _mm256_loadu_ps(g + 24);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg3, vg3));
+      const __m256 vg4 = _mm256_loadu_ps(g + 32);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg4, vg4));
+      const __m256 vg5 = _mm256_loadu_ps(g + 40);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg5, vg5));
+      const __m256 vg6 = _mm256_loadu_ps(g + 48);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg6, vg6));
+      const __m256 vg7 = _mm256_loadu_ps(g + 56);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg7, vg7));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+      _mm256_storeu_ps(
+          w + 16,
+          _mm256_add_ps(_mm256_loadu_ps(w + 16), _mm256_mul_ps(vg2, vstep)));
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 24,
+          _mm256_add_ps(_mm256_loadu_ps(w + 24), _mm256_mul_ps(vg3, vstep)));
+      _mm256_storeu_ps(
+          w + 32,
+          _mm256_add_ps(_mm256_loadu_ps(w + 32), _mm256_mul_ps(vg4, vstep)));
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 40,
+          _mm256_add_ps(_mm256_loadu_ps(w + 40), _mm256_mul_ps(vg5, vstep)));
+      _mm256_storeu_ps(
+          w + 48,
+          _mm256_add_ps(_mm256_loadu_ps(w + 48), _mm256_mul_ps(vg6, vstep)));
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 56,
+          _mm256_add_ps(_mm256_loadu_ps(w + 56), _mm256_mul_ps(vg7, vstep)));
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      const __m256 vg2 = _mm256_loadu_ps(g + 16);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg2, vg2));
+      const __m256 vg3 = _mm256_loadu_ps(g + 24);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg3, vg3));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+      _mm256_storeu_ps(
+          w + 16,
+          _mm256_add_ps(_mm256_loadu_ps(w + 16), _mm256_mul_ps(vg2, vstep)));
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 24,
+          _mm256_add_ps(_mm256_loadu_ps(w + 24), _mm256_mul_ps(vg3, vstep)));
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      const __m256 vg0 = _mm256_loadu_ps(g + 0);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg0, vg0));
+      const __m256 vg1 = _mm256_loadu_ps(g + 8);
+      vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg1, vg1));
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      _mm256_storeu_ps(
+          w + 0,
+          _mm256_add_ps(_mm256_loadu_ps(w + 0), _mm256_mul_ps(vg0, vstep)));
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm256_storeu_ps(
+          w + 8,
+          _mm256_add_ps(_mm256_loadu_ps(w + 8), _mm256_mul_ps(vg1, vstep)));
+    }
+  } else {
+    // generic code
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      _mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);
+      __m256 vsum = _mm256_setzero_ps();
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        const __m256 vg = _mm256_loadu_ps(g + j);
+        vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg, vg));
+      }
+      float sum[8];
+      _mm256_storeu_ps(sum, vsum);
+      float hs = (
+          (
+              sum[0] + sum[1]) + (
+                  sum[2] + sum[3])) + ((sum[4] + sum[5]) + (sum[6] + sum[7]));
+      for (; j < block_size; ++j) {
+        hs += g[j] * g[j];
+      }
+      const float hi = moment[idx] = moment[idx] + hs / block_size;
+      const float step = lr / (std::sqrt(hi) + epsilon);
+      const __m256 vstep = _mm256_set1_ps(step);
+      j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        {
+          const __m256 vg = _mm256_loadu_ps(g + j);
+          _mm256_storeu_ps(
+              w + j,
+              _mm256_add_ps(_mm256_loadu_ps(w + j), _mm256_mul_ps(vg, vstep)));
+        }
+        _mm_prefetch((&w_next[j]), _MM_HINT_T0);
+      }
+      for (; j < block_size; ++j) {
+        const float gj = g[j];
+        w[j] = w[j] + gj * step;
+      }
+    }
+  }
+  return true;
+}
+
+bool SparseAdam_int32_t__avx2_fma(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const int32_t* indices,
+    const float* grad,
+    float* param,
+    float* moment1,
+    float* moment2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr_correction) {
+  const TIndex prefdist_T0 = 16;
+  const __m256 vbeta1 = _mm256_set1_ps(beta1);
+  const __m256 vbeta2 = _mm256_set1_ps(beta2);
+  const __m256 vbeta1c = _mm256_set1_ps(1 - beta1);
+  const __m256 vbeta2c = _mm256_set1_ps(1 - beta2);
+  const __m256 vepsilon = _mm256_set1_ps(epsilon);
+  const __m256 vlr_correction = _mm256_set1_ps(lr_correction);
+  if (block_size == 128) {
+    // unrolling 16 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 16), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 16), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 16, vm);
+        _mm256_storeu_ps(m2 + 16, vv);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 24), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 24), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 24, vm);
+        _mm256_storeu_ps(m2 + 24, vv);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 32), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 32), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 32, vm);
+        _mm256_storeu_ps(m2 + 32, vv);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 40), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 40), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 40, vm);
+        _mm256_storeu_ps(m2 + 40, vv);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 48), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 48), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 48, vm);
+        _mm256_storeu_ps(m2 + 48, vv);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 56), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 56), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 56, vm);
+        _mm256_storeu_ps(m2 + 56, vv);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 64);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 64), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 64), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 64, vm);
+        _mm256_storeu_ps(m2 + 64, vv);
+        _mm256_storeu_ps(
+            w + 64,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 64),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[64]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[64]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[64]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 72);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 72), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 72), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 72, vm);
+        _mm256_storeu_ps(m2 + 72, vv);
+        _mm256_storeu_ps(
+            w + 72,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 72),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 80);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 80), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 80), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 80, vm);
+        _mm256_storeu_ps(m2 + 80, vv);
+        _mm256_storeu_ps(
+            w + 80,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 80),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[80]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[80]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[80]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 88);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 88), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 88), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 88, vm);
+        _mm256_storeu_ps(m2 + 88, vv);
+        _mm256_storeu_ps(
+            w + 88,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 88),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 96);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 96), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 96), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 96, vm);
+        _mm256_storeu_ps(m2 + 96, vv);
+        _mm256_storeu_ps(
+            w + 96,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 96),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[96]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[96]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[96]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 104);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 104), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 104), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 104, vm);
+        _mm256_storeu_ps(m2 + 104, vv);
+        _mm256_storeu_ps(
+            w + 104,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 104),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 112);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 112), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 112), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 112, vm);
+        _mm256_storeu_ps(m2 + 112, vv);
+        _mm256_storeu_ps(
+            w + 112,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 112),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[112]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[112]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[112]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 120);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 120), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 120), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 120, vm);
+        _mm256_storeu_ps(m2 + 120, vv);
+        _mm256_storeu_ps(
+            w + 120,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 120),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 16), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 16), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 16, vm);
+        _mm256_storeu_ps(m2 + 16, vv);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 24), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 24), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 24, vm);
+        _mm256_storeu_ps(m2 + 24, vv);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 32), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 32), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 32, vm);
+        _mm256_storeu_ps(m2 + 32, vv);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 40), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 40), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 40, vm);
+        _mm256_storeu_ps(m2 + 40, vv);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 48), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 48), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 48, vm);
+        _mm256_storeu_ps(m2 + 48, vv);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 56), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 56), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 56, vm);
+        _mm256_storeu_ps(m2 + 56, vv);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 16), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 16), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 16, vm);
+        _mm256_storeu_ps(m2 + 16, vv);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 24), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 24), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 24, vm);
+        _mm256_storeu_ps(m2 + 24, vv);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else {
+    // generic code
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        {
+          const __m256 vg = _mm256_loadu_ps(g + j);
+          const __m256 vm = _mm256_add_ps(
+              _mm256_mul_ps(_mm256_loadu_ps(m1 + j), vbeta1),
+              _mm256_mul_ps(vg, vbeta1c));
+          const __m256 vv = _mm256_add_ps(
+              _mm256_mul_ps(_mm256_loadu_ps(m2 + j), vbeta2),
+              _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+          _mm256_storeu_ps(m1 + j, vm);
+          _mm256_storeu_ps(m2 + j, vv);
+          _mm256_storeu_ps(
+              w + j,
+              _mm256_add_ps(
+                  _mm256_loadu_ps(w + j),
+                  _mm256_div_ps(
+                      _mm256_mul_ps(vlr_correction, vm),
+                      _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+        }
+        _mm_prefetch((&w_next[j]), _MM_HINT_T0);
+        _mm_prefetch((&m1_next[j]), _MM_HINT_T0);
+        _mm_prefetch((&m2_next[j]), _MM_HINT_T0);
+      }
+      for (; j < block_size; ++j) {
+        const float gj = g[j];
+        const float mj = m1[j] = m1[j] * beta1 + gj * (1 - beta1);
+        const float vj = m2[j] = m2[j] * beta2 + gj * gj * (1 - beta2);
+        w[j] = w[j] + lr_correction * mj / (std::sqrt(vj) + epsilon);
+      }
+    }
+  }
+  return true;
+}
+
+bool SparseAdam_int64_t__avx2_fma(
+    const TIndex block_size,
+    const TIndex index_size,
+    const TIndex param_rows,
+    const TIndex row_begin,
+    const TIndex row_end,
+    const int64_t* indices,
+    const float* grad,
+    float* param,
+    float* moment1,
+    float* moment2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float lr_correction) {
+  const TIndex prefdist_T0 = 16;
+  const __m256 vbeta1 = _mm256_set1_ps(beta1);
+  const __m256 vbeta2 = _mm256_set1_ps(beta2);
+  const __m256 vbeta1c = _mm256_set1_ps(1 - beta1);
+  const __m256 vbeta2c = _mm256_set1_ps(1 - beta2);
+  const __m256 vepsilon = _mm256_set1_ps(epsilon);
+  const __m256 vlr_correction = _mm256_set1_ps(lr_correction);
+  if (block_size == 128) {
+    // unrolling 16 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 16), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 16), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 16, vm);
+        _mm256_storeu_ps(m2 + 16, vv);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 24), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 24), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 24, vm);
+        _mm256_storeu_ps(m2 + 24, vv);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 32), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 32), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 32, vm);
+        _mm256_storeu_ps(m2 + 32, vv);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 40), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 40), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 40, vm);
+        _mm256_storeu_ps(m2 + 40, vv);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 48), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 48), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 48, vm);
+        _mm256_storeu_ps(m2 + 48, vv);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 56), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 56), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 56, vm);
+        _mm256_storeu_ps(m2 + 56, vv);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 64);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 64), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 64), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 64, vm);
+        _mm256_storeu_ps(m2 + 64, vv);
+        _mm256_storeu_ps(
+            w + 64,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 64),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[64]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[64]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[64]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 72);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 72), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 72), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 72, vm);
+        _mm256_storeu_ps(m2 + 72, vv);
+        _mm256_storeu_ps(
+            w + 72,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 72),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 80);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 80), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 80), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 80, vm);
+        _mm256_storeu_ps(m2 + 80, vv);
+        _mm256_storeu_ps(
+            w + 80,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 80),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[80]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[80]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[80]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 88);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 88), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 88), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 88, vm);
+        _mm256_storeu_ps(m2 + 88, vv);
+        _mm256_storeu_ps(
+            w + 88,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 88),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 96);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 96), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 96), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 96, vm);
+        _mm256_storeu_ps(m2 + 96, vv);
+        _mm256_storeu_ps(
+            w + 96,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 96),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[96]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[96]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[96]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 104);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 104), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 104), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 104, vm);
+        _mm256_storeu_ps(m2 + 104, vv);
+        _mm256_storeu_ps(
+            w + 104,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 104),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 112);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 112), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 112), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 112, vm);
+        _mm256_storeu_ps(m2 + 112, vv);
+        _mm256_storeu_ps(
+            w + 112,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 112),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[112]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[112]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[112]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 120);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 120), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 120), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 120, vm);
+        _mm256_storeu_ps(m2 + 120, vv);
+        _mm256_storeu_ps(
+            w + 120,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 120),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else if (block_size == 64) {
+    // unrolling 8 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 16), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 16), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 16, vm);
+        _mm256_storeu_ps(m2 + 16, vv);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 24), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 24), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 24, vm);
+        _mm256_storeu_ps(m2 + 24, vv);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 32);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 32), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 32), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 32, vm);
+        _mm256_storeu_ps(m2 + 32, vv);
+        _mm256_storeu_ps(
+            w + 32,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 32),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[32]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[32]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 40);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 40), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 40), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 40, vm);
+        _mm256_storeu_ps(m2 + 40, vv);
+        _mm256_storeu_ps(
+            w + 40,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 40),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 48);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 48), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 48), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 48, vm);
+        _mm256_storeu_ps(m2 + 48, vv);
+        _mm256_storeu_ps(
+            w + 48,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 48),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[48]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[48]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 56);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 56), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 56), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 56, vm);
+        _mm256_storeu_ps(m2 + 56, vv);
+        _mm256_storeu_ps(
+            w + 56,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 56),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else if (block_size == 32) {
+    // unrolling 4 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 16);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 16), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 16), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 16, vm);
+        _mm256_storeu_ps(m2 + 16, vv);
+        _mm256_storeu_ps(
+            w + 16,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 16),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[16]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[16]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 24);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 24), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 24), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 24, vm);
+        _mm256_storeu_ps(m2 + 24, vv);
+        _mm256_storeu_ps(
+            w + 24,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 24),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else if (block_size == 16) {
+    // unrolling 2 times
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 0);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 0), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 0), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 0, vm);
+        _mm256_storeu_ps(m2 + 0, vv);
+        _mm256_storeu_ps(
+            w + 0,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 0),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+      _mm_prefetch((&w_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m1_next[0]), _MM_HINT_T0);
+      _mm_prefetch((&m2_next[0]), _MM_HINT_T0);
+      {
+        const __m256 vg = _mm256_loadu_ps(g + 8);
+        const __m256 vm = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m1 + 8), vbeta1),
+            _mm256_mul_ps(vg, vbeta1c));
+        const __m256 vv = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(m2 + 8), vbeta2),
+            _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+        _mm256_storeu_ps(m1 + 8, vm);
+        _mm256_storeu_ps(m2 + 8, vv);
+        _mm256_storeu_ps(
+            w + 8,
+            _mm256_add_ps(
+                _mm256_loadu_ps(w + 8),
+                _mm256_div_ps(
+                    _mm256_mul_ps(vlr_correction, vm),
+                    _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+      }
+    }
+  } else {
+    // generic code
+    for (TIndex i = 0; i < index_size; ++i) {
+      const TIndex idx = indices[i];
+      if (idx < 0 || idx >= param_rows) {
+        return false;
+      }
+      if (idx < row_begin || idx >= row_end) {
+        continue;
+      }
+      const TIndex next_T0 =
+          (i < index_size - prefdist_T0) ? (i + prefdist_T0) : i;
+      TIndex idx_pref_T0 = indices[next_T0];
+      if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {
+        idx_pref_T0 = idx;
+      }
+      const float* g = grad + i * block_size;
+      float* w = param + idx * block_size;
+      float* w_next = param + idx_pref_T0 * block_size;
+      float* m1 = moment1 + idx * block_size;
+      float* m1_next = moment1 + idx_pref_T0 * block_size;
+      float* m2 = moment2 + idx * block_size;
+      float* m2_next = moment2 + idx_pref_T0 * block_size;
+      TIndex j = 0;
+      for (; j + 8 <= block_size; j += 8) {
+        {
+          const __m256 vg = _mm256_loadu_ps(g + j);
+          const __m256 vm = _mm256_add_ps(
+              _mm256_mul_ps(_mm256_loadu_ps(m1 + j), vbeta1),
+              _mm256_mul_ps(vg, vbeta1c));
+          const __m256 vv = _mm256_add_ps(
+              _mm256_mul_ps(_mm256_loadu_ps(m2 + j), vbeta2),
+              _mm256_mul_ps(_mm256_mul_ps(vg, vg), vbeta2c));
+          _mm256_storeu_ps(m1 + j, vm);
+          _mm256_storeu_ps(m2 + j, vv);
+          _mm256_storeu_ps(
+              w + j,
+              _mm256_add_ps(
+                  _mm256_loadu_ps(w + j),
+                  _mm256_div_ps(
+                      _mm256_mul_ps(vlr_correction, vm),
+                      _mm256_add_ps(_mm256_sqrt_ps(vv), vepsilon))));
+        }
+        _mm_prefetch((&w_next[j]), _MM_HINT_T0);
+        _mm_prefetch((&m1_next[j]), _MM_HINT_T0);
+        _mm_prefetch((&m2_next[j]), _MM_HINT_T0);
+      }
+      for (; j < block_size; ++j) {
+        const float gj = g[j];
+        const float mj = m1[j] = m1[j] * beta1 + gj * (1 - beta1);
+        const float vj = m2[j] = m2[j] * beta2 + gj * gj * (1 - beta2);
+        w[j] = w[j] + lr_correction * mj / (std::sqrt(vj) + epsilon);
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace caffe2
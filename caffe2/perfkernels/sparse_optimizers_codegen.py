@@ -0,0 +1,296 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+import argparse
+import sys
+
+# Generates the AVX2 sparse optimizer kernels in sparse_optimizers_avx2.cc.
+#
+# Each kernel walks the gradient rows in order and updates the parameter (and
+# optimizer state) rows they point to in place. The rows of the index
+# prefdist_T0 positions ahead are prefetched while the current row is being
+# updated. The vector code does the same float operations in the same order
+# as the scalar reference in sparse_optimizers.cc, except for the row-wise
+# gradient square sum, which is accumulated in 8 lanes.
+
+# Per optimizer: the optimizer state arguments, the (argument, row pointer)
+# names of the state that is laid out like the parameter, whether the state
+# is one value per row instead, and the hyperparameters.
+OPTIMIZERS = {
+    "SparseAdagrad": {
+        "state_args": ["moment"],
+        "state": [("moment", "h")],
+        "rowwise": False,
+        "args": ["float epsilon,", "float lr)"],
+    },
+    "RowWiseSparseAdagrad": {
+        "state_args": ["moment"],
+        "state": [],
+        "rowwise": True,
+        "args": ["float epsilon,", "float lr)"],
+    },
+    "SparseAdam": {
+        "state_args": ["moment1", "moment2"],
+        "state": [("moment1", "m1"), ("moment2", "m2")],
+        "rowwise": False,
+        "args": [
+            "float beta1,",
+            "float beta2,",
+            "float epsilon,",
+            "float lr_correction)",
+        ],
+    },
+}
+
+
+def constants(name):
+    code = []
+    if name == "SparseAdagrad":
+        code.append("const __m256 vepsilon = _mm256_set1_ps(epsilon);")
+        code.append("const __m256 vlr = _mm256_set1_ps(lr);")
+    elif name == "RowWiseSparseAdagrad":
+        pass
+    elif name == "SparseAdam":
+        code.append("const __m256 vbeta1 = _mm256_set1_ps(beta1);")
+        code.append("const __m256 vbeta2 = _mm256_set1_ps(beta2);")
+        code.append("const __m256 vbeta1c = _mm256_set1_ps(1 - beta1);")
+        code.append("const __m256 vbeta2c = _mm256_set1_ps(1 - beta2);")
+        code.append("const __m256 vepsilon = _mm256_set1_ps(epsilon);")
+        code.append(
+            "const __m256 vlr_correction = _mm256_set1_ps(lr_correction);")
+    else:
+        assert False
+    return code
+
+
+def row_pointers(name):
+    code = []
+    code.append("const float* g = grad + i * block_size;")
+    code.append("float* w = param + idx * block_size;")
+    code.append("float* w_next = param + idx_pref_T0 * block_size;")
+    for arg, row in OPTIMIZERS[name]["state"]:
+        code.append("float* {} = {} + idx * block_size;".format(row, arg))
+        code.append(
+            "float* {}_next = {} + idx_pref_T0 * block_size;".format(row, arg))
+    return code
+
+
+# Vector update of 8 elements at offset `j` (a constant or "j"). `vg` names
+# an already loaded gradient register, if any.
+def vector_update(name, j, vg=None):
+    code = []
+    if vg:
+        code.append(
+            "_mm256_storeu_ps(w + {0}, _mm256_add_ps(_mm256_loadu_ps(w + {0}),"
+            " _mm256_mul_ps({1}, vstep)));".format(j, vg))
+        return code
+    code.append("{")
+    code.append("const __m256 vg = _mm256_loadu_ps(g + {});".format(j))
+    if name == "SparseAdagrad":
+        code.append(
+            "const __m256 vh = _mm256_add_ps("
+            "_mm256_loadu_ps(h + {0}), _mm256_mul_ps(vg, vg));".format(j))
+        code.append("_mm256_storeu_ps(h + {}, vh);".format(j))
+        code.append(
+            "_mm256_storeu_ps(w + {0}, _mm256_add_ps(_mm256_loadu_ps(w + {0}),"
+            " _mm256_div_ps(_mm256_mul_ps(vlr, vg), _mm256_add_ps("
+            "_mm256_sqrt_ps(vh), vepsilon))));".format(j))
+    elif name == "RowWiseSparseAdagrad":
+        code.append(
+            "_mm256_storeu_ps(w + {0}, _mm256_add_ps(_mm256_loadu_ps(w + {0}),"
+            " _mm256_mul_ps(vg, vstep)));".format(j))
+    elif name == "SparseAdam":
+        code.append(
+            "const __m256 vm = _mm256_add_ps(_mm256_mul_ps("
+            "_mm256_loadu_ps(m1 + {0}), vbeta1), _mm256_mul_ps(vg, vbeta1c));"
+            .format(j))
+        code.append(
+            "const __m256 vv = _mm256_add_ps(_mm256_mul_ps("
+            "_mm256_loadu_ps(m2 + {0}), vbeta2), _mm256_mul_ps("
+            "_mm256_mul_ps(vg, vg), vbeta2c));".format(j))
+        code.append("_mm256_storeu_ps(m1 + {}, vm);".format(j))
+        code.append("_mm256_storeu_ps(m2 + {}, vv);".format(j))
+        code.append(
+            "_mm256_storeu_ps(w + {0}, _mm256_add_ps(_mm256_loadu_ps(w + {0}),"
+            " _mm256_div_ps(_mm256_mul_ps(vlr_correction, vm), _mm256_add_ps("
+            "_mm256_sqrt_ps(vv), vepsilon))));".format(j))
+    else:
+        assert False
+    code.append("}")
+    return code
+
+
+def scalar_update(name):
+    code = []
+    code.append("const float gj = g[j];")
+    if name == "SparseAdagrad":
+        code.append("const float hj = h[j] = h[j] + gj * gj;")
+        code.append("w[j] = w[j] + lr * gj / (std::sqrt(hj) + epsilon);")
+    elif name == "RowWiseSparseAdagrad":
+        code.append("w[j] = w[j] + gj * step;")
+    elif name == "SparseAdam":
+        code.append(
+            "const float mj = m1[j] = m1[j] * beta1 + gj * (1 - beta1);")
+        code.append(
+            "const float vj = m2[j] = m2[j] * beta2 + gj * gj * (1 - beta2);")
+        code.append(
+            "w[j] = w[j] + lr_correction * mj / (std::sqrt(vj) + epsilon);")
+    else:
+        assert False
+    return code
+
+
+def prefetch(name, j):
+    code = ["_mm_prefetch((&w_next[{}]), _MM_HINT_T0);".format(j)]
+    for _, row in OPTIMIZERS[name]["state"]:
+        code.append(
+            "_mm_prefetch((&{}_next[{}]), _MM_HINT_T0);".format(row, j))
+    return code
+
+
+# The square sum of a gradient row and the resulting step, for the row-wise
+# optimizer.
+def rowwise_step(uf):
+    code = []
+    code.append("__m256 vsum = _mm256_setzero_ps();")
+    if uf is None:
+        code.append("TIndex j = 0;")
+        code.append("for (; j + 8 <= block_size; j += 8) {")
+        code.append("const __m256 vg = _mm256_loadu_ps(g + j);")
+        code.append("vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg, vg));")
+        code.append("}")
+    else:
+        for k in range(uf):
+            code.append(
+                "const __m256 vg{0} = _mm256_loadu_ps(g + {1});".format(
+                    k, 8 * k))
+            code.append(
+                "vsum = _mm256_add_ps(vsum, _mm256_mul_ps(vg{0}, vg{0}));"
+                .format(k))
+    code.append("float sum[8];")
+    code.append("_mm256_storeu_ps(sum, vsum);")
+    code.append(
+        "float hs = ((sum[0] + sum[1]) + (sum[2] + sum[3])) +"
+        " ((sum[4] + sum[5]) + (sum[6] + sum[7]));")
+    if uf is None:
+        code.append("for (; j < block_size; ++j) {")
+        code.append("hs += g[j] * g[j];")
+        code.append("}")
+    code.append(
+        "const float hi = moment[idx] = moment[idx] + hs / block_size;")
+    code.append("const float step = lr / (std::sqrt(hi) + epsilon);")
+    code.append("const __m256 vstep = _mm256_set1_ps(step);")
+    return code
+
+
+def loop(name, uf):
+    code = []
+    if uf is not None:
+        code.append("// unrolling " + str(uf) + " times")
+    code.append("for (TIndex i = 0; i < index_size; ++i) {")
+    code.append("const TIndex idx = indices[i];")
+    code.append("if (idx < 0 || idx >= param_rows) {")
+    code.append("return false;")
+    code.append("}")
+    code.append("if (idx < row_begin || idx >= row_end) {")
+    code.append("continue;")
+    code.append("}")
+    code.append(
+        "const TIndex next_T0 = (i < index_size - prefdist_T0)"
+        " ? (i + prefdist_T0) : i;")
+    code.append("TIndex idx_pref_T0 = indices[next_T0];")
+    code.append("if (idx_pref_T0 < 0 || idx_pref_T0 >= param_rows) {")
+    code.append("idx_pref_T0 = idx;")
+    code.append("}")
+    code.extend(row_pointers(name))
+    if OPTIMIZERS[name]["rowwise"]:
+        code.append("_mm_prefetch((&moment[idx_pref_T0]), _MM_HINT_T0);")
+        code.extend(rowwise_step(uf))
+    if uf is not None:
+        for k in range(uf):
+            j = 8 * k
+            # The row-wise step has loaded the whole gradient row already.
+            vg = "vg{}".format(k) if OPTIMIZERS[name]["rowwise"] else None
+            code.extend(vector_update(name, j, vg))
+            # One prefetch per 64 byte cache line.
+            if (4 * j) % 64 == 0:
+                code.extend(prefetch(name, j))
+    else:
+        # The row-wise step already declared j.
+        code.append("j = 0;" if OPTIMIZERS[name]["rowwise"] else "TIndex j = 0;")
+        code.append("for (; j + 8 <= block_size; j += 8) {")
+        code.extend(vector_update(name, "j"))
+        code.extend(prefetch(name, "j"))
+        code.append("}")
+        code.append("for (; j < block_size; ++j) {")
+        code.extend(scalar_update(name))
+        code.append("}")
+    code.append("}")
+    return code
+
+
+# start main code
+parser = argparse.ArgumentParser()
+parser.add_argument('-f', '--filename', help="file name")
+opts = parser.parse_args()
+filename = opts.filename if opts.filename else "sparse_optimizers_avx2.cc"
+fout = open(filename, 'w')
+
+code = []
+# includes
+code.append("//// --------------------------")
+code.append("//// ATTENTION:")
+code.append("//// THIS CODE IS AUTOGENERATED")
+code.append("//// BY {}".format(sys.argv[0]))
+code.append("//// DO NOT MODIFY!!!")
+code.append("//// --------------------------\n\n")
+
+code.append("#include <caffe2/core/common.h>")
+code.append("#include <caffe2/core/types.h>")
+code.append("#include <immintrin.h>")
+code.append("#include <cmath>")
+code.append("\n")
+
+code.append("namespace caffe2 {\n")
+for name in ["SparseAdagrad", "RowWiseSparseAdagrad", "SparseAdam"]:
+    for IndexType in ["int32_t", "int64_t"]:
+        code.append("bool {}_{}__avx2_fma(".format(name, IndexType))
+        code.append("const TIndex block_size,")
+        code.append("const TIndex index_size,")
+        code.append("const TIndex param_rows,")
+        code.append("const TIndex row_begin,")
+        code.append("const TIndex row_end,")
+        code.append("const {}* indices,".format(IndexType))
+        code.append("const float* grad,")
+        code.append("float* param,")
+        for arg in OPTIMIZERS[name]["state_args"]:
+            code.append("float* {},".format(arg))
+        code.extend(OPTIMIZERS[name]["args"])
+        code.append("{")
+        code.append("const TIndex prefdist_T0 = 16;")
+        code.extend(constants(name))
+        code.append("if (block_size == 128) {")
+        code.extend(loop(name, 16))
+        code.append("} else if (block_size == 64) {")
+        code.extend(loop(name, 8))
+        code.append("} else if (block_size == 32) {")
+        code.extend(loop(name, 4))
+        code.append("} else if (block_size == 16) {")
+        code.extend(loop(name, 2))
+        code.append("} else {")
+        code.append("// generic code")
+        code.extend(loop(name, None))
+        code.append("}")
+        code.append("return true;")
+        code.append("}")
+        code.append("\n")
+
+code.append("} // namespace caffe2")
+
+for c in code:
+    fout.write(c + "\n")
+fout.close()
+
+
+print("Created " + filename)
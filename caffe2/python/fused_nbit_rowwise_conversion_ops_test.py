@@ -0,0 +1,108 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+from caffe2.python import core, workspace
+import caffe2.python.hypothesis_test_util as hu
+
+import numpy as np
+from hypothesis import given
+import hypothesis.strategies as st
+
+
+def fused_rowwise_nbit_quantize_reference(data, bit_rate):
+    num_elem_per_byte = 8 // bit_rate
+    max_quantized_value = (1 << bit_rate) - 1
+    # The bias is rounded to float16 before quantizing against it.
+    bias = np.min(data, axis=1, keepdims=True).astype(np.float16)
+    maximum = np.max(data, axis=1, keepdims=True)
+    span = maximum - bias.astype(np.float32)
+    scale = np.where(span == 0, 1.0, span / max_quantized_value)
+    scale = scale.astype(np.float16)
+    inverse_scale = 1.0 / scale.astype(np.float32)
+    quantized_data = np.clip(
+        np.rint((data - bias.astype(np.float32)) * inverse_scale),
+        0,
+        max_quantized_value,
+    ).astype(np.uint8)
+    # Pad the columns to whole bytes and pack, lowest bits first.
+    padding = -data.shape[1] % num_elem_per_byte
+    quantized_data = np.pad(quantized_data, ((0, 0), (0, padding)), 'constant')
+    packed_data = np.zeros(
+        [data.shape[0], quantized_data.shape[1] // num_elem_per_byte],
+        dtype=np.uint8,
+    )
+    for i in range(num_elem_per_byte):
+        packed_data |= quantized_data[:, i::num_elem_per_byte] << (i * bit_rate)
+    scale_bias = np.concatenate([scale, bias], axis=1).view(np.uint8)
+    return np.concatenate([packed_data, scale_bias], axis=1)
+
+
+def fused_rowwise_nbit_dequantize_reference(fused_quantized, bit_rate):
+    num_elem_per_byte = 8 // bit_rate
+    mask = (1 << bit_rate) - 1
+    scale_bias = fused_quantized[:, -4:].copy().view(np.float16)
+    scale = scale_bias[:, :1].astype(np.float32)
+    bias = scale_bias[:, 1:].astype(np.float32)
+    packed_data = fused_quantized[:, :-4]
+    quantized_data = np.empty(
+        [packed_data.shape[0], packed_data.shape[1] * num_elem_per_byte],
+        dtype=np.uint8,
+    )
+    for i in range(num_elem_per_byte):
+        quantized_data[:, i::num_elem_per_byte] = \
+            (packed_data >> (i * bit_rate)) & mask
+    return quantized_data * scale + bias
+
+
+class TestFusedNBitRowwiseQuantizationConversion(hu.HypothesisTestCase):
+    @given(
+        input_data=hu.tensor(min_dim=2, max_dim=2),
+        bit_rate=st.sampled_from([2, 4]),
+    )
+    def test_quantize_op(self, input_data, bit_rate):
+        quantize = core.CreateOperator(
+            'FloatToFused{}BitRowwiseQuantized'.format(bit_rate),
+            ['input_data'],
+            ['quantized_data'],
+        )
+        workspace.FeedBlob('input_data', input_data)
+        workspace.RunOperatorOnce(quantize)
+
+        quantized_data = workspace.FetchBlob('quantized_data')
+
+        reference = fused_rowwise_nbit_quantize_reference(
+            input_data.astype(np.float32), bit_rate
+        )
+        np.testing.assert_array_equal(quantized_data, reference)
+
+    @given(
+        input_data=hu.tensor(min_dim=2, max_dim=2),
+        bit_rate=st.sampled_from([2, 4]),
+    )
+    def test_quantize_and_dequantize_op(self, input_data, bit_rate):
+        quantize = core.CreateOperator(
+            'FloatToFused{}BitRowwiseQuantized'.format(bit_rate),
+            ['input_data'],
+            ['quantized_data'],
+        )
+        workspace.FeedBlob('input_data', input_data)
+        workspace.RunOperatorOnce(quantize)
+
+        quantized_data = workspace.FetchBlob('quantized_data')
+
+        dequantize = core.CreateOperator(
+            'Fused{}BitRowwiseQuantizedToFloat'.format(bit_rate),
+            ['quantized_data'],
+            ['dequantized_data'],
+        )
+        workspace.RunOperatorOnce(dequantize)
+
+        dequantized_data = workspace.FetchBlob('dequantized_data')
+
+        reference = fused_rowwise_nbit_dequantize_reference(
+            quantized_data, bit_rate
+        )
+        np.testing.assert_array_almost_equal(dequantized_data, reference)
+
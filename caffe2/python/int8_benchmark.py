@@ -0,0 +1,188 @@
+## @package int8_benchmark
+# Module caffe2.python.int8_benchmark
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+from caffe2.python import core, workspace
+
+import argparse
+import numpy as np
+
+import logging
+
+logging.basicConfig()
+log = logging.getLogger("int8_bench")
+log.setLevel(logging.INFO)
+
+
+# (name, batch, height, width, input channels, output channels, kernel, stride)
+CONV_SHAPES = [
+    ("resnet_conv1", 1, 224, 224, 3, 64, 7, 2),
+    ("resnet_3x3", 1, 56, 56, 64, 64, 3, 1),
+    ("resnet_1x1", 1, 56, 56, 256, 64, 1, 1),
+    ("resnet_3x3_s2", 1, 28, 28, 128, 128, 3, 2),
+    ("mobilenet_1x1", 1, 14, 14, 512, 512, 1, 1),
+]
+
+# (name, batch, input features, output features)
+FC_SHAPES = [
+    ("resnet_fc", 1, 2048, 1000),
+    ("ranking_fc", 64, 512, 256),
+    ("ranking_fc_wide", 64, 1024, 1024),
+]
+
+# (name, batch, height, width, channels)
+ELEMENTWISE_SHAPES = [
+    ("resnet_56x56", 1, 56, 56, 256),
+    ("resnet_14x14", 8, 14, 14, 1024),
+]
+
+
+def quantization_params(x):
+    lo = min(float(x.min()), 0.0)
+    hi = max(float(x.max()), 0.0)
+    scale = max((hi - lo) / 255.0, 1e-6)
+    zero_point = int(np.clip(round(-lo / scale), 0, 255))
+    return scale, zero_point
+
+
+def quantize(x, scale, zero_point):
+    return np.clip(np.round(x / scale) + zero_point, 0, 255).astype(np.uint8)
+
+
+def feed_int8(init_net, name, x):
+    '''
+    Adds an op to init_net creating the Int8 blob `name` from float data x,
+    and feeds x itself as the float blob `name`_fp32.
+    '''
+    scale, zero_point = quantization_params(x)
+    init_net.Int8GivenTensorFill(
+        [], name,
+        values=quantize(x, scale, zero_point).tobytes(),
+        shape=list(x.shape),
+        Y_scale=scale,
+        Y_zero_point=zero_point,
+    )
+    workspace.FeedBlob(name + "_fp32", x)
+    return scale
+
+
+def feed_bias(init_net, name, b, scale):
+    init_net.Int8GivenIntTensorFill(
+        [], name,
+        values=np.round(b / scale).astype(np.int32).tolist(),
+        shape=list(b.shape),
+        Y_scale=scale,
+        Y_zero_point=0,
+    )
+    workspace.FeedBlob(name + "_fp32", b)
+
+
+def benchmark(net, args):
+    workspace.CreateNet(net)
+    return workspace.BenchmarkNet(
+        net.Proto().name, args.warmup_iterations, args.iterations, False)[0]
+
+
+def compare(name, init_net, fp32_net, int8_net, args):
+    workspace.RunNetOnce(init_net)
+    fp32_ms = benchmark(fp32_net, args)
+    int8_ms = benchmark(int8_net, args)
+    log.info("{:<20} fp32 {:8.3f} ms  int8 {:8.3f} ms  speedup {:5.2f}x".format(
+        name, fp32_ms, int8_ms, fp32_ms / int8_ms))
+
+
+def conv_nets(shape, order):
+    name, N, H, W, C, M, K, S = shape
+    init_net = core.Net(name + "_init")
+    fp32_net = core.Net(name + "_fp32")
+    int8_net = core.Net(name + "_int8")
+    X = np.random.rand(N, H, W, C).astype(np.float32)
+    w = (np.random.rand(M, K, K, C).astype(np.float32) - 0.5)
+    b = np.random.rand(M).astype(np.float32)
+    X_scale = feed_int8(init_net, "X", X)
+    W_scale = feed_int8(init_net, "W", w)
+    feed_bias(init_net, "b", b, X_scale * W_scale)
+    if order == "NCHW":
+        workspace.FeedBlob("X_fp32", X.transpose(0, 3, 1, 2).copy())
+        workspace.FeedBlob("W_fp32", w.transpose(0, 3, 1, 2).copy())
+    conv_args = dict(kernel=K, stride=S, pad=K // 2)
+    fp32_net.Conv(["X_fp32", "W_fp32", "b_fp32"], "Y_fp32",
+                  order=order, **conv_args)
+    int8_net.Int8Conv(["X", "W", "b"], "Y", order="NHWC",
+                      Y_scale=0.05, Y_zero_point=0, **conv_args)
+    return init_net, fp32_net, int8_net
+
+
+def fc_nets(shape):
+    name, N, K, M = shape
+    init_net = core.Net(name + "_init")
+    fp32_net = core.Net(name + "_fp32")
+    int8_net = core.Net(name + "_int8")
+    X = np.random.rand(N, K).astype(np.float32)
+    w = (np.random.rand(M, K).astype(np.float32) - 0.5)
+    b = np.random.rand(M).astype(np.float32)
+    X_scale = feed_int8(init_net, "X", X)
+    W_scale = feed_int8(init_net, "W", w)
+    feed_bias(init_net, "b", b, X_scale * W_scale)
+    fp32_net.FC(["X_fp32", "W_fp32", "b_fp32"], "Y_fp32")
+    int8_net.Int8FC(["X", "W", "b"], "Y", Y_scale=0.05, Y_zero_point=0)
+    return init_net, fp32_net, int8_net
+
+
+def elementwise_nets(shape, op):
+    name, N, H, W, C = shape
+    name = op.lower() + "_" + name
+    init_net = core.Net(name + "_init")
+    fp32_net = core.Net(name + "_fp32")
+    int8_net = core.Net(name + "_int8")
+    A = np.random.randn(N, H, W, C).astype(np.float32)
+    B = np.random.randn(N, H, W, C).astype(np.float32)
+    feed_int8(init_net, "A", A)
+    feed_int8(init_net, "B", B)
+    if op == "Add":
+        fp32_net.Add(["A_fp32", "B_fp32"], "Y_fp32")
+        int8_net.Int8Add(["A", "B"], "Y", Y_scale=0.05, Y_zero_point=128)
+    elif op == "MaxPool":
+        fp32_net.MaxPool("A_fp32", "Y_fp32", kernel=3, stride=2, order="NHWC")
+        int8_net.Int8MaxPool("A", "Y", kernel=3, stride=2, order="NHWC")
+    else:
+        getattr(fp32_net, op)("A_fp32", "Y_fp32")
+        getattr(int8_net, "Int8" + op)("A", "Y")
+    return init_net, fp32_net, int8_net
+
+
+def main(args):
+    np.random.seed(2018)
+    for shape in CONV_SHAPES:
+        compare("conv/" + shape[0], *conv_nets(shape, args.fp32_order),
+                args=args)
+    for shape in FC_SHAPES:
+        compare("fc/" + shape[0], *fc_nets(shape), args=args)
+    for shape in ELEMENTWISE_SHAPES:
+        for op in ["Add", "Relu", "Sigmoid", "MaxPool"]:
+            compare("{}/{}".format(op.lower(), shape[0]),
+                    *elementwise_nets(shape, op), args=args)
+
+
+def GetArgumentParser():
+    parser = argparse.ArgumentParser(
+        description="Compare Int8 operators against their fp32 counterparts")
+    parser.add_argument(
+        "--iterations", type=int, default=50,
+        help="Number of timed iterations per net")
+    parser.add_argument(
+        "--warmup_iterations", type=int, default=5,
+        help="Number of untimed iterations per net")
+    parser.add_argument(
+        "--fp32_order", type=str, default="NCHW", choices=["NCHW", "NHWC"],
+        help="Storage order of the fp32 convolutions (Int8Conv is NHWC only)")
+    return parser
+
+
+if __name__ == '__main__':
+    args, extra_args = GetArgumentParser().parse_known_args()
+    workspace.GlobalInit(['caffe2', '--caffe2_log_level=0'] + extra_args)
+    main(args)
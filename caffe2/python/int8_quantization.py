@@ -0,0 +1,114 @@
+## @package int8_quantization
+# Module caffe2.python.int8_quantization
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+from caffe2.python import core, transformations, workspace
+
+import copy
+import numpy as np
+
+
+def calibrate(net, input_batches):
+    '''
+    Runs net (already created in the workspace, with its weights filled in)
+    once per entry of input_batches, a list of {blob name: numpy array}, and
+    returns the {blob: (min, max)} ranges of every float tensor it touched.
+    '''
+    observer = net.AddObserver("CalibrationObserver")
+    try:
+        for batch in input_batches:
+            for name, value in batch.items():
+                workspace.FeedBlob(name, value)
+            workspace.RunNet(net.Proto().name)
+        return observer.tensor_ranges()
+    finally:
+        net.RemoveObserver(observer)
+
+
+def quantize(net, ranges, external_outputs=None):
+    '''
+    Returns (int8_init_net, int8_net): a copy of net rewritten to Int8*
+    operators using the calibration ranges, and a net creating the quantized
+    weights. The float weights must still be in the workspace.
+    '''
+    int8_net = core.Net(copy.deepcopy(net.Proto()))
+    int8_net.Proto().name = net.Proto().name + "_int8"
+    init = transformations.quantizeInt8(int8_net, ranges, external_outputs)
+    int8_init_net = core.Net(init)
+    int8_init_net.Proto().name = net.Proto().name + "_int8_init"
+    return int8_init_net, int8_net
+
+
+def accuracy_report(net, int8_net, input_batches, outputs=None):
+    '''
+    Runs both nets on every batch and compares their outputs. Returns
+    {output: {"max_abs_error", "mean_abs_error", "top1_agreement"}}, where
+    top-1 agreement is the fraction of rows of 2D outputs whose argmax
+    matches.
+    '''
+    if outputs is None:
+        outputs = [str(b) for b in net.Proto().external_output]
+    errors = {name: [] for name in outputs}
+    agree = {name: [] for name in outputs}
+    for batch in input_batches:
+        for name, value in batch.items():
+            workspace.FeedBlob(name, value)
+        workspace.RunNet(net.Proto().name)
+        expected = {name: workspace.FetchBlob(name).copy() for name in outputs}
+        workspace.RunNet(int8_net.Proto().name)
+        for name in outputs:
+            actual = workspace.FetchBlob(name)
+            errors[name].append(np.abs(actual - expected[name]).ravel())
+            if expected[name].ndim == 2:
+                agree[name].append(
+                    np.argmax(actual, 1) == np.argmax(expected[name], 1))
+    report = {}
+    for name in outputs:
+        error = np.concatenate(errors[name])
+        report[name] = {
+            "max_abs_error": float(error.max()) if error.size else 0.0,
+            "mean_abs_error": float(error.mean()) if error.size else 0.0,
+        }
+        if agree[name]:
+            report[name]["top1_agreement"] = float(
+                np.concatenate(agree[name]).mean())
+    return report
+
+
+def speed_report(net, int8_net, warmup_iterations=5, iterations=50):
+    '''
+    Returns the average milliseconds per run of both nets on the inputs
+    currently in the workspace.
+    '''
+    def run(n):
+        return workspace.BenchmarkNet(
+            n.Proto().name, warmup_iterations, iterations, False)[0]
+    fp32_ms = run(net)
+    int8_ms = run(int8_net)
+    return {"fp32_ms": fp32_ms, "int8_ms": int8_ms,
+            "speedup": fp32_ms / int8_ms}
+
+
+def quantize_and_report(net, calibration_batches, eval_batches,
+                        external_outputs=None):
+    '''
+    Calibrates net on calibration_batches, quantizes it and evaluates the
+    int8 net against it on eval_batches. net must already be created in the
+    workspace. Returns (int8_init_net, int8_net, report).
+    '''
+    ranges = calibrate(net, calibration_batches)
+    int8_init_net, int8_net = quantize(net, ranges, external_outputs)
+    workspace.RunNetOnce(int8_init_net)
+    workspace.CreateNet(int8_net, overwrite=True)
+    report = {
+        "accuracy": accuracy_report(
+            net, int8_net, eval_batches, external_outputs),
+        "speed": speed_report(net, int8_net),
+        "quantized_ops": sum(
+            op.type.startswith("Int8") for op in int8_net.Proto().op),
+        "total_ops": len(int8_net.Proto().op),
+    }
+    return int8_init_net, int8_net, report
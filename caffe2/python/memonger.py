@@ -279,6 +279,271 @@ def release_blobs_when_used(netproto, dont_free_blobs, selector_fun=None):
     return netproto
 
 
+RecomputeStatistics = collections.namedtuple(
+    'RecomputeStatistics',
+    ['baseline_nbytes', 'optimized_nbytes', 'forward_ops', 'recomputed_ops',
+     'forward_flops', 'recomputed_flops'])
+
+# Ops that must only run once per run of the net: the random, stateful and
+# side-effecting ops that constant folding doesn't fold either, and SpatialBN,
+# which updates its running statistics in training.
+_NOT_RECOMPUTABLE_OPS = set(C.impure_operators()) | {"SpatialBN"}
+
+
+def _reads_non_tensor(op):
+    '''
+    Whether op reads a blob of the workspace that isn't a tensor, such as a
+    reader, queue, DB cursor or counter, whose state it may advance.
+    '''
+    return any(
+        workspace.HasBlob(b) and not C.is_tensor_blob(b) for b in op.input)
+
+
+def _peak_live_nbytes(ops, static_blobs, external_output, size_of):
+    '''
+    Peak total size of the non-static blobs that are alive at once when ops
+    run in order, if every blob is allocated when first written and freed
+    after its last use.
+    '''
+    first = {}
+    last = {}
+    for i, op in enumerate(ops):
+        for b in list(op.input) + list(op.output):
+            if b in static_blobs:
+                continue
+            first.setdefault(b, i)
+            last[b] = i
+    for b in external_output:
+        if b in last:
+            last[b] = len(ops)
+    delta = collections.defaultdict(int)
+    for b, i in viewitems(first):
+        delta[i] += size_of(b)
+        delta[last[b] + 1] -= size_of(b)
+    live = 0
+    peak = 0
+    for i in sorted(delta):
+        live += delta[i]
+        peak = max(peak, live)
+    return peak
+
+
+def _op_flops(op):
+    if not all(workspace.HasBlob(b) for b in op.input):
+        return 0
+    try:
+        return workspace.GetOperatorCost(op, list(op.input))[0]
+    except Exception:
+        return 0
+
+
+def recompute_activations(
+    net,
+    num_forward_ops,
+    memory_budget=None,
+    blob_sizes=None,
+    dont_recompute_blobs=None,
+):
+    '''
+    Trades compute for activation memory in training nets, like the
+    checkpointing of "Training Deep Nets with Sublinear Memory Cost": the
+    forward pass is split into segments, and the activations of a segment
+    that the gradient ops read are computed again by copies of the
+    segment's ops, right before the first gradient op that needs them.
+    Only the blobs a segment shares with the rest of the forward pass stay
+    alive until the backward pass; the gradient ops are the ones the
+    gradient registry generated and only read renamed inputs.
+
+    Ops that are random, have side effects, read non-tensor blobs of the
+    workspace (readers, queues, DBs) or update blobs in place across segments
+    are never recomputed.
+
+    @num_forward_ops:  the first num_forward_ops ops of net are the forward
+                       pass, e.g. the length of the net before
+                       AddGradientOperators(), and the remaining ones its
+                       gradient (and optimizer) ops.
+    @memory_budget:    most activation bytes (or blobs, without blob_sizes)
+                       a segment may recompute. Defaults to the total over
+                       the square root of the number of forward ops.
+    @blob_sizes:       optional map from blob to its size in bytes, such as
+                       the one of collect_blob_sizes().
+    @dont_recompute_blobs: blobs the gradient ops must keep reading from the
+                       forward pass.
+
+    The forward activations the gradient ops no longer read can then be
+    reclaimed by release_blobs_when_used() or share_grad_blobs().
+
+    Returns (optimized protobuf, RecomputeStatistics). The byte counts are
+    the peak activation memory if blobs are freed after their last use, the
+    FLOPs those of the ops that have cost inference and whose inputs are in
+    the workspace.
+    '''
+    netproto = copy.deepcopy(net.Proto())
+    forward = list(netproto.op[:num_forward_ops])
+    backward = list(netproto.op[num_forward_ops:])
+    external_input = set(netproto.external_input)
+    external_output = set(netproto.external_output)
+    keep = external_input | external_output | set(dont_recompute_blobs or [])
+
+    def size_of(b):
+        return blob_sizes.get(b, 0) if blob_sizes else 1
+
+    writes = collections.defaultdict(list)
+    for i, op in enumerate(forward):
+        for b in op.output:
+            writes[b].append(i)
+    backward_reads = set()
+    backward_writes = set()
+    for op in backward:
+        backward_reads.update(op.input)
+        backward_writes.update(op.output)
+
+    # Segments may only start where no blob is written both before and
+    # after, so that in-place chains are recomputed as a whole.
+    cut = [True] * (len(forward) + 1)
+    for indices in viewvalues(writes):
+        for i in range(indices[0] + 1, indices[-1] + 1):
+            cut[i] = False
+
+    def is_recomputable(op):
+        return (
+            op.type not in _NOT_RECOMPUTABLE_OPS and
+            not _reads_non_tensor(op) and
+            not any(arg.HasField('n') or arg.nets for arg in op.arg) and
+            not any(b in external_input or b in backward_writes
+                    for b in op.output)
+        )
+
+    blocks = []
+    for i in range(len(forward)):
+        if cut[i]:
+            blocks.append([i, i + 1, True, 0])
+        else:
+            blocks[-1][1] = i + 1
+        blocks[-1][2] = blocks[-1][2] and is_recomputable(forward[i])
+        blocks[-1][3] += sum(
+            size_of(b) for b in forward[i].output
+            if b in backward_reads and b not in keep and writes[b][0] == i)
+
+    if memory_budget is None:
+        total = sum(block[3] for block in blocks)
+        memory_budget = total / max(len(forward), 1) ** 0.5
+
+    segments = []
+    start = end = None
+    cost = 0
+    for (block_start, block_end, recomputable, block_cost) in blocks:
+        if start is not None and (
+                not recomputable or cost + block_cost > memory_budget):
+            segments.append((start, end))
+            start = None
+        if recomputable:
+            if start is None:
+                start, cost = block_start, 0
+            end = block_end
+            cost += block_cost
+    if start is not None:
+        segments.append((start, end))
+
+    used_names = set(external_input) | external_output
+    for op in netproto.op:
+        used_names.update(op.input)
+        used_names.update(op.output)
+
+    original = {}
+
+    def fresh_name(b):
+        name = b + "_recompute"
+        k = 1
+        while name in used_names:
+            name = "{}_recompute_{}".format(b, k)
+            k += 1
+        used_names.add(name)
+        original[name] = b
+        return name
+
+    inserts = collections.defaultdict(list)
+    renames = {}
+    recomputed_forward_ops = []
+    for (start, end) in segments:
+        written = set()
+        for op in forward[start:end]:
+            written.update(op.output)
+        read_later = set()
+        for op in forward[end:]:
+            read_later.update(op.input)
+        checkpoints = written & (read_later | keep)
+        dropped = (written & backward_reads) - checkpoints
+        if not dropped:
+            continue
+        renamed = {b: fresh_name(b) for b in written}
+
+        recompute = []
+        for i in range(start, end):
+            op = copy.deepcopy(forward[i])
+            inputs = [
+                b if b not in written or (
+                    b in checkpoints and writes[b][-1] < i) else renamed[b]
+                for b in op.input]
+            del op.input[:]
+            op.input.extend(inputs)
+            del op.output[:]
+            op.output.extend(renamed[b] for b in forward[i].output)
+            recompute.append((i, op))
+
+        # Only keep the copies that the gradient ops depend on
+        needed = {renamed[b] for b in dropped}
+        kept = []
+        for (i, op) in reversed(recompute):
+            if any(b in needed for b in op.output):
+                needed.update(op.input)
+                kept.append((i, op))
+        kept.reverse()
+
+        first_use = min(
+            j for j, op in enumerate(backward)
+            if any(b in dropped for b in op.input))
+        overwritten = set()
+        for op in backward[:first_use]:
+            overwritten.update(op.output)
+        if any(b in overwritten for (_, op) in kept for b in op.input):
+            continue
+
+        inserts[first_use].extend(op for (_, op) in kept)
+        recomputed_forward_ops.extend(forward[i] for (i, _) in kept)
+        for b in dropped:
+            renames[b] = renamed[b]
+
+    ops = list(forward)
+    for j, op in enumerate(backward):
+        ops.extend(inserts[j])
+        if any(b in renames for b in op.input):
+            inputs = [renames.get(b, b) for b in op.input]
+            del op.input[:]
+            op.input.extend(inputs)
+        ops.append(op)
+    del netproto.op[:]
+    netproto.op.extend(ops)
+
+    stats = RecomputeStatistics(
+        baseline_nbytes=_peak_live_nbytes(
+            net.Proto().op, external_input, external_output, size_of),
+        optimized_nbytes=_peak_live_nbytes(
+            netproto.op, external_input, external_output,
+            lambda b: size_of(original.get(b, b))),
+        forward_ops=len(forward),
+        recomputed_ops=len(recomputed_forward_ops),
+        forward_flops=sum(_op_flops(op) for op in forward),
+        recomputed_flops=sum(_op_flops(op) for op in recomputed_forward_ops),
+    )
+    log.info(
+        "Recomputing {} of {} forward ops in {} segments: peak activation "
+        "memory {} -> {}".format(
+            stats.recomputed_ops, stats.forward_ops, len(segments),
+            stats.baseline_nbytes, stats.optimized_nbytes))
+    return netproto, stats
+
+
 def _find_source_nodes(g):
     ''' Return nodes without predecessors '''
     ret = []
@@ -756,6 +756,79 @@ class MemongerTest(hu.HypothesisTestCase):
 
         self.assertEqual(expect_frees, found_frees)
 
+    @given(input_dim=st.integers(min_value=1, max_value=4),
+           output_dim=st.integers(min_value=1, max_value=4),
+           batch_size=st.integers(min_value=1, max_value=4),
+           inplace=st.booleans())
+    @settings(max_examples=5, timeout=120)
+    def test_recompute_activations(self, input_dim, output_dim, batch_size,
+                                   inplace):
+        m = model_helper.ModelHelper()
+        x = brew.fc(m, "data", "fc0", dim_in=input_dim, dim_out=output_dim)
+        for i in range(16):
+            x = brew.relu(m, x, x if inplace else "relu{}".format(i))
+            x = brew.fc(m, x, "fc{}".format(i + 1),
+                        dim_in=output_dim, dim_out=output_dim)
+        m.net.Softmax(x, "pred") \
+             .LabelCrossEntropy(["label"], ["xent"]) \
+             .AveragedLoss([], "loss")
+        num_forward_ops = len(m.net.Proto().op)
+        input_to_grad = m.AddGradientOperators(["loss"])
+        grad_names = [str(input_to_grad[p]) for p in m.params]
+
+        optim_proto, stats = memonger.recompute_activations(
+            m.net, num_forward_ops)
+        self.assertGreater(stats.recomputed_ops, 0)
+        self.assertLess(stats.optimized_nbytes, stats.baseline_nbytes)
+        # The gradient ops are unchanged, recomputation only adds ops
+        self.assertEqual(
+            len(optim_proto.op), len(m.net.Proto().op) + stats.recomputed_ops)
+
+        data = np.random.randn(batch_size, input_dim).astype(np.float32)
+        label = np.random.randint(
+            low=0, high=output_dim, size=(batch_size,)).astype(np.int32)
+        workspace.RunNetOnce(m.param_init_net)
+        workspace.FeedBlob("data", data)
+        workspace.FeedBlob("label", label)
+        workspace.RunNetOnce(m.net)
+        loss = workspace.FetchBlob("loss")
+        grads = [workspace.FetchBlob(g) for g in grad_names]
+
+        for g in grad_names:
+            workspace.FeedBlob(g, np.array([0.0]))
+        with_frees = memonger.release_blobs_when_used(
+            optim_proto, set(grad_names + ["loss"]))
+        workspace.RunNetOnce(with_frees)
+        np.testing.assert_almost_equal(loss, workspace.FetchBlob("loss"))
+        for g, grad in zip(grad_names, grads):
+            np.testing.assert_almost_equal(grad, workspace.FetchBlob(g))
+
+    def test_recompute_activations_keeps_impure_ops(self):
+        m = model_helper.ModelHelper()
+        m.param_init_net.CreateCounter([], "counter", init_count=2)
+        x = brew.fc(m, "data", "fc0", dim_in=4, dim_out=4)
+        for i in range(16):
+            x = brew.relu(m, x, "relu{}".format(i))
+            if i == 8:
+                # RetrieveCount reads a counter, which isn't a tensor
+                m.net.RetrieveCount("counter", "count")
+                m.net.Cast("count", "scale", to=core.DataType.FLOAT)
+                m.net.StopGradient("scale", "scale")
+                x = m.net.Mul([x, "scale"], "scaled", broadcast=1)
+                x, _ = m.net.Dropout(x, ["dropout", "dropout_mask"], ratio=0.5)
+            x = brew.fc(m, x, "fc{}".format(i + 1), dim_in=4, dim_out=4)
+        m.net.AveragedLoss(x, "loss")
+        num_forward_ops = len(m.net.Proto().op)
+        m.AddGradientOperators(["loss"])
+        workspace.RunNetOnce(m.param_init_net)
+
+        optim_proto, stats = memonger.recompute_activations(
+            m.net, num_forward_ops)
+        self.assertGreater(stats.recomputed_ops, 0)
+        types = [op.type for op in optim_proto.op]
+        self.assertEqual(types.count("RetrieveCount"), 1)
+        self.assertEqual(types.count("Dropout"), 1)
+
 
 if __name__ == '__main__':
     unittest.main()
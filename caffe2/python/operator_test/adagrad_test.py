@@ -10,7 +10,7 @@ from hypothesis import given, settings, HealthCheck
 import hypothesis.strategies as st
 import numpy as np
 
-from caffe2.python import core
+from caffe2.python import core, workspace
 import caffe2.python.hypothesis_test_util as hu
 from caffe2.python.operator_test.adagrad_test_helper import (
     ref_adagrad, adagrad_sparse_test_helper
@@ -25,6 +25,14 @@ class TestAdagrad(hu.HypothesisTestCase):
         param_out = param_in + grad_adj
         return (param_out, mom_out)
 
+    @staticmethod
+    def run_sharded(op_type, names, inputs, num_threads, **kwargs):
+        for name, value in zip(names, inputs):
+            workspace.FeedBlob(name, value)
+        workspace.RunOperatorOnce(core.CreateOperator(
+            op_type, names, names[:2], num_threads=num_threads, **kwargs))
+        return [workspace.FetchBlob(name) for name in names[:2]]
+
     @given(inputs=hu.tensors(n=3),
            lr=st.floats(min_value=0.01, max_value=0.99,
                         allow_nan=False, allow_infinity=False),
@@ -220,6 +228,93 @@ class TestAdagrad(hu.HypothesisTestCase):
             [param, momentum, indices, grad, lr],
             ref_row_wise_sparse)
 
+    # Block sizes below, inside and above the unrolled range of the AVX2
+    # kernels, and indices that repeat so that a row is updated more than once.
+    @given(num_rows=st.integers(min_value=1, max_value=32),
+           block_size=st.sampled_from([1, 5, 16, 32, 64, 128, 133]),
+           num_indices=st.integers(min_value=1, max_value=64),
+           num_threads=st.integers(min_value=2, max_value=8),
+           lr=st.floats(min_value=0.01, max_value=0.99,
+                        allow_nan=False, allow_infinity=False),
+           epsilon=st.floats(min_value=0.01, max_value=0.99,
+                             allow_nan=False, allow_infinity=False),
+           **hu.gcs_cpu_only)
+    def test_sparse_adagrad_multithreaded(self, num_rows, block_size,
+                                          num_indices, num_threads, lr,
+                                          epsilon, gc, dc):
+        param = np.random.randn(num_rows, block_size).astype(np.float32)
+        momentum = np.abs(
+            np.random.randn(num_rows, block_size).astype(np.float32))
+        indices = np.random.randint(num_rows, size=num_indices)
+        grad = np.random.randn(num_indices, block_size).astype(np.float32)
+        lr = np.array([lr], dtype=np.float32)
+        names = ["param", "momentum", "indices", "grad", "lr"]
+        inputs = [param, momentum, indices, grad, lr]
+
+        op = core.CreateOperator(
+            "SparseAdagrad", names, names[:2],
+            epsilon=epsilon, num_threads=num_threads, device_option=gc)
+
+        # Repeated rows see the result of their previous update.
+        def ref_sparse(param, momentum, indices, grad, lr):
+            param_out = np.copy(param)
+            momentum_out = np.copy(momentum)
+            for i, index in enumerate(indices):
+                param_out[index], momentum_out[index] = ref_adagrad(
+                    param_out[index], momentum_out[index], grad[i], lr,
+                    epsilon)
+            return (param_out, momentum_out)
+
+        self.assertReferenceChecks(gc, op, inputs, ref_sparse)
+        for sharded, single in zip(
+                self.run_sharded("SparseAdagrad", names, inputs, num_threads,
+                                 epsilon=epsilon),
+                self.run_sharded("SparseAdagrad", names, inputs, 1,
+                                 epsilon=epsilon)):
+            np.testing.assert_array_equal(sharded, single)
+
+    @given(num_rows=st.integers(min_value=1, max_value=32),
+           block_size=st.sampled_from([1, 5, 16, 32, 64, 128, 133]),
+           num_indices=st.integers(min_value=1, max_value=64),
+           num_threads=st.integers(min_value=2, max_value=8),
+           lr=st.floats(min_value=0.01, max_value=0.99,
+                        allow_nan=False, allow_infinity=False),
+           epsilon=st.floats(min_value=0.01, max_value=0.99,
+                             allow_nan=False, allow_infinity=False),
+           **hu.gcs_cpu_only)
+    def test_row_wise_sparse_adagrad_multithreaded(self, num_rows, block_size,
+                                                   num_indices, num_threads,
+                                                   lr, epsilon, gc, dc):
+        param = np.random.randn(num_rows, block_size).astype(np.float32)
+        momentum = np.abs(np.random.randn(num_rows).astype(np.float32))
+        indices = np.random.randint(num_rows, size=num_indices)
+        grad = np.random.randn(num_indices, block_size).astype(np.float32)
+        lr = np.array([lr], dtype=np.float32)
+        names = ["param", "momentum", "indices", "grad", "lr"]
+        inputs = [param, momentum, indices, grad, lr]
+
+        op = core.CreateOperator(
+            "RowWiseSparseAdagrad", names, names[:2],
+            epsilon=epsilon, num_threads=num_threads, device_option=gc)
+
+        def ref_row_wise_sparse(param, momentum, indices, grad, lr):
+            param_out = np.copy(param)
+            momentum_out = np.copy(momentum)
+            for i, index in enumerate(indices):
+                param_out[index], momentum_out[index] = \
+                    self.ref_row_wise_adagrad(
+                        param_out[index], momentum_out[index], grad[i], lr,
+                        epsilon)
+            return (param_out, momentum_out)
+
+        self.assertReferenceChecks(gc, op, inputs, ref_row_wise_sparse)
+        for sharded, single in zip(
+                self.run_sharded("RowWiseSparseAdagrad", names, inputs,
+                                 num_threads, epsilon=epsilon),
+                self.run_sharded("RowWiseSparseAdagrad", names, inputs, 1,
+                                 epsilon=epsilon)):
+            np.testing.assert_array_equal(sharded, single)
+
     @given(inputs=hu.tensors(n=1),
            lr=st.floats(min_value=0.01, max_value=0.99,
                         allow_nan=False, allow_infinity=False),
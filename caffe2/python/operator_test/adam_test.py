@@ -10,7 +10,7 @@ from hypothesis import given
 import hypothesis.strategies as st
 import numpy as np
 
-from caffe2.python import core
+from caffe2.python import core, workspace
 import caffe2.python.hypothesis_test_util as hu
 
 
@@ -44,6 +44,15 @@ class TestAdam(hu.HypothesisTestCase):
             (np.sqrt(mom2_out) + epsilon)
         return (param_out, mom1_out, mom2_out)
 
+    @staticmethod
+    def run_sharded(names, inputs, num_threads, **kwargs):
+        for name, value in zip(names, inputs):
+            workspace.FeedBlob(name, value)
+        workspace.RunOperatorOnce(core.CreateOperator(
+            "SparseAdam", names, names[:3], num_threads=num_threads,
+            **kwargs))
+        return [workspace.FetchBlob(name) for name in names[:3]]
+
     @given(inputs=hu.tensors(n=4),
            ITER=st.integers(min_value=0, max_value=10000),
            LR=st.floats(min_value=0.01, max_value=0.99,
@@ -176,6 +185,61 @@ class TestAdam(hu.HypothesisTestCase):
             ref_sparse,
             input_device_options=input_device_options)
 
+    # Block sizes below, inside and above the unrolled range of the AVX2
+    # kernels, and indices that repeat so that a row is updated more than once.
+    @given(num_rows=st.integers(min_value=1, max_value=32),
+           block_size=st.sampled_from([1, 5, 16, 32, 64, 128, 133]),
+           num_indices=st.integers(min_value=1, max_value=64),
+           num_threads=st.integers(min_value=2, max_value=8),
+           ITER=st.integers(min_value=0, max_value=10000),
+           LR=st.floats(min_value=0.01, max_value=0.99,
+                        allow_nan=False, allow_infinity=False),
+           beta1=st.floats(min_value=0.01, max_value=0.99,
+                           allow_nan=False, allow_infinity=False),
+           beta2=st.floats(min_value=0.01, max_value=0.99,
+                           allow_nan=False, allow_infinity=False),
+           epsilon=st.floats(min_value=0.01, max_value=0.99,
+                             allow_nan=False, allow_infinity=False),
+           **hu.gcs_cpu_only)
+    def test_sparse_adam_multithreaded(self, num_rows, block_size,
+                                       num_indices, num_threads, ITER, LR,
+                                       beta1, beta2, epsilon, gc, dc):
+        param = np.random.randn(num_rows, block_size).astype(np.float32)
+        mom1 = np.random.randn(num_rows, block_size).astype(np.float32)
+        mom2 = np.abs(
+            np.random.randn(num_rows, block_size).astype(np.float32))
+        indices = np.random.randint(num_rows, size=num_indices)
+        grad = np.random.randn(num_indices, block_size).astype(np.float32)
+        ITER = np.array([ITER], dtype=np.int64)
+        LR = np.array([LR], dtype=np.float32)
+        names = ["param", "mom1", "mom2", "indices", "grad", "lr", "iter"]
+        inputs = [param, mom1, mom2, indices, grad, LR, ITER]
+
+        op = core.CreateOperator(
+            "SparseAdam", names, names[:3],
+            beta1=beta1, beta2=beta2, epsilon=epsilon,
+            num_threads=num_threads)
+
+        # Repeated rows see the result of their previous update.
+        def ref_sparse(param, mom1, mom2, indices, grad, LR, ITER):
+            param_out = np.copy(param)
+            mom1_out = np.copy(mom1)
+            mom2_out = np.copy(mom2)
+            for i, index in enumerate(indices):
+                param_out[index], mom1_out[index], mom2_out[index] = \
+                    self.ref_adam(param_out[index], mom1_out[index],
+                                  mom2_out[index], grad[i], LR, ITER,
+                                  beta1, beta2, epsilon)
+            return (param_out, mom1_out, mom2_out)
+
+        self.assertReferenceChecks(gc, op, inputs, ref_sparse)
+        for sharded, single in zip(
+                self.run_sharded(names, inputs, num_threads,
+                                 beta1=beta1, beta2=beta2, epsilon=epsilon),
+                self.run_sharded(names, inputs, 1,
+                                 beta1=beta1, beta2=beta2, epsilon=epsilon)):
+            np.testing.assert_array_equal(sharded, single)
+
     @given(inputs=hu.tensors(n=3),
            ITER=st.integers(min_value=0, max_value=10000),
            LR=st.floats(min_value=0.01, max_value=0.99,
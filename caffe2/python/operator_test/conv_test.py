@@ -419,6 +419,57 @@ class TestConvolution(hu.HypothesisTestCase):
                 atol=1e-4,
                 rtol=1e-4)
 
+    @given(stride=st.integers(1, 2),
+           pad=st.integers(0, 1),
+           kernel=st.sampled_from([1, 3]),
+           order=st.sampled_from(["NCHW", "NHWC"]),
+           batch_size=st.integers(1, 2),
+           **hu.gcs_cpu_only)
+    def test_convolution_large_image(self, stride, pad, kernel, order,
+                                     batch_size, gc, dc):
+        # Large enough that 3x3 kernels fill the column buffer in bands and
+        # 1x1 kernels take the im2col-free path.
+        size, input_channels, output_channels = 40, 16, 8
+        X = np.random.rand(
+            batch_size, input_channels, size, size).astype(np.float32) - 0.5
+        w = np.random.rand(
+            output_channels, input_channels, kernel, kernel).astype(np.float32)\
+            - 0.5
+        b = np.random.rand(output_channels).astype(np.float32) - 0.5
+
+        X_pad = np.pad(X, ((0, 0), (0, 0), (pad, pad), (pad, pad)), 'constant')
+        out_size = (size + 2 * pad - kernel) // stride + 1
+        Y_ref = np.zeros(
+            (batch_size, output_channels, out_size, out_size), np.float32)
+        for i in range(kernel):
+            for j in range(kernel):
+                patch = X_pad[:, :, i:i + stride * out_size:stride,
+                              j:j + stride * out_size:stride]
+                Y_ref += np.einsum('nchw,mc->nmhw', patch, w[:, :, i, j])
+        Y_ref += b.reshape((1, -1, 1, 1))
+
+        if order == "NHWC":
+            X = X.transpose((0, 2, 3, 1))
+            w = w.transpose((0, 2, 3, 1))
+        op = core.CreateOperator(
+            "Conv",
+            ["X", "w", "b"],
+            ["Y"],
+            stride=stride,
+            kernel=kernel,
+            pad=pad,
+            order=order,
+            device_option=gc,
+        )
+        self.ws.create_blob("X").feed(X, device_option=gc)
+        self.ws.create_blob("w").feed(w, device_option=gc)
+        self.ws.create_blob("b").feed(b, device_option=gc)
+        self.ws.run(op)
+        Y = self.ws.blobs["Y"].fetch()
+        if order == "NHWC":
+            Y = Y.transpose((0, 3, 1, 2))
+        np.testing.assert_allclose(Y, Y_ref, atol=1e-4, rtol=1e-4)
+
     @given(num_workers=st.integers(1, 4),
            net_type=st.sampled_from(
                ["simple", "dag"] +
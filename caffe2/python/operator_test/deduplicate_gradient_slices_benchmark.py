@@ -0,0 +1,77 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import argparse
+import numpy as np
+import datetime
+
+from caffe2.python import core, workspace
+
+ENGINES = ['', 'SparseHash']
+
+
+def benchmark_deduplicate_gradient_slices(
+        engine,
+        categorical_limit,
+        embedding_dim,
+        num_indices,
+        zipf_a,
+        iterations):
+    # Embedding gradients are dominated by a few hot ids; draw the indices
+    # from a Zipf distribution folded into the table.
+    np.random.seed(1701)
+    indices = (np.random.zipf(zipf_a, num_indices) - 1) % categorical_limit
+    indices = indices.astype(np.int64)
+    grad = np.random.rand(num_indices, embedding_dim).astype(np.float32)
+    workspace.FeedBlob("indices", indices)
+    workspace.FeedBlob("grad", grad)
+    print('{} unique out of {} indices {}'.format(
+        len(np.unique(indices)), num_indices, datetime.datetime.now()))
+
+    net = core.Net("mynet")
+    unique, remapping = net.Unique(["indices"], 2, engine=engine)
+    net.UnsortedSegmentSum(["grad", remapping], "deduped_grad")
+    workspace.CreateNet(net)
+
+    # The first entry is the time of the whole net, followed by the time of
+    # every operator.
+    stats = workspace.BenchmarkNet(net.Name(), 1, iterations, True)
+    workspace.ResetWorkspace()
+    return stats[1], stats[2]
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="minimal benchmark for deduplicating sparse gradients.")
+    parser.add_argument(
+        '-e', "--embedding-size", type=int, default=6000000,
+        help="Lookup table size.")
+    parser.add_argument(
+        "--embedding-dim", type=int, default=64,
+        help="Embedding dimension.")
+    parser.add_argument(
+        '-n', "--num-indices", type=int, default=100000,
+        help="Number of gradient slices.")
+    parser.add_argument(
+        '-a', "--zipf-a", type=float, default=1.1,
+        help="Parameter of the Zipf distribution of the indices.")
+    parser.add_argument(
+        '-i', "--iteration", type=int, default=100,
+        help="The number of iterations.")
+    args, extra_args = parser.parse_known_args()
+    core.GlobalInit(['python'] + extra_args)
+    results = []
+    for engine in ENGINES:
+        results.append(benchmark_deduplicate_gradient_slices(
+            engine,
+            args.embedding_size,
+            args.embedding_dim,
+            args.num_indices,
+            args.zipf_a,
+            args.iteration))
+    print('{:>12} {:>14} {:>16}'.format('engine', 'Unique ms', 'SegmentSum ms'))
+    for engine, (unique_ms, segment_ms) in zip(ENGINES, results):
+        print('{:>12} {:>14.3f} {:>16.3f}'.format(
+            engine or 'default', unique_ms, segment_ms))
@@ -79,3 +79,20 @@ class TestExpandOp(hu.HypothesisTestCase):
     def test_expand_nonrand_shape2(self, X, gc, dc):
         self.run_expand_op_test_nonrand(
             "Expand", X, gc, dc, [4, 1, 2, 2])
+
+    @given(X_and_shape=st.sampled_from([
+        (np.ones([0, 4], dtype=np.float32), [1, 4]),
+        (np.ones([0, 1, 4], dtype=np.float32), [3, 1]),
+        (np.ones([1, 4], dtype=np.float32), [0, 4])]),
+           **hu.gcs)
+    def test_expand_empty(self, X_and_shape, gc, dc):
+        X, shape = X_and_shape
+        op = core.CreateOperator(
+            "Expand",
+            ["X", "shape"],
+            ["Y"],
+        )
+        def ref(X, shape):
+            return (X * np.ones(shape),)
+
+        self.assertReferenceChecks(gc, op, [X, np.array(shape)], ref)
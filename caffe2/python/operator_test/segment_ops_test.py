@@ -671,6 +671,79 @@ class TestSegmentOps(hu.HypothesisTestCase):
         self.assertReferenceChecks(
             gc, op, [D, W, indices, L], ref_sparse)
 
+    @given(**hu.gcs_cpu_only)
+    def test_sorted_segment_range_log_exp_all_neg_inf(self, gc, dc):
+        # Segment 0 is all -inf in its first column, segment 1 everywhere
+        X = np.array([[-np.inf, 1.0],
+                      [-np.inf, 2.0],
+                      [-np.inf, -np.inf],
+                      [-np.inf, -np.inf]], dtype=np.float32)
+        segments = np.array([0, 0, 1, 1], dtype=np.int32)
+        for op_type in ["SortedSegmentRangeLogSumExp",
+                        "SortedSegmentRangeLogMeanExp"]:
+            op = core.CreateOperator(op_type, ["X", "segments"], "out")
+            workspace.FeedBlob("X", X)
+            workspace.FeedBlob("segments", segments)
+            workspace.RunOperatorOnce(op)
+            out = workspace.FetchBlob("out")
+            self.assertFalse(np.isnan(out).any(), op_type)
+            np.testing.assert_array_equal(
+                out[:, 0], [-np.inf, -np.inf], err_msg=op_type)
+            np.testing.assert_array_equal(
+                out[1], [-np.inf, -np.inf], err_msg=op_type)
+
+    @given(num_threads=st.integers(2, 8), **hu.gcs_cpu_only)
+    def test_multi_threaded_segment_ops(self, num_threads, gc, dc):
+        # Skewed lengths, so that threads get different numbers of segments
+        lengths = np.array([0, 1, 40, 0, 3, 17, 1, 0, 2], dtype=np.int32)
+        N = lengths.sum()
+        X = np.random.rand(N, 3, 5).astype(np.float32)
+        W = np.random.rand(N).astype(np.float32)
+        range_ids = np.repeat(
+            np.arange(np.count_nonzero(lengths)),
+            lengths[lengths > 0]).astype(np.int32)
+        unsorted_ids = np.random.permutation(
+            np.repeat(np.arange(len(lengths)), lengths)).astype(np.int32)
+        cases = [
+            ("LengthsSum", [X, lengths]),
+            ("LengthsMean", [X, lengths]),
+            ("LengthsMax", [X, lengths]),
+            ("LengthsWeightedSum", [X, W, lengths]),
+            ("SortedSegmentRangeMean", [X, range_ids]),
+            ("SortedSegmentRangeLogSumExp", [X, range_ids]),
+            ("SortedSegmentRangeMax", [X, range_ids]),
+            ("UnsortedSegmentSum", [X, unsorted_ids]),
+            ("UnsortedSegmentMean", [X, unsorted_ids]),
+            ("UnsortedSegmentWeightedSum", [X, W, unsorted_ids]),
+        ]
+
+        def run(op_type, inputs, num_threads):
+            names = ["input_{}".format(i) for i in range(len(inputs))]
+            for name, value in zip(names, inputs):
+                workspace.FeedBlob(name, value, device_option=gc)
+            op = core.CreateOperator(
+                op_type, names, "out", num_threads=num_threads,
+                device_option=gc)
+            grad_ops, _ = core.GradientRegistry.GetGradientForOp(
+                op, ["out_grad"])
+            workspace.RunOperatorOnce(op)
+            out = workspace.FetchBlob("out")
+            out_grad = np.random.RandomState(0).rand(*out.shape)
+            workspace.FeedBlob(
+                "out_grad", out_grad.astype(np.float32), device_option=gc)
+            results = [out]
+            for grad_op in grad_ops:
+                workspace.RunOperatorOnce(grad_op)
+                results += [workspace.FetchBlob(b) for b in grad_op.output]
+            return results
+
+        for op_type, inputs in cases:
+            expected = run(op_type, inputs, 1)
+            actual = run(op_type, inputs, num_threads)
+            self.assertEqual(len(expected), len(actual))
+            for e, a in zip(expected, actual):
+                np.testing.assert_allclose(e, a, rtol=1e-5, err_msg=op_type)
+
    # @given(
    #     inputs=hu.lengths_tensor(
    #         dtype=np.float32,
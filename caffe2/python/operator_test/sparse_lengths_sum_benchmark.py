@@ -12,10 +12,17 @@ from caffe2.python import core, workspace
 DTYPES = {
     'uint8': np.uint8,
     'uint8_fused': np.uint8,
+    'uint4_fused': np.uint8,
+    'uint2_fused': np.uint8,
     'float': np.float32,
     'float16': np.float16,
 }
 
+FUSED_NBIT = {
+    'uint4_fused': 4,
+    'uint2_fused': 2,
+}
+
 
 def benchmark_sparse_lengths_sum(
         dtype_str,
@@ -26,10 +33,19 @@ def benchmark_sparse_lengths_sum(
         iterations):
     print('Preparing lookup table. ' + str(datetime.datetime.now()))
 
-    # We will use a constant, but non-trivial value so we save initialization
-    # time.
-    data = np.ones([categorical_limit, embedding_size], dtype=np.float32)
-    data *= 17.01
+    if dtype_str in FUSED_NBIT:
+        # Each byte packs 8 / bit_rate values; the scale and bias are float16.
+        bit_rate = FUSED_NBIT[dtype_str]
+        packed_size = -(-embedding_size * bit_rate // 8)
+        data = np.random.randint(
+            255, size=(categorical_limit, packed_size)).astype(np.uint8)
+        scale_bias = np.random.rand(categorical_limit, 2).astype(np.float16)
+        data = np.concatenate([data, scale_bias.view(np.uint8)], axis=1)
+    else:
+        # We will use a constant, but non-trivial value so we save
+        # initialization time.
+        data = np.ones([categorical_limit, embedding_size], dtype=np.float32)
+        data *= 17.01
 
     if dtype_str == 'uint8':
         scale_bias = np.random.rand(categorical_limit, 2).astype(np.float32)
@@ -39,7 +55,11 @@ def benchmark_sparse_lengths_sum(
         data = np.concatenate([data, scale_bias], axis=1)
 
     print('Data has shape {} {}'.format(data.shape, datetime.datetime.now()))
-    workspace.FeedBlob("X", data.astype(DTYPES[dtype_str]))
+    data = data.astype(DTYPES[dtype_str])
+    workspace.FeedBlob("X", data)
+    table_bytes = data.nbytes
+    if dtype_str == 'uint8':
+        table_bytes += scale_bias.nbytes
 
     # In order to produce truly random lengths and indices, we will embed a
     # Python operator in the net to generate them.
@@ -59,6 +79,9 @@ def benchmark_sparse_lengths_sum(
         net.SparseLengthsSum8BitsRowwise(["X", "indices", "lengths", "scale_bias"], "Y")
     elif dtype_str == "uint8_fused":
         net.SparseLengthsSumFused8BitRowwise(["X", "indices", "lengths"], "Y")
+    elif dtype_str in FUSED_NBIT:
+        getattr(net, "SparseLengthsSumFused{}BitRowwise".format(
+            FUSED_NBIT[dtype_str]))(["X", "indices", "lengths"], "Y")
     else:
         net.SparseLengthsSum(["X", "indices", "lengths"], "Y")
     workspace.CreateNet(net)
@@ -69,15 +92,21 @@ def benchmark_sparse_lengths_sum(
 
     print('Preparation finished. ' + str(datetime.datetime.now()))
 
-    workspace.BenchmarkNet(net.Name(), 1, iterations, True)
+    # The first entry is the time of the whole net, followed by the time of
+    # every operator; the lookup is the second operator.
+    stats = workspace.BenchmarkNet(net.Name(), 1, iterations, True)
+    workspace.ResetWorkspace()
+    return table_bytes, stats[2]
 
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
         description="minimal benchmark for sparse lengths sum.")
     parser.add_argument(
-        '-d', "--dtype", choices=list(DTYPES.keys()), default="float",
-        help="The data type for the input lookup table.")
+        '-d', "--dtype", choices=list(DTYPES.keys()), default=["float"],
+        nargs='+',
+        help="The data types for the input lookup table. With more than one, "
+        "prints a summary of memory versus throughput for all of them.")
     parser.add_argument(
         '-e', "--embedding-size", type=int, default=6000000,
         help="Lookup table size.")
@@ -95,10 +124,21 @@ if __name__ == "__main__":
         help="The number of iterations.")
     args, extra_args = parser.parse_known_args()
     core.GlobalInit(['python'] + extra_args)
-    benchmark_sparse_lengths_sum(
-        args.dtype,
-        args.embedding_size,
-        args.embedding_dim,
-        args.average_len,
-        args.batch_size,
-        args.iteration)
+    results = []
+    for dtype in args.dtype:
+        results.append(benchmark_sparse_lengths_sum(
+            dtype,
+            args.embedding_size,
+            args.embedding_dim,
+            args.average_len,
+            args.batch_size,
+            args.iteration))
+    print('{:>12} {:>14} {:>14} {:>16}'.format(
+        'dtype', 'bytes/row', 'table MB', 'M rows/s'))
+    for dtype, (table_bytes, op_ms) in zip(args.dtype, results):
+        rows_per_second = args.average_len * args.batch_size / (op_ms / 1e3)
+        print('{:>12} {:>14.1f} {:>14.1f} {:>16.2f}'.format(
+            dtype,
+            table_bytes / args.embedding_size,
+            table_bytes / 2**20,
+            rows_per_second / 1e6))
@@ -67,3 +67,39 @@ class TestUniqueOps(hu.HypothesisTestCase):
             inputs=[X],
             reference=partial(_unique_ref, return_inverse=return_remapping),
         )
+
+    @given(
+        X=hu.tensor1d(
+            # allow empty
+            min_len=0,
+            dtype=np.int64,
+            # allow negatives
+            elements=st.integers(min_value=-10, max_value=10)),
+        return_remapping=st.booleans(),
+        **hu.gcs_cpu_only
+    )
+    def test_unique_op_sparse_hash(self, X, return_remapping, gc, dc):
+        # the SparseHash engine returns indices in order of first occurrence
+        def ref(x):
+            _, first, inverse = np.unique(
+                x, return_index=True, return_inverse=True)
+            order = np.argsort(first)
+            rank = np.empty_like(order)
+            rank[order] = np.arange(len(order))
+            unique = x[np.sort(first)]
+            if return_remapping:
+                return [unique, rank[inverse].astype(np.int32)]
+            return [unique]
+
+        op = core.CreateOperator(
+            "Unique",
+            ['X'],
+            ["U", "remap"] if return_remapping else ["U"],
+            engine="SparseHash",
+        )
+        self.assertReferenceChecks(
+            device_option=gc,
+            op=op,
+            inputs=[X],
+            reference=ref,
+        )
@@ -12,13 +12,16 @@
 #include "caffe2/core/stats.h"
 #include "caffe2/core/transform.h"
 #include "caffe2/mkl/mkl_utils.h"
+#include "caffe2/observers/calibration_observer.h"
 #include "caffe2/observers/runcnt_observer.h"
 #include "caffe2/observers/time_observer.h"
 #include "caffe2/onnx/backend.h"
 #include "caffe2/onnx/helper.h"
 #include "caffe2/onnx/onnx_exporter.h"
+#include "caffe2/opt/constant_folding.h"
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/fusion.h"
+#include "caffe2/opt/int8_quantization.h"
 #include "caffe2/opt/mobile.h"
 #include "caffe2/opt/optimize_ideep.h"
 #include "caffe2/opt/passes.h"
@@ -267,6 +270,18 @@ void addObjectMethods(py::module& m) {
                 cast_ob, "Observer does not implement this function.");
             return cast_ob->average_time_children();
           })
+      .def(
+          "tensor_ranges",
+          [](ObserverBase<NetBase>* ob) {
+            auto* cast_ob = dynamic_cast_if_rtti<CalibrationNetObserver*>(ob);
+            CAFFE_ENFORCE(
+                cast_ob, "Observer does not implement this function.");
+            std::map<std::string, std::pair<float, float>> ranges;
+            for (const auto& kv : cast_ob->tensorRanges()) {
+              ranges[kv.first] = std::make_pair(kv.second.min, kv.second.max);
+            }
+            return ranges;
+          })
       .def("debug_info", [](ObserverBase<NetBase>* ob) {
         return ob->debugInfo();
       });
@@ -1032,6 +1047,12 @@ void addGlobalMethods(py::module& m) {
     CAFFE_ENFORCE(gWorkspace);
     return gWorkspace->HasBlob(name);
   });
+  m.def("is_tensor_blob", [](const std::string& name) {
+    CAFFE_ENFORCE(gWorkspace);
+    const auto* blob = gWorkspace->GetBlob(name);
+    return blob && GetTensorInfoFunction(blob->meta().id()) != nullptr;
+  });
+  m.def("impure_operators", []() { return opt::impureOperators(); });
   m.def(
       "create_net",
       [](py::bytes net_def, bool overwrite) {
@@ -1093,6 +1114,12 @@ void addGlobalMethods(py::module& m) {
           observer = net->AttachObserver(std::move(net_ob));
         }
 
+        if (observer_type.compare("CalibrationObserver") == 0) {
+          unique_ptr<CalibrationNetObserver> net_ob =
+              make_unique<CalibrationNetObserver>(net);
+          observer = net->AttachObserver(std::move(net_ob));
+        }
+
         CAFFE_ENFORCE(observer != nullptr);
         return py::cast(observer);
       });
@@ -1579,6 +1606,34 @@ void addGlobalMethods(py::module& m) {
     return py::bytes(out);
   });
 
+  m.def(
+      "transform_quantizeInt8",
+      [](py::bytes def,
+         const std::map<std::string, std::pair<float, float>>& ranges,
+         const std::vector<std::string>& external_outputs) {
+        CAFFE_ENFORCE(gWorkspace);
+        caffe2::NetDef proto;
+        CAFFE_ENFORCE(
+            ParseProtoFromLargeString(def.cast<std::string>(), &proto));
+
+        auto nn = caffe2::convertToNNModule(proto);
+        caffe2::NetDef init_proto;
+        opt::quantizeInt8(
+            &nn,
+            gWorkspace,
+            opt::TensorRanges(ranges.begin(), ranges.end()),
+            std::unordered_set<std::string>(
+                external_outputs.begin(), external_outputs.end()),
+            &init_proto);
+        auto new_proto = caffe2::convertToCaffe2Proto(nn, proto);
+
+        std::string out;
+        new_proto.SerializeToString(&out);
+        std::string init_out;
+        init_proto.SerializeToString(&init_out);
+        return std::make_pair(py::bytes(out), py::bytes(init_out));
+      });
+
   m.def("transform_sinkMaxPool", [](py::bytes def) {
     caffe2::NetDef proto;
     CAFFE_ENFORCE(ParseProtoFromLargeString(def.cast<std::string>(), &proto));
@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 from __future__ import unicode_literals
 
+from caffe2.proto import caffe2_pb2
 import caffe2.python._import_c_extension as C
 
 
@@ -62,3 +63,20 @@ def fuseConvBN(net):
     net.Proto().ParseFromString(
         C.transform_fuseConvBN(net.Proto().SerializeToString())
     )
+
+
+def quantizeInt8(net, ranges, external_outputs=None):
+    '''
+    Rewrites net in place to use Int8* operators, given the calibrated
+    {blob: (min, max)} ranges of its activations. Weights must be present in
+    the current workspace. Returns a NetDef whose ops recreate the quantized
+    weights.
+    '''
+    if external_outputs is None:
+        external_outputs = [str(b) for b in net.Proto().external_output]
+    quantized, init = C.transform_quantizeInt8(
+        net.Proto().SerializeToString(), ranges, external_outputs)
+    net.Proto().ParseFromString(quantized)
+    init_net = caffe2_pb2.NetDef()
+    init_net.ParseFromString(init)
+    return init_net
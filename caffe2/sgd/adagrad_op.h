@@ -1,6 +1,8 @@
 #pragma once
 
 #include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/sparse_optimizers.h"
+#include "caffe2/sgd/sharded_sparse_update.h"
 
 namespace caffe2 {
 
@@ -158,7 +160,8 @@ class SparseAdagradOp final : public Operator<Context> {
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   SparseAdagradOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
-        epsilon_(OperatorBase::GetSingleArgument<float>("epsilon", 1e-5f)) {}
+        epsilon_(OperatorBase::GetSingleArgument<float>("epsilon", 1e-5f)),
+        numThreads_(OperatorBase::GetSingleArgument<int>("num_threads", 1)) {}
 
   bool RunOnDevice() override {
     // Enforce shapes
@@ -177,8 +180,6 @@ class SparseAdagradOp final : public Operator<Context> {
     const auto* lr = Input(LR).template data<T>();
     const auto* indices = Input(INDICES).template data<SIndex>();
     const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* paramIn = Input(PARAM).template data<T>();
-    const auto* momentIn = Input(MOMENT_1).template data<T>();
     auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
     auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
 
@@ -188,54 +189,35 @@ class SparseAdagradOp final : public Operator<Context> {
     }
 
     auto block_size = Input(GRAD).size() / n;
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float hi = momentOut[idx] = momentIn[idx] + gi * gi;
-        paramOut[idx] = paramIn[idx] + lr[0] * gi / (std::sqrt(hi) + epsilon_);
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
-
-#ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).size(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).size(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-        adagrad_update(
-            block_size,
-            paramIn + offsetIdx,
-            gradIn + offsetI,
-            momentIn + offsetIdx,
-            paramOut + offsetIdx,
-            momentOut + offsetIdx,
-            epsilon_,
-            1.0f,
-            lr,
-            &context_);
-      }
-    }
+    const TIndex param_rows = Input(PARAM).dim(0);
+    const bool ok = ShardedSparseUpdate(
+        param_rows, numThreads_, [&](TIndex row_begin, TIndex row_end) {
+          return caffe2::SparseAdagrad<SIndex>(
+              block_size,
+              n,
+              param_rows,
+              row_begin,
+              row_end,
+              indices,
+              gradIn,
+              paramOut,
+              momentOut,
+              epsilon_,
+              lr[0]);
+        });
+    CAFFE_ENFORCE(
+        ok,
+        this->debug_def().input(INDICES),
+        " contains an index out of the ",
+        param_rows,
+        " rows of ",
+        this->debug_def().input(PARAM));
     return true;
   }
 
  protected:
   T epsilon_;
+  int numThreads_;
   INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR);
   OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
 };
@@ -246,7 +228,8 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   RowWiseSparseAdagradOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
-        epsilon_(OperatorBase::GetSingleArgument<float>("epsilon", 1e-5f)) {}
+        epsilon_(OperatorBase::GetSingleArgument<float>("epsilon", 1e-5f)),
+        numThreads_(OperatorBase::GetSingleArgument<int>("num_threads", 1)) {}
 
   bool RunOnDevice() override {
     // Enforce shapes
@@ -265,8 +248,6 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
     const auto* lr = Input(LR).template data<T>();
     const auto* indices = Input(INDICES).template data<SIndex>();
     const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* paramIn = Input(PARAM).template data<T>();
-    const auto* momentIn = Input(MOMENT_1).template data<T>();
     auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
     auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
 
@@ -276,60 +257,35 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
     }
 
     auto block_size = Input(GRAD).size() / n;
-
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float hi = momentOut[idx] = momentIn[idx] + gi * gi;
-        paramOut[idx] = paramIn[idx] + lr[0] * gi / (std::sqrt(hi) + epsilon_);
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
-
-#ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).size(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).size(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-
-        const float* w = paramIn + offsetIdx;
-        const float* g = gradIn + offsetI;
-        const float* h = momentIn + idx;
-        float* nw = paramOut + offsetIdx;
-        float* nh = momentOut + idx;
-        float hs = 0.;
-        for (auto j = 0; j < block_size; ++j) {
-          float gj = g[j];
-          hs += gj * gj;
-        }
-        float hi = nh[0] = h[0] + hs / block_size;
-        float step = lr[0] / (std::sqrt(hi) + epsilon_);
-        for (auto j = 0; j < block_size; ++j) {
-          nw[j] = w[j] + g[j] * step;
-        }
-      }
-    }
+    const TIndex param_rows = Input(PARAM).dim(0);
+    const bool ok = ShardedSparseUpdate(
+        param_rows, numThreads_, [&](TIndex row_begin, TIndex row_end) {
+          return caffe2::RowWiseSparseAdagrad<SIndex>(
+              block_size,
+              n,
+              param_rows,
+              row_begin,
+              row_end,
+              indices,
+              gradIn,
+              paramOut,
+              momentOut,
+              epsilon_,
+              lr[0]);
+        });
+    CAFFE_ENFORCE(
+        ok,
+        this->debug_def().input(INDICES),
+        " contains an index out of the ",
+        param_rows,
+        " rows of ",
+        this->debug_def().input(PARAM));
     return true;
   }
 
  protected:
   T epsilon_;
+  int numThreads_;
   INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR);
   OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
 };
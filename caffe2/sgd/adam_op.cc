@@ -64,7 +64,11 @@ OPERATOR_SCHEMA(SparseAdam)
     .Output(2, "output_moment_2", "Updated second moment")
     .Arg("beta1", "Default 0.9")
     .Arg("beta2", "Default 0.999")
-    .Arg("epsilon", "Default 1e-5");
+    .Arg("epsilon", "Default 1e-5")
+    .Arg(
+        "num_threads",
+        "Number of threads to split the update over by parameter row. "
+        "Default 1");
 
 REGISTER_CPU_OPERATOR(
     RowWiseSparseAdam,
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/sparse_optimizers.h"
+#include "caffe2/sgd/sharded_sparse_update.h"
 
 namespace caffe2 {
 
@@ -158,7 +160,8 @@ class SparseAdamOp final : public Operator<Context> {
       : Operator<Context>(operator_def, ws),
         beta1_(OperatorBase::GetSingleArgument<float>("beta1", 0.9f)),
         beta2_(OperatorBase::GetSingleArgument<float>("beta2", 0.999f)),
-        epsilon_(OperatorBase::GetSingleArgument<float>("epsilon", 1e-5f)) {}
+        epsilon_(OperatorBase::GetSingleArgument<float>("epsilon", 1e-5f)),
+        numThreads_(OperatorBase::GetSingleArgument<int>("num_threads", 1)) {}
 
   bool RunOnDevice() override {
     // Enforce shapes
@@ -186,69 +189,38 @@ class SparseAdamOp final : public Operator<Context> {
     auto block_size = Input(PARAM).size() / Input(PARAM).dim(0);
     auto n = Input(GRAD).size() / block_size;
 
-    const auto* paramIn = Input(PARAM).template data<T>();
     const auto* indices = Input(INDICES).template data<SIndex>();
     const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* moment1In = Input(MOMENT_1).template data<T>();
-    const auto* moment2In = Input(MOMENT_2).template data<T>();
     auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
     auto* moment1Out = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
     auto* moment2Out = Output(OUTPUT_MOMENT_2)->template mutable_data<T>();
 
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float mi = moment1Out[idx] =
-            moment1In[idx] * beta1_ + gi * (1 - beta1_);
-        float vi = moment2Out[idx] =
-            moment2In[idx] * beta2_ + gi * gi * (1 - beta2_);
-        paramOut[idx] =
-            paramIn[idx] + lr[0] * correction * mi / (std::sqrt(vi) + epsilon_);
-
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
-
-#ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).size(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).size(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-
-        adam_compute(
-            block_size,
-            paramIn + offsetIdx,
-            gradIn + offsetI,
-            moment1In + offsetIdx,
-            moment2In + offsetIdx,
-            paramOut + offsetIdx,
-            moment1Out + offsetIdx,
-            moment2Out + offsetIdx,
-            beta1_,
-            beta2_,
-            epsilon_,
-            correction,
-            lr,
-            &context_);
-      }
-    }
+    const TIndex param_rows = Input(PARAM).dim(0);
+    const bool ok = ShardedSparseUpdate(
+        param_rows, numThreads_, [&](TIndex row_begin, TIndex row_end) {
+          return caffe2::SparseAdam<SIndex>(
+              block_size,
+              n,
+              param_rows,
+              row_begin,
+              row_end,
+              indices,
+              gradIn,
+              paramOut,
+              moment1Out,
+              moment2Out,
+              beta1_,
+              beta2_,
+              epsilon_,
+              lr[0] * correction);
+        });
+    CAFFE_ENFORCE(
+        ok,
+        this->debug_def().input(INDICES),
+        " contains an index out of the ",
+        param_rows,
+        " rows of ",
+        this->debug_def().input(PARAM));
     return true;
   }
 
@@ -256,6 +228,7 @@ class SparseAdamOp final : public Operator<Context> {
   T beta1_;
   T beta2_;
   T epsilon_;
+  int numThreads_;
   INPUT_TAGS(PARAM, MOMENT_1, MOMENT_2, INDICES, GRAD, LR, ITER);
   OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1, OUTPUT_MOMENT_2);
 };
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+namespace caffe2 {
+
+// Runs update(row_begin, row_end) over num_shards disjoint, contiguous
+// ranges covering [0, param_rows), in parallel on GetIntraOpThreadPool() if
+// num_shards > 1. Each row belongs to exactly one shard, so updates to a row
+// repeated in the indices are still applied in order. Returns false if any
+// update did.
+template <typename F>
+bool ShardedSparseUpdate(TIndex param_rows, int num_shards, F update) {
+  if (num_shards <= 1 || param_rows < num_shards) {
+    return update(0, param_rows);
+  }
+  std::atomic<bool> ok{true};
+  GetIntraOpThreadPool()->run(
+      [&](int /* unused */, size_t shard) {
+        const TIndex begin = param_rows * shard / num_shards;
+        const TIndex end = param_rows * (shard + 1) / num_shards;
+        if (!update(begin, end)) {
+          ok = false;
+        }
+      },
+      num_shards);
+  return ok;
+}
+
+} // namespace caffe2
@@ -27,8 +27,10 @@
 #include <unordered_set>
 #include <vector>
 
+#include "c10/util/Transpose.h"
 #include "caffe2/core/context.h"
 #include "caffe2/utils/cpu_neon.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
 
 #include "Eigen/Core"
 #include "Eigen/Dense"
@@ -45,10 +47,50 @@
 #include <process.h>
 #endif
 
+CAFFE2_DEFINE_int(
+    caffe2_math_parallel_grain_size,
+    32768,
+    "Minimum number of elements that CPU math functions hand to each thread "
+    "of their context's thread pool. Smaller inputs run on one thread.");
+
 namespace caffe2 {
 
 namespace math {
 
+namespace {
+
+// Runs f(begin, end) over contiguous ranges covering [0, n). The ranges are
+// split over the context's thread pool if it has one, as long as each gets
+// at least --caffe2_math_parallel_grain_size elements, cost being the number
+// of elements an index stands for. f runs on pool threads and must not throw,
+// and isn't called at all if n is 0.
+template <typename F>
+void ParallelFor(const int n, const int cost, CPUContext* context, const F& f) {
+  if (n <= 0) {
+    return;
+  }
+  ThreadPool* pool = context == nullptr ? nullptr : context->thread_pool();
+  std::int64_t num_shards = 1;
+  if (pool != nullptr && n > 1) {
+    const std::int64_t work = static_cast<std::int64_t>(n) * cost;
+    num_shards = std::min<std::int64_t>(
+        {work / std::max(FLAGS_caffe2_math_parallel_grain_size, 1),
+         pool->getNumThreads(),
+         n});
+  }
+  if (num_shards <= 1) {
+    f(0, n);
+    return;
+  }
+  pool->run(
+      [&](int /* unused */, size_t shard) {
+        f(n * shard / num_shards, n * (shard + 1) / num_shards);
+      },
+      num_shards);
+}
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 // BLAS alternatives.
 // Depending on whether we have specified an external BLAS library or not, we
@@ -723,28 +765,57 @@ DEFINE_SIMPLE_BINARY_FUNCTION(Div, /)
 // Eigen or via custom code.
 ////////////////////////////////////////////////////////////////////////////////
 
-#define CAFFE2_SPECIALIZED_REDUCEMIN(T)    \
-  template <>                              \
-  void ReduceMin<T, CPUContext>(           \
-      const int N,                         \
-      const T* x,                          \
-      T* y,                                \
-      Tensor<CPUContext>* /*scratch_ptr*/, \
-      CPUContext* /*context*/) {           \
-    *y = *std::min_element(x, x + N);      \
+namespace {
+
+// The first element of x[0, N) that no other element compares less than,
+// found per block of --caffe2_math_parallel_grain_size elements in parallel.
+template <typename T, class Compare>
+T ParallelMinElement(
+    const int N,
+    const T* x,
+    const Compare& comp,
+    CPUContext* context) {
+  const int block_size = std::max(FLAGS_caffe2_math_parallel_grain_size, 1);
+  if (N <= block_size || context == nullptr ||
+      context->thread_pool() == nullptr) {
+    return *std::min_element(x, x + N, comp);
+  }
+  const int num_blocks = (N + block_size - 1) / block_size;
+  std::vector<T> block_min(num_blocks);
+  ParallelFor(num_blocks, block_size, context, [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      const T* block = x + i * block_size;
+      block_min[i] = *std::min_element(
+          block, x + std::min(N, (i + 1) * block_size), comp);
+    }
+  });
+  return *std::min_element(block_min.cbegin(), block_min.cend(), comp);
+}
+
+} // namespace
+
+#define CAFFE2_SPECIALIZED_REDUCEMIN(T)                     \
+  template <>                                               \
+  void ReduceMin<T, CPUContext>(                            \
+      const int N,                                          \
+      const T* x,                                           \
+      T* y,                                                 \
+      Tensor<CPUContext>* /*scratch_ptr*/,                  \
+      CPUContext* context) {                                \
+    *y = ParallelMinElement(N, x, std::less<T>(), context); \
   }
 CAFFE2_SPECIALIZED_REDUCEMIN(float)
 #undef CAFFE2_SPECIALIZED_REDUCEMIN
 
-#define CAFFE2_SPECIALIZED_REDUCEMAX(T)    \
-  template <>                              \
-  void ReduceMax<T, CPUContext>(           \
-      const int N,                         \
-      const T* x,                          \
-      T* y,                                \
-      Tensor<CPUContext>* /*scratch_ptr*/, \
-      CPUContext* /*context*/) {           \
-    *y = *std::max_element(x, x + N);      \
+#define CAFFE2_SPECIALIZED_REDUCEMAX(T)                        \
+  template <>                                                  \
+  void ReduceMax<T, CPUContext>(                               \
+      const int N,                                             \
+      const T* x,                                              \
+      T* y,                                                    \
+      Tensor<CPUContext>* /*scratch_ptr*/,                     \
+      CPUContext* context) {                                   \
+    *y = ParallelMinElement(N, x, std::greater<T>(), context); \
   }
 CAFFE2_SPECIALIZED_REDUCEMAX(float)
 CAFFE2_SPECIALIZED_REDUCEMAX(int32_t)
@@ -754,6 +825,65 @@ CAFFE2_SPECIALIZED_REDUCEMAX(int64_t)
 
 namespace {
 
+// ReduceTensor with the outputs split over the context's thread pool. Every
+// output reduces its elements of X in the same order as the serial loop, so
+// the results don't depend on the number of threads.
+template <typename T, class Reducer>
+void ReduceTensorByOutput(
+    const int num_dims,
+    const int* dims,
+    const int* Y_dims,
+    const Reducer& reducer,
+    const T& init,
+    const T* X,
+    T* Y,
+    CPUContext* context) {
+  std::vector<int> X_strides(num_dims);
+  std::vector<int> reduce_dims;
+  std::vector<int> reduce_strides;
+  int stride = 1;
+  for (int i = num_dims - 1; i >= 0; --i) {
+    X_strides[i] = stride;
+    stride *= dims[i];
+  }
+  for (int i = 0; i < num_dims; ++i) {
+    if (Y_dims[i] != dims[i]) {
+      reduce_dims.push_back(dims[i]);
+      reduce_strides.push_back(X_strides[i]);
+    }
+  }
+  const int num_reduce_dims = reduce_dims.size();
+  const int Y_size =
+      std::accumulate(Y_dims, Y_dims + num_dims, 1, std::multiplies<int>());
+  const int reduce_size = std::accumulate(
+      reduce_dims.cbegin(), reduce_dims.cend(), 1, std::multiplies<int>());
+  ParallelFor(Y_size, reduce_size, context, [&](int begin, int end) {
+    std::vector<int> Y_index(num_dims);
+    std::vector<int> reduce_index(num_reduce_dims);
+    utils::ComputeIndexInDims(num_dims, Y_dims, begin, Y_index.data());
+    for (int i = begin; i < end; ++i) {
+      const int X_offset = std::inner_product(
+          Y_index.cbegin(), Y_index.cend(), X_strides.cbegin(), 0);
+      std::fill(reduce_index.begin(), reduce_index.end(), 0);
+      T value = init;
+      for (int j = 0; j < reduce_size; ++j) {
+        value = reducer(
+            value,
+            X[X_offset +
+              std::inner_product(
+                  reduce_index.cbegin(),
+                  reduce_index.cend(),
+                  reduce_strides.cbegin(),
+                  0)]);
+        utils::IncreaseIndexInDims(
+            num_reduce_dims, reduce_dims.data(), reduce_index.data());
+      }
+      Y[i] = value;
+      utils::IncreaseIndexInDims(num_dims, Y_dims, Y_index.data());
+    }
+  });
+}
+
 template <typename T, class Reducer>
 void ReduceTensor(
     const int num_dims,
@@ -777,6 +907,11 @@ void ReduceTensor(
       std::accumulate(dims, dims + num_dims, 1, std::multiplies<int>());
   const int Y_size = std::accumulate(
       Y_dims.cbegin(), Y_dims.cend(), 1, std::multiplies<int>());
+  if (Y_size > 1 && context != nullptr && context->thread_pool() != nullptr) {
+    ReduceTensorByOutput(
+        num_dims, dims, Y_dims.data(), reducer, init, X, Y, context);
+    return;
+  }
   Set<T, CPUContext>(Y_size, init, Y, context);
   std::vector<int> index(num_dims, 0);
   for (int X_index = 0; X_index < X_size; ++X_index) {
@@ -907,7 +1042,8 @@ void BroadcastImpl(
     const int Y_ndim,
     const int* Y_dims,
     const T* X,
-    T* Y) {
+    T* Y,
+    CPUContext* context) {
   CAFFE_ENFORCE_LE(X_ndim, Y_ndim);
   std::vector<int> X_dims_ex(Y_ndim);
   const int d = Y_ndim - X_ndim;
@@ -918,28 +1054,34 @@ void BroadcastImpl(
   }
   const int Y_size =
       std::accumulate(Y_dims, Y_dims + Y_ndim, 1, std::multiplies<int>());
-  std::vector<int> index(Y_ndim, 0);
-  for (int Y_index = 0; Y_index < Y_size; ++Y_index) {
-    const int X_index =
-        utils::GetIndexFromDims(Y_ndim, X_dims_ex.data(), index.data());
-    Y[Y_index] = X[X_index];
-    utils::IncreaseIndexInDims(Y_ndim, Y_dims, index.data());
+  if (Y_size == 0) {
+    return;
   }
+  ParallelFor(Y_size, 1, context, [&](int begin, int end) {
+    std::vector<int> index(Y_ndim);
+    utils::ComputeIndexInDims(Y_ndim, Y_dims, begin, index.data());
+    for (int Y_index = begin; Y_index < end; ++Y_index) {
+      const int X_index =
+          utils::GetIndexFromDims(Y_ndim, X_dims_ex.data(), index.data());
+      Y[Y_index] = X[X_index];
+      utils::IncreaseIndexInDims(Y_ndim, Y_dims, index.data());
+    }
+  });
 }
 
 } // namespace
 
-#define CAFFE2_SPECIALIZED_BROADCAST(T)                     \
-  template <>                                               \
-  void Broadcast<T, CPUContext>(                            \
-      const int X_ndim,                                     \
-      const int* X_dims,                                    \
-      const int Y_ndim,                                     \
-      const int* Y_dims,                                    \
-      const T* X,                                           \
-      T* Y,                                                 \
-      CPUContext* /* context */) {                          \
-    BroadcastImpl<T>(X_ndim, X_dims, Y_ndim, Y_dims, X, Y); \
+#define CAFFE2_SPECIALIZED_BROADCAST(T)                              \
+  template <>                                                        \
+  void Broadcast<T, CPUContext>(                                     \
+      const int X_ndim,                                              \
+      const int* X_dims,                                             \
+      const int Y_ndim,                                              \
+      const int* Y_dims,                                             \
+      const T* X,                                                    \
+      T* Y,                                                          \
+      CPUContext* context) {                                         \
+    BroadcastImpl<T>(X_ndim, X_dims, Y_ndim, Y_dims, X, Y, context); \
   }
 CAFFE2_SPECIALIZED_BROADCAST(std::int32_t)
 CAFFE2_SPECIALIZED_BROADCAST(std::int64_t)
@@ -1302,11 +1444,14 @@ void ColwiseBinaryOp(
   }
 }
 
+// Splits the rows of C over the context's thread pool. The broadcast operand
+// has cols elements if rowwise, and rows elements otherwise.
 template <typename TIn, typename TOut, class Operator1, class Operator2>
 void BinaryOpWith2DBroadcasting(
     const int ndim,
     const int* dims,
     const int pivot,
+    const bool rowwise,
     const bool broadcast_1st,
     const Operator1& op1,
     const Operator2& op2,
@@ -1318,11 +1463,25 @@ void BinaryOpWith2DBroadcasting(
       std::accumulate(dims, dims + pivot, 1, std::multiplies<int>());
   const int cols =
       std::accumulate(dims + pivot, dims + ndim, 1, std::multiplies<int>());
-  if (broadcast_1st) {
-    op1(rows, cols, A, B, C, context);
-  } else {
-    op2(rows, cols, A, B, C, context);
-  }
+  ParallelFor(rows, cols, context, [&](int begin, int end) {
+    const int offset = begin * cols;
+    const int broadcast_offset = rowwise ? 0 : begin;
+    if (broadcast_1st) {
+      op1(end - begin,
+          cols,
+          A + broadcast_offset,
+          B + offset,
+          C + offset,
+          context);
+    } else {
+      op2(end - begin,
+          cols,
+          A + offset,
+          B + broadcast_offset,
+          C + offset,
+          context);
+    }
+  });
 }
 
 template <typename TIn, typename TOut, class BinaryOperator>
@@ -1334,16 +1493,23 @@ void BroadcastBinaryOpImpl(
     const BinaryOperator& op,
     const TIn* A,
     const TIn* B,
-    TOut* C) {
-  std::vector<int> index(ndim, 0);
+    TOut* C,
+    CPUContext* context) {
   const int C_size =
       std::accumulate(C_dims, C_dims + ndim, 1, std::multiplies<int>());
-  for (int C_index = 0; C_index < C_size; ++C_index) {
-    const int A_index = utils::GetIndexFromDims(ndim, A_dims, index.data());
-    const int B_index = utils::GetIndexFromDims(ndim, B_dims, index.data());
-    C[C_index] = op(A[A_index], B[B_index]);
-    utils::IncreaseIndexInDims(ndim, C_dims, index.data());
+  if (C_size == 0) {
+    return;
   }
+  ParallelFor(C_size, 1, context, [&](int begin, int end) {
+    std::vector<int> index(ndim);
+    utils::ComputeIndexInDims(ndim, C_dims, begin, index.data());
+    for (int C_index = begin; C_index < end; ++C_index) {
+      const int A_index = utils::GetIndexFromDims(ndim, A_dims, index.data());
+      const int B_index = utils::GetIndexFromDims(ndim, B_dims, index.data());
+      C[C_index] = op(A[A_index], B[B_index]);
+      utils::IncreaseIndexInDims(ndim, C_dims, index.data());
+    }
+  });
 }
 
 } // namespace
@@ -1492,87 +1658,93 @@ DEFINE_2D_BROADCAST_1ST_DIV_FUNCTION(std::int32_t)
 DEFINE_2D_BROADCAST_1ST_DIV_FUNCTION(std::int64_t)
 #undef DEFINE_2D_BROADCAST_1ST_DIV_FUNCTION
 
-#define DELEGATE_BROADCAST_BINARY_FUNCTION(TIn, TOut, Func, Op) \
-  template <>                                                   \
-  void Func<TIn, CPUContext>(                                   \
-      const int A_ndim,                                         \
-      const int* A_dims,                                        \
-      const int B_ndim,                                         \
-      const int* B_dims,                                        \
-      const TIn* A,                                             \
-      const TIn* B,                                             \
-      TOut* C,                                                  \
-      CPUContext* context) {                                    \
-    const int ndim = std::max(A_ndim, B_ndim);                  \
-    std::vector<int> A_dims_array(ndim);                        \
-    std::vector<int> B_dims_array(ndim);                        \
-    std::vector<int> C_dims_array(ndim);                        \
-    utils::ComputeBroadcastBinaryOpDims(                        \
-        A_ndim,                                                 \
-        A_dims,                                                 \
-        B_ndim,                                                 \
-        B_dims,                                                 \
-        A_dims_array.data(),                                    \
-        B_dims_array.data(),                                    \
-        C_dims_array.data());                                   \
-    if (A_dims_array == B_dims_array) {                         \
-      const int size = std::accumulate(                         \
-          C_dims_array.cbegin(),                                \
-          C_dims_array.cend(),                                  \
-          1,                                                    \
-          std::multiplies<int>());                              \
-      Func<TIn, CPUContext>(size, A, B, C, context);            \
-      return;                                                   \
-    }                                                           \
-    int pivot;                                                  \
-    bool broadcast_1st;                                         \
-    if (utils::IsRowwiseBroadcastBinaryOp(                      \
-            ndim,                                               \
-            A_dims_array.data(),                                \
-            B_dims_array.data(),                                \
-            &pivot,                                             \
-            &broadcast_1st)) {                                  \
-      BinaryOpWith2DBroadcasting(                               \
-          ndim,                                                 \
-          C_dims_array.data(),                                  \
-          pivot,                                                \
-          broadcast_1st,                                        \
-          Rowwise##Func<TIn, CPUContext, true>,                 \
-          Rowwise##Func<TIn, CPUContext, false>,                \
-          A,                                                    \
-          B,                                                    \
-          C,                                                    \
-          context);                                             \
-      return;                                                   \
-    }                                                           \
-    if (utils::IsColwiseBroadcastBinaryOp(                      \
-            ndim,                                               \
-            A_dims_array.data(),                                \
-            B_dims_array.data(),                                \
-            &pivot,                                             \
-            &broadcast_1st)) {                                  \
-      BinaryOpWith2DBroadcasting(                               \
-          ndim,                                                 \
-          C_dims_array.data(),                                  \
-          pivot,                                                \
-          broadcast_1st,                                        \
-          Colwise##Func<TIn, CPUContext, true>,                 \
-          Colwise##Func<TIn, CPUContext, false>,                \
-          A,                                                    \
-          B,                                                    \
-          C,                                                    \
-          context);                                             \
-      return;                                                   \
-    }                                                           \
-    BroadcastBinaryOpImpl(                                      \
-        ndim,                                                   \
-        A_dims_array.data(),                                    \
-        B_dims_array.data(),                                    \
-        C_dims_array.data(),                                    \
-        Op<TIn>(),                                              \
-        A,                                                      \
-        B,                                                      \
-        C);                                                     \
+#define DELEGATE_BROADCAST_BINARY_FUNCTION(TIn, TOut, Func, Op)     \
+  template <>                                                       \
+  void Func<TIn, CPUContext>(                                       \
+      const int A_ndim,                                             \
+      const int* A_dims,                                            \
+      const int B_ndim,                                             \
+      const int* B_dims,                                            \
+      const TIn* A,                                                 \
+      const TIn* B,                                                 \
+      TOut* C,                                                      \
+      CPUContext* context) {                                        \
+    const int ndim = std::max(A_ndim, B_ndim);                      \
+    std::vector<int> A_dims_array(ndim);                            \
+    std::vector<int> B_dims_array(ndim);                            \
+    std::vector<int> C_dims_array(ndim);                            \
+    utils::ComputeBroadcastBinaryOpDims(                            \
+        A_ndim,                                                     \
+        A_dims,                                                     \
+        B_ndim,                                                     \
+        B_dims,                                                     \
+        A_dims_array.data(),                                        \
+        B_dims_array.data(),                                        \
+        C_dims_array.data());                                       \
+    if (A_dims_array == B_dims_array) {                             \
+      const int size = std::accumulate(                             \
+          C_dims_array.cbegin(),                                    \
+          C_dims_array.cend(),                                      \
+          1,                                                        \
+          std::multiplies<int>());                                  \
+      ParallelFor(size, 1, context, [&](int begin, int end) {       \
+        Func<TIn, CPUContext>(                                      \
+            end - begin, A + begin, B + begin, C + begin, context); \
+      });                                                           \
+      return;                                                       \
+    }                                                               \
+    int pivot;                                                      \
+    bool broadcast_1st;                                             \
+    if (utils::IsRowwiseBroadcastBinaryOp(                          \
+            ndim,                                                   \
+            A_dims_array.data(),                                    \
+            B_dims_array.data(),                                    \
+            &pivot,                                                 \
+            &broadcast_1st)) {                                      \
+      BinaryOpWith2DBroadcasting(                                   \
+          ndim,                                                     \
+          C_dims_array.data(),                                      \
+          pivot,                                                    \
+          true,                                                     \
+          broadcast_1st,                                            \
+          Rowwise##Func<TIn, CPUContext, true>,                     \
+          Rowwise##Func<TIn, CPUContext, false>,                    \
+          A,                                                        \
+          B,                                                        \
+          C,                                                        \
+          context);                                                 \
+      return;                                                       \
+    }                                                               \
+    if (utils::IsColwiseBroadcastBinaryOp(                          \
+            ndim,                                                   \
+            A_dims_array.data(),                                    \
+            B_dims_array.data(),                                    \
+            &pivot,                                                 \
+            &broadcast_1st)) {                                      \
+      BinaryOpWith2DBroadcasting(                                   \
+          ndim,                                                     \
+          C_dims_array.data(),                                      \
+          pivot,                                                    \
+          false,                                                    \
+          broadcast_1st,                                            \
+          Colwise##Func<TIn, CPUContext, true>,                     \
+          Colwise##Func<TIn, CPUContext, false>,                    \
+          A,                                                        \
+          B,                                                        \
+          C,                                                        \
+          context);                                                 \
+      return;                                                       \
+    }                                                               \
+    BroadcastBinaryOpImpl(                                          \
+        ndim,                                                       \
+        A_dims_array.data(),                                        \
+        B_dims_array.data(),                                        \
+        C_dims_array.data(),                                        \
+        Op<TIn>(),                                                  \
+        A,                                                          \
+        B,                                                          \
+        C,                                                          \
+        context);                                                   \
   }
 
 #define DEFINE_BROADCAST_COMPARE_FUNCTION(Func, Op)                \
@@ -1864,7 +2036,7 @@ void Im2Col<float, CPUContext, StorageOrder::NCHW>(
     const int stride_w,
     const float* img_data,
     float* col_data,
-    CPUContext* /*context*/) {
+    CPUContext* context) {
   const int output_h =
       (height + pad_b + pad_t - (dilation_h * (kernel_h - 1) + 1)) / stride_h +
       1;
@@ -1876,32 +2048,40 @@ void Im2Col<float, CPUContext, StorageOrder::NCHW>(
   // From Torch, THNN_(unfolded_copy)
   if (dilation_h == 1 && dilation_w == 1 && pad_l == 0 && pad_r == 0 &&
       pad_t == 0 && pad_b == 0) {
-    for (auto k = 0; k < channels * kernel_h * kernel_w; k++) {
-      const auto nip = k / (kernel_h * kernel_w);
-      const auto rest = k % (kernel_h * kernel_w);
-      const auto kh = rest / kernel_w;
-      const auto kw = rest % kernel_w;
-      auto* dst = col_data + nip * (kernel_h * kernel_w * output_h * output_w) +
-          kh * (kernel_w * output_h * output_w) + kw * (output_h * output_w);
-      const auto* src = img_data + nip * (height * width);
-      for (auto y = 0; y < output_h; y++) {
-        const auto iy = y * stride_h + kh;
-        const auto ix = kw;
-        if (stride_w == 1) {
-          memcpy(
-              dst + (y * output_w),
-              src + (iy * width + ix),
-              sizeof(float) * output_w);
-        } else {
-          for (auto x = 0; x < output_w; x++) {
-            memcpy(
-                dst + (y * output_w + x),
-                src + (iy * width + ix + x * stride_w),
-                sizeof(float));
+    ParallelFor(
+        channels * kernel_h * kernel_w,
+        output_h * output_w,
+        context,
+        [&](int begin, int end) {
+          for (auto k = begin; k < end; k++) {
+            const auto nip = k / (kernel_h * kernel_w);
+            const auto rest = k % (kernel_h * kernel_w);
+            const auto kh = rest / kernel_w;
+            const auto kw = rest % kernel_w;
+            auto* dst = col_data +
+                nip * (kernel_h * kernel_w * output_h * output_w) +
+                kh * (kernel_w * output_h * output_w) +
+                kw * (output_h * output_w);
+            const auto* src = img_data + nip * (height * width);
+            for (auto y = 0; y < output_h; y++) {
+              const auto iy = y * stride_h + kh;
+              const auto ix = kw;
+              if (stride_w == 1) {
+                memcpy(
+                    dst + (y * output_w),
+                    src + (iy * width + ix),
+                    sizeof(float) * output_w);
+              } else {
+                for (auto x = 0; x < output_w; x++) {
+                  memcpy(
+                      dst + (y * output_w + x),
+                      src + (iy * width + ix + x * stride_w),
+                      sizeof(float));
+                }
+              }
+            }
           }
-        }
-      }
-    }
+        });
     return;
   }
 
@@ -1911,31 +2091,36 @@ void Im2Col<float, CPUContext, StorageOrder::NCHW>(
     const int pad_h = pad_t;
     const int pad_w = pad_l;
     const int channel_size = height * width;
-    for (int channel = channels; channel--; img_data += channel_size) {
-      for (int kernel_row = 0; kernel_row < kernel_h; kernel_row++) {
-        for (int kernel_col = 0; kernel_col < kernel_w; kernel_col++) {
-          int input_row = -pad_h + kernel_row * dilation_h;
-          for (int output_rows = output_h; output_rows; output_rows--) {
-            if (!is_a_ge_zero_and_a_lt_b(input_row, height)) {
-              for (int output_cols = output_w; output_cols; output_cols--) {
-                *(col_data++) = 0;
-              }
-            } else {
-              int input_col = -pad_w + kernel_col * dilation_w;
-              for (int output_col = output_w; output_col; output_col--) {
-                if (is_a_ge_zero_and_a_lt_b(input_col, width)) {
-                  *(col_data++) = img_data[input_row * width + input_col];
-                } else {
-                  *(col_data++) = 0;
+    const int col_channel_size = kernel_h * kernel_w * output_h * output_w;
+    ParallelFor(channels, col_channel_size, context, [&](int begin, int end) {
+      const float* img = img_data + begin * channel_size;
+      float* col = col_data + begin * col_channel_size;
+      for (int channel = begin; channel < end; ++channel, img += channel_size) {
+        for (int kernel_row = 0; kernel_row < kernel_h; kernel_row++) {
+          for (int kernel_col = 0; kernel_col < kernel_w; kernel_col++) {
+            int input_row = -pad_h + kernel_row * dilation_h;
+            for (int output_rows = output_h; output_rows; output_rows--) {
+              if (!is_a_ge_zero_and_a_lt_b(input_row, height)) {
+                for (int output_cols = output_w; output_cols; output_cols--) {
+                  *(col++) = 0;
+                }
+              } else {
+                int input_col = -pad_w + kernel_col * dilation_w;
+                for (int output_col = output_w; output_col; output_col--) {
+                  if (is_a_ge_zero_and_a_lt_b(input_col, width)) {
+                    *(col++) = img[input_row * width + input_col];
+                  } else {
+                    *(col++) = 0;
+                  }
+                  input_col += stride_w;
                 }
-                input_col += stride_w;
               }
+              input_row += stride_h;
             }
-            input_row += stride_h;
           }
         }
       }
-    }
+    });
     return;
   }
 
@@ -1947,23 +2132,27 @@ void Im2Col<float, CPUContext, StorageOrder::NCHW>(
   int width_col = (width + pad_l + pad_r - dkernel_w) / stride_w + 1;
 
   int channels_col = channels * kernel_h * kernel_w;
-  for (int c = 0; c < channels_col; ++c) {
-    int w_offset = c % kernel_w;
-    int h_offset = (c / kernel_w) % kernel_h;
-    int c_im = c / kernel_h / kernel_w;
-    for (int h = 0; h < height_col; ++h) {
-      for (int w = 0; w < width_col; ++w) {
-        int h_pad = h * stride_h - pad_t + h_offset * dilation_h;
-        int w_pad = w * stride_w - pad_l + w_offset * dilation_w;
-        if (h_pad >= 0 && h_pad < height && w_pad >= 0 && w_pad < width) {
-          col_data[(c * height_col + h) * width_col + w] =
-              img_data[(c_im * height + h_pad) * width + w_pad];
-        } else {
-          col_data[(c * height_col + h) * width_col + w] = 0;
+  ParallelFor(
+      channels_col, height_col * width_col, context, [&](int begin, int end) {
+        for (int c = begin; c < end; ++c) {
+          int w_offset = c % kernel_w;
+          int h_offset = (c / kernel_w) % kernel_h;
+          int c_im = c / kernel_h / kernel_w;
+          for (int h = 0; h < height_col; ++h) {
+            for (int w = 0; w < width_col; ++w) {
+              int h_pad = h * stride_h - pad_t + h_offset * dilation_h;
+              int w_pad = w * stride_w - pad_l + w_offset * dilation_w;
+              if (h_pad >= 0 && h_pad < height && w_pad >= 0 &&
+                  w_pad < width) {
+                col_data[(c * height_col + h) * width_col + w] =
+                    img_data[(c_im * height + h_pad) * width + w_pad];
+              } else {
+                col_data[(c * height_col + h) * width_col + w] = 0;
+              }
+            }
+          }
         }
-      }
-    }
-  }
+      });
 }
 
 template <>
@@ -1983,35 +2172,39 @@ void Im2Col<float, CPUContext, StorageOrder::NHWC>(
     const int stride_w,
     const float* img_data,
     float* col_data,
-    CPUContext* /*context*/) {
+    CPUContext* context) {
   const int dkernel_h = dilation_h * (kernel_h - 1) + 1;
   const int dkernel_w = dilation_w * (kernel_w - 1) + 1;
 
   int height_col = (height + pad_t + pad_b - dkernel_h) / stride_h + 1;
   int width_col = (width + pad_l + pad_r - dkernel_w) / stride_w + 1;
 
-  int h_pad = -pad_t;
-  for (int h = 0; h < height_col; ++h) {
-    int w_pad = -pad_l;
-    for (int w = 0; w < width_col; ++w) {
-      for (int ih = h_pad; ih < h_pad + dkernel_h; ih += dilation_h) {
-        for (int iw = w_pad; iw < w_pad + dkernel_w; iw += dilation_w) {
-          if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-            memcpy(
-                col_data,
-                img_data + (ih * width + iw) * channels,
-                sizeof(float) * channels);
-          } else {
-            // This should be simply padded with zero.
-            memset(col_data, 0, sizeof(float) * channels);
+  const int col_row_size = width_col * kernel_h * kernel_w * channels;
+  ParallelFor(height_col, col_row_size, context, [&](int begin, int end) {
+    float* col = col_data + begin * col_row_size;
+    int h_pad = -pad_t + begin * stride_h;
+    for (int h = begin; h < end; ++h) {
+      int w_pad = -pad_l;
+      for (int w = 0; w < width_col; ++w) {
+        for (int ih = h_pad; ih < h_pad + dkernel_h; ih += dilation_h) {
+          for (int iw = w_pad; iw < w_pad + dkernel_w; iw += dilation_w) {
+            if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+              memcpy(
+                  col,
+                  img_data + (ih * width + iw) * channels,
+                  sizeof(float) * channels);
+            } else {
+              // This should be simply padded with zero.
+              memset(col, 0, sizeof(float) * channels);
+            }
+            col += channels;
           }
-          col_data += channels;
         }
+        w_pad += stride_w;
       }
-      w_pad += stride_w;
+      h_pad += stride_h;
     }
-    h_pad += stride_h;
-  }
+  });
 }
 
 template <>
@@ -2348,20 +2541,20 @@ bool TryTransposeWithHPTT(
 
 #endif // CAFFE2_USE_HPTT
 
-std::vector<int>
-ComputeXStrides(const int ndim, const int* dims, const int* axes) {
-  std::vector<int> x_strides(ndim);
-  std::vector<int> buff(ndim);
-  int cur_stride = 1;
-  for (int i = ndim - 1; i >= 0; --i) {
-    buff[i] = cur_stride;
-    cur_stride *= dims[i];
-  }
-  for (int i = 0; i < ndim; ++i) {
-    x_strides[i] = buff[axes[i]];
+// Adapts ParallelFor to the parallel_for hook of c10::PermuteCopy.
+struct ContextParallelFor {
+  template <typename F>
+  void operator()(const std::int64_t n, const std::int64_t cost, const F& f)
+      const {
+    ParallelFor(
+        n,
+        std::min<std::int64_t>(cost, std::numeric_limits<int>::max()),
+        context,
+        [&](int begin, int end) { f(begin, end); });
   }
-  return x_strides;
-}
+
+  CPUContext* context;
+};
 
 template <typename T>
 void TransposeCPUImpl(
@@ -2369,40 +2562,11 @@ void TransposeCPUImpl(
     const int* dims,
     const int* axes,
     const T* X,
-    T* Y) {
-  std::vector<int> Y_dims(ndim);
-  for (int i = 0; i < ndim; ++i) {
-    Y_dims[i] = dims[axes[i]];
-  }
-  // Measure amount of contiguous data we can copy at once
-  int block_size = 1;
-  int num_shared_idx = 0;
-  for (int i = ndim - 1; i >= 0 && axes[i] == i; --i) {
-    block_size *= Y_dims[i];
-    ++num_shared_idx;
-  }
-  const int itr_axes = ndim - num_shared_idx;
-  const int num_blocks = std::accumulate(
-      Y_dims.cbegin(), Y_dims.cbegin() + itr_axes, 1, std::multiplies<int>());
-  if (ndim < 2 || itr_axes == 0) {
-    std::memcpy(Y, X, num_blocks * block_size * sizeof(T));
-    return;
-  }
-  const std::vector<int> X_strides = ComputeXStrides(itr_axes, dims, axes);
-  std::vector<int> index(itr_axes, 0);
-  for (int Y_index = 0; Y_index < num_blocks; ++Y_index) {
-    const int X_index = std::inner_product(
-        X_strides.cbegin(), X_strides.cend(), index.cbegin(), 0);
-    if (block_size == 1) {
-      Y[Y_index] = X[X_index];
-    } else {
-      std::memcpy(
-          Y + block_size * Y_index,
-          X + block_size * X_index,
-          block_size * sizeof(T));
-    }
-    utils::IncreaseIndexInDims(itr_axes, Y_dims.data(), index.data());
-  }
+    T* Y,
+    CPUContext* context) {
+  const std::vector<std::int64_t> X_dims(dims, dims + ndim);
+  c10::PermuteCopy(
+      ndim, X_dims.data(), axes, X, Y, ContextParallelFor{context});
 }
 
 } // namespace
@@ -2414,25 +2578,25 @@ void Transpose<float, CPUContext>(
     const int* axes,
     const float* X,
     float* Y,
-    CPUContext* /* context */) {
+    CPUContext* context) {
 #ifdef CAFFE2_USE_HPTT
   if (TryTransposeWithHPTT(ndim, dims, axes, X, Y)) {
     return;
   }
 #endif // CAFFE2_USE_HPTT
-  TransposeCPUImpl(ndim, dims, axes, X, Y);
+  TransposeCPUImpl(ndim, dims, axes, X, Y, context);
 }
 
-#define CAFFE2_SPECIALIZED_TRANSPOSE(T)       \
-  template <>                                 \
-  void Transpose<T, CPUContext>(              \
-      const int ndim,                         \
-      const int* dims,                        \
-      const int* axes,                        \
-      const T* X,                             \
-      T* Y,                                   \
-      CPUContext* /* context */) {            \
-    TransposeCPUImpl(ndim, dims, axes, X, Y); \
+#define CAFFE2_SPECIALIZED_TRANSPOSE(T)                \
+  template <>                                          \
+  void Transpose<T, CPUContext>(                       \
+      const int ndim,                                  \
+      const int* dims,                                 \
+      const int* axes,                                 \
+      const T* X,                                      \
+      T* Y,                                            \
+      CPUContext* context) {                           \
+    TransposeCPUImpl(ndim, dims, axes, X, Y, context); \
   }
 CAFFE2_SPECIALIZED_TRANSPOSE(double)
 CAFFE2_SPECIALIZED_TRANSPOSE(int)
@@ -1,4 +1,7 @@
+#include <array>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -9,6 +12,9 @@
 #include "caffe2/proto/caffe2.pb.h"
 #include "caffe2/utils/conversions.h"
 #include "caffe2/utils/math.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+CAFFE2_DECLARE_int(caffe2_math_parallel_grain_size);
 
 namespace caffe2 {
 
@@ -687,6 +693,9 @@ TEST_F(BroadcastTest, BroadcastFloatTest) {
       {2, 2, 2},
       {1.0f, 2.0f},
       {1.0f, 1.0f, 2.0f, 2.0f, 1.0f, 1.0f, 2.0f, 2.0f});
+  // Empty outputs
+  RunBroadcastTest({2}, {0, 2}, {1.0f, 2.0f}, {});
+  RunBroadcastTest({0, 1}, {0, 3}, {}, {});
 }
 
 class MomentsTest : public testing::Test {
@@ -849,6 +858,234 @@ TEST_F(TransposeTest, TransposeFloatTest) {
       {1.0f, 2.0f, 5.0f, 6.0f, 3.0f, 4.0f, 7.0f, 8.0f});
 }
 
+TEST_F(TransposeTest, TransposeOrderSwitchTest) {
+  // Large enough for several tiles of the blocked transpose, with partial
+  // tiles and a channel count that isn't a multiple of the SIMD width.
+  const int N = 2, C = 37, H = 9, W = 11;
+  std::vector<float> X(N * C * H * W);
+  std::iota(X.begin(), X.end(), 0.0f);
+  std::vector<float> Y(X.size());
+  for (int n = 0; n < N; ++n) {
+    for (int c = 0; c < C; ++c) {
+      for (int hw = 0; hw < H * W; ++hw) {
+        Y[(n * H * W + hw) * C + c] = X[(n * C + c) * H * W + hw];
+      }
+    }
+  }
+  RunTransposeTest({N, C, H, W}, {0, 2, 3, 1}, X, Y);
+  RunTransposeTest({N, H, W, C}, {0, 3, 1, 2}, Y, X);
+}
+
+// Runs the math functions that can split their work over a thread pool with
+// and without one, in pieces of a few elements, and expects the same results.
+class ThreadPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    grain_size_ = FLAGS_caffe2_math_parallel_grain_size;
+    FLAGS_caffe2_math_parallel_grain_size = 3;
+    pool_ = ThreadPool::defaultThreadPool();
+    pool_->setMinWorkSize(1);
+    parallel_context_.set_thread_pool(pool_.get());
+  }
+
+  void TearDown() override {
+    FLAGS_caffe2_math_parallel_grain_size = grain_size_;
+  }
+
+  static std::vector<float> Iota(const int size) {
+    std::vector<float> data(size);
+    for (int i = 0; i < size; ++i) {
+      data[i] = static_cast<float>((i * 7) % 13) - 6.0f;
+    }
+    return data;
+  }
+
+  template <class Func>
+  void ExpectSameResults(const int size, const Func& func) {
+    std::vector<float> expected(size);
+    std::vector<float> actual(size);
+    func(expected.data(), &serial_context_);
+    func(actual.data(), &parallel_context_);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_FLOAT_EQ(expected[i], actual[i]);
+    }
+  }
+
+  int grain_size_;
+  std::unique_ptr<ThreadPool> pool_;
+  CPUContext serial_context_;
+  CPUContext parallel_context_;
+};
+
+TEST_F(ThreadPoolTest, Im2ColTest) {
+  const int C = 3, H = 7, W = 6;
+  const std::vector<float> img = Iota(C * H * W);
+  // {kernel, dilation, pad, stride} covering every NCHW code path.
+  const std::vector<std::array<int, 4>> params = {
+      {3, 1, 0, 1}, {3, 1, 1, 2}, {2, 2, 1, 1}, {1, 1, 0, 2}};
+  for (const auto& p : params) {
+    const int k = p[0], d = p[1], pad = p[2], s = p[3];
+    const int out_h = (H + 2 * pad - (d * (k - 1) + 1)) / s + 1;
+    const int out_w = (W + 2 * pad - (d * (k - 1) + 1)) / s + 1;
+    const int col_size = C * k * k * out_h * out_w;
+    ExpectSameResults(col_size, [&](float* col, CPUContext* context) {
+      math::Im2Col<float, CPUContext, StorageOrder::NCHW>(
+          C,
+          H,
+          W,
+          k,
+          k,
+          d,
+          d,
+          pad,
+          pad,
+          pad,
+          pad,
+          s,
+          s,
+          img.data(),
+          col,
+          context);
+    });
+    ExpectSameResults(col_size, [&](float* col, CPUContext* context) {
+      math::Im2Col<float, CPUContext, StorageOrder::NHWC>(
+          C,
+          H,
+          W,
+          k,
+          k,
+          d,
+          d,
+          pad,
+          pad,
+          pad,
+          pad,
+          s,
+          s,
+          img.data(),
+          col,
+          context);
+    });
+  }
+}
+
+TEST_F(ThreadPoolTest, TransposeTest) {
+  const std::vector<int> dims = {4, 3, 5, 2};
+  const std::vector<float> X = Iota(120);
+  for (const auto& axes : std::vector<std::vector<int>>{
+           {3, 2, 1, 0}, {0, 2, 1, 3}, {1, 0, 2, 3}, {0, 2, 3, 1}}) {
+    ExpectSameResults(X.size(), [&](float* Y, CPUContext* context) {
+      math::Transpose<float, CPUContext>(
+          dims.size(), dims.data(), axes.data(), X.data(), Y, context);
+    });
+  }
+}
+
+TEST_F(ThreadPoolTest, ReduceTest) {
+  const std::vector<int> dims = {4, 3, 5};
+  const std::vector<float> X = Iota(60);
+  ExpectSameResults(1, [&](float* Y, CPUContext* context) {
+    math::ReduceMax<float, CPUContext>(X.size(), X.data(), Y, nullptr, context);
+  });
+  ExpectSameResults(1, [&](float* Y, CPUContext* context) {
+    math::ReduceMin<float, CPUContext>(X.size(), X.data(), Y, nullptr, context);
+  });
+  for (const auto& axes :
+       std::vector<std::vector<int>>{{0}, {1}, {2}, {2, 0}}) {
+    int Y_size = X.size();
+    for (const int axis : axes) {
+      Y_size /= dims[axis];
+    }
+    ExpectSameResults(Y_size, [&](float* Y, CPUContext* context) {
+      math::ReduceMax<float, CPUContext>(
+          dims.size(),
+          dims.data(),
+          axes.size(),
+          axes.data(),
+          X.data(),
+          Y,
+          context);
+    });
+    ExpectSameResults(Y_size, [&](float* Y, CPUContext* context) {
+      math::ReduceSum<float, CPUContext>(
+          dims.size(),
+          dims.data(),
+          axes.size(),
+          axes.data(),
+          X.data(),
+          Y,
+          context);
+    });
+  }
+}
+
+TEST_F(ThreadPoolTest, BroadcastTest) {
+  const std::vector<int> Y_dims = {4, 3, 5};
+  const std::vector<float> A = Iota(60);
+  for (const auto& B_dims : std::vector<std::vector<int>>{
+           {4, 3, 5}, {5}, {4, 3, 1}, {4, 1, 5}}) {
+    const std::vector<float> B = Iota(std::accumulate(
+        B_dims.cbegin(), B_dims.cend(), 1, std::multiplies<int>()));
+    ExpectSameResults(A.size(), [&](float* Y, CPUContext* context) {
+      math::Broadcast<float, CPUContext>(
+          B_dims.size(),
+          B_dims.data(),
+          Y_dims.size(),
+          Y_dims.data(),
+          B.data(),
+          Y,
+          context);
+    });
+    ExpectSameResults(A.size(), [&](float* C, CPUContext* context) {
+      math::Add<float, CPUContext>(
+          Y_dims.size(),
+          Y_dims.data(),
+          B_dims.size(),
+          B_dims.data(),
+          A.data(),
+          B.data(),
+          C,
+          context);
+    });
+    ExpectSameResults(A.size(), [&](float* C, CPUContext* context) {
+      math::Sub<float, CPUContext>(
+          B_dims.size(),
+          B_dims.data(),
+          Y_dims.size(),
+          Y_dims.data(),
+          B.data(),
+          A.data(),
+          C,
+          context);
+    });
+  }
+}
+
+TEST_F(ThreadPoolTest, EmptyBroadcastTest) {
+  const std::vector<int> A_dims = {0, 5};
+  const std::vector<int> B_dims = {5};
+  const std::vector<float> B = Iota(5);
+  for (CPUContext* context : {&serial_context_, &parallel_context_}) {
+    math::Broadcast<float, CPUContext>(
+        B_dims.size(),
+        B_dims.data(),
+        A_dims.size(),
+        A_dims.data(),
+        B.data(),
+        nullptr,
+        context);
+    math::Mul<float, CPUContext>(
+        A_dims.size(),
+        A_dims.data(),
+        B_dims.size(),
+        B_dims.data(),
+        nullptr,
+        B.data(),
+        nullptr,
+        context);
+  }
+}
+
 } // namespace
 
 } // namespace caffe2
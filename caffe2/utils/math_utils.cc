@@ -30,6 +30,18 @@ int GetIndexFromDims(const int n, const int* dims, const int* index) {
   return sum;
 }
 
+void ComputeIndexInDims(const int n, const int* dims, int offset, int* index) {
+  for (int i = n - 1; i >= 0; --i) {
+    // Dims of size 0 have no positions, and only index 0 is meaningful.
+    if (dims[i] == 0) {
+      index[i] = 0;
+      continue;
+    }
+    index[i] = offset % dims[i];
+    offset /= dims[i];
+  }
+}
+
 bool IsIdentityPermutation(const int n, const int* perm) {
   for (int i = 0; i < n; ++i) {
     if (perm[i] != i) {
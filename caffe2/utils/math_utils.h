@@ -46,6 +46,10 @@ void IncreaseIndexInDims(const int n, const int* dims, int* index);
 // Get index value from dims and index digits.
 int GetIndexFromDims(const int n, const int* dims, const int* index);
 
+// Set the index digits of the offset-th position in dims, the inverse of
+// GetIndexFromDims.
+void ComputeIndexInDims(const int n, const int* dims, int offset, int* index);
+
 // Checks if the input permutation is an identity permutation;
 bool IsIdentityPermutation(const int n, const int* perm);
 
@@ -11,6 +11,7 @@
 #include <string>
 
 using namespace at;
+using Catch::StartsWith;
 
 // A macro so we don't lose location information when an assertion fails.
 #define REQUIRE_OPTIONS(device_, index_, type_, layout_)                    \
@@ -87,6 +88,18 @@ TEST_CASE("TensorOptions/ConstructsWellFromVariables") {
   REQUIRE(!options.requires_grad());
 }
 
+TEST_CASE("TensorOptions/HasNoTypeForSparseCsr") {
+  auto options = TensorOptions().layout(kSparseCsr);
+  REQUIRE_OPTIONS(kCPU, -1, kFloat, kSparseCsr);
+  REQUIRE_THROWS_WITH(
+      options.type(), StartsWith("there is no Type for sparse CSR tensors"));
+
+  options = TensorOptions(empty(5));
+  REQUIRE_THROWS_WITH(
+      options.layout(kSparseCsr),
+      StartsWith("there is no Type for sparse CSR tensors"));
+}
+
 TEST_CASE("Device/ParsesCorrectlyFromString") {
   Device device("cpu:0");
   REQUIRE(device == Device(kCPU, 0));
@@ -266,6 +266,34 @@ class ProcessGroupGlooTest(TestCase):
         work.wait()
         self.assertEqual(torch.Tensor([float(self.size * (self.size + 1) / 2)]), x)
 
+    def test_allreduce_coalesced_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.size, self.opts())
+
+        xs = [
+            torch.Tensor([self.rank + 1.0]),
+            torch.Tensor([[self.rank + 1.0] * 3] * 2),
+        ]
+        work = pg.allreduce_coalesced(xs)
+        work.wait()
+        expected = float(self.size * (self.size + 1) / 2)
+        self.assertEqual(torch.Tensor([expected]), xs[0])
+        self.assertEqual(torch.Tensor([[expected] * 3] * 2), xs[1])
+
+    def test_allreduce_registered_ops(self):
+        store = c10d.FileStore(self.file.name)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.size, self.opts())
+
+        x = torch.Tensor([self.rank + 1.0])
+        pg.register_tensors([x])
+
+        # Run twice to reuse the algorithm on the registered tensor
+        for i in range(2):
+            x.fill_(self.rank + 1.0)
+            work = pg.allreduce([x])
+            work.wait()
+            self.assertEqual(torch.Tensor([float(self.size * (self.size + 1) / 2)]), x)
+
 
 class ProcessGroupNCCLTest(TestCase):
     MAIN_PROCESS_RANK = 0
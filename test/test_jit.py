@@ -363,6 +363,23 @@ class TestJit(JitTestCase):
             else:
                 raise
 
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    def test_reduction_fusion_cpu(self):
+        def f(x, y):
+            e = torch.exp(x - y)
+            return e, e.sum(1, keepdim=True), (e * e).mean(1)
+
+        x = torch.randn(4, 70, dtype=torch.float)
+        y = torch.randn(4, 70, dtype=torch.float)
+        try:
+            ge = self.checkTrace(f, (x, y), inputs_require_grads=False)
+            graph = ge.graph_for(x, y)
+        except RuntimeError as e:
+            if 'Failed to compile' in e.args[0]:
+                raise unittest.SkipTest('Failed to compile')
+            raise
+        self.assertEqual([n.kind() for n in graph.nodes()], ['prim::FusionGroup'])
+
     @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
     @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
     def test_lstm_fusion_concat(self):
@@ -531,6 +548,44 @@ class TestJit(JitTestCase):
                 self.assertFalse(fn.has_trace_for(*unk_config))
         self.assertEqual(fn.hits, 0)
 
+    def test_batch_mm_shared_operand(self):
+        def foo(x, w1, w2, w3, y):
+            # three projections of x, and two mms with w1 on the right
+            a = x.mm(w1) + 1
+            b = x.mm(w2) * 2
+            c = x.mm(w3)
+            d = y.mm(w1) + y.t().mm(w1)
+            return a, b, c, d
+
+        x = torch.randn(4, 5)
+        y = torch.randn(5, 5)
+        ws = [torch.randn(5, 6) for _ in range(3)]
+        inputs = [x] + ws + [y]
+        ge = self.checkTrace(foo, inputs)
+        graph = ge.graph_for(*inputs)
+        self.assertEqual(len([n for n in graph.nodes() if n.kind() == 'aten::mm']), 2)
+
+    def test_batch_mm_shared_operand_chained(self):
+        def foo(x, z, w1, w2, W):
+            # batching u and v puts a chunk before u, which m_b then reads, so
+            # m_a and m_b can only be batched in front of m_b
+            m_a = z.mm(W)
+            u = x.mm(w1)
+            v = x.mm(w2)
+            m_b = u.mm(W)
+            return m_a, v * 2, m_b + 1
+
+        x = torch.randn(4, 5)
+        z = torch.randn(4, 6)
+        w1 = torch.randn(5, 6)
+        w2 = torch.randn(5, 6)
+        W = torch.randn(6, 3)
+        inputs = [x, z, w1, w2, W]
+        ge = self.checkTrace(foo, inputs)
+        graph = ge.graph_for(*inputs)
+        self.assertEqual(len([n for n in graph.nodes() if n.kind() == 'aten::mm']), 2)
+        torch._C._jit_pass_lint(graph)
+
     def test_cse(self):
         x = torch.tensor([0.4, 0.3], requires_grad=True)
         y = torch.tensor([0.7, 0.5], requires_grad=True)
@@ -3340,6 +3395,59 @@ def func(t):
         self.assertExpectedGraph(graph)
         self.checkScript(fn, (torch.tensor(10),))
 
+    def test_loop_invariant_hoisting(self):
+        def fn(x, w):
+            y = x
+            for i in range(10):
+                y = y + torch.sigmoid(w) * 2
+            return y
+
+        graph = torch.jit._script_graph(fn)
+        self.run_pass('hoist_loop_invariants', graph)
+        graph_str = str(graph)
+        self.assertLess(graph_str.index('aten::sigmoid'), graph_str.index('prim::Loop'))
+        self.assertLess(graph_str.index('aten::mul'), graph_str.index('prim::Loop'))
+        self.checkScript(fn, (torch.randn(3, 4), torch.randn(3, 4)))
+
+    def test_loop_invariant_hoisting_in_executor(self):
+        @torch.jit.script
+        def fn(x, w):
+            y = x
+            for i in range(10):
+                y = y + torch.sigmoid(w) * 2
+            return y
+
+        x, w = torch.randn(3, 4), torch.randn(3, 4)
+        self.assertEqual(fn(x, w), x + 10 * (torch.sigmoid(w) * 2))
+        # hoisted before the loop is unrolled, so sigmoid runs once
+        self.assertEqual(str(fn.graph_for(x, w)).count('aten::sigmoid'), 1)
+
+    def test_loop_invariant_hoisting_unknown_trip_count(self):
+        def fn(x, w, n):
+            y = x
+            for i in range(n):
+                y = y + torch.mm(w, w)
+            return y
+
+        graph = torch.jit._script_graph(fn)
+        self.run_pass('hoist_loop_invariants', graph)
+        graph_str = str(graph)
+        # the loop may not run, and mm would throw for non-square w
+        self.assertGreater(graph_str.index('aten::mm'), graph_str.index('prim::Loop'))
+        self.checkScript(fn, (torch.randn(3, 4), torch.randn(3, 4), torch.tensor(0)))
+
+    def test_loop_invariant_hoisting_zero_trip_count(self):
+        @torch.jit.script
+        def fn(x, w):
+            y = x
+            for i in range(0):
+                y = y + torch.mm(w, w)
+            return y
+
+        # mm of the non-square w throws if it runs
+        x, w = torch.randn(3, 4), torch.randn(3, 4)
+        self.assertEqual(fn(x, w), x)
+
     def test_loop_unroll_unused_counter(self):
         def fn(x):
             y = FIXME_zerol()
@@ -13,6 +13,7 @@ from operator import mul
 from collections import OrderedDict
 import hashlib
 import os
+import tempfile
 
 import torch
 import torch.backends.cudnn as cudnn
@@ -1766,9 +1767,11 @@ class TestNN(NNTestCase):
         self.assertEqual(es_weight_grad, expected_grad_weight, dtype2prec[dtype])
 
         # now compare EmbeddingBag vs Embedding + Sum/Mean, for constant bag length
-        def _test_vs_Embedding(N, D, B, L, max_norm=None):
-            es = nn.EmbeddingBag(N, D, mode=mode, sparse=sparse, max_norm=max_norm).to(device, dtype)
-            e = nn.Embedding(N, D, max_norm=max_norm).to(device, dtype)
+        def _test_vs_Embedding(N, D, B, L, max_norm=None, scale_grad_by_freq=False):
+            es = nn.EmbeddingBag(N, D, mode=mode, sparse=sparse, max_norm=max_norm,
+                                 scale_grad_by_freq=scale_grad_by_freq).to(device, dtype)
+            e = nn.Embedding(N, D, max_norm=max_norm,
+                             scale_grad_by_freq=scale_grad_by_freq).to(device, dtype)
             e.weight.data.copy_(es.weight.data)
             input = torch.randint(N, (B, L), device=device, dtype=torch.long)
             offsets = torch.arange(0, B, device=device, dtype=torch.long).mul_(L)
@@ -1799,6 +1802,12 @@ class TestNN(NNTestCase):
         for max_norm in (None, 3):
             for p in itertools.product([1, 2], repeat=4):
                 _test_vs_Embedding(*p, max_norm=max_norm)
+        # enough bags to be split across threads, rows that are not a
+        # multiple of the vector width and repeated indices
+        _test_vs_Embedding(50, 67, 1000, 20)
+        # sparse gradients do not support scale_grad_by_freq
+        if mode != 'max' and not sparse:
+            _test_vs_Embedding(10, 19, 50, 8, scale_grad_by_freq=True)
 
         # check that giving illegal input combos raises error
         es = nn.EmbeddingBag(10, 20, mode=mode, sparse=sparse)
@@ -3268,6 +3277,68 @@ class TestNN(NNTestCase):
                              torch.cat([m1.weight.grad.data, m2.weight.grad.data], 0),
                              dtype2prec[dtype])
 
+    def test_Conv2d_depthwise_cpu(self):
+        for multiplier, stride, padding, dilation, kernel_size in product([1, 2], [1, 2], [0, 2], [1, 2], [3, 5]):
+            m = nn.Conv2d(3, 3 * multiplier, kernel_size, stride, padding, dilation, groups=3).double()
+            i = torch.randn(2, 3, 11, 10, dtype=torch.double)
+            # The same convolution with groups=1 and a block diagonal weight
+            full_weight = torch.zeros(3 * multiplier, 3, kernel_size, kernel_size, dtype=torch.double)
+            for c in range(3):
+                full_weight[c * multiplier:(c + 1) * multiplier, c] = m.weight.data[c * multiplier:(c + 1) * multiplier, 0]
+            expected = F.conv2d(i, full_weight, m.bias.data, stride, padding, dilation)
+            self.assertEqual(m(i), expected)
+
+        i = torch.randn(2, 2, 6, 5, dtype=torch.double, requires_grad=True)
+        w = torch.randn(4, 1, 3, 3, dtype=torch.double, requires_grad=True)
+        b = torch.randn(4, dtype=torch.double, requires_grad=True)
+        for stride, padding, dilation in product([1, 2], [0, 1], [1, 2]):
+            def func(i, w, b):
+                return F.conv2d(i, w, b, stride, padding, dilation, groups=2)
+            self.assertTrue(gradcheck(func, (i, w, b)))
+        self.assertTrue(gradgradcheck(func, (i, w, b)))
+
+    def test_cpu_winograd_convolution(self):
+        # 5 x 7 and 12 x 9 inputs give outputs with and without partial tiles,
+        # for both tile sizes
+        for padding, size in product([0, 1, 3], [(5, 7), (12, 9)]):
+            i = torch.randn(2, 3, *size, dtype=torch.double, requires_grad=True)
+            w = torch.randn(4, 3, 3, 3, dtype=torch.double, requires_grad=True)
+            b = torch.randn(4, dtype=torch.double, requires_grad=True)
+
+            def func(i, w, b):
+                return torch.cpu_winograd_convolution(i, w, b, (padding, padding))
+            self.assertEqual(func(i, w, b), F.conv2d(i, w, b, padding=padding))
+            self.assertEqual(func(i.float(), w.float(), b.float()),
+                             F.conv2d(i.float(), w.float(), b.float(), padding=padding), prec=1e-4)
+            self.assertTrue(gradcheck(func, (i, w, b)))
+
+    def test_Conv_cpu_benchmark(self):
+        convs = [
+            nn.Conv2d(4, 6, kernel_size=1, stride=2, groups=2),
+            nn.Conv2d(4, 6, kernel_size=3, padding=1, bias=False),
+            nn.Conv3d(4, 4, kernel_size=1),
+            nn.Conv1d(4, 8, kernel_size=1, groups=4),
+        ]
+        inputs = [torch.randn(2, 4, 7, 7), torch.randn(2, 4, 7, 7),
+                  torch.randn(2, 4, 3, 4, 5), torch.randn(2, 4, 9)]
+        cache_file = os.path.join(tempfile.mkdtemp(), 'conv_algorithms.txt')
+        for conv, input in zip(convs, inputs):
+            input.requires_grad_()
+            expected = conv(input)
+            expected_grads = torch.autograd.grad(expected.sum(), (input,) + tuple(conv.parameters()))
+            with torch.backends.cpu.flags(conv_benchmark=True, conv_benchmark_cache_file=cache_file):
+                # The first call benchmarks, the second one uses the cache
+                for _ in range(2):
+                    output = conv(input)
+                    grads = torch.autograd.grad(output.sum(), (input,) + tuple(conv.parameters()))
+                    self.assertEqual(output, expected)
+                    for grad, expected_grad in zip(grads, expected_grads):
+                        self.assertEqual(grad, expected_grad)
+        self.assertFalse(torch.backends.cpu.conv_benchmark)
+        self.assertIsNone(torch.backends.cpu.conv_benchmark_cache_file)
+        with open(cache_file) as f:
+            self.assertEqual(len(f.readlines()), len(convs))
+
     # Very similar to test_Conv2d_naive_groups but with special care to handle
     # the number of groups == number of input channels
     @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
@@ -390,6 +390,16 @@ class TestSparse(TestCase):
         self.assertTrue(x_coalesced.is_coalesced())
         self.assertFalse(y_uncoalesced.is_coalesced())
 
+    def test_coalesce_repeated_indices(self):
+        # Few distinct indices repeated many times, with enough entries in the
+        # first case for the CPU radix sort to split its passes into chunks.
+        for sparse_dims, nnz in [(1, 50000), (2, 1000)]:
+            with_size = [300] * sparse_dims + [3]
+            i = (torch.rand(sparse_dims, nnz, device=self.device).pow(4) * 300).long()
+            v = torch.randn(nnz, 3, dtype=self.value_dtype, device=self.device)
+            x = self.SparseTensor(i, v, torch.Size(with_size))
+            self.safeCoalesce(x)
+
     def test_t_empty(self):
         x = self.SparseTensor(2, 3)
         x.t_()
@@ -445,6 +455,75 @@ class TestSparse(TestCase):
         test_shape(100, 1000, 200)
         test_shape(64, 10000, 300)
 
+    @cpu_only
+    def test_mm_skewed_rows(self):
+        # A few rows hold most of the nonzeros, with enough of them for the
+        # CPU kernel to split the rows across threads.
+        di, dj, dk, nnz = 500, 1000, 64, 20000
+        rows = (torch.rand(nnz).pow(4) * di).long()
+        cols = (torch.rand(nnz) * dj).long()
+        v = torch.randn(nnz, dtype=self.value_dtype)
+        x = self.SparseTensor(torch.stack([rows, cols]), v, torch.Size([di, dj])).coalesce()
+        y = torch.randn(dj, dk, dtype=self.value_dtype)
+
+        expected = torch.mm(x.to_dense(), y)
+        self.assertEqual(torch.mm(x, y), expected)
+        # The second product reuses the row pointers of the first one
+        self.assertEqual(torch.mm(x, y), expected)
+        self.assertEqual(torch.mm(x, y.t().contiguous().t()), expected)
+
+        # Overwriting the matrix in place must drop them
+        rows = (torch.rand(nnz) * di).long()
+        z = self.SparseTensor(torch.stack([rows, cols]), v, torch.Size([di, dj])).coalesce()
+        x.copy_(z)
+        self.assertEqual(torch.mm(x, y), torch.mm(z.to_dense(), y))
+
+    @cpu_only
+    def test_csr(self):
+        def test_shape(di, dj, dk, nnz):
+            x, _, _ = self._gen_sparse(2, nnz, [di, dj])
+            dense = self.safeToDense(x)
+            for csr in [torch.sparse.CsrTensor.from_tensor(x),
+                        torch.sparse.CsrTensor.from_tensor(dense)]:
+                self.assertEqual(csr.crow_indices.numel(), di + 1)
+                self.assertEqual(csr.to_dense(), dense)
+                self.assertEqual(csr.to_sparse_coo().to_dense(), dense)
+
+                y = torch.randn(dj, dk, dtype=self.value_dtype)
+                t = torch.randn(di, dk, dtype=self.value_dtype)
+                self.assertEqual(csr.mm(y), torch.mm(dense, y))
+                self.assertEqual(csr.addmm(t, y, beta=0.5, alpha=2),
+                                 torch.addmm(0.5, t, 2, dense, y))
+
+                rows = torch.LongTensor([di - 1, 0, di // 2, 0])
+                self.assertEqual(csr.index_select(rows).to_dense(), dense.index_select(0, rows))
+                self.assertEqual(csr.sum(1), dense.sum(1))
+                self.assertEqual(csr.sum(0), dense.sum(0))
+
+        test_shape(7, 5, 3, 10)
+        test_shape(1000, 100, 64, 5000)
+
+        empty = torch.sparse.CsrTensor.from_tensor(torch.zeros(3, 4, dtype=self.value_dtype))
+        self.assertEqual(empty.nnz(), 0)
+        self.assertEqual(empty.crow_indices, torch.zeros(4).long())
+        self.assertEqual(empty.mm(torch.ones(4, 2, dtype=self.value_dtype)), torch.zeros(3, 2))
+
+    @cpu_only
+    def test_csr_invalid(self):
+        crow = torch.LongTensor([0, 2, 1])
+        col = torch.LongTensor([0, 1])
+        v = torch.randn(2, dtype=self.value_dtype)
+        with self.assertRaisesRegex(RuntimeError, "non-decreasing"):
+            torch.sparse.CsrTensor(crow, col, v, (2, 2)).to_dense()
+        crow = torch.LongTensor([0, 1, 2])
+        col = torch.LongTensor([0, 2])
+        with self.assertRaisesRegex(RuntimeError, "out of range"):
+            torch.sparse.CsrTensor(crow, col, v, (2, 2)).mm(torch.randn(2, 2, dtype=self.value_dtype))
+        # All the columns are in range, but the matrix has 4 of them.
+        col = torch.LongTensor([0, 1])
+        with self.assertRaisesRegex(RuntimeError, "size mismatch"):
+            torch.sparse.CsrTensor(crow, col, v, (2, 4)).mm(torch.randn(2, 2, dtype=self.value_dtype))
+
     @cpu_only
     def test_saddmm(self):
         def test_shape(di, dj, dk):
@@ -7732,6 +7732,31 @@ class TestTorch(TestCase):
         t2 = torch.from_numpy(t.numpy().transpose())
         self.assertEqual(t1, t2)
 
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    def test_big_permute(self):
+        for dtype in [torch.float, torch.double, torch.int, torch.uint8]:
+            t = torch.randn(7, 1, 37, 61).mul(100).to(dtype)
+            for dims in [(0, 2, 3, 1), (3, 1, 0, 2), (2, 1, 3, 0)]:
+                t1 = t.permute(*dims).contiguous()
+                t2 = torch.from_numpy(t.numpy().transpose(dims).copy())
+                self.assertEqual(t1, t2)
+
+    def test_strided_dtype_copy(self):
+        # values that every dtype below, half included, represents exactly
+        src = torch.randint(0, 100, (13, 70, 33)).double()
+        sources = [src, src.permute(2, 0, 1), src[:, 5:60:3], src.transpose(0, 2)[::2]]
+        dtypes = [torch.half, torch.float, torch.double, torch.int, torch.long, torch.uint8]
+        for s in sources:
+            for src_dtype in dtypes:
+                s1 = s.to(src_dtype)
+                for dst_dtype in dtypes:
+                    dst = torch.zeros(s.size()).to(dst_dtype)
+                    dst.copy_(s1)
+                    self.assertEqual(dst.double(), s)
+                    dst_t = torch.zeros(s.size()[::-1]).to(dst_dtype).permute(2, 1, 0)
+                    dst_t.copy_(s1)
+                    self.assertEqual(dst_t.double(), s)
+
     def test_inplace_division(self):
         t = torch.rand(5, 5)
         id_before = id(t)
@@ -0,0 +1,65 @@
+import sys
+import torch
+from contextlib import contextmanager
+
+# Write:
+#
+#   torch.backends.cpu.conv_benchmark = True
+#
+# to time every applicable algorithm the first time a CPU convolution of a
+# given shape runs, and use the fastest one from then on. Setting
+#
+#   torch.backends.cpu.conv_benchmark_cache_file = 'conv_algorithms.txt'
+#
+# also saves the choices to that file and reads them back in later processes,
+# so that the benchmarks only run once per machine. The file should not be
+# shared between machines, since the fastest algorithm depends on the CPU.
+
+
+@contextmanager
+def flags(conv_benchmark=False, conv_benchmark_cache_file=None):
+    orig_flags = (torch._C._get_cpu_conv_benchmark(),
+                  torch._C._get_cpu_conv_benchmark_cache_file())
+    torch._C._set_cpu_conv_benchmark(conv_benchmark)
+    torch._C._set_cpu_conv_benchmark_cache_file(conv_benchmark_cache_file or '')
+    try:
+        yield
+    finally:
+        # recover the previous values
+        torch._C._set_cpu_conv_benchmark(orig_flags[0])
+        torch._C._set_cpu_conv_benchmark_cache_file(orig_flags[1])
+
+
+class ContextProp(object):
+    def __init__(self, getter, setter):
+        self.getter = getter
+        self.setter = setter
+
+    def __get__(self, obj, objtype):
+        return self.getter()
+
+    def __set__(self, obj, val):
+        self.setter(val)
+
+
+def _get_cache_file():
+    return torch._C._get_cpu_conv_benchmark_cache_file() or None
+
+
+def _set_cache_file(path):
+    torch._C._set_cpu_conv_benchmark_cache_file(path or '')
+
+
+class CPUModule(object):
+    def __init__(self, m):
+        self.__dict__ = m.__dict__
+        # You have to retain the old module, otherwise it will
+        # get GC'ed and a lot of things will break.  See:
+        # https://stackoverflow.com/questions/47540722/how-do-i-use-the-sys-modules-replacement-trick-in-init-py-on-python-2
+        self.__old_mod = m
+    conv_benchmark = ContextProp(torch._C._get_cpu_conv_benchmark, torch._C._set_cpu_conv_benchmark)
+    conv_benchmark_cache_file = ContextProp(_get_cache_file, _set_cache_file)
+
+# This is the sys.modules replacement trick, see
+# https://stackoverflow.com/questions/2447353/getattr-on-a-module/7668273#7668273
+sys.modules[__name__] = CPUModule(sys.modules[__name__])
@@ -95,6 +95,9 @@ void registerLayoutObject(THPLayout *layout, at::Backend backend) {
 }
 
 at::Type& getType(at::ScalarType scalarType, const THPLayout& layout, const at::Device& device) {
+  if (layout.layout == at::Layout::SparseCsr) {
+    throw std::runtime_error("torch.sparse_csr matrices can't be created as a Tensor, use torch.sparse.CsrTensor");
+  }
   const at::Backend backend = get_backend(device.type() == at::Device::Type::CUDA, layout.layout == at::Layout::Sparse);
   auto baseType = at::globalContext().getTypeOpt(backend, scalarType);
   if (!baseType) {
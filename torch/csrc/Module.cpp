@@ -375,6 +375,33 @@ PyObject *THPModule_benchmarkCuDNN(PyObject *_unused)
   else Py_RETURN_FALSE;
 }
 
+PyObject *THPModule_setBenchmarkCPUConv(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(PyBool_Check(arg), "set_cpu_conv_benchmark expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  at::globalContext().setBenchmarkCPUConvolution(arg == Py_True);
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_benchmarkCPUConv(PyObject *_unused)
+{
+  if (at::globalContext().benchmarkCPUConvolution()) Py_RETURN_TRUE;
+  else Py_RETURN_FALSE;
+}
+
+PyObject *THPModule_setCPUConvCacheFile(PyObject *_unused, PyObject *arg)
+{
+  THPUtils_assert(THPUtils_checkString(arg), "set_cpu_conv_benchmark_cache_file "
+          "expects a str, but got %s", THPUtils_typename(arg));
+  at::globalContext().setCPUConvolutionCacheFile(THPUtils_unpackString(arg));
+  Py_RETURN_NONE;
+}
+
+PyObject *THPModule_CPUConvCacheFile(PyObject *_unused)
+{
+  return THPUtils_packString(at::globalContext().cpuConvolutionCacheFile());
+}
+
 PyObject *THPModule_setFlushDenormal(PyObject *_unused, PyObject *arg) {
   THPUtils_assert(PyBool_Check(arg), "flush_denormal expects a bool, "
           "but got %s", THPUtils_typename(arg));
@@ -437,6 +464,10 @@ static PyMethodDef TorchMethods[] = {
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  NULL},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     NULL},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  NULL},
+  {"_get_cpu_conv_benchmark", (PyCFunction)THPModule_benchmarkCPUConv, METH_NOARGS,     NULL},
+  {"_set_cpu_conv_benchmark", (PyCFunction)THPModule_setBenchmarkCPUConv, METH_O,  NULL},
+  {"_get_cpu_conv_benchmark_cache_file", (PyCFunction)THPModule_CPUConvCacheFile, METH_NOARGS,     NULL},
+  {"_set_cpu_conv_benchmark_cache_file", (PyCFunction)THPModule_setCPUConvCacheFile, METH_O,  NULL},
   {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       NULL},
   {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_O,       NULL},
   {"set_flush_denormal", (PyCFunction)THPModule_setFlushDenormal, METH_O,     NULL},
@@ -181,7 +181,23 @@ PyObject* c10d_init(PyObject* _unused) {
                 ::gloo::transport::tcp::CreateDevice(attr));
             return std::make_shared<::c10d::ProcessGroupGloo>(
                 store, rank, size, options);
-          }));
+          }))
+      .def(
+          "allreduce_coalesced",
+          [](::c10d::ProcessGroupGloo& pg,
+             std::vector<at::Tensor>& xs,
+             ::c10d::ReduceOp op) {
+            ::c10d::AllreduceOptions opts;
+            opts.reduceOp = op;
+            return pg.allreduceCoalesced(xs, opts);
+          },
+          py::arg("tensors"),
+          py::arg("op") = ::c10d::ReduceOp::SUM,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "register_tensors",
+          &::c10d::ProcessGroupGloo::registerTensors,
+          py::arg("tensors"));
 
 #ifdef USE_C10D_NCCL
   shared_ptr_class_<::c10d::ProcessGroupNCCL>(
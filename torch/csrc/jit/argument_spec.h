@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include "torch/csrc/autograd/variable.h"
@@ -79,6 +80,47 @@ struct ArgumentSpec {
     }
   }
 
+  // checks whether constructing an ArgumentSpec from `tensors` would produce
+  // a spec equal to this one, without allocating or hashing a new spec.
+  // GraphExecutor uses this to check its most recently used plan before
+  // falling back to a hash table lookup.
+  bool matches(bool with_grad, const variable_tensor_list & tensors) const {
+    if(tensors.size() != ntensors)
+      return false;
+    auto pods = tensor_info();
+    const int64_t * next_dim = sizes_strides();
+    const int64_t * end = data.data() + data.size();
+    uint32_t total_dims = 0;
+    for(size_t i = 0; i < ntensors; i++) {
+      const auto & t = tensors[i];
+      const auto & pod = pods[i];
+      if(pod.defined != t.defined())
+        return false;
+      if(t.defined()) {
+        int device = (!t.type().is_cuda()) ? -1 : t.get_device();
+        bool requires_grad = with_grad && static_cast<const autograd::Variable&>(t).requires_grad();
+        if(pod.type != static_cast<unsigned int>(t.type().scalarType()) ||
+           pod.device != device ||
+           pod.requires_grad != requires_grad)
+          return false;
+        auto sizes = t.sizes();
+        auto strides = t.strides();
+        total_dims += sizes.size();
+        if(pod.total_dims != total_dims || end - next_dim < 2 * (int64_t) sizes.size())
+          return false;
+        if(!std::equal(sizes.begin(), sizes.end(), next_dim))
+          return false;
+        next_dim += sizes.size();
+        if(!std::equal(strides.begin(), strides.end(), next_dim))
+          return false;
+        next_dim += strides.size();
+      } else if(pod.total_dims != total_dims) {
+        return false;
+      }
+    }
+    return next_dim == end;
+  }
+
   // equality is fast: check ntensors, and then check the raw array data,
   // there are no size/stride indirections
   bool operator==(const ArgumentSpec & spec) const {
@@ -37,6 +37,36 @@ std::vector<bool> TensorDesc::findContiguous(
   return cont;
 }
 
+bool isRowReduction(Node * node) {
+  if (node->kind() != aten::sum && node->kind() != aten::mean)
+    return false;
+  // no attributes but dim and keepdim, e.g. no dtype
+  if (node->inputs().size() != 1 || node->outputs().size() != 1 ||
+      node->attributeNames().size() != 2 ||
+      !node->hasAttribute(attr::dim) || !node->hasAttribute(attr::keepdim) ||
+      node->kindOf(attr::keepdim) != AttributeKind::i)
+    return false;
+  auto type = node->input()->type()->cast<TensorType>();
+  if (!type || type->sizes().empty() || type->sizes().back() == 0)
+    return false;
+  int64_t ndim = type->sizes().size();
+  // the output needs a dimension to be indexed by row
+  if (ndim == 1 && !node->i(attr::keepdim))
+    return false;
+  int64_t dim;
+  if (node->kindOf(attr::dim) == AttributeKind::is) {
+    auto dims = node->is(attr::dim);
+    if (dims.size() != 1)
+      return false;
+    dim = dims[0];
+  } else if (node->kindOf(attr::dim) == AttributeKind::i) {
+    dim = node->i(attr::dim);
+  } else {
+    return false;
+  }
+  return dim == ndim - 1 || dim == -1;
+}
+
 namespace {
 
 #ifdef USE_CUDA
@@ -122,6 +152,44 @@ void ${kernelName}(IndexType totalElements, void ** args) {
 }
 )");
 
+// Used when some outputs are reductions over the last dimension. Each
+// iteration computes a row of the map, accumulating the reductions, and
+// stores them once the row is done.
+auto cpu_reduction_compilation_unit_template = CodeTemplate(R"(
+#include <cstddef>
+#include <cstdint>
+#include <math.h>
+${type_declarations}
+
+#define OMP_THRESHOLD 100000
+static void ${kernelName}_kernel(IndexType totalElements, IndexType rowSize, ${formals}) {
+  IndexType totalRows = totalElements / rowSize;
+  #pragma omp parallel for if(totalElements > OMP_THRESHOLD)
+  for (IndexType rowIndex = 0;
+        rowIndex < totalRows;
+        rowIndex += 1) {
+      ${reductionInits}
+      for (IndexType linearIndex = rowIndex * rowSize;
+            linearIndex < (rowIndex + 1) * rowSize;
+            linearIndex += 1) {
+          // Convert `linearIndex` into an offset of tensor:
+          ${tensorOffsets}
+          // calculate the results
+          ${kernelBody}
+      }
+      // Reduced outputs are indexed by row
+      IndexType linearIndex = rowIndex;
+      ${reductionOffsets}
+      ${reductionStores}
+    }
+}
+
+extern "C"
+void ${kernelName}(IndexType totalElements, void ** args) {
+  ${kernelName}_kernel(totalElements, *static_cast<IndexType*>(args[1]) ${,argument_loads});
+}
+)");
+
 // This snippet enables half support in the jit. Following the pattern for
 // reductions, fp16 input data is immediately upconverted to float
 // with __half2float(). All mathematical operations are done on float
@@ -319,16 +387,25 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
   // TODO: handle cases where we need to generate > 2^32 element tensors
   env.s("IndexType","unsigned int"); //avoiding slow header includes to get uint32_t
 
+  bool has_reductions = std::any_of(
+      subgraph.outputs().begin(), subgraph.outputs().end(),
+      [](Value * o) { return isRowReduction(o->node()); });
+  JIT_ASSERTM(!use_cuda || !has_reductions, "reductions are only fused on the CPU");
+
   std::stringstream body;
   std::stringstream tensorOffsets;
+  std::stringstream reductionInits;
+  std::stringstream reductionOffsets;
+  std::stringstream reductionStores;
   std::vector<std::string> formals;
   std::vector<std::string> argument_loads;
-  auto emitFormal = [&](Value * n, const TensorDesc & desc) {
+  auto emitFormal = [&](Value * n, const TensorDesc & desc, std::ostream & offsets) {
     std::string tensor = "t" + std::to_string(formals.size()); //can't be unique() because Param may be an output
     size_t nDim = desc.nDim();
-    emitIndexingFor(tensorOffsets, tensor, nDim,  desc.lastIsContiguous());
+    emitIndexingFor(offsets, tensor, nDim,  desc.lastIsContiguous());
     env.s("tensor",tensor);
-    env.d("formal_index", formals.size() + 1); // + 1 because the first argument is the linearIndex
+    // + 1 because the first argument is the numel, + 2 if the row size follows
+    env.d("formal_index", formals.size() + (has_reductions ? 2 : 1));
     env.d("nDim",nDim);
     env.s("scalar_type",scalarTypeName(desc.scalar_type));
     formals.push_back(format("TensorInfo<${scalar_type},${nDim}> ${tensor}",env));
@@ -337,25 +414,31 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
   {
     size_t i = 0;
     for(auto p : subgraph.inputs())
-      emitFormal(p,agraph.input_desc[i++]);
+      emitFormal(p,agraph.input_desc[i++],tensorOffsets);
   }
   std::vector<ConcatDesc> concat_desc;
-  std::vector<Value*> flat_output_nodes;
+  // outputs, and the index of their formal
+  std::vector<std::pair<Value*, size_t>> flat_output_nodes;
+  std::vector<std::pair<Value*, size_t>> reduction_output_nodes;
   {
     size_t i = 0;
     for(auto o : subgraph.outputs()) {
       auto & desc = agraph.output_desc[i++];
-      if(o->node()->kind() != aten::cat) {
-        emitFormal(o, desc);
+      if(isRowReduction(o->node())) {
+        reduction_output_nodes.emplace_back(o, formals.size());
+        emitFormal(o, desc, reductionOffsets);
+        concat_desc.emplace_back();
+      } else if(o->node()->kind() != aten::cat) {
+        flat_output_nodes.emplace_back(o, formals.size());
+        emitFormal(o, desc, tensorOffsets);
         concat_desc.emplace_back();
-        flat_output_nodes.push_back(o);
       } else {
         auto cat = o->node();
         size_t nInputs = cat->inputs().size();
         concat_desc.emplace_back(desc, nInputs, cat->i(attr::dim));
         for(auto c : cat->inputs()) {
-          emitFormal(c, *concat_desc.back().subtensorDesc);
-          flat_output_nodes.push_back(c);
+          flat_output_nodes.emplace_back(c, formals.size());
+          emitFormal(c, *concat_desc.back().subtensorDesc, tensorOffsets);
         }
       }
     }
@@ -385,18 +468,31 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
   for(auto n : subgraph.nodes()) {
     if(n->kind() == aten::cat)
       continue; // Concat nodes by narrowing the output Tensors before the kernel runs
+    if(isRowReduction(n))
+      continue; // Reductions accumulate their input below
     env.s("node",valueName(n->output()));
     env.s("rhs", encodeRHS(n));
     body << format("auto ${node} = ${rhs};\n",env);
   }
 
-  for(auto o : flat_output_nodes) {
-    env.d("formal",formal_count++);
+  for(auto & o : reduction_output_nodes) {
+    Node * n = o.first->node();
+    env.d("formal",o.second);
+    env.s("node",valueName(o.first));
+    env.s("input",valueName(n->input()));
+    env.s("rhs", n->kind() == aten::mean ? format("${node} / rowSize",env) : valueName(o.first));
+    reductionInits << format("float ${node} = 0;\n",env);
+    body << format("${node} += ${input};\n",env);
+    reductionStores << format("t${formal}.data[t${formal}_offset] = ${rhs};\n",env);
+  }
+
+  for(auto & o : flat_output_nodes) {
+    env.d("formal",o.second);
     env.s("access",format("t${formal}.data[t${formal}_offset]",env));
-    env.s("node",valueName(o));
+    env.s("node",valueName(o.first));
 
     // Acquires and converts (if needed) outputs
-    auto ot = o->type()->cast<TensorType>();
+    auto ot = o.first->type()->cast<TensorType>();
     if (use_cuda && ot && ot->scalarType() == at::ScalarType::Half) {
       body << format("${access} = __float2half(${node});\n",env);
       has_half_tensor = true;
@@ -414,11 +510,16 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
 
   env.s("tensorOffsets",tensorOffsets.str());
   env.s("kernelBody",body.str());
+  env.s("reductionInits",reductionInits.str());
+  env.s("reductionOffsets",reductionOffsets.str());
+  env.s("reductionStores",reductionStores.str());
   env.v("formals",formals);
   env.v("argument_loads",argument_loads);
   env.s("type_declarations", type_declarations_template.format(env));
   if(use_cuda) {
     out << cuda_compilation_unit_template.format(env);
+  } else if(has_reductions) {
+    out << cpu_reduction_compilation_unit_template.format(env);
   } else {
     out << cpu_compilation_unit_template.format(env);
   }
@@ -446,7 +547,15 @@ struct TensorInfo {
 CompiledFusionFunction::CompiledFusionFunction(const std::string & name, AnnotatedGraph & agraph)
   : name(name)
   , input_desc(agraph.input_desc)
-  , output_desc(agraph.output_desc) {}
+  , output_desc(agraph.output_desc) {
+  for(auto o : agraph.graph->outputs()) {
+    reduction_desc.emplace_back();
+    if(isRowReduction(o->node())) {
+      reduction_desc.back().reducesLastDim = true;
+      reduction_desc.back().keepdim = o->node()->i(attr::keepdim);
+    }
+  }
+}
 
 namespace {
 
@@ -510,15 +619,18 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
   JIT_ASSERT(inputs[0].numel() <= std::numeric_limits<uint32_t>::max());
   uint32_t numel = inputs[0].numel();
   at::IntList map_size = inputs[0].sizes();
+  bool has_reductions = std::any_of(reduction_desc.begin(), reduction_desc.end(),
+    [](const ReductionDesc & r) { return r.reducesLastDim; });
+  uint32_t row_size = map_size.empty() ? 1 : map_size.back();
   // Compute the storage needed to store TensorInfo structs for inputs and outputs.
   size_t uncompressedDim = input_desc.at(0).contiguity.size();
   size_t maxPossibleTensorInfoSize = sizeof(TensorInfo) + 2 * sizeof(uint32_t) * uncompressedDim;
   size_t maxPossibleBufferSize = maxPossibleTensorInfoSize * (inputs.size() + flat_outputs_size);
   std::vector<char> buffer(maxPossibleBufferSize);
   char * buffer_next = buffer.data();
-  // A vector of arguments to the kernel. It's (numel, *input_descs, *output_descs)
+  // A vector of arguments to the kernel. It's (numel, [row_size,] *input_descs, *output_descs)
   std::vector<void*> arguments;
-  arguments.reserve(1 + inputs.size() + flat_outputs_size);
+  arguments.reserve(2 + inputs.size() + flat_outputs_size);
   // Asserts that t's dims can be compressed in the same way as in desc
   // (that's what the kernel assumes), and appends it to the arguments vector.
   auto addTensorInfo = [&](TensorDesc & desc, const at::Tensor & t) {
@@ -531,12 +643,20 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
     arguments.push_back(ti);
   };
   arguments.push_back(&numel);
+  if (has_reductions)
+    arguments.push_back(&row_size);
   for (size_t i = 0; i < input_desc.size(); ++i)
     addTensorInfo(input_desc[i], inputs[i]);
   for (size_t i = 0; i < output_desc.size(); ++i) {
     auto & c = concat_desc[i];
     at::Tensor o = outputs[i];
-    if(c.nSubtensors == 1) {
+    if(reduction_desc[i].reducesLastDim) {
+      std::vector<int64_t> reduced_size(map_size.begin(), map_size.end() - 1);
+      if(reduction_desc[i].keepdim)
+        reduced_size.push_back(1);
+      o.resize_(reduced_size);
+      addTensorInfo(output_desc[i], outputs[i]);
+    } else if(c.nSubtensors == 1) {
       o.resize_(map_size);
       addTensorInfo(output_desc[i], outputs[i]);
     } else {
@@ -925,6 +1045,10 @@ FusionCompiler & sharedFusionCompiler() {
 
 namespace torch { namespace jit {
 
+bool isRowReduction(Node * node) {
+  return false;
+}
+
 CompiledFusionFunction::CompiledFusionFunction(const std::string & name, AnnotatedGraph & agraph) {}
 
 void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs, at::ArrayRef<at::Tensor> outputs) {}
@@ -78,6 +78,16 @@ struct ConcatDesc {
   }
 };
 
+// Reductions over the last dimension of a tensor (sum and mean), which the
+// CPU fusion compiler computes from the elementwise ops of a fusion group,
+// row by row. Other nodes of the group can't read their outputs.
+bool isRowReduction(Node * node);
+
+struct ReductionDesc {
+  bool reducesLastDim = false; // false for outputs that are not reductions
+  bool keepdim = false;
+};
+
 struct CompiledFusionFunction {
   TH_DISALLOW_COPY_AND_ASSIGN(CompiledFusionFunction);
 
@@ -100,8 +110,9 @@ protected:
   // The format of arguments is suitable for directly passing to a call to
   // cuLaunchKernel as the kernel arguments.
   // Currently the first argument is a pointer to numel (for passing to
-  // CUDA code), and the remainder are pointers to the TensorInfo<T> structs
-  // that compiled code uses to load Tensor data.
+  // CUDA code), followed by a pointer to the size of the last dimension if
+  // any output is a reduction, and the remainder are pointers to the
+  // TensorInfo<T> structs that compiled code uses to load Tensor data.
   // launch_with_tensors handles packing at::Tensors into this arguments array.
   // CPU code uses the same convension so that launch_with_tensors can be shared.
   virtual void launch_raw(uint32_t numel, void ** arguments) = 0;
@@ -115,6 +126,11 @@ protected:
   // an output is actually a concatenation of
   // many subtensors that the fusion group produces
   std::vector<ConcatDesc> concat_desc;
+
+  // same size as output_desc, describes whether
+  // an output is a reduction over the last dimension
+  // of the map instead of having its size
+  std::vector<ReductionDesc> reduction_desc;
 };
 
 struct FusionCompilerConfig {
@@ -25,6 +25,7 @@
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/jit/script/compiler.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -358,17 +359,25 @@ private:
     return autograd_fallback;
   }
   const ExecutionPlan & getOrCompile(const variable_tensor_list & inputs) {
+    bool with_grad = autograd::GradMode::is_enabled();
+    // fastest path: the inputs match the most recently used plan. This does
+    // not allocate, hash, or take the lock, which matters for small graphs
+    // run at small batch sizes where dispatch overhead dominates.
+    const PlanCacheEntry * last = last_plan.load(std::memory_order_acquire);
+    if(last && last->first.matches(with_grad, inputs))
+      return last->second;
     // outside lock guard, to minimize the time holding the lock on the fast path
     // ArgumentSpec even computes its hashCode here.
-    ArgumentSpec spec(autograd::GradMode::is_enabled(), inputs);
+    ArgumentSpec spec(with_grad, inputs);
     {
       std::lock_guard<std::mutex> lock(compile_mutex);
       auto it = plan_cache.find(spec);
-      if(it != plan_cache.end())
-        return it->second;
-      auto plan = compileSpec(spec);
-      auto r = plan_cache.emplace(std::move(spec), std::move(plan));
-      return r.first->second;
+      if(it == plan_cache.end()) {
+        auto plan = compileSpec(spec);
+        it = plan_cache.emplace(std::move(spec), std::move(plan)).first;
+      }
+      last_plan.store(&*it, std::memory_order_release);
+      return it->second;
     }
   }
 
@@ -433,6 +442,13 @@ private:
   // optimizable code paths, used when we can differentiate or when no derivative is needed
   // Spec describes input conditions, Plan describes how to execute them.
   std::unordered_map<ArgumentSpec, ExecutionPlan> plan_cache;
+  using PlanCacheEntry = std::pair<const ArgumentSpec, ExecutionPlan>;
+
+  // the plan_cache entry that was returned by the last call to getOrCompile.
+  // entries are never erased from plan_cache and unordered_map never moves
+  // its elements, so this pointer stays valid and the entry it points to is
+  // immutable; it can be read without holding the compile mutex.
+  std::atomic<const PlanCacheEntry*> last_plan {nullptr};
 
   // GraphExecutor can be accessed from  multiple thread so
   // anytime we are checking or updating the autograd_fallback or
@@ -511,6 +527,8 @@ void runOptimization(std::shared_ptr<Graph> & graph, bool graphMustSupportVariab
     // do not work on variables
 
     // They also may assume that concrete sizes/strides are availiable
+    // Hoisting needs the constant trip counts that unrolling replaces.
+    HoistLoopInvariants(graph);
     UnrollLoops(graph);
 
     //TODO: create peephole optimizations that are safe to run
@@ -0,0 +1,58 @@
+// Measures the overhead of GraphExecutor::run on a tiny graph, which is
+// dominated by finding the execution plan for the inputs. Pass the number of
+// runs as the first argument.
+
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/symbolic_variable.h"
+#include "torch/csrc/variable_tensor_functions.h"
+
+#include <ATen/ATen.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace torch { namespace jit {
+
+// Microseconds per run of `executor` on `inputs`, after a warm-up run that
+// compiles the plan
+double timeRuns(GraphExecutor& executor, const std::vector<at::Tensor>& inputs, int iterations) {
+  executor.run(variable_tensor_list(std::vector<at::Tensor>(inputs)));
+  auto begin = std::chrono::high_resolution_clock::now();
+  for(int i = 0; i < iterations; ++i) {
+    executor.run(variable_tensor_list(std::vector<at::Tensor>(inputs)));
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+}
+
+void benchmarkGraphExecutorDispatch(int iterations) {
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+
+  auto g = std::make_shared<Graph>();
+  auto a = SymbolicVariable::asNewInput(*g);
+  auto b = SymbolicVariable::asNewInput(*g);
+  g->registerOutput((a * b + a).value());
+  GraphExecutor executor(g);
+
+  auto x = v(at::randn({1, 4}, at::kCPU));
+  auto y = v(at::randn({1, 4}, at::kCPU));
+  auto z = v(at::randn({2, 4}, at::kCPU));
+  // the same specialization on every run
+  std::cout << "same inputs: " << timeRuns(executor, {x, y}, iterations) << " us per run\n";
+  // a second specialization, after which the first one is no longer the most
+  // recently used
+  std::cout << "other inputs: " << timeRuns(executor, {z, z}, iterations) << " us per run\n";
+}
+
+}} // namespace torch::jit
+
+int main(int argc, char* argv[]) {
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+  torch::jit::benchmarkGraphExecutorDispatch(iterations);
+  return 0;
+}
@@ -54,6 +54,7 @@ void initJITBindings(PyObject *module) {
    .def("_jit_pass_onnx", ToONNX)
    .def("_jit_pass_onnx_peephole", PeepholeOptimizeONNX)
    .def("_jit_pass_fuse", FuseGraph)
+   .def("_jit_pass_hoist_loop_invariants", HoistLoopInvariants)
    .def("_jit_pass_dce", [](std::shared_ptr<Graph>& g){
      return EliminateDeadCode(g); // overload resolution
    })
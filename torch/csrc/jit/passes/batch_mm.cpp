@@ -6,6 +6,7 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <map>
 #include <unordered_map>
 
 namespace torch { namespace jit {
@@ -64,6 +65,30 @@ namespace torch { namespace jit {
 // topological order and labeling nodes with TreeTokens. Then, we look for roots of
 // the trees we formed and fuse them.
 
+// Note [Batching independent MMs]
+// Once the trees are merged, this pass also looks for groups of independent mm
+// ops which share one of their operands, and whose other operands have equal
+// sizes. Those show up in forward passes with many projections of the same
+// input (e.g. query/key/value projections, or per-feature towers; linear layers
+// end up as mm + add after DecomposeAddmm). Such a group:
+//
+//   O1 = X @ W1,  O2 = X @ W2,  ...
+//
+// is replaced with a single mm of the shared operand and the concatenation of
+// the others, followed by a chunk of the result:
+//
+//   O1, O2, ... = chunk(X @ cat(W1, W2, ...; dim=1); dim=1)
+//
+// and likewise for a shared right hand side (concatenating along dim 0).
+//
+// The batched mm has to be inserted at a point where all operands are defined
+// and before any use of the original outputs. We use the position of the first
+// mm of the group if all operands are defined before it (the common case, since
+// the non-shared operands are usually parameters), and the position of the last
+// one if none of the outputs of the group are used before it (which also means
+// that no mm of the group depends on another one). Otherwise we leave the group
+// alone.
+
 // Tunable parameter. Set to something larger if it turns out to be better.
 static constexpr size_t min_fusion_size = 2;
 
@@ -139,8 +164,130 @@ struct TreeToken {
   }
 };
 
+enum class Side { LHS, RHS };
+
+static bool hasCompleteMatrixType(Value *v) {
+  auto type = v->type()->cast<TensorType>();
+  return type && type->sizes().size() == 2;
+}
+
+static void BatchIndependentMMs(Block* block) {
+  auto graph = block->owningGraph();
+
+  // renumbered after every rewrite, which inserts new nodes and makes mms use
+  // their outputs
+  std::unordered_map<Node*, size_t> position;
+  auto computePositions = [&]() {
+    position.clear();
+    size_t index = 0;
+    for (auto node : block->nodes())
+      position[node] = index++;
+  };
+  computePositions();
+
+  // values defined outside of this block or by its parameters are always
+  // available
+  auto definedBefore = [&](Value *v, Node *n) {
+    auto it = position.find(v->node());
+    return it == position.end() || it->second < position.at(n);
+  };
+  auto usedBefore = [&](Value *v, Node *n) {
+    for (auto use : v->uses()) {
+      Node *user = use.user;
+      while (user->owningBlock() != block)
+        user = user->owningBlock()->owningNode();
+      if (user == block->return_node())
+        continue;
+      if (position.at(user) <= position.at(n))
+        return true;
+    }
+    return false;
+  };
+
+  for (Side side : {Side::LHS, Side::RHS}) {
+    int shared_off = side == Side::LHS ? 0 : 1;
+    int other_off  = side == Side::LHS ? 1 : 0;
+    // the other operands are concatenated along the dimension that is not
+    // contracted, and the output is chunked along the same dimension
+    int cat_dim    = side == Side::LHS ? 1 : 0;
+
+    // group mm ops by their shared operand and the sizes of the other operand,
+    // in topological order
+    using GroupKey = std::pair<Value*, std::array<int64_t, 2>>;
+    std::map<GroupKey, std::vector<Node*>> groups;
+    std::vector<GroupKey> group_order;
+    for (auto node : block->nodes()) {
+      if (node->kind() != aten::mm || !node->hasUses())
+        continue;
+      Value *shared = node->inputs()[shared_off];
+      Value *other = node->inputs()[other_off];
+      if (!hasCompleteMatrixType(shared) || !hasCompleteMatrixType(other) ||
+          !hasCompleteMatrixType(node->output()))
+        continue;
+      GroupKey key {shared, as_array(other->type()->expect<TensorType>()->sizes())};
+      auto & group = groups[key];
+      if (group.empty())
+        group_order.push_back(key);
+      group.push_back(node);
+    }
+
+    for (auto & key : group_order) {
+      auto & matmuls = groups.at(key);
+      if (matmuls.size() < min_fusion_size)
+        continue;
+      Node *first = matmuls.front();
+      Node *last = matmuls.back();
+
+      Node *insertion_point = nullptr;
+      if (std::all_of(matmuls.begin(), matmuls.end(), [&](Node *mm) {
+            return definedBefore(mm->inputs()[other_off], first);
+          })) {
+        insertion_point = first;
+      } else if (std::none_of(matmuls.begin(), matmuls.end() - 1, [&](Node *mm) {
+            return usedBefore(mm->output(), last);
+          })) {
+        insertion_point = last;
+      } else {
+        continue;
+      }
+
+      auto other_type = key.second;
+      auto out_type = first->output()->type()->expect<TensorType>();
+      auto out_sizes = as_array(out_type->sizes());
+      int64_t num_mms = matmuls.size();
+
+      auto others = fmap(matmuls, [=](Node *mm) { return mm->inputs()[other_off]; });
+      Node *cat = graph->create(aten::cat, others)
+                       ->i_(attr::dim, cat_dim);
+      other_type[cat_dim] *= num_mms;
+      cat->output()->setType(out_type->withSizes(other_type));
+      cat->insertBefore(insertion_point);
+
+      Node *batch_mm = side == Side::LHS ?
+        graph->create(aten::mm, {key.first, cat->output()}) :
+        graph->create(aten::mm, {cat->output(), key.first});
+      auto batch_sizes = out_sizes;
+      batch_sizes[cat_dim] *= num_mms;
+      batch_mm->output()->setType(out_type->withSizes(batch_sizes));
+      batch_mm->insertBefore(insertion_point);
+
+      // chunks of the result are views into it, so they have its strides
+      Node *chunk = graph->create(aten::chunk, {batch_mm->output()}, 0)
+                         ->i_(attr::chunks, num_mms)
+                         ->i_(attr::dim, cat_dim);
+      auto batch_type = batch_mm->output()->type()->expect<TensorType>();
+      for (auto mm : matmuls) {
+        Value *chunk_output = chunk->addOutput();
+        chunk_output->setType(batch_type->withSizesStrides(out_sizes, batch_type->strides()));
+        mm->output()->replaceAllUsesWith(chunk_output);
+      }
+      chunk->insertBefore(insertion_point);
+      computePositions();
+    }
+  }
+}
+
 void BatchMMBlock(Block* block) {
-  enum class Side { LHS, RHS };
   auto graph = block->owningGraph();
 
   // Look for trees in the block
@@ -203,6 +350,10 @@ void BatchMMBlock(Block* block) {
     // NB: don't bother with cleaning up after yourself. We'll use DCE for that.
   }
   EliminateDeadCode(block);
+
+  // See Note [Batching independent MMs]
+  BatchIndependentMMs(block);
+  EliminateDeadCode(block);
 }
 
 void BatchMM(std::shared_ptr<Graph>& graph) {
@@ -1,6 +1,7 @@
 #include "torch/csrc/jit/passes/graph_fuser.h"
 #include "torch/csrc/jit/fusion_compiler.h"
 #include "torch/csrc/jit/autodiff.h"
+#include <algorithm>
 #include <unordered_map>
 
 #ifdef USE_CUDA
@@ -104,6 +105,82 @@ bool isSimpleMap(Node *node) {
 }
 
 
+// Returns true if v is defined in b, or in any block nested in b.
+bool isDefinedIn(Value * v, Block * b) {
+  for (Block * owner = v->node()->owningBlock(); owner; ) {
+    if (owner == b)
+      return true;
+    Node * owning_node = owner->owningNode();
+    owner = owning_node ? owning_node->owningBlock() : nullptr;
+  }
+  return false;
+}
+
+// Pure operators which are safe to evaluate once outside of a loop instead of
+// once per iteration, in addition to the simple mappable ones.
+std::unordered_set<NodeKind> hoistable = {
+  prim::Constant,
+  aten::mm,
+  aten::t,
+  aten::transpose,
+  aten::expand,
+  aten::cat,
+  aten::chunk,
+};
+
+// Returns the value of v if it is a constant holding a single number.
+at::optional<at::Scalar> constantValue(Value * v) {
+  Node * node = v->node();
+  if (node->kind() != prim::Constant)
+    return at::nullopt;
+  at::Tensor t = node->t(attr::value);
+  if (t.numel() != 1)
+    return at::nullopt;
+  return at::Scalar(t.view({})).local();
+}
+
+// Returns true if the loop is known to run at least once, i.e. its trip count
+// is a positive constant and its initial condition is true.
+bool runsAtLeastOnce(Node * loop) {
+  auto max_trip_count = constantValue(loop->inputs().at(0));
+  auto cond = constantValue(loop->inputs().at(1));
+  return max_trip_count && max_trip_count->toLong() > 0 &&
+         cond && cond->toLong() != 0;
+}
+
+// Moves nodes of loop bodies in b whose inputs are all defined outside of the
+// loop in front of the loop. Loop-invariant elementwise ops in scripted cells
+// (e.g. activations of parameters, or the input projections of an RNN that
+// doesn't depend on the hidden state) would otherwise run, and launch a kernel,
+// on every iteration. Once hoisted, they can also be fused with the ops
+// surrounding the loop.
+//
+// Hoisted ops run even if the loop doesn't, and any of them but constants may
+// throw (e.g. mm or add of tensors whose sizes don't match), so they are only
+// moved out of loops that are known to run.
+void hoistLoopInvariants(Block * b) {
+  for (Node * node : b->nodes()) {
+    for (Block * sub_block : node->blocks())
+      hoistLoopInvariants(sub_block);
+    if (node->kind() != prim::Loop)
+      continue;
+    Block * body = node->blocks().at(0);
+    bool runs = runsAtLeastOnce(node);
+    for (auto it = body->nodes().begin(); it != body->nodes().end();) {
+      Node * candidate = *it++;
+      if (!candidate->blocks().empty() ||
+          (simple_mappable.count(candidate->kind()) == 0 &&
+           hoistable.count(candidate->kind()) == 0) ||
+          (!runs && candidate->kind() != prim::Constant))
+        continue;
+      bool invariant = std::none_of(candidate->inputs().begin(), candidate->inputs().end(),
+                                    [&](Value * v) { return isDefinedIn(v, body); });
+      if (invariant)
+        candidate->moveBefore(node);
+    }
+  }
+}
+
 struct GraphFuser {
   Block * block;
 
@@ -200,6 +277,8 @@ struct GraphFuser {
   // all Fusable nodes can do this, but additionally Concat, which normally cannot be fused
   // because it is not a simple map, can be put in a fusion group
   // as long as no items in the group read the output of concat
+  // The same goes for reductions over the last dimension on the CPU, e.g. the
+  // sums of softmax and layer_norm, which are computed at the end of the group.
   bool isFusableAsExitNode(Node * node) {
     if(isFusable(node))
       return true;
@@ -207,6 +286,8 @@ struct GraphFuser {
     // otherwise they cannot partipate in the same map
     if(node->kind() == aten::cat && allOutputsHaveSameSize(node))
       return true;
+    if(isRowReduction(node) && getDevice(node) == kCPUDevice && allSupportedIO(node))
+      return true;
 
     return false;
   }
@@ -237,6 +318,23 @@ struct GraphFuser {
     return true;
   }
 
+  // The outputs of reductions are smaller than the map, so no other node of
+  // a fusion group can read them.
+  bool readsRowReduction(Node * consumer, Node * producer) {
+    if (producer->kind() != prim::FusionGroup)
+      return false;
+    auto subgraph_outputs = getSubgraph(producer).outputs();
+    for (size_t i = 0; i < subgraph_outputs.size(); ++i) {
+      if (!isRowReduction(subgraph_outputs[i]->node()))
+        continue;
+      for (auto u : producer->outputs()[i]->uses()) {
+        if (u.user == consumer)
+          return true;
+      }
+    }
+    return false;
+  }
+
   bool shouldFuse(Node * consumer, Value * producer) {
     // this handles cases where producer can be moved _into_ the fusion group of consumer.
     // TODO: extend to fusion of consumer into _producer's_ fusion blob
@@ -245,6 +343,7 @@ struct GraphFuser {
     // but this requires better handling of merging fusion groups so it is not done now
     at::optional<int> consumer_device = getDevice(consumer);
     return isFusable(producer->node()) &&
+      !readsRowReduction(consumer, producer->node()) &&
       allUsersAreThisConsumerOrOccurAfterIt(consumer, producer) &&
       consumer_device && consumer_device == getDevice(producer->node()) &&
       (*consumer_device != kCPUDevice || sharedFusionCompiler().canCompileOnCPU());
@@ -431,7 +530,9 @@ struct GraphFuser {
       return false;
     // and the thing being chunked is fusable into the consumer
     Value * producer_for_chunk = chunk->input();
-    if (!isFusable(producer_for_chunk->node()) || !allUsersAreThisConsumer(chunk,producer_for_chunk))
+    if (!isFusable(producer_for_chunk->node()) ||
+        readsRowReduction(chunk, producer_for_chunk->node()) ||
+        !allUsersAreThisConsumer(chunk,producer_for_chunk))
       return false;
     // and all uses of the chunk are in this consumer
     for (auto s : chunk->outputs()) {
@@ -576,6 +677,10 @@ struct GraphFuser {
 
 } // anonymous namespace
 
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph) {
+  hoistLoopInvariants(graph->block());
+}
+
 void FuseGraph(std::shared_ptr<Graph>& graph) {
   GraphFuser(graph->block()).run();
 }
@@ -8,4 +8,9 @@ namespace torch { namespace jit {
 // can prevent fusion opportunities from being exploited.
 void FuseGraph(std::shared_ptr<Graph>& graph);
 
+// Moves pure ops whose inputs are all defined outside of a loop in front of it,
+// so that they run once and can be fused with the ops around the loop. Run it
+// before UnrollLoops, which leaves loops without a constant trip count.
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph);
+
 }}
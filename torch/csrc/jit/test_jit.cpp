@@ -769,6 +769,18 @@ void argumentSpecTest() {
   REQUIRE(!(c == a));
   REQUIRE(spec.count(c) == 0);
 
+  // matches() agrees with constructing and comparing a new spec
+  REQUIRE(b.matches(true, list));
+  REQUIRE(!b.matches(false, list));
+  REQUIRE(!b.matches(true, list2));
+  REQUIRE(c.matches(true, list2));
+  auto list3 = createVarList({ var(CF, {1}, true), var(CD, {1, 2}, false) });
+  REQUIRE(!b.matches(true, list3));
+  // same total number of dimensions, but distributed differently
+  auto list4 = createVarList({ var(CF, {1, 1}, true), var(CF, {1}, true) });
+  auto list5 = createVarList({ var(CF, {1}, true), var(CF, {1, 1}, true) });
+  REQUIRE(!ArgumentSpec(true, list4).matches(true, list5));
+
 }
 
 void shapeAnalysisTest() {
@@ -822,6 +834,32 @@ void testGraphExecutor() {
   REQUIRE(almostEqual(Variable(outputs[1]).data(), r1));
 }
 
+void testGraphExecutorDispatch() {
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+
+  auto g = std::make_shared<Graph>();
+  auto a = SymbolicVariable::asNewInput(*g);
+  auto b = SymbolicVariable::asNewInput(*g);
+  g->registerOutput((a * b + a).value());
+  GraphExecutor executor(g);
+
+  auto x = at::randn({1, 4}, at::kCPU);
+  auto y = at::randn({1, 4}, at::kCPU);
+  auto z = at::randn({2, 4}, at::kCPU);
+  // the second run finds its plan through the most recently used check
+  for(int i = 0; i < 2; ++i) {
+    auto outputs = executor.run(createVarList({v(x), v(y)}));
+    REQUIRE(almostEqual(Variable(outputs[0]).data(), x * y + x));
+  }
+
+  // alternating between specializations must keep producing correct results
+  for(int i = 0; i < 4; ++i) {
+    auto in = (i % 2 == 0) ? z : x;
+    auto outputs = executor.run(createVarList({v(in), v(in)}));
+    REQUIRE(almostEqual(Variable(outputs[0]).data(), in * in + in));
+  }
+}
+
 void testBlocks(std::ostream & out) {
   Graph g;
   auto a = Var::asNewInput(g, "a");
@@ -906,6 +944,7 @@ std::string runJITCPPTests() {
   std::stringstream out;
   testControlFlow();
   testGraphExecutor();
+  testGraphExecutorDispatch();
   testBlocks(out);
   testCreateAutodiffSubgraphs(out);
   testDifferentiate(out);
@@ -931,6 +970,8 @@ TEST_CASE( "jit test CPU", "[cpu]" ) {
   std::stringstream out;
   SECTION( "control flow" )
     testControlFlow();
+  SECTION( "graph executor dispatch" )
+    testGraphExecutorDispatch();
   SECTION( "blocks" )
     testBlocks(out);
   SECTION( "create autodiff subgraphs" )
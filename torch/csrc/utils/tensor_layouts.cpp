@@ -31,6 +31,13 @@ void initializeLayouts() {
   }
   registerLayoutObject((THPLayout*)sparse_coo_layout, at::Backend::SparseCPU);
   registerLayoutObject((THPLayout*)sparse_coo_layout, at::Backend::SparseCUDA);
+
+  // Not registered for any Backend: sparse CSR matrices are not Tensors (yet)
+  PyObject *sparse_csr_layout = THPLayout_New(at::Layout::SparseCsr, "torch.sparse_csr");
+  Py_INCREF(sparse_csr_layout);
+  if (PyModule_AddObject(torch_module, "sparse_csr", sparse_csr_layout) != 0) {
+    throw python_error();
+  }
 }
 
 }} // namespace torch::utils
@@ -92,6 +92,15 @@ const ::gloo::ReductionFunction<T>* reductionFunction(const ReduceOp& r) {
   throw std::runtime_error("Unhandled ReduceOp");
 }
 
+std::vector<void*> getTensorDataPointers(
+    const std::vector<at::Tensor>& tensors) {
+  std::vector<void*> ptrs(tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    ptrs[i] = tensors[i].data_ptr();
+  }
+  return ptrs;
+}
+
 std::vector<cudaStream_t> getStreamVector(AlgorithmEntry& entry) {
   std::vector<cudaStream_t> streams(entry.streams.size());
   for (size_t i = 0; i < entry.streams.size(); i++) {
@@ -299,6 +308,7 @@ void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
   const auto& key = entry.key;
   switch (key.collectiveType) {
     case CollectiveType::ALLREDUCE:
+    case CollectiveType::ALLREDUCE_COALESCED:
       GENERATE_ALL_TYPES(key.type->scalarType(), createAllreduce, entry);
       return;
     case CollectiveType::BROADCAST:
@@ -388,6 +398,9 @@ void ProcessGroupGloo::createBroadcast(AlgorithmEntry& entry) {
 // picks up the work, because it performs I/O and can fail. Any I/O
 // failure must be signaled through the Work future.
 //
+// If the key refers to registered tensors, no temporary tensors are
+// allocated and the entry refers to the registered tensors instead.
+//
 EntryType ProcessGroupGloo::construct(const AlgorithmKey& key) {
   CUDADevice deviceGuard;
   auto entry = std::unique_ptr<AlgorithmEntry>(new AlgorithmEntry);
@@ -395,10 +408,14 @@ EntryType ProcessGroupGloo::construct(const AlgorithmKey& key) {
 
   // Allocate source tensors for this entry
   auto& srcSizes = key.srcSizes;
-  entry->src.resize(srcSizes.size());
-  for (size_t i = 0; i < srcSizes.size(); i++) {
-    deviceGuard.setDevice(key.type->is_cuda() ? key.devices[i] : -1);
-    entry->src[i] = key.type->tensor(srcSizes[i]);
+  if (key.bufferId >= 0) {
+    entry->src = registeredTensors_[key.bufferId];
+  } else {
+    entry->src.resize(srcSizes.size());
+    for (size_t i = 0; i < srcSizes.size(); i++) {
+      deviceGuard.setDevice(key.type->is_cuda() ? key.devices[i] : -1);
+      entry->src[i] = key.type->tensor(srcSizes[i]);
+    }
   }
 
   // If these are CUDA tensors, create streams and events
@@ -445,6 +462,44 @@ AlgorithmEntry* ProcessGroupGloo::checkout(const AlgorithmKey& key) {
   return entry.get();
 }
 
+int ProcessGroupGloo::lookupRegisteredTensors(
+    const std::vector<at::Tensor>& tensors) const {
+  auto it = registeredTensorIds_.find(getTensorDataPointers(tensors));
+  if (it == registeredTensorIds_.end()) {
+    return -1;
+  }
+
+  // Data pointers alone are not enough; the tensors may be different
+  // views of the same memory.
+  const auto& registered = registeredTensors_[it->second];
+  for (size_t i = 0; i < tensors.size(); i++) {
+    if (tensors[i].type() != registered[i].type() ||
+        !tensors[i].sizes().equals(registered[i].sizes())) {
+      return -1;
+    }
+  }
+
+  return it->second;
+}
+
+void ProcessGroupGloo::registerTensors(
+    const std::vector<at::Tensor>& tensors) {
+  assertSameSizeAndType(tensors);
+  for (const auto& tensor : tensors) {
+    if (!tensor.is_contiguous()) {
+      throw std::invalid_argument("registered tensors must be contiguous");
+    }
+  }
+
+  auto ptrs = getTensorDataPointers(tensors);
+  if (registeredTensorIds_.count(ptrs) > 0) {
+    throw std::invalid_argument("tensors are already registered");
+  }
+
+  registeredTensorIds_.emplace(std::move(ptrs), registeredTensors_.size());
+  registeredTensors_.push_back(tensors);
+}
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::enqueue(
     AlgorithmEntry* entry) {
   auto work = std::make_shared<WorkGloo>();
@@ -466,10 +521,16 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
   key.srcSizes = getSizes(tensors);
   key.srcRank = opts.rootRank;
   key.srcTensor = opts.rootTensor;
+  key.bufferId = lookupRegisteredTensors(tensors);
 
   // Retrieve (create or wait for) pointer to cache entry
   auto entry = checkout(key);
 
+  // Registered tensors are operated on in place
+  if (key.bufferId >= 0) {
+    return enqueueInPlace(entry);
+  }
+
   // Only copy root tensor
   if (getRank() == opts.rootRank) {
     entry->src[opts.rootTensor].copy_(tensors[opts.rootTensor]);
@@ -512,10 +573,16 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   key.srcSizes = getSizes(tensors);
   key.devices = getDevices(tensors);
   key.reduceOp = opts.reduceOp;
+  key.bufferId = lookupRegisteredTensors(tensors);
 
   // Retrieve (create or wait for) cache entry
   auto entry = checkout(key);
 
+  // Registered tensors are operated on in place
+  if (key.bufferId >= 0) {
+    return enqueueInPlace(entry);
+  }
+
   // Copy input tensors
   for (size_t i = 0; i < tensors.size(); i++) {
     entry->src[i].copy_(tensors[i]);
@@ -547,4 +614,78 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   return enqueue(entry);
 }
 
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduceCoalesced(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  assertSameType(tensors);
+
+  const auto devices = getDevices(tensors);
+  int64_t numel = 0;
+  for (size_t i = 0; i < tensors.size(); i++) {
+    if (devices[i] != devices[0]) {
+      throw std::invalid_argument("argument contains mixed devices");
+    }
+    numel += tensors[i].numel();
+  }
+
+  // The entry is keyed on the total number of elements, so that lists
+  // of tensors with different sizes can reuse the same entry.
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLREDUCE_COALESCED;
+  key.type = &tensors[0].type();
+  key.srcSizes = {std::vector<int64_t>{numel}};
+  key.devices = {devices[0]};
+  key.reduceOp = opts.reduceOp;
+
+  // Retrieve (create or wait for) cache entry
+  auto entry = checkout(key);
+
+  // Pack input tensors into the flat tensor
+  std::vector<at::Tensor> slices(tensors.size());
+  int64_t offset = 0;
+  for (size_t i = 0; i < tensors.size(); i++) {
+    const auto n = tensors[i].numel();
+    slices[i] = entry->src[0].narrow(0, offset, n).view(tensors[i].sizes());
+    slices[i].copy_(tensors[i]);
+    offset += n;
+  }
+
+  // In case of CUDA, ensure that operations that are queued after
+  // this collective wait for the collective to complete.
+  if (key.type->is_cuda()) {
+    synchronizeStreams(thcState_, entry);
+    entry->run = [=]() mutable {
+      entry->algorithm->run();
+      THCStreamGuard guard(thcState_, entry->streams[0]);
+      for (size_t i = 0; i < tensors.size(); i++) {
+        tensors[i].copy_(slices[i]);
+      }
+    };
+  } else {
+    entry->run = [=]() mutable {
+      entry->algorithm->run();
+      for (size_t i = 0; i < tensors.size(); i++) {
+        tensors[i].copy_(slices[i]);
+      }
+    };
+  }
+
+  return enqueue(entry);
+}
+
+// Enqueues an entry whose algorithm operates on registered tensors.
+// There is nothing to copy in or out; in case of CUDA, the private
+// streams still have to wait for the public streams, since the
+// algorithm reads memory that may have been written to by kernels
+// queued on the public streams.
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::enqueueInPlace(
+    AlgorithmEntry* entry) {
+  if (entry->key.type->is_cuda()) {
+    synchronizeStreams(thcState_, entry);
+  }
+
+  entry->run = [=]() mutable { entry->algorithm->run(); };
+  return enqueue(entry);
+}
+
 } // namespace c10d
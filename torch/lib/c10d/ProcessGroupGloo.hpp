@@ -43,7 +43,8 @@ struct AlgorithmKey {
         (devices == other.devices) && (srcSizes == other.srcSizes) &&
         (dstSizes == other.dstSizes) && (srcRank == other.srcRank) &&
         (dstRank == other.dstRank) && (srcTensor == other.srcTensor) &&
-        (dstTensor == other.dstTensor) && (reduceOp == other.reduceOp);
+        (dstTensor == other.dstTensor) && (reduceOp == other.reduceOp) &&
+        (bufferId == other.bufferId);
   }
 
   CollectiveType collectiveType = CollectiveType::UNUSED;
@@ -57,6 +58,12 @@ struct AlgorithmKey {
   int dstTensor = -1;
   ReduceOp reduceOp = ReduceOp::UNUSED;
 
+  // Identifier of the registered tensors this algorithm operates on
+  // in place, or -1 if it operates on its own copies (see
+  // ProcessGroupGloo::registerTensors). Registration happens in the
+  // same order on all processes, so this identifier is agreed upon.
+  int bufferId = -1;
+
   // This function is called by torch::hash<AlgorithmKey>
   static size_t hash(const AlgorithmKey& k) {
     return torch::get_hash(
@@ -69,7 +76,8 @@ struct AlgorithmKey {
         k.dstRank,
         k.srcTensor,
         k.dstTensor,
-        k.reduceOp);
+        k.reduceOp,
+        k.bufferId);
   }
 };
 
@@ -88,6 +96,13 @@ struct AlgorithmKey {
 // this to allow multiple entries per unique call, to better exploit
 // parallelism for calls with the same signature.
 //
+// There are two exceptions to the copying described above. Entries
+// for registered tensors (see ProcessGroupGloo::registerTensors) hold
+// references to the registered tensors themselves, and the algorithm
+// operates on them in place. Entries for coalesced allreduce hold a
+// single flat tensor that the inputs are packed into, and are keyed
+// on the total number of elements rather than the individual sizes.
+//
 struct AlgorithmEntry {
   AlgorithmKey key;
   std::unique_ptr<::gloo::Algorithm> algorithm;
@@ -243,6 +258,35 @@ class ProcessGroupGloo : public ProcessGroup {
       std::vector<at::Tensor>& tensors,
       const AllreduceOptions& opts = AllreduceOptions()) override;
 
+  // Reduces a list of tensors of the same type, on the same device,
+  // but with arbitrary sizes, using a single Gloo algorithm run.
+  //
+  // The tensors are packed into a flat buffer, reduced as one, and
+  // unpacked into the tensors again. This turns many collective calls
+  // for small tensors (e.g. gradients of small parameters) into one,
+  // and lets any list with the same total number of elements reuse
+  // the same algorithm instance. The list must have the same total
+  // number of elements on all processes.
+  //
+  std::shared_ptr<Work> allreduceCoalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions());
+
+  // Registers a list of tensors for zero-copy collectives.
+  //
+  // Subsequent broadcast and allreduce calls with exactly this list
+  // of tensors (same data pointers, sizes, and type) run the Gloo
+  // algorithm directly on their memory, instead of copying to and
+  // from the buffers held by the algorithm cache. The tensors must be
+  // contiguous and are kept alive for the lifetime of the process
+  // group, so that their addresses remain valid.
+  //
+  // Like the collectives, registration must happen in the same order
+  // on all processes. The caller must not modify registered tensors
+  // while a collective on them is in flight.
+  //
+  void registerTensors(const std::vector<at::Tensor>& tensors);
+
  protected:
   using KeyType = AlgorithmKey;
   using EntryType = std::unique_ptr<AlgorithmEntry>;
@@ -282,8 +326,24 @@ class ProcessGroupGloo : public ProcessGroup {
   // The list of cached algorithms, by algorithm key.
   std::unordered_map<KeyType, std::vector<EntryType>, HashType> cache_;
 
+  // Returns the buffer identifier of the registered tensors matching
+  // the specified list, or -1 if the list was not registered.
+  int lookupRegisteredTensors(const std::vector<at::Tensor>& tensors) const;
+
+  // Registered tensors, indexed by their buffer identifier.
+  std::vector<std::vector<at::Tensor>> registeredTensors_;
+
+  // Buffer identifier of registered tensors, by their data pointers.
+  std::unordered_map<
+      std::vector<void*>,
+      int,
+      torch::hash<std::vector<void*>>>
+      registeredTensorIds_;
+
   std::shared_ptr<Work> enqueue(AlgorithmEntry* entry);
 
+  std::shared_ptr<Work> enqueueInPlace(AlgorithmEntry* entry);
+
   std::deque<WorkType> queue_;
   std::mutex queueMutex_;
   std::condition_variable queueProduceCV_;
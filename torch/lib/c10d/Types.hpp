@@ -7,6 +7,7 @@ namespace c10d {
 enum class CollectiveType : std::uint8_t {
   BROADCAST,
   ALLREDUCE,
+  ALLREDUCE_COALESCED,
   UNUSED,
 };
 
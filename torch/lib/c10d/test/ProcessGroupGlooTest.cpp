@@ -188,6 +188,96 @@ void testAllreduce(const std::string& path, const at::Backend b) {
   }
 }
 
+void testAllreduceCoalesced(const std::string& path, const at::Backend b) {
+  const auto size = 4;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Generate inputs of different sizes
+  std::vector<std::vector<at::Tensor>> inputs(size);
+  for (auto i = 0; i < size; i++) {
+    const auto& type = at::getType(b, at::kFloat);
+    inputs[i] = std::vector<at::Tensor>({
+        at::ones(type, {16, 16}) * i,
+        at::ones(type, {3}) * i,
+        at::ones(type, {2, 5, 7}) * i,
+    });
+  }
+
+  // Kick off work
+  std::vector<std::shared_ptr<::c10d::ProcessGroup::Work>> work(size);
+  for (auto i = 0; i < size; i++) {
+    work[i] = tests[i].getProcessGroup().allreduceCoalesced(inputs[i]);
+  }
+
+  // Wait for work to complete
+  for (auto i = 0; i < size; i++) {
+    if (!work[i]->wait()) {
+      throw work[i]->exception();
+    }
+  }
+
+  // Verify outputs
+  const auto expected = (size * (size - 1)) / 2;
+  auto outputs = copyTensors(inputs);
+  for (auto i = 0; i < size; i++) {
+    for (auto& tensor : outputs[i]) {
+      auto data = tensor.data<float>();
+      for (auto j = 0; j < tensor.numel(); j++) {
+        if (data[j] != expected) {
+          throw std::runtime_error("BOOM!");
+        }
+      }
+    }
+  }
+}
+
+void testAllreduceRegistered(const std::string& path, const at::Backend b) {
+  const auto size = 4;
+  const auto iterations = 3;
+  auto tests = CollectiveTest::initialize(path, size);
+
+  // Generate inputs and register them
+  std::vector<std::vector<at::Tensor>> inputs(size);
+  for (auto i = 0; i < size; i++) {
+    auto tensor = at::ones(at::getType(b, at::kFloat), {16, 16}) * i;
+    inputs[i] = std::vector<at::Tensor>({tensor});
+    tests[i].getProcessGroup().registerTensors(inputs[i]);
+  }
+
+  // Run multiple times to reuse the algorithm on the same memory
+  for (auto k = 0; k < iterations; k++) {
+    for (auto i = 0; i < size; i++) {
+      inputs[i][0].fill_(i + k);
+    }
+
+    // Kick off work
+    std::vector<std::shared_ptr<::c10d::ProcessGroup::Work>> work(size);
+    for (auto i = 0; i < size; i++) {
+      work[i] = tests[i].getProcessGroup().allreduce(inputs[i]);
+    }
+
+    // Wait for work to complete
+    for (auto i = 0; i < size; i++) {
+      if (!work[i]->wait()) {
+        throw work[i]->exception();
+      }
+    }
+
+    // Verify outputs
+    const auto expected = (size * (size - 1)) / 2 + size * k;
+    auto outputs = copyTensors(inputs);
+    for (auto i = 0; i < size; i++) {
+      auto& tensor = outputs[i][0];
+      auto data = tensor.data<float>();
+      for (auto j = 0; j < tensor.numel(); j++) {
+        if (data[j] != expected) {
+          throw std::runtime_error("BOOM!");
+        }
+      }
+    }
+  }
+}
+
 void testBroadcast(const std::string& path, const at::Backend b) {
   const auto size = 2;
   const auto stride = 2;
@@ -268,6 +358,21 @@ int main(int argc, char** argv) {
     testAllreduce(file.path, at::kCUDA);
   }
 
+  {
+    TemporaryFile file;
+    testAllreduceCoalesced(file.path, at::kCPU);
+  }
+
+  {
+    TemporaryFile file;
+    testAllreduceCoalesced(file.path, at::kCUDA);
+  }
+
+  {
+    TemporaryFile file;
+    testAllreduceRegistered(file.path, at::kCPU);
+  }
+
   {
     TemporaryFile file;
     testBroadcast(file.path, at::kCPU);
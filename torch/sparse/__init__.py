@@ -1 +1,96 @@
 # The Tensor classes are added to this module by python_tensor.cpp
+import torch
+
+__all__ = ['CsrTensor']
+
+
+class CsrTensor(object):
+    r"""A sparse matrix in compressed sparse row (CSR) format.
+
+    The matrix is stored as three 1-D tensors: ``crow_indices`` holds
+    ``size[0] + 1`` row pointers, so that the entries of row ``i`` are at
+    positions ``crow_indices[i]`` to ``crow_indices[i + 1] - 1`` of
+    ``col_indices`` (their columns) and ``values``. Compared to a COO matrix,
+    the row index of every entry is replaced by one pointer per row, and the
+    entries of any row can be found without a search.
+
+    Only CPU matrices with scalar values are supported.
+
+    Arguments:
+        crow_indices (LongTensor): row pointers
+        col_indices (LongTensor): column of every entry
+        values (Tensor): value of every entry
+        size (torch.Size or tuple): size of the matrix
+    """
+
+    layout = torch.sparse_csr
+
+    def __init__(self, crow_indices, col_indices, values, size):
+        self.crow_indices = crow_indices
+        self.col_indices = col_indices
+        self.values = values
+        self._size = torch.Size(size)
+
+    @classmethod
+    def from_tensor(cls, tensor):
+        r"""Converts a dense or sparse COO matrix to CSR format."""
+        if tensor.is_sparse:
+            components = torch._sparse_csr_from_coo(tensor)
+        else:
+            components = torch._sparse_csr_from_dense(tensor)
+        return cls(*components, size=tensor.size())
+
+    def size(self):
+        return self._size
+
+    @property
+    def shape(self):
+        return self._size
+
+    @property
+    def dtype(self):
+        return self.values.dtype
+
+    def dim(self):
+        return 2
+
+    def nnz(self):
+        return self.values.numel()
+
+    def to_dense(self):
+        return torch._sparse_csr_to_dense(self.crow_indices, self.col_indices, self.values, self._size)
+
+    def to_sparse_coo(self):
+        return torch._sparse_csr_to_coo(self.crow_indices, self.col_indices, self.values, self._size)
+
+    def addmm(self, input, mat2, beta=1, alpha=1):
+        r"""Returns ``beta * input + alpha * (self @ mat2)`` for a dense
+        ``mat2``."""
+        return torch._sparse_csr_addmm(input, self.crow_indices, self.col_indices, self.values,
+                                       self._size, mat2, beta=beta, alpha=alpha)
+
+    def mm(self, mat2):
+        r"""Returns the dense product of this matrix with the dense ``mat2``."""
+        return self.addmm(mat2.new_zeros(()), mat2, beta=0)
+
+    def __matmul__(self, mat2):
+        return self.mm(mat2)
+
+    def index_select(self, index):
+        r"""Returns the CSR matrix made of the rows in ``index``."""
+        components = torch._sparse_csr_index_select(self.crow_indices, self.col_indices, self.values, index)
+        return CsrTensor(*components, size=(index.numel(), self._size[1]))
+
+    def sum(self, dim):
+        r"""Sums the entries of every row (``dim=1``) or column (``dim=0``)
+        into a dense vector."""
+        if dim == 1 or dim == -1:
+            return torch._sparse_csr_sum_rows(self.crow_indices, self.values)
+        if dim == 0 or dim == -2:
+            result = self.values.new_zeros(self._size[1])
+            return result.index_add_(0, self.col_indices, self.values)
+        raise IndexError("dimension out of range (expected to be in range of [-2, 1], but got {})".format(dim))
+
+    def __repr__(self):
+        return 'CsrTensor(crow_indices={}, col_indices={}, values={}, size={})'.format(
+            self.crow_indices, self.col_indices, self.values, tuple(self._size))